@@ -18,12 +18,14 @@
 const uint32_t workBitSize=448;
 const uint32_t collisionBitSize=24;
 const uint32_t numRounds=5;
+const uint32_t workWords=workBitSize/64;
 
 class stepElem {	
 	friend class BeamHash_III;
 	
 	private:
-	std::bitset<workBitSize> workBits;
+	// little-endian, word 0 holds the lowest (collision) bits
+	uint64_t workBits[workWords];
 	std::vector<uint32_t> indexTree;
 
 	public: 
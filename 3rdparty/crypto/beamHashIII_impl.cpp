@@ -41,30 +41,104 @@ uint64_t siphash24(uint64_t state0, uint64_t state1, uint64_t state2, uint64_t s
 } //end namespace sipHash
 
 
-stepElem::stepElem(const uint64_t * prePow, uint32_t index) {
-	workBits.reset();
+/********
+
+    Work bits operations, on the plain word arrays
+
+********/
+
+namespace {
+
+const uint32_t indexBitSize = collisionBitSize + 1;
+const uint32_t solutionIndices = 1 << numRounds;
+
+void seedWork(uint64_t* work, const uint64_t* prePow, uint32_t index) {
+	for (uint32_t i=0; i<workWords; i++) {
+		work[i] = sipHash::siphash24(prePow[0],prePow[1],prePow[2],prePow[3],(index << 3)+i);
+	}
+}
+
+// The work bits are extended to 512 bits by the leading indices of the tree, and the lowest word is replaced by their mix
+void mixWork(uint64_t* work, uint32_t remLen, const uint32_t* tree, uint32_t treeSize) {
+	uint64_t tempBits[8];
+	for (uint32_t i=0; i<workWords; i++) tempBits[i] = work[i];
+	for (uint32_t i=workWords; i<8; i++) tempBits[i] = 0;
+
+	uint32_t padNum = ((512-remLen) + collisionBitSize) / indexBitSize;
+	padNum = std::min(padNum, treeSize);
+
+	// the last pad starts below 512, the bits beyond are dropped
+	for (uint32_t i=0; i<padNum; i++) {
+		uint32_t pos = remLen + i*indexBitSize;
+		uint32_t word = pos >> 6;
+		uint32_t shift = pos & 0x3F;
 
-	for (int32_t i=6; i>=0; i--) {
-		workBits = (workBits << 64);
-		uint64_t hash=sipHash::siphash24(prePow[0],prePow[1],prePow[2],prePow[3],(index << 3)+i);
-		workBits |= hash; 		
+		tempBits[word] |= static_cast<uint64_t>(tree[i]) << shift;
+		if (shift && (word < 7)) tempBits[word+1] |= static_cast<uint64_t>(tree[i]) >> (64-shift);
 	}
 
+	uint64_t result = 0;
+	for (uint32_t i=0; i<8; i++) {
+		result += sipHash::rotl(tempBits[i], (29*(i+1)) & 0x3F);
+	}
+
+	work[0] = sipHash::rotl(result, 24);
+}
+
+// May be done in-place (res aliasing a or b)
+void mergeWork(uint64_t* res, const uint64_t* a, const uint64_t* b, uint32_t remLen) {
+	for (uint32_t i=0; i<workWords-1; i++) {
+		res[i] = ((a[i] ^ b[i]) >> collisionBitSize) | ((a[i+1] ^ b[i+1]) << (64-collisionBitSize));
+	}
+	res[workWords-1] = (a[workWords-1] ^ b[workWords-1]) >> collisionBitSize;
+
+	for (uint32_t i=0; i<workWords; i++) {
+		uint32_t lo = i*64;
+		if (remLen <= lo) {
+			res[i] = 0;
+		} else if (remLen < lo+64) {
+			res[i] &= (static_cast<uint64_t>(1) << (remLen-lo)) - 1;
+		}
+	}
+}
+
+uint32_t getCollisionWork(const uint64_t* work) {
+	return static_cast<uint32_t>(work[0]) & ((1 << collisionBitSize) - 1);
+}
+
+bool isZeroWork(const uint64_t* work) {
+	uint64_t acc = 0;
+	for (uint32_t i=0; i<workWords; i++) acc |= work[i];
+	return !acc;
+}
+
+// Work length of the elements mixed in the given round (1-based), and of the result of their merge
+uint32_t getMixLen(uint32_t round) {
+	uint32_t remLen = workBitSize-(round-1)*collisionBitSize;
+	if (round == 5) remLen -= 64;
+	return remLen;
+}
+
+uint32_t getMergeLen(uint32_t round) {
+	uint32_t remLen = workBitSize-round*collisionBitSize;
+	if (round == 4) remLen -= 64;
+	if (round == 5) remLen = collisionBitSize;
+	return remLen;
+}
+
+} // namespace
+
+
+stepElem::stepElem(const uint64_t * prePow, uint32_t index) {
+	seedWork(workBits, prePow, index);
 	indexTree.assign(1, index);
 }
 
 stepElem::stepElem(const stepElem &a, const stepElem &b, uint32_t remLen) {
 	// Create a new rounds step element from matching two ancestors
-	workBits.reset();
-
-	workBits = a.workBits ^ b.workBits;
-	workBits = (workBits >> collisionBitSize);
-
-	std::bitset<workBitSize> mask;
-	mask.set();
-	mask = (mask >> (workBitSize-remLen));
-	workBits &= mask;
+	mergeWork(workBits, a.workBits, b.workBits, remLen);
 
+	indexTree.reserve(a.indexTree.size() + b.indexTree.size());
 	if (a.indexTree[0] < b.indexTree[0]) {
 		indexTree.insert(indexTree.end(), a.indexTree.begin(), a.indexTree.end());
 		indexTree.insert(indexTree.end(), b.indexTree.begin(), b.indexTree.end());
@@ -75,49 +149,19 @@ stepElem::stepElem(const stepElem &a, const stepElem &b, uint32_t remLen) {
 }
 
 void stepElem::applyMix(uint32_t remLen) {
-	std::bitset<512> tempBits(workBits.to_string());
-
-	// Add in the bits of the index tree to the end of work bits
-	uint32_t padNum = ((512-remLen) + collisionBitSize) / (collisionBitSize + 1);
-	padNum = std::min(padNum, static_cast<uint32_t>(indexTree.size()));
-
-	for (uint32_t i=0; i<padNum; i++) {
-		std::bitset<512> tmp(indexTree[i]);
-		tmp = tmp << (remLen+i*(collisionBitSize + 1));
-		tempBits |= tmp;
-	}
-
-
-	// Applyin the mix from the lined up bits
-	std::bitset<512> mask(0xFFFFFFFFFFFFFFFFUL);
-	uint64_t result = 0;
-	for (uint32_t i=0; i<8; i++) {
-		uint64_t tmp = (tempBits & mask).to_ullong();
-		tempBits = tempBits >> 64;
-
-		result += sipHash::rotl(tmp, (29*(i+1)) & 0x3F);
-	}
-	result = sipHash::rotl(result, 24);
-
-
-	// Wipe out lowest 64 bits in favor of the mixed bits
-	workBits = (workBits >> 64);
-	workBits = (workBits << 64);
-	workBits |= std::bitset<workBitSize>(result);
+	mixWork(workBits, remLen, &indexTree.front(), static_cast<uint32_t>(indexTree.size()));
 }
 
 uint32_t stepElem::getCollisionBits() const {
-	std::bitset<workBitSize> mask((1 << collisionBitSize) - 1);
-	return (uint32_t) (workBits & mask).to_ullong();
+	return getCollisionWork(workBits);
 }
 
 bool stepElem::isZero() {
-	return workBits.none();
+	return isZeroWork(workBits);
 }
 
 uint64_t getLowBits(stepElem test) {
-	std::bitset<workBitSize> mask(~0ULL);
-	return (uint64_t) (test.workBits & mask).to_ullong();
+	return test.workBits[0];
 }
 /********
 
@@ -143,10 +187,6 @@ bool indexAfter(stepElem &a, stepElem &b) {
 	return (a.indexTree[0] < b.indexTree[0]);
 }
 
-bool sortStepElement(const stepElem &a, const stepElem &b) {
-	return (a.getCollisionBits() < b.getCollisionBits());
-}
-
 
 /********
 
@@ -154,39 +194,27 @@ bool sortStepElement(const stepElem &a, const stepElem &b) {
 
 ********/
 
-std::vector<uint32_t> GetIndicesFromMinimal(std::vector<uint8_t> soln) {
-	std::bitset<800> inStream;
-	std::bitset<800> mask((1 << (collisionBitSize+1))-1);
+// 32 indices of 25 bits, packed little-endian into bytes 0..99
+void GetIndicesFromMinimal(const uint8_t* soln, uint32_t* indices) {
+	for (uint32_t i=0; i<solutionIndices; i++) {
+		uint32_t pos = i*indexBitSize;
+		const uint8_t* p = soln + (pos >> 3);
 
-	inStream.reset();
-	for (int32_t i = 99; i>=0; i--) {
-		inStream = (inStream << 8);
-		inStream |= (uint64_t) soln[i];
+		// the index with its bit offset always fits in 4 bytes
+		uint32_t val = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+		indices[i] = (val >> (pos & 7)) & ((1 << indexBitSize) - 1);
 	}
-
-	std::vector<uint32_t> res;
-	for (uint32_t i=0; i<32; i++) {
-		res.push_back((uint32_t) (inStream & mask).to_ullong() );
-		inStream = (inStream >> (collisionBitSize+1));
-	}
-
-	return res;
 }
 
-std::vector<uint8_t> GetMinimalFromIndices(std::vector<uint32_t> sol) {
-	std::bitset<800> inStream;
-	std::bitset<800> mask(0xFF);
+std::vector<uint8_t> GetMinimalFromIndices(const uint32_t* indices) {
+	std::vector<uint8_t> res(100, 0);
+	for (uint32_t i=0; i<solutionIndices; i++) {
+		uint32_t pos = i*indexBitSize;
+		uint64_t val = static_cast<uint64_t>(indices[i] & ((1 << indexBitSize) - 1)) << (pos & 7);
 
-	inStream.reset();
-	for (int32_t i = static_cast<uint32_t>(sol.size()); i>=0; i--) {
-		inStream = (inStream << (collisionBitSize+1));
-		inStream |= (uint64_t) sol[i];
-	}
-
-	std::vector<uint8_t> res;
-	for (uint32_t i=0; i<100; i++) {
-		res.push_back((uint8_t) (inStream & mask).to_ullong() );
-		inStream = (inStream >> 8);
+		for (uint32_t j = pos >> 3; val; j++, val >>= 8) {
+			res[j] |= static_cast<uint8_t>(val);
+		}
 	}
 
 	return res;
@@ -215,61 +243,122 @@ bool BeamHash_III::IsValidSolution(const blake2b_state& base_state, std::vector<
 	if (soln.size() != 104)  {		
 		return false;
     	}
-	
+
+	// This will only evaluate bytes 0..99
+	uint32_t indices[solutionIndices];
+	GetIndicesFromMinimal(&soln[0], indices);
+
+	// Index order and distinctness don't depend on the hashes, so they are checked first.
+	// Once the order is valid, the tree of each element is a contiguous range of the indices.
+	for (uint32_t round=1; round<=numRounds; round++) {
+		uint32_t half = 1 << (round-1);
+		for (uint32_t i=0; i<solutionIndices; i += 2*half) {
+			if (indices[i] >= indices[i+half]) return false;
+		}
+	}
+
+	uint32_t sorted[solutionIndices];
+	std::copy(indices, indices + solutionIndices, sorted);
+	std::sort(sorted, sorted + solutionIndices);
+	if (std::adjacent_find(sorted, sorted + solutionIndices) != sorted + solutionIndices) {
+		return false;
+	}
+
 	uint64_t prePow[4];
 	blake2b_state state = base_state;
 	// Last 4 bytes of solution are our extra nonce
 	blake2b_update(&state, (uint8_t*) &soln[100], 4);			
 	blake2b_final(&state, (uint8_t*) &prePow[0], static_cast<uint8_t>(32));	
 
-	// This will only evaluate bytes 0..99
-	std::vector<uint32_t> indices = GetIndicesFromMinimal(soln);
+	// Elements are merged in-place, element i of the next round goes to X[i]
+	uint64_t X[solutionIndices][workWords];
+
+	for (uint32_t round=1; round<=numRounds; round++) {
+		uint32_t treeSize = 1 << (round-1);
+		uint32_t mixLen = getMixLen(round);
+		uint32_t mergeLen = getMergeLen(round);
+
+		for (uint32_t i=0; i < (solutionIndices >> (round-1)); i += 2) {
+			if (round == 1) {
+				seedWork(X[i], prePow, indices[i]);
+				seedWork(X[i+1], prePow, indices[i+1]);
+			}
+
+			mixWork(X[i], mixLen, indices + i*treeSize, treeSize);
+			mixWork(X[i+1], mixLen, indices + (i+1)*treeSize, treeSize);
+
+			if (getCollisionWork(X[i]) != getCollisionWork(X[i+1])) return false;
+
+			mergeWork(X[i/2], X[i], X[i+1], mergeLen);
+		}
+	}
+
+	return isZeroWork(X[0]);
+}
+
+
+#ifdef ENABLE_MINING
+
+namespace {
+
+// Solver memory, reused for the following nonces (by the same thread).
+// Elements of a round are kept in flat arrays: work words, the first (lowest) index of the tree, and the
+// pair of parents in the previous round (in the tree order). The trees are never copied, the leading indices
+// needed for the mix are collected through the parents.
+struct SolverArena {
+	std::vector<uint64_t> m_pWork[2];
+	std::vector<uint32_t> m_pFirst[2];
+	std::vector<uint32_t> m_pParents[numRounds]; // [0] is unused, seeds are their own indices
+
+	std::vector<uint64_t> m_Keys; // collision bits << 32 | element
+	std::vector<uint64_t> m_KeysTmp;
+	std::vector<uint32_t> m_Buckets;
 
-	std::vector<stepElem> X;
-	for (uint32_t i=0; i<indices.size(); i++) {
-		X.emplace_back(&prePow[0], indices[i]);
+	static SolverArena& get() {
+		static thread_local SolverArena s_Arena;
+		return s_Arena;
 	}
 
-	uint32_t round=1;
-	while (X.size() > 1) {
-		std::vector<stepElem> Xtmp;
-
-		for (size_t i = 0; i < X.size(); i += 2) {
-			uint32_t remLen = workBitSize-(round-1)*collisionBitSize;
-			if (round == 5) remLen -= 64;
-
-			X[i].applyMix(remLen);
-			X[i+1].applyMix(remLen);
-		
-			if (!hasCollision(X[i], X[i+1])) { 
-				//std::cout << "Collision Error" << i << " " << X.size() << " " << X[i].getCollisionBits() << " " << X[i+1].getCollisionBits() << std::endl;
-                		return false;
-            		}
-
-			if (!distinctIndices(X[i], X[i+1])) { 
-				//std::cout << "Non-Distinct" << i << " " << X.size() << std::endl;
-                		return false;
-            		}
-
-			if (!indexAfter(X[i], X[i+1])) { 
-				//std::cout << "Index Order" << i << " " << X.size() << std::endl;
-                		return false;
-            		}
-
-			remLen = workBitSize-round*collisionBitSize;
-			if (round == 4) remLen -= 64;
-			if (round == 5) remLen = collisionBitSize;
-
-			Xtmp.emplace_back(X[i], X[i+1], remLen);
+	uint32_t getLeaves(uint32_t level, uint32_t elem, uint32_t* res, uint32_t maxNum) const {
+		if (!level) {
+			res[0] = elem;
+			return 1;
 		}
 
-		X = Xtmp;
-		round++;
+		const uint32_t* parents = &m_pParents[level][2*elem];
+		uint32_t num = getLeaves(level-1, parents[0], res, maxNum);
+		if (num < maxNum) num += getLeaves(level-1, parents[1], res + num, maxNum - num);
+		return num;
 	}
 
-	return X[0].isZero();	
-}
+	// LSD radix by the collision bits, in 2 passes of 12 bits, so that the counters stay in cache
+	void sortKeys() {
+		const uint32_t bucketBits = collisionBitSize / 2;
+		const uint32_t bucketNum = 1 << bucketBits;
+
+		m_KeysTmp.resize(m_Keys.size());
+		m_Buckets.resize(bucketNum);
+
+		for (uint32_t pass=0; pass<2; pass++) {
+			uint32_t shift = 32 + pass*bucketBits;
+
+			std::fill(m_Buckets.begin(), m_Buckets.end(), 0);
+			for (uint64_t key : m_Keys) m_Buckets[(key >> shift) & (bucketNum-1)]++;
+
+			uint32_t pos = 0;
+			for (uint32_t& bucket : m_Buckets) {
+				uint32_t num = bucket;
+				bucket = pos;
+				pos += num;
+			}
+
+			for (uint64_t key : m_Keys) m_KeysTmp[m_Buckets[(key >> shift) & (bucketNum-1)]++] = key;
+			m_Keys.swap(m_KeysTmp);
+		}
+	}
+};
 
+} // namespace
 
 SolverCancelledException beamSolverCancelled;
 
@@ -285,94 +374,114 @@ bool BeamHash_III::OptimisedSolve(const blake2b_state& base_state,
 	blake2b_update(&state, (uint8_t*) &extraNonce, 4);			
 	blake2b_final(&state, (uint8_t*) &prePow[0], static_cast<uint8_t>(32));
 
-	std::vector<stepElem> elements;
-	elements.reserve(1 << (collisionBitSize+1)); 
+	// the cancel callback is too heavy to be invoked per element
+	const uint32_t cancelMask = (1 << 12) - 1;
+
+	SolverArena& arena = SolverArena::get();
+	uint32_t cur = 0;
+	uint32_t num = 1 << indexBitSize;
 
 	// Seeding
-	for (uint32_t i=0; i<(1 << (collisionBitSize+1)); i++) {
-		elements.emplace_back(&prePow[0], i);
-		if (cancelled(ListGeneration)) throw beamSolverCancelled;
+	arena.m_pWork[cur].resize(static_cast<size_t>(num) * workWords);
+	arena.m_pFirst[cur].resize(num);
+	for (uint32_t i=0; i<num; i++) {
+		seedWork(&arena.m_pWork[cur][static_cast<size_t>(i) * workWords], &prePow[0], i);
+		arena.m_pFirst[cur][i] = i;
+		if (!(i & cancelMask) && cancelled(ListGeneration)) throw beamSolverCancelled;
 	}
 
 	// Round 1 to 5
-	uint32_t round;
-	for (round=1; round<5; round++) {
-
-		uint32_t remLen = workBitSize-(round-1)*collisionBitSize;
-
-		// Mixing of elements
-		for (uint32_t i=0; i<elements.size(); i++) {
-			elements[i].applyMix(remLen);
-			if (cancelled(MixElements)) throw beamSolverCancelled;
+	for (uint32_t round=1; round<=numRounds; round++) {
+		uint32_t level = round-1;
+		uint32_t mixLen = getMixLen(round);
+		uint32_t mergeLen = getMergeLen(round);
+
+		std::vector<uint64_t>& work = arena.m_pWork[cur];
+		const std::vector<uint32_t>& first = arena.m_pFirst[cur];
+
+		// Mixing of elements, only the leading indices of the trees are needed
+		uint32_t padNum = std::min(((512-mixLen) + collisionBitSize) / indexBitSize, 1U << level);
+		uint32_t tree[solutionIndices];
+
+		arena.m_Keys.resize(num);
+		for (uint32_t i=0; i<num; i++) {
+			uint64_t* pWork = &work[static_cast<size_t>(i) * workWords];
+			arena.getLeaves(level, i, tree, padNum);
+			mixWork(pWork, mixLen, tree, padNum);
+
+			arena.m_Keys[i] = (static_cast<uint64_t>(getCollisionWork(pWork)) << 32) | i;
+			if (!(i & cancelMask) && cancelled(MixElements)) throw beamSolverCancelled;
 		}
 
 		// Sorting
-		std::sort(elements.begin(), elements.end(), sortStepElement);
+		arena.sortKeys();
 		if (cancelled(ListSorting)) throw beamSolverCancelled;
 
-		// Set length of output bits
-		remLen = workBitSize-round*collisionBitSize;
-		if (round == 4) remLen -= 64;
-
 		// Creating matches
-		std::vector<stepElem> outElements;
-		outElements.reserve(1 << (collisionBitSize+1));
-
-		for (uint32_t i=0; i<elements.size()-1; i++) {
-			uint32_t j=i+1;
-			while (j < elements.size()) {
-				if (hasCollision(elements[i], elements[j])) {
-					outElements.emplace_back(elements[i], elements[j], remLen);
-				} else {
-					break;
-				}
-				j++;
-			}
-			if (cancelled(ListColliding)) throw beamSolverCancelled;
-		}
-
-		elements = outElements;	
-	}
-
-	// Check the output of the last round for solutions
-	uint32_t remLen = workBitSize-(round-1)*collisionBitSize - 64;
-
-	// Mixing of elements
-	for (uint32_t i=0; i<elements.size(); i++) {
-		elements[i].applyMix(remLen);
-		if (cancelled(MixElements)) throw beamSolverCancelled;
-	}
-
-	// Sorting
-	std::sort(elements.begin(), elements.end(), sortStepElement);
-	if (cancelled(ListSorting)) throw beamSolverCancelled;
-
-	// Set length of output bits
-	remLen = collisionBitSize;
-
-	// Creating matches
-	for (uint32_t i=0; i<elements.size()-1; i++) {
-		uint32_t j=i+1;
-		while (j < elements.size()) {
-			if (hasCollision(elements[i], elements[j])) {
-				stepElem temp(elements[i], elements[j], remLen);
-
-				if (temp.isZero()) {
-					std::vector<uint8_t> sol = GetMinimalFromIndices(temp.indexTree);
+		std::vector<uint64_t>& workOut = arena.m_pWork[!cur];
+		std::vector<uint32_t>& firstOut = arena.m_pFirst[!cur];
+		workOut.clear();
+		firstOut.clear();
+		if (round < numRounds) arena.m_pParents[round].clear();
+
+		for (uint32_t i=0; i<num; ) {
+			uint32_t j = i+1;
+			uint64_t key = arena.m_Keys[i] >> 32;
+			while ((j < num) && ((arena.m_Keys[j] >> 32) == key)) j++;
+
+			for (uint32_t a=i; a<j; a++) {
+				for (uint32_t b=a+1; b<j; b++) {
+					uint32_t elemA = static_cast<uint32_t>(arena.m_Keys[a]);
+					uint32_t elemB = static_cast<uint32_t>(arena.m_Keys[b]);
+					if (first[elemA] > first[elemB]) std::swap(elemA, elemB);
+
+					const uint64_t* pWorkA = &work[static_cast<size_t>(elemA) * workWords];
+					const uint64_t* pWorkB = &work[static_cast<size_t>(elemB) * workWords];
+
+					if (round < numRounds) {
+						size_t pos = workOut.size();
+						workOut.resize(pos + workWords);
+						mergeWork(&workOut[pos], pWorkA, pWorkB, mergeLen);
+
+						firstOut.push_back(first[elemA]);
+						arena.m_pParents[round].push_back(elemA);
+						arena.m_pParents[round].push_back(elemB);
+						continue;
+					}
+
+					uint64_t res[workWords];
+					mergeWork(res, pWorkA, pWorkB, mergeLen);
+					if (!isZeroWork(res)) continue;
+
+					uint32_t indices[solutionIndices];
+					uint32_t half = solutionIndices / 2;
+					arena.getLeaves(level, elemA, indices, half);
+					arena.getLeaves(level, elemB, indices + half, half);
+
+					// the colliding subtrees may share indices, such a solution is invalid
+					uint32_t sorted[solutionIndices];
+					std::copy(indices, indices + solutionIndices, sorted);
+					std::sort(sorted, sorted + solutionIndices);
+					if (std::adjacent_find(sorted, sorted + solutionIndices) != sorted + solutionIndices) continue;
+
+					std::vector<uint8_t> sol = GetMinimalFromIndices(indices);
 
 					// Adding the extra nonce
 					for (uint32_t k=0; k<4; k++) sol.push_back(extraNonce[k]);
 
 					if (validBlock(sol))  return true;
 				}
-			} else {
-				break;
 			}
-			j++;
+
+			if (((i ^ j) & ~cancelMask) && cancelled(ListColliding)) throw beamSolverCancelled;
+			i = j;
 		}
-		if (cancelled(ListColliding)) throw beamSolverCancelled;
+
+		cur = !cur;
+		num = static_cast<uint32_t>(arena.m_pFirst[cur].size());
 	}
 
 	return false;
 }
 
+#endif // ENABLE_MINING
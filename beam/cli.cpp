@@ -183,7 +183,8 @@ int main_impl(int argc, char* argv[])
 #define LOG_FILES_PREFIX "node_"
 
 		const auto path = boost::filesystem::system_complete(LOG_FILES_DIR);
-		auto logger = beam::Logger::create(logLevel, logLevel, fileLogLevel, LOG_FILES_PREFIX, path.string());
+		size_t logAsyncRingSize = (vm.count(cli::LOG_ASYNC) && vm[cli::LOG_ASYNC].as<bool>()) ? Logger::DEF_ASYNC_RING_SIZE : 0;
+		auto logger = beam::Logger::create(logLevel, logLevel, fileLogLevel, LOG_FILES_PREFIX, path.string(), logAsyncRingSize);
 
 		try
 		{
@@ -343,6 +344,8 @@ int main_impl(int argc, char* argv[])
 					if (!vm[cli::BBS_ENABLE].as<bool>())
 						ZeroObject(node.m_Cfg.m_Bbs.m_Limit);
 
+					node.m_Cfg.m_Bbs.m_sPathJournal = vm[cli::BBS_JOURNAL].as<string>();
+
 					auto var = vm[cli::FAST_SYNC];
 					if (!var.empty())
 					{
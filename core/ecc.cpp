@@ -381,6 +381,144 @@ namespace ECC {
 		m_bInitialized = false;
 	}
 
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__) && !defined(__ANDROID__)
+	// compiled for several instruction sets, the appropriate one is selected at runtime
+#	define BEAM_HASH_LANES_TARGETS __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#	define BEAM_HASH_LANES_TARGETS
+#endif
+
+	namespace
+	{
+		const uint32_t s_pSha256K[64] = {
+			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+			0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+			0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+			0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+			0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+			0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+			0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+			0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+		};
+
+		inline uint32_t Sha256Rotr(uint32_t x, uint32_t n)
+		{
+			return (x >> n) | (x << (32 - n));
+		}
+
+		const uint32_t s_nLanes = Hash::Processor::s_Lanes;
+
+		// SHA-256 compression, lanes are interleaved (word-major), so that the inner loops are vectorized
+		BEAM_HASH_LANES_TARGETS
+		void Sha256TransformLanes(uint32_t (&pS)[8][s_nLanes], const uint32_t (&pBlock)[16][s_nLanes])
+		{
+			uint32_t pW[64][s_nLanes];
+			memcpy(pW, pBlock, sizeof(pBlock));
+
+			for (uint32_t i = 16; i < 64; i++)
+			{
+				for (uint32_t j = 0; j < s_nLanes; j++)
+				{
+					uint32_t w15 = pW[i - 15][j];
+					uint32_t w2 = pW[i - 2][j];
+
+					pW[i][j] = pW[i - 16][j] + pW[i - 7][j] +
+						(Sha256Rotr(w15, 7) ^ Sha256Rotr(w15, 18) ^ (w15 >> 3)) +
+						(Sha256Rotr(w2, 17) ^ Sha256Rotr(w2, 19) ^ (w2 >> 10));
+				}
+			}
+
+			uint32_t pV[8][s_nLanes];
+			memcpy(pV, pS, sizeof(pS));
+
+			for (uint32_t i = 0; i < 64; i++)
+			{
+				for (uint32_t j = 0; j < s_nLanes; j++)
+				{
+					uint32_t a = pV[0][j], b = pV[1][j], c = pV[2][j], d = pV[3][j];
+					uint32_t e = pV[4][j], f = pV[5][j], g = pV[6][j], h = pV[7][j];
+
+					uint32_t t1 = h + (Sha256Rotr(e, 6) ^ Sha256Rotr(e, 11) ^ Sha256Rotr(e, 25)) + (g ^ (e & (f ^ g))) + s_pSha256K[i] + pW[i][j];
+					uint32_t t2 = (Sha256Rotr(a, 2) ^ Sha256Rotr(a, 13) ^ Sha256Rotr(a, 22)) + ((a & b) | (c & (a | b)));
+
+					pV[7][j] = g;
+					pV[6][j] = f;
+					pV[5][j] = e;
+					pV[4][j] = d + t1;
+					pV[3][j] = c;
+					pV[2][j] = b;
+					pV[1][j] = a;
+					pV[0][j] = t1 + t2;
+				}
+			}
+
+			for (uint32_t i = 0; i < 8; i++)
+				for (uint32_t j = 0; j < s_nLanes; j++)
+					pS[i][j] += pV[i][j];
+		}
+
+	} // namespace
+
+	void Hash::Processor::FinalizeLanes(Value* pRes, const uint8_t* pTails, uint32_t nTail) const
+	{
+		assert(m_bInitialized && (nTail <= s_TailMax));
+
+		// buffered data, tail, padding and length. Up to 3 blocks
+		uint32_t nBuf = static_cast<uint32_t>(bytes & 0x3f);
+		uint32_t nBlocks = (nBuf + nTail + 9 + 63) >> 6;
+
+		uint8_t pMsg[64 * 3];
+		memset(pMsg, 0, nBlocks << 6);
+		memcpy(pMsg, buf, nBuf);
+		pMsg[nBuf + nTail] = 0x80;
+
+		uint64_t nBits = (static_cast<uint64_t>(bytes) + nTail) << 3;
+		for (uint32_t i = 0; i < 8; i++)
+			pMsg[(nBlocks << 6) - 1 - i] = static_cast<uint8_t>(nBits >> (i << 3));
+
+		uint32_t pS[8][s_nLanes];
+		for (uint32_t i = 0; i < 8; i++)
+			for (uint32_t j = 0; j < s_nLanes; j++)
+				pS[i][j] = s[i];
+
+		for (uint32_t iBlock = 0; iBlock < nBlocks; iBlock++)
+		{
+			uint32_t pBlock[16][s_nLanes];
+
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				uint32_t nPos = (iBlock << 6) + (i << 2);
+
+				for (uint32_t j = 0; j < s_nLanes; j++)
+				{
+					uint32_t w = 0;
+					for (uint32_t k = 0; k < 4; k++)
+					{
+						uint32_t n = nPos + k - nBuf; // relative to tail
+						uint8_t x = (n < nTail) ? pTails[j * nTail + n] : pMsg[nPos + k];
+						w = (w << 8) | x;
+					}
+					pBlock[i][j] = w;
+				}
+			}
+
+			Sha256TransformLanes(pS, pBlock);
+		}
+
+		for (uint32_t j = 0; j < s_nLanes; j++)
+		{
+			uint8_t* pDst = pRes[j].m_pData;
+			for (uint32_t i = 0; i < 8; i++, pDst += 4)
+			{
+				uint32_t w = pS[i][j];
+				pDst[0] = static_cast<uint8_t>(w >> 24);
+				pDst[1] = static_cast<uint8_t>(w >> 16);
+				pDst[2] = static_cast<uint8_t>(w >> 8);
+				pDst[3] = static_cast<uint8_t>(w);
+			}
+		}
+	}
+
 	void Hash::Processor::Write(const beam::Blob& v)
 	{
 		Write(v.p, v.n);
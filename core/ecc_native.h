@@ -602,6 +602,12 @@ namespace ECC
 		Processor& Serialize(const T&);
 
 		void operator >> (Value& hv) { Finalize(hv); }
+
+		// Finalizes s_Lanes messages at once, each is the current state followed by its own tail (all tails are of the same size).
+		// Intended for brute-force search, such as bbs PoW. Lanes are processed in lock-step, which is vectorized. The state is not modified.
+		static const uint32_t s_Lanes = 16;
+		static const uint32_t s_TailMax = 64;
+		void FinalizeLanes(Value* pRes, const uint8_t* pTails, uint32_t nTail) const;
 	};
 
 	class Hash::Mac
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "fly_client.h"
+#include "../utility/logger.h"
 
 namespace beam {
 namespace proto {
@@ -84,6 +85,7 @@ void FlyClient::NetworkStd::Connection::ResetVars()
     m_LoginFlags = 0;
     m_Flags = 0;
     m_NodeID = Zero;
+    m_TimeProgress_ms = 0;
 }
 
 void FlyClient::NetworkStd::Connection::ResetInternal()
@@ -91,6 +93,9 @@ void FlyClient::NetworkStd::Connection::ResetInternal()
     m_pSync.reset();
 	KillTimer();
 
+    if (m_pTimerRequest)
+        m_pTimerRequest->cancel();
+
     if (Flags::Owned & m_Flags)
         m_This.m_Client.OnOwnedNode(m_NodeID, false);
 
@@ -168,6 +173,47 @@ void FlyClient::NetworkStd::Connection::OnTimer()
     }
 }
 
+void FlyClient::NetworkStd::Connection::SetRequestTimer()
+{
+    uint32_t timeout_ms = m_This.m_Cfg.m_RequestTimeout_ms;
+    if (!timeout_ms || m_lst.empty())
+    {
+        if (m_pTimerRequest)
+            m_pTimerRequest->cancel();
+        return;
+    }
+
+    // responses come in order, the deadline is for the first request. Count from the last progress, since with pipelining
+    // the request may wait in the queue
+    uint32_t dt_ms = GetTime_ms() - std::max(m_lst.front().m_TimeSent_ms, m_TimeProgress_ms);
+
+    if (!m_pTimerRequest)
+        m_pTimerRequest = io::Timer::create(io::Reactor::get_Current());
+
+    m_pTimerRequest->start((dt_ms < timeout_ms) ? (timeout_ms - dt_ms) : 0, false, [this]() { OnRequestTimer(); });
+}
+
+void FlyClient::NetworkStd::Connection::OnRequestTimer()
+{
+    if (m_lst.empty())
+        return;
+
+    uint32_t dt_ms = GetTime_ms() - std::max(m_lst.front().m_TimeSent_ms, m_TimeProgress_ms);
+    if (dt_ms < m_This.m_Cfg.m_RequestTimeout_ms)
+    {
+        SetRequestTimer(); // rescheduled
+        return;
+    }
+
+    m_Stats.m_Timeouts++;
+    LOG_WARNING() << "Node " << m_Addr << " request timeout, pending=" << m_lst.size() << ", reconnecting";
+
+    // the responses can't be skipped, so drop the connection. Its requests are returned to the idle list
+    ResetAll();
+    SetTimer(m_This.m_Cfg.m_ReconnectTimeout_ms);
+    m_This.OnNewRequests();
+}
+
 void FlyClient::NetworkStd::Connection::OnMsg(Authentication&& msg)
 {
     NodeConnection::OnMsg(std::move(msg));
@@ -573,19 +619,106 @@ void FlyClient::NetworkStd::PostRequestInternal(Request& r)
     m_lst.push_back(*pNode);
     pNode->m_pRequest = &r;
 
-    OnNewRequests();
+    if (IsBatchable(r))
+    {
+        if (!m_pTimerBatch)
+            m_pTimerBatch = io::Timer::create(io::Reactor::get_Current());
+
+        m_pTimerBatch->start(0, false, [this]() { OnNewRequests(); });
+    }
+    else
+        OnNewRequests();
+}
+
+bool FlyClient::NetworkStd::IsBatchable(const Request& r)
+{
+    switch (r.get_Type())
+    {
+    case Request::Type::Utxo:
+        return !Cast::Up<RequestUtxo>(r).m_Msg.m_MaturityMin; // continuation is requested individually
+
+    case Request::Type::Kernel2:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool FlyClient::NetworkStd::IsSameBatch(const Request& r0, const Request& r1)
+{
+    if ((r0.get_Type() != r1.get_Type()) || !IsBatchable(r1))
+        return false;
+
+    if (Request::Type::Kernel2 == r0.get_Type())
+        return Cast::Up<RequestKernel2>(r0).m_Msg.m_Fetch == Cast::Up<RequestKernel2>(r1).m_Msg.m_Fetch;
+
+    return true;
 }
 
 void FlyClient::NetworkStd::OnNewRequests()
 {
-    for (ConnectionList::iterator it = m_Connections.begin(); m_Connections.end() != it; ++it)
+    for (RequestList::iterator it = m_lst.begin(); m_lst.end() != it; )
     {
-        Connection& c = *it;
-        if (c.IsLive() && c.IsSecureOut())
+        RequestNode& n = *it++;
+        assert(n.m_pRequest);
+        if (!n.m_pRequest->m_pTrg)
         {
-            c.AssignRequests();
-            break;
+            m_lst.Delete(n);
+            continue;
+        }
+
+        // least outstanding requests first, then the faster one. The prioritized (i.e. the most recent tip) wins the tie
+        Connection* pBest = nullptr;
+        for (ConnectionList::iterator itC = m_Connections.begin(); m_Connections.end() != itC; ++itC)
+        {
+            Connection& c = *itC;
+            if (!c.IsLive() || !c.IsSecureOut())
+                continue;
+
+            size_t nPending = c.m_lst.size();
+            if (m_Cfg.m_MaxPendingRequests && (nPending >= m_Cfg.m_MaxPendingRequests))
+                continue;
+
+            if (pBest)
+            {
+                if (nPending > pBest->m_lst.size())
+                    continue;
+                if ((nPending == pBest->m_lst.size()) && (c.m_Stats.get_LatencyAvg_ms() >= pBest->m_Stats.get_LatencyAvg_ms()))
+                    continue;
+            }
+
+            if (c.IsSupported(*n.m_pRequest))
+                pBest = &c;
+        }
+
+        if (!pBest)
+            continue;
+
+        if (IsBatchable(*n.m_pRequest) && pBest->IsBatchSupported())
+        {
+            std::vector<RequestNode*> vBatch;
+            vBatch.push_back(&n);
+
+            for (RequestList::iterator it2 = it; (m_lst.end() != it2) && (vBatch.size() < g_ProofsMultiMax); )
+            {
+                RequestNode& n2 = *it2++;
+                if (!n2.m_pRequest->m_pTrg || !IsSameBatch(*n.m_pRequest, *n2.m_pRequest))
+                    continue;
+
+                if ((m_lst.end() != it) && (&*it == &n2))
+                    ++it; // skip it in the outer loop
+                vBatch.push_back(&n2);
+            }
+
+            if (vBatch.size() > 1)
+            {
+                pBest->AssignBatch(vBatch);
+                continue;
+            }
         }
+
+        pBest->AssignRequest(n);
     }
 }
 
@@ -597,8 +730,7 @@ bool FlyClient::NetworkStd::Connection::IsAtTip() const
 
 void FlyClient::NetworkStd::Connection::AssignRequests()
 {
-    for (RequestList::iterator it = m_This.m_lst.begin(); m_This.m_lst.end() != it; )
-        AssignRequest(*it++);
+    m_This.OnNewRequests();
 
     if (m_lst.empty() && m_This.m_Cfg.m_PollPeriod_ms)
         SetTimer(m_This.m_Cfg.m_CloseConnectionDelay_ms); // this should allow to get sbbs messages
@@ -606,25 +738,31 @@ void FlyClient::NetworkStd::Connection::AssignRequests()
         KillTimer();
 }
 
-void FlyClient::NetworkStd::Connection::AssignRequest(RequestNode& n)
+bool FlyClient::NetworkStd::Connection::IsSupported(Request& r)
 {
-    assert(n.m_pRequest);
-    if (!n.m_pRequest->m_pTrg)
+    switch (r.get_Type())
     {
-        m_This.m_lst.Delete(n);
-        return;
+#define THE_MACRO(type, msgOut, msgIn) \
+    case Request::Type::type: \
+        return IsSupported(Cast::Up<Request##type>(r));
+
+    REQUEST_TYPES_All(THE_MACRO)
+#undef THE_MACRO
+
+    default: // ?!
+        return true; // would be discarded on assignment
     }
+}
+
+void FlyClient::NetworkStd::Connection::AssignRequest(RequestNode& n)
+{
+    assert(n.m_pRequest && n.m_pRequest->m_pTrg);
 
     switch (n.m_pRequest->get_Type())
     {
 #define THE_MACRO(type, msgOut, msgIn) \
     case Request::Type::type: \
-        { \
-            Request##type& req = Cast::Up<Request##type>(*n.m_pRequest); \
-            if (!IsSupported(req)) \
-                return; \
-            SendRequest(req); \
-        } \
+        SendRequest(Cast::Up<Request##type>(*n.m_pRequest)); \
         break;
 
     REQUEST_TYPES_All(THE_MACRO)
@@ -635,8 +773,64 @@ void FlyClient::NetworkStd::Connection::AssignRequest(RequestNode& n)
         return;
     }
 
+    n.m_Batch = 0;
+    AddPending(n);
+}
+
+void FlyClient::NetworkStd::Connection::AssignBatch(const std::vector<RequestNode*>& vBatch)
+{
+    assert(vBatch.size() > 1);
+    const Request& r0 = *vBatch.front()->m_pRequest;
+
+    if (Request::Type::Utxo == r0.get_Type())
+    {
+        GetProofUtxoMulti msg;
+        msg.m_Utxos.reserve(vBatch.size());
+
+        for (size_t i = 0; i < vBatch.size(); i++)
+            msg.m_Utxos.push_back(Cast::Up<RequestUtxo>(*vBatch[i]->m_pRequest).m_Msg.m_Utxo);
+
+        Send(msg);
+    }
+    else
+    {
+        GetProofKernelMulti msg;
+        msg.m_Fetch = Cast::Up<RequestKernel2>(r0).m_Msg.m_Fetch;
+        msg.m_IDs.reserve(vBatch.size());
+
+        for (size_t i = 0; i < vBatch.size(); i++)
+            msg.m_IDs.push_back(Cast::Up<RequestKernel2>(*vBatch[i]->m_pRequest).m_Msg.m_ID);
+
+        Send(msg);
+    }
+
+    for (size_t i = 0; i < vBatch.size(); i++)
+    {
+        vBatch[i]->m_Batch = 0;
+        AddPending(*vBatch[i]);
+    }
+
+    vBatch.front()->m_Batch = static_cast<uint32_t>(vBatch.size());
+}
+
+void FlyClient::NetworkStd::Connection::AddPending(RequestNode& n)
+{
     m_This.m_lst.erase(RequestList::s_iterator_to(n));
+
+    n.m_TimeSent_ms = GetTime_ms();
     m_lst.push_back(n);
+
+    if (m_lst.size() == 1)
+    {
+        KillTimer(); // in case it was scheduled to close
+        m_TimeProgress_ms = n.m_TimeSent_ms;
+        SetRequestTimer();
+    }
+}
+
+bool FlyClient::NetworkStd::Connection::IsBatchSupported() const
+{
+    return LoginFlags::Extension::get(m_LoginFlags) >= 7;
 }
 
 void FlyClient::NetworkStd::RequestList::Clear()
@@ -666,12 +860,93 @@ FlyClient::Request& FlyClient::NetworkStd::Connection::get_FirstRequestStrict(Re
     RequestNode& n = m_lst.front();
     assert(n.m_pRequest);
 
-    if (n.m_pRequest->get_Type() != x)
+    if ((n.m_pRequest->get_Type() != x) || n.m_Batch)
         ThrowUnexpected();
 
     return *n.m_pRequest;
 }
 
+uint32_t FlyClient::NetworkStd::Connection::get_FirstBatchStrict(Request::Type x)
+{
+    if (m_lst.empty())
+        ThrowUnexpected();
+    RequestNode& n = m_lst.front();
+    assert(n.m_pRequest);
+
+    if ((n.m_pRequest->get_Type() != x) || !n.m_Batch)
+        ThrowUnexpected();
+
+    uint32_t nBatch = n.m_Batch;
+    n.m_Batch = 0; // the requests are completed one by one
+    return nBatch;
+}
+
+void FlyClient::NetworkStd::Connection::OnMsg(ProofUtxoMulti&& msg)
+{
+    uint32_t nBatch = get_FirstBatchStrict(Request::Type::Utxo);
+    if (msg.m_Counts.size() != nBatch)
+        ThrowUnexpected();
+
+    Merkle::MultiPath::Reader rd(msg.m_Proofs);
+    size_t iState = 0;
+
+    for (uint32_t i = 0; i < nBatch; i++)
+    {
+        RequestUtxo& req = Cast::Up<RequestUtxo>(get_FirstRequestStrict(Request::Type::Utxo));
+
+        uint32_t nCount = msg.m_Counts[i];
+        if ((nCount > Input::Proof::s_EntriesMax) || (nCount > msg.m_States.size() - iState))
+            ThrowUnexpected();
+
+        req.m_Res.m_Proofs.resize(nCount);
+        for (uint32_t j = 0; j < nCount; j++)
+        {
+            Input::Proof& proof = req.m_Res.m_Proofs[j];
+            proof.m_State = msg.m_States[iState++];
+            if (!rd.Read(proof.m_Proof))
+                ThrowUnexpected();
+        }
+
+        OnRequestData(req);
+        OnFirstRequestDone(IsSupported(req));
+    }
+}
+
+void FlyClient::NetworkStd::Connection::OnMsg(ProofKernelMulti&& msg)
+{
+    uint32_t nBatch = get_FirstBatchStrict(Request::Type::Kernel2);
+    if (msg.m_Heights.size() != nBatch)
+        ThrowUnexpected();
+
+    Merkle::MultiPath::Reader rd(msg.m_Proofs);
+    size_t iKrn = 0;
+
+    for (uint32_t i = 0; i < nBatch; i++)
+    {
+        RequestKernel2& req = Cast::Up<RequestKernel2>(get_FirstRequestStrict(Request::Type::Kernel2));
+
+        req.m_Res.m_Height = msg.m_Heights[i];
+        req.m_Res.m_Proof.clear();
+        req.m_Res.m_Kernel.reset();
+
+        if (req.m_Res.m_Height)
+        {
+            if (!rd.Read(req.m_Res.m_Proof))
+                ThrowUnexpected();
+
+            if (req.m_Msg.m_Fetch)
+            {
+                if (iKrn >= msg.m_Kernels.size())
+                    ThrowUnexpected();
+                req.m_Res.m_Kernel = std::move(msg.m_Kernels[iKrn++]);
+            }
+        }
+
+        OnRequestData(req);
+        OnFirstRequestDone(IsSupported(req));
+    }
+}
+
 #define THE_MACRO_SWAP_FIELD(type, name) std::swap(req.m_Res.m_##name, msg.m_##name);
 #define THE_MACRO(type, msgOut, msgIn) \
 void FlyClient::NetworkStd::Connection::OnMsg(msgIn&& msg) \
@@ -853,6 +1128,13 @@ void FlyClient::NetworkStd::Connection::OnFirstRequestDone(bool bStillSupported)
     RequestNode& n = m_lst.front();
     assert(n.m_pRequest);
 
+    m_TimeProgress_ms = GetTime_ms();
+
+    uint32_t dt_ms = m_TimeProgress_ms - n.m_TimeSent_ms;
+    m_Stats.m_Requests++;
+    m_Stats.m_Latency_ms += dt_ms;
+    std::setmax(m_Stats.m_LatencyMax_ms, dt_ms);
+
     if (n.m_pRequest->m_pTrg)
     {
         if (!bStillSupported)
@@ -860,6 +1142,7 @@ void FlyClient::NetworkStd::Connection::OnFirstRequestDone(bool bStillSupported)
             // should retry
             m_lst.erase(RequestList::s_iterator_to(n));
             m_This.m_lst.push_back(n);
+            SetRequestTimer();
             m_This.OnNewRequests();
             return;
         }
@@ -869,6 +1152,11 @@ void FlyClient::NetworkStd::Connection::OnFirstRequestDone(bool bStillSupported)
     else
         m_lst.Delete(n); // aborted already
 
+    SetRequestTimer();
+
+    if (m_This.m_Cfg.m_MaxPendingRequests)
+        m_This.OnNewRequests(); // there's room for more
+
     if (m_lst.empty() && m_This.m_Cfg.m_PollPeriod_ms)
     {
         SetTimer(0);
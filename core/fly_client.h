@@ -134,6 +134,8 @@ namespace proto {
 				:public boost::intrusive::list_base_hook<>
 			{
 				Request::Ptr m_pRequest;
+				uint32_t m_TimeSent_ms = 0;
+				uint32_t m_Batch = 0; // if sent in a batch: its size, set for the 1st request. The others follow it
 			};
 
 			struct RequestList
@@ -146,13 +148,20 @@ namespace proto {
 			};
 			
 			RequestList m_lst; // idle
-			void OnNewRequests();
+			void OnNewRequests(); // assigns idle requests to the least loaded connections that support them
+
+			// utxo and kernel proofs are coalesced, if the node supports. They're assigned on the next loop iteration, so that the requests posted at-once are sent together
+			static bool IsBatchable(const Request&);
+			static bool IsSameBatch(const Request&, const Request&);
+			io::Timer::Ptr m_pTimerBatch;
 
 			struct Config {
 				std::vector<io::Address> m_vNodes;
 				uint32_t m_PollPeriod_ms = 0; // set to 0 to keep connection. Anyway poll period would be no less than the expected rate of blocks
 				uint32_t m_ReconnectTimeout_ms = 5000;
                 uint32_t m_CloseConnectionDelay_ms = 1000;
+				uint32_t m_MaxPendingRequests = 0; // pipelining depth per connection, 0 = unlimited
+				uint32_t m_RequestTimeout_ms = 30000; // if no response within this time - the connection is reset, and its requests are retried via others. 0 = no timeout
 				bool m_UseProxy = false;
 				io::Address m_ProxyAddr;
 			} m_Cfg;
@@ -182,6 +191,7 @@ namespace proto {
 				void PostChainworkProof(const StateArray&, Height hLowHeight);
 				void PrioritizeSelf();
 				Request& get_FirstRequestStrict(Request::Type);
+				uint32_t get_FirstBatchStrict(Request::Type);
 				void OnFirstRequestDone(bool bStillSupported);
 
 				io::Timer::Ptr m_pTimer;
@@ -189,6 +199,11 @@ namespace proto {
 				void SetTimer(uint32_t);
 				void KillTimer();
 
+				io::Timer::Ptr m_pTimerRequest;
+				uint32_t m_TimeProgress_ms; // last time a request was sent to the idle connection, or answered
+				void OnRequestTimer();
+				void SetRequestTimer();
+
 				void ResetInternal();
 				void ResetVars();
 
@@ -209,6 +224,21 @@ namespace proto {
 				RequestList m_lst; // in progress
 				void AssignRequests();
 				void AssignRequest(RequestNode&);
+				void AssignBatch(const std::vector<RequestNode*>&);
+				void AddPending(RequestNode&);
+				bool IsSupported(Request&);
+				bool IsBatchSupported() const;
+
+				// kept across reconnects
+				struct Stats
+				{
+					uint64_t m_Requests = 0; // answered
+					uint64_t m_Timeouts = 0;
+					uint64_t m_Latency_ms = 0; // total, from send to the response (including the queue on the node side)
+					uint32_t m_LatencyMax_ms = 0;
+
+					uint32_t get_LatencyAvg_ms() const { return m_Requests ? static_cast<uint32_t>(m_Latency_ms / m_Requests) : 0; }
+				} m_Stats;
 
 				bool IsAtTip() const;
 				uint32_t m_LoginFlags;
@@ -233,6 +263,8 @@ namespace proto {
 				virtual void OnMsg(proto::BbsMsg&& msg) override;
 				virtual void OnMsg(proto::EventsSerif&& msg) override;
 				virtual void OnMsg(PeerInfo&& msg) override;
+				virtual void OnMsg(proto::ProofUtxoMulti&& msg) override;
+				virtual void OnMsg(proto::ProofKernelMulti&& msg) override;
 #define THE_MACRO(type, msgOut, msgIn) \
 				virtual void OnMsg(proto::msgIn&&) override; \
 				bool IsSupported(Request##type&); \
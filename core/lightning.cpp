@@ -580,6 +580,12 @@ Channel::DataUpdate& Channel::CreateUpdatePoint(uint32_t iRole, const CoinID& ms
 	d.m_PeerKeyValid = false;
 	d.m_RevealedSelfKey = false;
 
+	// not all of them are set by every update type (e.g. no phase2 for Direct), but all are persisted
+	d.m_tx1.m_Offset = Zero;
+	d.m_tx2.m_Offset = Zero;
+	d.m_txPeer2.m_Offset = Zero;
+	d.m_PeerKey = Zero;
+
 	return d;
 }
 
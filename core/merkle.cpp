@@ -633,6 +633,45 @@ void MultiProof::Verifier::Process(uint64_t i)
 	}
 }
 
+/////////////////////////////
+// MultiPath
+void MultiPath::Builder::Add(const Proof& p)
+{
+	uint32_t nShared = 0;
+	while ((nShared < p.size()) && (nShared < m_Last.size()) && (p[p.size() - nShared - 1] == m_Last[m_Last.size() - nShared - 1]))
+		nShared++;
+
+	uint32_t nOwn = static_cast<uint32_t>(p.size()) - nShared;
+
+	m_This.m_vShared.push_back(nShared);
+	m_This.m_vOwn.push_back(nOwn);
+	m_This.m_vData.insert(m_This.m_vData.end(), p.begin(), p.begin() + nOwn);
+
+	m_Last = p;
+}
+
+bool MultiPath::Reader::Read(Proof& p)
+{
+	if ((m_iProof >= m_This.m_vShared.size()) || (m_iProof >= m_This.m_vOwn.size()))
+		return false;
+
+	uint32_t nShared = m_This.m_vShared[m_iProof];
+	uint32_t nOwn = m_This.m_vOwn[m_iProof];
+
+	if ((nShared > m_Last.size()) || (nOwn > m_This.m_vData.size() - m_iData))
+		return false;
+
+	m_iProof++;
+
+	p.resize(nOwn + nShared);
+	std::copy(m_This.m_vData.begin() + m_iData, m_This.m_vData.begin() + m_iData + nOwn, p.begin());
+	std::copy(m_Last.end() - nShared, m_Last.end(), p.begin() + nOwn);
+	m_iData += nOwn;
+
+	m_Last = p;
+	return true;
+}
+
 /////////////////////////////
 // HardVerifier
 HardVerifier::HardVerifier(const HardProof& p)
@@ -265,6 +265,44 @@ namespace Merkle {
 		};
 	};
 
+	// Several (arbitrary) proofs at-once, in a given order. Each proof is encoded vs the previous one: the upper part they have in common is omitted.
+	// Effective when the proofs end at the same root (i.e. several elements of the same tree, and the same path from the tree to the definition).
+	struct MultiPath
+	{
+		std::vector<uint32_t> m_vShared; // for each proof: num of its last nodes, which are the same as of the previous one
+		std::vector<uint32_t> m_vOwn; // for each proof: num of nodes preceeding the shared ones
+		Proof m_vData; // own nodes of all the proofs
+
+		template <typename Archive>
+		void serialize(Archive& ar)
+		{
+			ar
+				& m_vShared
+				& m_vOwn
+				& m_vData;
+		}
+
+		class Builder
+		{
+			MultiPath& m_This;
+			Proof m_Last;
+		public:
+			Builder(MultiPath& x) :m_This(x) {}
+			void Add(const Proof&);
+		};
+
+		class Reader
+		{
+			const MultiPath& m_This;
+			Proof m_Last;
+			size_t m_iProof = 0;
+			size_t m_iData = 0;
+		public:
+			Reader(const MultiPath& x) :m_This(x) {}
+			bool Read(Proof&); // returns false if no more proofs, or the encoding is invalid
+		};
+	};
+
 	// Helper class for arbitrary (custom) tree
 	// Can be used to get the root hash, build a proof, and verification (deduce number of nodes and their direction)
 	struct IEvaluator
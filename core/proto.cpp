@@ -189,7 +189,45 @@ void ProtocolPlus::InitCipher()
 }
 
 
-bool Bbs::Encrypt(ByteBuffer& res, const PeerID& publicAddr, ECC::Scalar::Native& nonce, const void* p, uint32_t n)
+const uint8_t Bbs::RecipientTag::s_pMarker[8] = { 'b', 'b', 's', '.', 't', 'a', 'g', 1 };
+
+void Bbs::RecipientTag::get_Value(Value& res, const PeerID& ephemeral, const PeerID& publicAddr)
+{
+    ECC::Hash::Value hv;
+    ECC::Hash::Processor()
+        << "bbs.tag"
+        << ephemeral
+        << publicAddr
+        >> hv;
+
+    static_assert(Value::nBytes <= ECC::Hash::Value::nBytes);
+    memcpy(res.m_pData, hv.m_pData, res.nBytes);
+}
+
+bool Bbs::RecipientTag::Read(const uint8_t* p, uint32_t& n)
+{
+    if (n < m_Ephemeral.nBytes + ECC::Hash::Value::nBytes + s_Size)
+        return false;
+
+    const uint8_t* pTrailer = p + n - s_Size;
+    if (memcmp(pTrailer + m_Value.nBytes, s_pMarker, sizeof(s_pMarker)))
+        return false;
+
+    memcpy(m_Ephemeral.m_pData, p, m_Ephemeral.nBytes);
+    memcpy(m_Value.m_pData, pTrailer, m_Value.nBytes);
+    n -= s_Size;
+
+    return true;
+}
+
+bool Bbs::RecipientTag::IsFor(const PeerID& publicAddr) const
+{
+    Value val;
+    get_Value(val, m_Ephemeral, publicAddr);
+    return val == m_Value;
+}
+
+bool Bbs::Encrypt(ByteBuffer& res, const PeerID& publicAddr, ECC::Scalar::Native& nonce, const void* p, uint32_t n, bool bTag /* = false */)
 {
     PeerID myPublic;
     myPublic.FromSk(nonce);
@@ -213,6 +251,15 @@ bool Bbs::Encrypt(ByteBuffer& res, const PeerID& publicAddr, ECC::Scalar::Native
 
     cOut.XCrypt(enc, pDst + myPublic.nBytes, hvMac.nBytes + n);
 
+    if (bTag)
+    {
+        RecipientTag::Value val;
+        RecipientTag::get_Value(val, myPublic, publicAddr);
+
+        res.insert(res.end(), val.m_pData, val.m_pData + val.nBytes);
+        res.insert(res.end(), RecipientTag::s_pMarker, RecipientTag::s_pMarker + sizeof(RecipientTag::s_pMarker));
+    }
+
     return true;
 }
 
@@ -84,6 +84,13 @@ namespace proto {
     macro(ECC::Point, Utxo) \
     macro(Height, MaturityMin) /* set to non-zero in case the result is too big, and should be retrieved within multiple queries */
 
+#define BeamNodeMsg_GetProofUtxoMulti(macro) \
+    macro(std::vector<ECC::Point>, Utxos)
+
+#define BeamNodeMsg_GetProofKernelMulti(macro) \
+    macro(std::vector<Merkle::Hash>, IDs) \
+    macro(bool, Fetch)
+
 #define BeamNodeMsg_GetProofShieldedOutp(macro) \
     macro(ECC::Point, SerialPub)
 
@@ -112,6 +119,16 @@ namespace proto {
 #define BeamNodeMsg_ProofUtxo(macro) \
     macro(std::vector<Input::Proof>, Proofs)
 
+#define BeamNodeMsg_ProofUtxoMulti(macro) \
+    macro(std::vector<uint32_t>, Counts) /* num of entries per utxo, up to Input::Proof::s_EntriesMax */ \
+    macro(std::vector<Input::State>, States) \
+    macro(Merkle::MultiPath, Proofs) /* for each entry */
+
+#define BeamNodeMsg_ProofKernelMulti(macro) \
+    macro(std::vector<Height>, Heights) /* 0 if not found */ \
+    macro(std::vector<TxKernel::Ptr>, Kernels) /* for each found, if requested */ \
+    macro(Merkle::MultiPath, Proofs) /* for each found */
+
 #define BeamNodeMsg_ProofShieldedOutp(macro) \
     macro(ECC::Point, Commitment) \
     macro(TxoID, ID) \
@@ -290,6 +307,10 @@ namespace proto {
     macro(0x36, ProofAsset) \
     macro(0x2a, GetShieldedList) \
     macro(0x2b, ShieldedList) \
+    macro(0x40, GetProofUtxoMulti) \
+    macro(0x41, ProofUtxoMulti) \
+    macro(0x42, GetProofKernelMulti) \
+    macro(0x43, ProofKernelMulti) \
     /* onwer-relevant */ \
     macro(0x2c, GetEvents) \
     /* macro(0x2d, EventsLegacy) Deprecated */ \
@@ -334,9 +355,10 @@ namespace proto {
             // 4 - Supports proto::Events (replaces proto::EventsLegacy)
             // 5 - Supports Events serif, max num of events per message increased from 64 to 1024
             // 6 - Newer Event::AssetCtl, newer Utxo events
+            // 7 - Supports GetProofUtxoMulti, GetProofKernelMulti
 
             static const uint32_t Minimum = 4;
-            static const uint32_t Maximum = 6;
+            static const uint32_t Maximum = 7;
 
             static void set(uint32_t& nFlags, uint32_t nExt);
             static uint32_t get(uint32_t nFlags);
@@ -351,6 +373,7 @@ namespace proto {
     };
 
 	static const uint32_t g_HdrPackMaxSize = 2048; // about 400K
+	static const uint32_t g_ProofsMultiMax = 256; // max num of elements in GetProof...Multi
 
     struct Event
     {
@@ -499,6 +522,7 @@ namespace proto {
     inline void ZeroInit(Block::SystemState::Full& x) { ZeroObject(x); }
     inline void ZeroInit(Block::SystemState::Sequence::Prefix& x) { ZeroObject(x); }
     inline void ZeroInit(Block::ChainWorkProof& x) {}
+    inline void ZeroInit(Merkle::MultiPath&) {}
     inline void ZeroInit(ECC::Point& x) { ZeroObject(x); }
     inline void ZeroInit(ECC::Signature& x) { ZeroObject(x); }
     inline void ZeroInit(TxKernel::LongProof& x) { ZeroObject(x.m_State); }
@@ -516,6 +540,11 @@ namespace proto {
         static void Set(std::unique_ptr<T>& var, TArg arg) { var = std::move(arg); }
     };
 
+    template <typename T> struct InitArg<std::vector<std::unique_ptr<T> > > {
+        typedef std::vector<std::unique_ptr<T> >& TArg;
+        static void Set(std::vector<std::unique_ptr<T> >& var, TArg arg) { var = std::move(arg); }
+    };
+
 	namespace Bbs
 	{
 		static const size_t s_MaxMsgSize = 1024 * 1024;
@@ -533,7 +562,24 @@ namespace proto {
 
 		typedef uintBig_t<4> NonceType;
 
-		bool Encrypt(ByteBuffer& res, const PeerID& publicAddr, ECC::Scalar::Native& nonce, const void*, uint32_t); // will fail iff addr is invalid
+		// Optional trailer of the encrypted message, lets the recipient find its address by a hash, instead of the trial decryption (ECDH per address).
+		// The tag depends on the ephemeral key, hence it doesn't link messages sent to the same address (unless the address is known).
+		// Older wallets don't recognize it, hence it's opt-in for the sender.
+		struct RecipientTag
+		{
+			typedef uintBig_t<8> Value;
+			static const uint8_t s_pMarker[8];
+			static const uint32_t s_Size = Value::nBytes + sizeof(s_pMarker);
+
+			PeerID m_Ephemeral;
+			Value m_Value;
+
+			static void get_Value(Value&, const PeerID& ephemeral, const PeerID& publicAddr);
+			bool Read(const uint8_t* p, uint32_t& n); // if the message is tagged - reads the tag and excludes it from the size
+			bool IsFor(const PeerID& publicAddr) const;
+		};
+
+		bool Encrypt(ByteBuffer& res, const PeerID& publicAddr, ECC::Scalar::Native& nonce, const void*, uint32_t, bool bTag = false); // will fail iff addr is invalid
 		bool Decrypt(uint8_t*& p, uint32_t& n, const ECC::Scalar::Native& privateAddr);
 	};
 
@@ -235,6 +235,39 @@ void TestHash()
 	}
 }
 
+void TestHashLanes()
+{
+	const uint32_t nLanes = Hash::Processor::s_Lanes;
+
+	uint8_t pPrefix[150];
+	uint8_t pTails[nLanes * Hash::Processor::s_TailMax];
+	GenRandom(pPrefix, sizeof(pPrefix));
+	GenRandom(pTails, sizeof(pTails));
+
+	// all the combinations of the buffered size and the num of blocks
+	const uint32_t pPrefixSize[] = { 0, 1, 20, 54, 55, 56, 63, 64, 65, 119, 150 };
+	const uint32_t pTailSize[] = { 0, 1, 9, 12, 55, 56, 63, Hash::Processor::s_TailMax };
+
+	for (uint32_t nPrefix : pPrefixSize)
+	{
+		Hash::Processor hp;
+		hp << beam::Blob(pPrefix, nPrefix);
+
+		for (uint32_t nTail : pTailSize)
+		{
+			Hash::Value pRes[nLanes];
+			hp.FinalizeLanes(pRes, pTails, nTail);
+
+			for (uint32_t j = 0; j < nLanes; j++)
+			{
+				Hash::Value hv;
+				Hash::Processor(hp) << beam::Blob(pTails + j * nTail, nTail) >> hv;
+				verify_test(hv == pRes[j]);
+			}
+		}
+	}
+}
+
 void TestScalars()
 {
 	Scalar::Native s0, s1, s2;
@@ -2184,6 +2217,7 @@ void TestAll()
 {
 	TestUintBig();
 	TestHash();
+	TestHashLanes();
 	TestScalars();
 	TestPoints();
 	TestSigning();
@@ -2518,6 +2552,45 @@ void RunBenchmark()
 		} while (bm.ShouldContinue());
 	}
 
+	{
+		// PoW-like search: common prefix, short varying tail
+		uint8_t pBuf[0x100];
+		GenRandom(pBuf, sizeof(pBuf));
+
+		Hash::Processor hpPrefix;
+		hpPrefix << beam::Blob(pBuf, sizeof(pBuf));
+
+		const uint32_t nTail = 9;
+		uint8_t pTails[Hash::Processor::s_Lanes * nTail];
+		GenRandom(pTails, sizeof(pTails));
+
+		{
+			BenchmarkMeter bm("Hash.Tail.x1");
+			do
+			{
+				for (uint32_t i = 0; i < bm.N; i++)
+				{
+					Hash::Processor(hpPrefix)
+						<< beam::Blob(pTails, nTail)
+						>> hv;
+				}
+
+			} while (bm.ShouldContinue());
+		}
+
+		{
+			Hash::Value pRes[Hash::Processor::s_Lanes];
+
+			BenchmarkMeter bm("Hash.Tail.Lanes");
+			do
+			{
+				for (uint32_t i = 0; i < bm.N; i++)
+					hpPrefix.FinalizeLanes(pRes, pTails, nTail);
+
+			} while (bm.ShouldContinue());
+		}
+	}
+
 	Hash::Processor() << "abcd" >> hv;
 
 	Signature sig;
@@ -20,13 +20,17 @@
 #include "nlohmann/json.hpp"
 #include "utility/helpers.h"
 #include "utility/logger.h"
+#include "utility/executor.h"
+#include "utility/io/asyncevent.h"
+#include <list>
+#include <unordered_map>
+#include <mutex>
 
 namespace beam { namespace explorer {
 
 namespace {
 
 static const size_t PACKER_FRAGMENTS_SIZE = 4096;
-static const size_t CACHE_DEPTH = 100000;
 
 const char* hash_to_hex(char* buf, const Merkle::Hash& hash) {
     return to_hex(buf, hash.m_pData, hash.nBytes);
@@ -47,61 +51,142 @@ const char* difficulty_to_hex(char* buf, const Difficulty& d) {
     return uint256_to_hex(buf, raw);
 }
 
-struct ResponseCache {
-    io::SharedBuffer status;
-    std::map<Height, io::SharedBuffer> blocks;
-    Height currentHeight=0;
+using nlohmann::json;
+
+// Quoted, 64 bits of the hash are enough
+void set_etag(Response& r, const ECC::Hash::Value& hv) {
+    char buf[20];
+    buf[0] = '"';
+    to_hex(buf + 1, hv.m_pData, 8);
+    buf[17] = '"';
+    buf[18] = 0;
+    r.etag = buf;
+}
+
+void set_etag(Response& r) {
+    ECC::Hash::Processor hp;
+    for (const auto& f : r.body) {
+        hp << Blob(f.data, static_cast<uint32_t>(f.size));
+    }
+    ECC::Hash::Value hv;
+    hp >> hv;
+    set_etag(r, hv);
+}
+
+Response::Ptr make_response(const json& j) {
+    HttpMsgCreator packer(PACKER_FRAGMENTS_SIZE);
+    io::SerializedMsg sm;
+    if (!serialize_json_msg(sm, packer, j)) {
+        return Response::Ptr();
+    }
+
+    auto r = std::make_shared<Response>();
+    r->body.push_back(io::normalize(sm, false));
+    r->size = r->body.back().size;
+    set_etag(*r);
+    return r;
+}
 
-    explicit ResponseCache(size_t depth) : _depth(depth)
+/// LRU cache of the rendered responses, bounded by their total size
+class ResponseCache {
+public:
+    enum Type : char { BLOCK = 'b', RANGE = 'r', KERNEL = 'k' };
+
+    struct Entry {
+        std::string key;
+        Response::Ptr response; // none for the kernel lookups
+        Height height; // the highest block it depends on
+        size_t size;
+    };
+
+    explicit ResponseCache(size_t maxSize) : _maxSize(maxSize)
     {}
 
-    void compact() {
-        if (blocks.empty() || currentHeight <= _depth) return;
-        Height horizon = currentHeight - _depth;
-        if (blocks.rbegin()->first < horizon) {
-            blocks.clear();
-            return;
-        }
-        auto b = blocks.begin();
-        auto it = b;
-        while (it != blocks.end()) {
-            if (it->first >= horizon) break;
-            ++it;
+    static std::string make_key(Type type, const void* p, size_t n) {
+        std::string key(1, type);
+        key.append(static_cast<const char*>(p), n);
+        return key;
+    }
+
+    static std::string block_key(Height h) {
+        return make_key(BLOCK, &h, sizeof(h));
+    }
+
+    static std::string range_key(Height h, uint64_t n) {
+        uint64_t p[] = { h, n };
+        return make_key(RANGE, p, sizeof(p));
+    }
+
+    static std::string kernel_key(const ByteBuffer& id) {
+        return make_key(KERNEL, id.data(), id.size());
+    }
+
+    const Entry* find(const std::string& key) {
+        auto it = _index.find(key);
+        if (it == _index.end()) return nullptr;
+        _lru.splice(_lru.begin(), _lru, it->second);
+        return &*it->second;
+    }
+
+    void put(std::string&& key, const Response::Ptr& response, Height h) {
+        erase(key);
+
+        static const size_t ENTRY_OVERHEAD = 128;
+        size_t size = key.size() * 2 + ENTRY_OVERHEAD + (response ? response->size : 0);
+        if (size > _maxSize) return;
+
+        _lru.push_front(Entry{ std::move(key), response, h, size });
+        _index[_lru.front().key] = _lru.begin();
+        _size += size;
+
+        while (_size > _maxSize) {
+            erase(_index.find(_lru.back().key));
         }
-        blocks.erase(b, it);
     }
 
-    bool get_block(io::SerializedMsg& out, Height h) {
-        const auto& it = blocks.find(h);
-        if (it == blocks.end()) return false;
-        out.push_back(it->second);
-        return true;
+    void erase(const std::string& key) {
+        erase(_index.find(key));
     }
 
-    void put_block(Height h, const io::SharedBuffer& body) {
-        if (currentHeight - h > _depth) return;
-        compact();
-        blocks[h] = body;
+    /// Erases everything that depends on the blocks starting from the given height
+    void rollback(Height h) {
+        for (auto it = _lru.begin(); it != _lru.end(); ) {
+            const Entry& e = *it++;
+            if (e.height >= h) {
+                erase(_index.find(e.key));
+            }
+        }
     }
 
 private:
-    size_t _depth;
-};
+    using List = std::list<Entry>;
+
+    void erase(std::unordered_map<std::string, List::iterator>::iterator it) {
+        if (it == _index.end()) return;
+        List::iterator itEntry = it->second;
+        _size -= itEntry->size;
+        _index.erase(it);
+        _lru.erase(itEntry);
+    }
 
-using nlohmann::json;
+    size_t _maxSize;
+    size_t _size = 0;
+    List _lru;
+    std::unordered_map<std::string, List::iterator> _index;
+};
 
 } //namespace
 
 /// Explorer server backend, gets callback on status update and returns json messages for server
 class Adapter : public Node::IObserver, public IAdapter {
 public:
-    Adapter(Node& node) :
-        _packer(PACKER_FRAGMENTS_SIZE),
+    Adapter(Node& node, uint32_t workerThreads, size_t cacheSize) :
 		_node(node),
         _nodeBackend(node.get_Processor()),
         _statusDirty(true),
         _nodeIsSyncing(true),
-        _cache(CACHE_DEPTH)
+        _cache(cacheSize),
+        _workerThreads(workerThreads)
     {
         init_helper_fragments();
         _hook = &node.m_Cfg.m_Observer;
@@ -110,6 +195,8 @@ public:
     }
 
     virtual ~Adapter() {
+        // the blocks being rendered are abandoned
+        _executor.reset();
         if (_nextHook) *_hook = _nextHook;
     }
 
@@ -142,54 +229,43 @@ private:
     }
 
     void OnStateChanged() override {
-        const auto& cursor = _nodeBackend.m_Cursor;
-        _cache.currentHeight = cursor.m_Sid.m_Height;
         _statusDirty = true;
         if (_nextHook) _nextHook->OnStateChanged();
     }
 
     void OnRolledBack(const Block::SystemState::ID& id) override {
 
-        auto& blocks = _cache.blocks;
+        _cache.rollback(id.m_Height);
 
-        blocks.erase(blocks.lower_bound(id.m_Height), blocks.end());
+        // blocks being rendered now are not cached
+        ++_generation;
 
         if (_nextHook) _nextHook->OnRolledBack(id);
     }
 
-    bool get_status(io::SerializedMsg& out) override {
+    void get_status(const Callback& cb) override {
         if (_statusDirty) {
             const auto& cursor = _nodeBackend.m_Cursor;
 
-            _cache.currentHeight = cursor.m_Sid.m_Height;
-
             char buf[80];
 
-            _sm.clear();
-            if (!serialize_json_msg(
-                _sm,
-                _packer,
+            _status = make_response(
                 json{
                     { "timestamp", cursor.m_Full.m_TimeStamp },
-                    { "height", _cache.currentHeight },
+                    { "height", cursor.m_Sid.m_Height },
                     { "low_horizon", _nodeBackend.m_Extra.m_TxoHi },
                     { "hash", hash_to_hex(buf, cursor.m_ID.m_Hash) },
                     { "chainwork",  uint256_to_hex(buf, cursor.m_Full.m_ChainWork) },
                     { "peers_count", _node.get_AcessiblePeerCount() }
                 }
-            )) {
-                return false;
-            }
+            );
 
-            _cache.status = io::normalize(_sm, false);
-            _statusDirty = false;
-            _sm.clear();
+            _statusDirty = !_status;
         }
-        out.push_back(_cache.status);
-        return true;
+        cb(_status);
     }
 
-    bool extract_row(Height height, uint64_t& row, uint64_t* prevRow) {
+    bool extract_row(Height height, uint64_t& row) {
         NodeDB& db = _nodeBackend.get_DB();
         NodeDB::WalkerState ws;
         db.EnumStatesAt(ws, height);
@@ -202,12 +278,6 @@ private:
                 break;
             }
         }
-        if (prevRow) {
-            *prevRow = row;
-            if (!db.get_Prev(*prevRow)) {
-                *prevRow = 0;
-            }
-        }
         return true;
     }
 
@@ -378,219 +448,378 @@ private:
         }
     };
 
+    struct BlockData {
+        Block::SystemState::Full state;
+        Block::SystemState::ID id;
+        Block::Body body;
+        std::vector<Output::Ptr> outsIn;
+        std::vector<Asset::Full> assets;
+    };
 
-    bool extract_block_from_row(json& out, uint64_t row, Height height) {
+    // db access, on the reactor thread
+    bool extract_block_data(BlockData& d, uint64_t row) {
         NodeDB& db = _nodeBackend.get_DB();
 
-        Block::SystemState::Full blockState;
-		Block::SystemState::ID id;
-		Block::Body block;
-		bool ok = true;
-        std::vector<Output::Ptr> vOutsIn;
-
         try {
-            db.get_State(row, blockState);
-			blockState.get_ID(id);
+            db.get_State(row, d.state);
+			d.state.get_ID(d.id);
 
 			NodeDB::StateID sid;
 			sid.m_Row = row;
-			sid.m_Height = id.m_Height;
-			_nodeBackend.ExtractBlockWithExtra(block, vOutsIn, sid);
+			sid.m_Height = d.id.m_Height;
+			_nodeBackend.ExtractBlockWithExtra(d.body, d.outsIn, sid);
 
 		} catch (...) {
-            ok = false;
+            return false;
         }
 
+        Asset::Full ai;
+        for (ai.m_ID = 1; ; ai.m_ID++)
+        {
+            int ret = _nodeBackend.get_AssetAt(ai, d.id.m_Height);
+            if (!ret)
+                break;
 
-        if (ok) {
-            char buf[80];
+            if (ret > 0)
+                d.assets.push_back(ai);
+        }
 
-            assert(block.m_vInputs.size() == vOutsIn.size());
+        return true;
+    }
 
-            json inputs = json::array();
-            for (size_t i = 0; i < block.m_vInputs.size(); i++)
-            {
-                const Input& inp = *block.m_vInputs[i];
-                const Output& outp = *vOutsIn[i];
-                assert(inp.m_Commitment == outp.m_Commitment);
+    // json rendering, may run on the worker threads
+    static Response::Ptr render_block(const BlockData& d) {
+        char buf[80];
+
+        Height height = d.id.m_Height;
+        const Block::Body& block = d.body;
+
+        assert(block.m_vInputs.size() == d.outsIn.size());
+
+        json inputs = json::array();
+        for (size_t i = 0; i < block.m_vInputs.size(); i++)
+        {
+            const Input& inp = *block.m_vInputs[i];
+            const Output& outp = *d.outsIn[i];
+            assert(inp.m_Commitment == outp.m_Commitment);
+
+            Height hCreate = inp.m_Internal.m_Maturity - outp.get_MinMaturity(0);
+
+            inputs.push_back(
+            json{
+                {"commitment", uint256_to_hex(buf, outp.m_Commitment.m_X)},
+                {"height",   hCreate},
+                {"extra",  ExtraInfo::get(outp, hCreate, inp.m_Internal.m_Maturity)}
+            }
+            );
+        }
+
+        json outputs = json::array();
+        for (const auto &v : block.m_vOutputs) {
+            outputs.push_back(
+            json{
+                {"commitment", uint256_to_hex(buf, v->m_Commitment.m_X)},
+                {"extra",  ExtraInfo::get(*v, height, v->get_MinMaturity(height))}
+            }
+            );
+        }
 
-                Height hCreate = inp.m_Internal.m_Maturity - outp.get_MinMaturity(0);
+        json kernels = json::array();
+        for (const auto &v : block.m_vKernels) {
 
-                inputs.push_back(
+            Amount fee = 0;
+            std::string sExtra = ExtraInfo::get(*v, fee);
+
+            kernels.push_back(
                 json{
-                    {"commitment", uint256_to_hex(buf, outp.m_Commitment.m_X)},
-                    {"height",   hCreate},
-                    {"extra",  ExtraInfo::get(outp, hCreate, inp.m_Internal.m_Maturity)}
+                    {"id", hash_to_hex(buf, v->m_Internal.m_ID)},
+                    {"minHeight", v->m_Height.m_Min},
+                    {"maxHeight", v->m_Height.m_Max},
+                    {"fee", fee},
+                    {"extra",  sExtra}
                 }
-                );
-            }
+            );
+        }
 
-            json outputs = json::array();
-            for (const auto &v : block.m_vOutputs) {
-                outputs.push_back(
+        json assets = json::array();
+        for (const auto& ai : d.assets) {
+            assets.push_back(
                 json{
-                    {"commitment", uint256_to_hex(buf, v->m_Commitment.m_X)},
-                    {"extra",  ExtraInfo::get(*v, height, v->get_MinMaturity(height))}
+                    {"id", ai.m_ID},
+                    {"metadata", ExtraInfo::get(ai.m_Metadata)},
+                    {"metahash", hash_to_hex(buf, ai.m_Metadata.m_Hash)},
+                    {"owner", hash_to_hex(buf, ai.m_Owner)},
+                    {"value_lo", AmountBig::get_Lo(ai.m_Value)},
+                    {"value_hi", AmountBig::get_Hi(ai.m_Value)},
+                    {"lock_height",  ai.m_LockHeight}
                 }
-                );
-            }
+            );
+        }
 
-            json kernels = json::array();
-            for (const auto &v : block.m_vKernels) {
+        json out{
+            {"found",      true},
+            {"timestamp",  d.state.m_TimeStamp},
+            {"height",     d.state.m_Height},
+            {"hash",       hash_to_hex(buf, d.id.m_Hash)},
+            {"prev",       hash_to_hex(buf, d.state.m_Prev)},
+            {"difficulty", d.state.m_PoW.m_Difficulty.ToFloat()},
+            {"chainwork",  uint256_to_hex(buf, d.state.m_ChainWork)},
+            {"subsidy",    Rules::get_Emission(d.state.m_Height)},
+            {"assets",     assets},
+            {"inputs",     inputs},
+            {"outputs",    outputs},
+            {"kernels",    kernels}
+        };
 
-                Amount fee = 0;
-                std::string sExtra = ExtraInfo::get(*v, fee);
+        LOG_DEBUG() << out;
 
-                kernels.push_back(
-                    json{
-                        {"id", hash_to_hex(buf, v->m_Internal.m_ID)},
-                        {"minHeight", v->m_Height.m_Min},
-                        {"maxHeight", v->m_Height.m_Max},
-                        {"fee", fee},
-                        {"extra",  sExtra}
-                    }
-                );
-            }
+        return make_response(out);
+    }
 
-            json assets = json::array();
-            Asset::Full ai;
-            for (ai.m_ID = 1; ; ai.m_ID++)
-            {
-                int ret = _nodeBackend.get_AssetAt(ai, height);
-                if (!ret)
-                    break;
+    /// Response of one block, or a range of blocks (in descending order). Completed once all the blocks are rendered
+    struct Request {
+        using Ptr = std::shared_ptr<Request>;
 
-                if (ret > 0)
-                {
-                    assets.push_back(
-                        json{
-                            {"id", ai.m_ID},
-                            {"metadata", ExtraInfo::get(ai.m_Metadata)},
-                            {"metahash", hash_to_hex(buf, ai.m_Metadata.m_Hash)},
-                            {"owner", hash_to_hex(buf, ai.m_Owner)},
-                            {"value_lo", AmountBig::get_Lo(ai.m_Value)},
-                            {"value_hi", AmountBig::get_Hi(ai.m_Value)},
-                            {"lock_height",  ai.m_LockHeight}
-                        }
-                    );
-                }
+        Callback callback;
+        std::vector<Response::Ptr> parts;
+        uint32_t pending = 0;
+        bool range = false;
+
+        // the range is cached if all its blocks exist, and there was no rollback meanwhile
+        bool cacheable = false;
+        uint64_t generation = 0;
+        Height start = 0;
+    };
+
+    struct RenderJob : public Executor::TaskAsync {
+        Adapter& _this;
+        uint64_t _generation;
+        BlockData _data;
+
+        RenderJob(Adapter& x, uint64_t generation) : _this(x), _generation(generation)
+        {}
+
+        void Exec(Executor::Context&) override {
+            Response::Ptr r = render_block(_data);
+
+            {
+                std::unique_lock<std::mutex> lock(_this._mutex);
+                _this._rendered.push_back({ _data.id.m_Height, _generation, std::move(r) });
             }
+            _this._renderedEvent->post();
+        }
+    };
+
+    struct Rendered {
+        Height height;
+        uint64_t generation;
+        Response::Ptr response;
+    };
+
+    using Waiters = std::vector<std::pair<Request::Ptr, size_t> >;
 
-            out = json{
-                {"found",      true},
-                {"timestamp",  blockState.m_TimeStamp},
-                {"height",     blockState.m_Height},
-                {"hash",       hash_to_hex(buf, id.m_Hash)},
-                {"prev",       hash_to_hex(buf, blockState.m_Prev)},
-                {"difficulty", blockState.m_PoW.m_Difficulty.ToFloat()},
-                {"chainwork",  uint256_to_hex(buf, blockState.m_ChainWork)},
-                {"subsidy",    Rules::get_Emission(blockState.m_Height)},
-                {"assets",     assets},
-                {"inputs",     inputs},
-                {"outputs",    outputs},
-                {"kernels",    kernels}
-            };
-
-            LOG_DEBUG() << out;
-        }
-        return ok;
+    void push_render(std::unique_ptr<RenderJob>&& job) {
+        if (!_executor) {
+            _renderedEvent = io::AsyncEvent::create(io::Reactor::get_Current(), [this]() { on_rendered(); });
+
+            _executor = std::make_unique<ExecutorMT>();
+            _executor->set_Threads(_workerThreads);
+        }
+        _executor->Push(std::move(job));
     }
 
-    bool extract_block(json& out, Height height, uint64_t& row, uint64_t* prevRow) {
-        bool ok = true;
-        if (row == 0) {
-            ok = extract_row(height, row, prevRow);
-        } else if (prevRow != 0) {
-            *prevRow = row;
-            if (!_nodeBackend.get_DB().get_Prev(*prevRow)) {
-                *prevRow = 0;
+    void on_rendered() {
+        std::vector<Rendered> rendered;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            rendered.swap(_rendered);
+        }
+
+        for (auto& x : rendered) {
+            auto it = _rendering.find({ x.height, x.generation });
+            assert(it != _rendering.end());
+            Waiters waiters = std::move(it->second);
+            _rendering.erase(it);
+
+            on_block_ready(x.height, x.generation, x.response);
+
+            for (const auto& w : waiters) {
+                const Request::Ptr& req = w.first;
+                req->parts[w.second] = x.response;
+                assert(req->pending);
+                if (!--req->pending) {
+                    complete(*req);
+                }
             }
         }
-        return ok && extract_block_from_row(out, row, height);
     }
 
-    bool get_block_impl(io::SerializedMsg& out, uint64_t height, uint64_t& row, uint64_t* prevRow) {
-        if (_cache.get_block(out, height)) {
-            if (prevRow && row > 0) {
-                extract_row(height, row, prevRow);
-            }
-            return true;
+    void on_block_ready(Height height, uint64_t generation, const Response::Ptr& r) {
+        if (r && (generation == _generation)) {
+            _cache.put(ResponseCache::block_key(height), r, height);
         }
+    }
 
-        if (_statusDirty) {
-            const auto &cursor = _nodeBackend.m_Cursor;
-            _cache.currentHeight = cursor.m_Sid.m_Height;
+    /// Takes the block from the cache, or from the pending render, or extracts it and starts rendering.
+    /// row: the row of the block above on input (0 if unknown), the row of this block on output (0 if it wasn't extracted)
+    void add_block(const Request::Ptr& req, size_t iPart, Height height, uint64_t& row) {
+        uint64_t rowAbove = row;
+        row = 0;
+
+        const ResponseCache::Entry* e = _cache.find(ResponseCache::block_key(height));
+        if (e) {
+            req->parts[iPart] = e->response;
+            return;
+        }
+
+        auto it = _rendering.find({ height, _generation });
+        if (it != _rendering.end()) {
+            it->second.emplace_back(req, iPart);
+            req->pending++;
+            return;
         }
 
-        io::SharedBuffer body;
-        bool blockAvailable = (height <= _cache.currentHeight);
+        bool blockAvailable = (height <= _nodeBackend.m_Cursor.m_Sid.m_Height);
         if (blockAvailable) {
-            json j;
-            if (!extract_block(j, height, row, prevRow)) {
-                blockAvailable = false;
+            if (rowAbove) {
+                row = rowAbove;
+                blockAvailable = _nodeBackend.get_DB().get_Prev(row);
             } else {
-                _sm.clear();
-                if (serialize_json_msg(_sm, _packer, j)) {
-                    body = io::normalize(_sm, false);
-                    _cache.put_block(height, body);
-                } else {
-                    return false;
-                }
-                _sm.clear();
+                blockAvailable = extract_row(height, row);
             }
         }
 
-        if (blockAvailable) {
-            out.push_back(body);
-            return true;
+        auto job = std::make_unique<RenderJob>(*this, _generation);
+        if (blockAvailable && !extract_block_data(job->_data, row)) {
+            blockAvailable = false;
         }
 
-        return serialize_json_msg(out, _packer, json{ { "found", false}, {"height", height } });
+        if (!blockAvailable) {
+            row = 0;
+            req->cacheable = false;
+            req->parts[iPart] = make_response(json{ { "found", false}, {"height", height } });
+            return;
+        }
+
+        if (!_workerThreads) {
+            req->parts[iPart] = render_block(job->_data);
+            on_block_ready(height, _generation, req->parts[iPart]);
+            return;
+        }
+
+        _rendering[{ height, _generation }].emplace_back(req, iPart);
+        req->pending++;
+        push_render(std::move(job));
     }
 
-    bool get_block(io::SerializedMsg& out, uint64_t height) override {
-        uint64_t row=0;
-        return get_block_impl(out, height, row, 0);
+    void complete(const Request& req) {
+        for (const auto& part : req.parts) {
+            if (!part) {
+                return req.callback(part);
+            }
+        }
+
+        if (!req.range) {
+            return req.callback(req.parts.front());
+        }
+
+        auto r = std::make_shared<Response>();
+        r->body.reserve(req.parts.size() * 2 + 1);
+
+        // the etag of the range is made of the etags of its blocks
+        ECC::Hash::Processor hp;
+
+        r->body.push_back(_leftBrace);
+        for (size_t i = 0; i < req.parts.size(); i++) {
+            const Response& part = *req.parts[i];
+            if (i) {
+                r->body.push_back(_comma);
+            }
+            r->body.insert(r->body.end(), part.body.begin(), part.body.end());
+            r->size += part.size + 1;
+            hp << part.etag;
+        }
+        r->body.push_back(_rightBrace);
+        r->size++;
+
+        ECC::Hash::Value hv;
+        hp >> hv;
+        set_etag(*r, hv);
+
+        if (req.cacheable && (req.generation == _generation)) {
+            uint64_t n = req.parts.size();
+            _cache.put(ResponseCache::range_key(req.start, n), r, req.start + n - 1);
+        }
+
+        req.callback(r);
     }
 
-    bool get_block_by_hash(io::SerializedMsg& out, const ByteBuffer& hash) override {
-        NodeDB& db = _nodeBackend.get_DB();
+    void get_block(const Callback& cb, uint64_t height) override {
+        auto req = std::make_shared<Request>();
+        req->callback = cb;
+        req->parts.resize(1);
 
-        Height height = db.FindBlock(hash);
         uint64_t row = 0;
+        add_block(req, 0, height, row);
 
-        return get_block_impl(out, height, row, 0);
+        if (!req->pending) {
+            complete(*req);
+        }
     }
 
-    bool get_block_by_kernel(io::SerializedMsg& out, const ByteBuffer& key) override {
+    void get_block_by_hash(const Callback& cb, const ByteBuffer& hash) override {
         NodeDB& db = _nodeBackend.get_DB();
 
-        Height height = db.FindKernel(key);
-        uint64_t row = 0;
+        Height height = db.FindBlock(hash);
+
+        get_block(cb, height);
+    }
+
+    void get_block_by_kernel(const Callback& cb, const ByteBuffer& key) override {
+        std::string cacheKey = ResponseCache::kernel_key(key);
+
+        Height height;
+        const ResponseCache::Entry* e = _cache.find(cacheKey);
+        if (e) {
+            height = e->height;
+        } else {
+            height = _nodeBackend.get_DB().FindKernel(key);
+            if (height >= Rules::HeightGenesis) {
+                _cache.put(std::move(cacheKey), Response::Ptr(), height);
+            }
+        }
 
-        return get_block_impl(out, height, row, 0);
+        get_block(cb, height);
     }
 
-    bool get_blocks(io::SerializedMsg& out, uint64_t startHeight, uint64_t n) override {
+    void get_blocks(const Callback& cb, uint64_t startHeight, uint64_t n) override {
         static const uint64_t maxElements = 1500;
         if (n > maxElements) n = maxElements;
         else if (n==0) n=1;
+
+        const ResponseCache::Entry* e = _cache.find(ResponseCache::range_key(startHeight, n));
+        if (e) {
+            return cb(e->response);
+        }
+
         Height endHeight = startHeight + n - 1;
-        out.push_back(_leftBrace);
+
+        auto req = std::make_shared<Request>();
+        req->callback = cb;
+        req->parts.resize(n);
+        req->range = true;
+        req->cacheable = true;
+        req->generation = _generation;
+        req->start = startHeight;
+
         uint64_t row = 0;
-        uint64_t prevRow = 0;
-        for (;;) {
-            bool ok = get_block_impl(out, endHeight, row, &prevRow);
-            if (!ok) return false;
-            if (endHeight == startHeight) {
-                break;
-            }
-            out.push_back(_comma);
-            row = prevRow;
-            --endHeight;
+        for (size_t i = 0; i < n; i++) {
+            add_block(req, i, endHeight - i, row);
+        }
+
+        if (!req->pending) {
+            complete(*req);
         }
-        out.push_back(_rightBrace);
-        return true;
     }
 
     bool get_peers(io::SerializedMsg& out) override
@@ -621,8 +850,6 @@ private:
         return true;
     }
 
-    HttpMsgCreator _packer;
-
     // node db interface
 	Node& _node;
     NodeProcessor& _nodeBackend;
@@ -640,14 +867,25 @@ private:
     Node::IObserver** _hook;
     Node::IObserver* _nextHook;
 
+    Response::Ptr _status;
     ResponseCache _cache;
 
-    io::SerializedMsg _sm;
+    // incremented on rollback, the blocks rendered before are not cached
+    uint64_t _generation = 0;
+
+    // blocks being rendered on the worker threads, and the requests waiting for them
+    std::map<std::pair<Height, uint64_t>, Waiters> _rendering;
+
+    uint32_t _workerThreads;
+    std::unique_ptr<ExecutorMT> _executor;
+    io::AsyncEvent::Ptr _renderedEvent;
+
+    std::mutex _mutex;
+    std::vector<Rendered> _rendered;
 };
 
-IAdapter::Ptr create_adapter(Node& node) {
-    return IAdapter::Ptr(new Adapter(node));
+IAdapter::Ptr create_adapter(Node& node, uint32_t workerThreads, size_t cacheSize) {
+    return IAdapter::Ptr(new Adapter(node, workerThreads, cacheSize));
 }
 
 }} //namespaces
-
@@ -12,8 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#pragma once
+
 #include "utility/io/buffer.h"
 #include "utility/common.h"
+#include <functional>
 
 namespace beam {
 
@@ -21,26 +24,45 @@ struct Node;
 
 namespace explorer {
 
+/// Response body, shared by the cache and the pending responses
+struct Response {
+    using Ptr = std::shared_ptr<const Response>;
+
+    io::SerializedMsg body;
+    size_t size = 0;
+
+    /// Quoted, as in the ETag header
+    std::string etag;
+};
+
 /// node->explorer adapter interface
 struct IAdapter {
     using Ptr = std::unique_ptr<IAdapter>;
 
+    /// Called on the reactor thread, either from within the request or later, once the body is rendered. nullptr on error
+    using Callback = std::function<void(const Response::Ptr&)>;
+
     virtual ~IAdapter() = default;
 
     /// Returns body for /status request
-    virtual bool get_status(io::SerializedMsg& out) = 0;
+    virtual void get_status(const Callback& cb) = 0;
 
-    virtual bool get_block(io::SerializedMsg& out, uint64_t height) = 0;
+    virtual void get_block(const Callback& cb, uint64_t height) = 0;
 
-    virtual bool get_block_by_hash(io::SerializedMsg& out, const ByteBuffer& hash) = 0;
+    virtual void get_block_by_hash(const Callback& cb, const ByteBuffer& hash) = 0;
 
-    virtual bool get_block_by_kernel(io::SerializedMsg& out, const ByteBuffer& key) = 0;
+    virtual void get_block_by_kernel(const Callback& cb, const ByteBuffer& key) = 0;
 
-    virtual bool get_blocks(io::SerializedMsg& out, uint64_t startHeight, uint64_t n) = 0;
+    virtual void get_blocks(const Callback& cb, uint64_t startHeight, uint64_t n) = 0;
 
     virtual bool get_peers(io::SerializedMsg& out) = 0;
 };
 
-IAdapter::Ptr create_adapter(Node& node);
+/// Defaults, the explorer node options use them too
+static const uint32_t DEFAULT_WORKER_THREADS = 2;
+static const uint32_t DEFAULT_CACHE_SIZE_MB = 64;
+
+/// Blocks are rendered on the worker threads (on the reactor if 0), the rendered responses are kept in the cache of the given size
+IAdapter::Ptr create_adapter(Node& node, uint32_t workerThreads = DEFAULT_WORKER_THREADS, size_t cacheSize = size_t(DEFAULT_CACHE_SIZE_MB) * 1024 * 1024);
 
 }} //namespaces
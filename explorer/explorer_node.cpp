@@ -22,6 +22,8 @@ using namespace std;
 #define LOG_FILES_DIR "logs"
 #define FILES_PREFIX "explorer-node"
 #define API_PORT_PARAMETER "api_port"
+#define API_THREADS_PARAMETER "api_threads"
+#define API_CACHE_SIZE_PARAMETER "api_cache_size"
 
 struct Options {
     std::string nodeDbFilename;
@@ -34,6 +36,8 @@ struct Options {
     static const unsigned logRotationPeriod = 3*60*60*1000; // 3 hours
     std::vector<uint32_t> whitelist;
     uint32_t logCleanupPeriod;
+    uint32_t apiThreads;
+    size_t apiCacheSize;
 };
 
 static bool parse_cmdline(int argc, char* argv[], Options& o);
@@ -61,7 +65,7 @@ int main(int argc, char* argv[]) {
 
         Node node;
         setup_node(node, options);
-        explorer::IAdapter::Ptr adapter = explorer::create_adapter(node);
+        explorer::IAdapter::Ptr adapter = explorer::create_adapter(node, options.apiThreads, options.apiCacheSize);
         node.Initialize();
         explorer::Server server(*adapter, *reactor, options.explorerListenTo, options.accessControlFile, options.whitelist);
         LOG_INFO() << "Node listens to " << options.nodeListenTo << ", explorer listens to " << options.explorerListenTo;
@@ -89,6 +93,8 @@ bool parse_cmdline(int argc, char* argv[], Options& o) {
         (cli::NODE_PEER, po::value<string>()->default_value("eu-node03.masternet.beam.mw:8100"), "peer address")
         (cli::PORT_FULL, po::value<uint16_t>()->default_value(10000), "port to start the local node on")
         (API_PORT_PARAMETER, po::value<uint16_t>()->default_value(8888), "port to start the local api server on")
+        (API_THREADS_PARAMETER, po::value<uint32_t>()->default_value(explorer::DEFAULT_WORKER_THREADS), "number of threads rendering the api responses (0 - render on the main thread)")
+        (API_CACHE_SIZE_PARAMETER, po::value<uint32_t>()->default_value(explorer::DEFAULT_CACHE_SIZE_MB), "api responses cache size (MB)")
         (cli::KEY_OWNER, po::value<string>()->default_value(""), "owner viewer key")
         (cli::PASS, po::value<string>()->default_value(""), "password for owner key")
         (cli::IP_WHITELIST, po::value<std::string>()->default_value(""), "IP whitelist")
@@ -130,6 +136,8 @@ bool parse_cmdline(int argc, char* argv[], Options& o) {
         o.nodeConnectTo = vm[cli::NODE_PEER].as<string>();
         o.nodeListenTo.port(vm[cli::PORT].as<uint16_t>());
         o.explorerListenTo.port(vm[API_PORT_PARAMETER].as<uint16_t>());
+        o.apiThreads = vm[API_THREADS_PARAMETER].as<uint32_t>();
+        o.apiCacheSize = size_t(vm[API_CACHE_SIZE_PARAMETER].as<uint32_t>()) * 1024 * 1024;
 
         std::string keyOwner = vm[cli::KEY_OWNER].as<string>();
         if (!keyOwner.empty())
@@ -85,7 +85,9 @@ void Server::on_stream_accepted(io::TcpStream::Ptr&& newStream, io::ErrorCode er
 
         newStream->enable_keepalive(1);
         LOG_DEBUG() << STS << "+peer " << peer;
-        _connections[peer.u64()] = std::make_unique<HttpConnection>(
+        Connection& c = _connections[peer.u64()];
+        c.pending.clear();
+        c.conn = std::make_unique<HttpConnection>(
             peer.u64(),
             BaseConnection::inbound,
             BIND_THIS_MEMFN(on_request),
@@ -115,9 +117,14 @@ bool Server::on_request(uint64_t id, const HttpMsgReader::Message& msg) {
         { "status", DIR_STATUS }, { "block", DIR_BLOCK }, { "blocks", DIR_BLOCKS }, { "peers", DIR_PEERS}
     };
 
-    const HttpConnection::Ptr& conn = it->second;
+    Connection& c = it->second;
 
-    bool (Server::*func)(const HttpConnection::Ptr&) = 0;
+    uint64_t slot = ++_lastSlot;
+    PendingResponse& pr = c.pending.emplace_back();
+    pr.slot = slot;
+    pr.ifNoneMatch = msg.msg->get_header("If-None-Match");
+
+    void (Server::*func)(uint64_t, uint64_t) = 0;
 
     if (_currentUrl.parse(path, dirs)) {
         switch (_currentUrl.dir) {
@@ -138,95 +145,151 @@ bool Server::on_request(uint64_t id, const HttpMsgReader::Message& msg) {
         }
     }
 
-    bool keepalive = false;
+    // the responses completed within the request are sent once it's handled
+    _inRequest = true;
 
     if (func) {
         //bool validKey = _acl.check(_currentUrl.args["m"], _currentUrl.args["n"], _currentUrl.args["h"]);
-        bool validKey = _acl.check(conn->peer_address());
+        bool validKey = _acl.check(c.conn->peer_address());
         if (!validKey) {
-            send(conn, 403, "Forbidden");
+            set_response(id, slot, 403, "Forbidden");
         } else {
-            keepalive = (this->*func)(conn);
+            (this->*func)(id, slot);
         }
     } else {
-        send(conn, 404, "Not Found");
+        set_response(id, slot, 404, "Not Found");
     }
 
-    if (!keepalive) {
-        conn->shutdown();
-        _connections.erase(it);
+    _inRequest = false;
+
+    return flush(id);
+}
+
+IAdapter::Callback Server::make_callback(uint64_t id, uint64_t slot, const char* errorMessage) {
+    return [this, id, slot, errorMessage](const Response::Ptr& response) {
+        if (response) {
+            set_response(id, slot, 200, "OK", response);
+        } else {
+            set_response(id, slot, 500, errorMessage);
+        }
+    };
+}
+
+void Server::set_response(uint64_t id, uint64_t slot, int code, const char* message, const Response::Ptr& response) {
+    auto it = _connections.find(id);
+    if (it == _connections.end()) return; // closed meanwhile
+
+    auto& pending = it->second.pending;
+    auto itPr = std::find_if(pending.begin(), pending.end(), [slot](const PendingResponse& x) { return x.slot == slot; });
+    if (itPr == pending.end()) return;
+
+    PendingResponse& pr = *itPr;
+    pr.code = code;
+    pr.message = message;
+    pr.response = response;
+
+    if (!_inRequest) {
+        flush(id);
     }
-    return keepalive;
 }
 
-bool Server::send_status(const HttpConnection::Ptr& conn) {
-    _body.clear();
-    if (!_backend.get_status(_body)) {
-        return send(conn, 500, "Internal error #1");
+bool Server::flush(uint64_t id) {
+    auto it = _connections.find(id);
+    if (it == _connections.end()) return false;
+
+    Connection& c = it->second;
+    while (!c.pending.empty() && c.pending.front().code) {
+        bool keepalive = send(c.conn, c.pending.front());
+        c.pending.pop_front();
+
+        if (!keepalive) {
+            c.conn->shutdown();
+            _connections.erase(it);
+            return false;
+        }
     }
-    return send(conn, 200, "OK");
+    return true;
 }
 
-bool Server::send_block(const HttpConnection::Ptr &conn) {
+void Server::send_status(uint64_t id, uint64_t slot) {
+    _backend.get_status(make_callback(id, slot, "Internal error #1"));
+}
+
+void Server::send_block(uint64_t id, uint64_t slot) {
 
     if (_currentUrl.has_arg("hash"))
     {
         ByteBuffer hash;
 
-        if (!_currentUrl.get_hex_arg("hash", hash) || !_backend.get_block_by_hash(_body, hash)) {
-            return send(conn, 500, "Internal error #2");
+        if (!_currentUrl.get_hex_arg("hash", hash)) {
+            return set_response(id, slot, 500, "Internal error #2");
         }
+        _backend.get_block_by_hash(make_callback(id, slot, "Internal error #2"), hash);
     }
     else if (_currentUrl.has_arg("kernel"))
     {
         ByteBuffer kernel;
 
-        if (!_currentUrl.get_hex_arg("kernel", kernel) || !_backend.get_block_by_kernel(_body, kernel)) {
-            return send(conn, 500, "Internal error #2");
+        if (!_currentUrl.get_hex_arg("kernel", kernel)) {
+            return set_response(id, slot, 500, "Internal error #2");
         }
+        _backend.get_block_by_kernel(make_callback(id, slot, "Internal error #2"), kernel);
     }
     else 
     {
         auto height = _currentUrl.get_int_arg("height", 0);
-        if (!_backend.get_block(_body, height)) {
-            return send(conn, 500, "Internal error #2");
-        }
+        _backend.get_block(make_callback(id, slot, "Internal error #2"), height);
     }
-
-    return send(conn, 200, "OK");
 }
 
-bool Server::send_blocks(const HttpConnection::Ptr& conn) {
+void Server::send_blocks(uint64_t id, uint64_t slot) {
     auto start = _currentUrl.get_int_arg("height", 0);
     auto n = _currentUrl.get_int_arg("n", 0);
     if (start <= 0 || n < 0) {
-        return send(conn, 400, "Bad request");
+        return set_response(id, slot, 400, "Bad request");
     }
-    if (!_backend.get_blocks(_body, start, n)) {
-        return send(conn, 500, "Internal error #3");
-    }
-    return send(conn, 200, "OK");
+    _backend.get_blocks(make_callback(id, slot, "Internal error #3"), start, n);
 }
 
-bool Server::send_peers(const HttpConnection::Ptr& conn) {
-    if (!_backend.get_peers(_body)) {
-        return send(conn, 500, "Internal error #3");
+void Server::send_peers(uint64_t id, uint64_t slot) {
+    auto response = std::make_shared<Response>();
+    if (!_backend.get_peers(response->body)) {
+        return set_response(id, slot, 500, "Internal error #3");
     }
-    return send(conn, 200, "OK");
+    for (const auto& f : response->body) { response->size += f.size; }
+    set_response(id, slot, 200, "OK", response);
 }
 
-bool Server::send(const HttpConnection::Ptr& conn, int code, const char* message) {
+bool Server::send(const HttpConnection::Ptr& conn, const PendingResponse& pr) {
     assert(conn);
 
-    size_t bodySize = 0;
-    for (const auto& f : _body) { bodySize += f.size; }
+    int code = pr.code;
+    const char* message = pr.message;
+    const Response* response = pr.response.get();
+
+    HeaderPair headers[1];
+    size_t numHeaders = 0;
+
+    if (response && !response->etag.empty()) {
+        headers[numHeaders++] = HeaderPair("ETag", response->etag.c_str());
+
+        // If-None-Match may be a list of etags, or *
+        const std::string& inm = pr.ifNoneMatch;
+        if (!inm.empty() && (inm == "*" || inm.find(response->etag) != std::string::npos)) {
+            code = 304;
+            message = "Not Modified";
+            response = nullptr;
+        }
+    }
+
+    size_t bodySize = response ? response->size : 0;
 
     bool ok = _msgCreator.create_response(
         _headers,
         code,
         message,
-        0, //headers,
-        0, //sizeof(headers) / sizeof(HeaderPair),
+        headers,
+        numHeaders,
         1,
         "application/json",
         bodySize
@@ -235,7 +298,7 @@ bool Server::send(const HttpConnection::Ptr& conn, int code, const char* message
     if (ok) {
         auto result = conn->write_msg(_headers);
         if (result && bodySize > 0) {
-            result = conn->write_msg(_body);
+            result = conn->write_msg(response->body);
         }
         if (!result) ok = false;
     } else {
@@ -243,8 +306,7 @@ bool Server::send(const HttpConnection::Ptr& conn, int code, const char* message
     }
 
     _headers.clear();
-    _body.clear();
-    return (ok && code == 200);
+    return (ok && (code == 200 || code == 304));
 }
 
 Server::IPAccessControl::IPAccessControl(const std::string &ipsFileName) :
@@ -17,13 +17,13 @@
 #include "utility/io/tcpserver.h"
 #include "utility/io/coarsetimer.h"
 #include "utility/helpers.h"
+#include "adapter.h"
 #include <string_view>
 #include <set>
+#include <deque>
 
 namespace beam { namespace explorer {
 
-struct IAdapter;
-
 class Server {
 public:
     Server(IAdapter& adapter, io::Reactor& reactor, io::Address bindAddress, const std::string& keysFileName, const std::vector<uint32_t>& whitelist);
@@ -48,12 +48,32 @@ private:
 
     void on_stream_accepted(io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode);
 
+    /// Responses are sent in the order of the requests, while some of them may be ready after the following ones
+    struct PendingResponse {
+        uint64_t slot = 0;
+        int code = 0; // not ready yet
+        const char* message = nullptr;
+        Response::Ptr response;
+        std::string ifNoneMatch;
+    };
+
+    struct Connection {
+        HttpConnection::Ptr conn;
+        std::deque<PendingResponse> pending;
+    };
+
     bool on_request(uint64_t id, const HttpMsgReader::Message& msg);
-    bool send_status(const HttpConnection::Ptr& conn);
-    bool send_block(const HttpConnection::Ptr& conn);
-    bool send_blocks(const HttpConnection::Ptr& conn);
-    bool send_peers(const HttpConnection::Ptr& conn);
-    bool send(const HttpConnection::Ptr& conn, int code, const char* message);
+    void send_status(uint64_t id, uint64_t slot);
+    void send_block(uint64_t id, uint64_t slot);
+    void send_blocks(uint64_t id, uint64_t slot);
+    void send_peers(uint64_t id, uint64_t slot);
+
+    IAdapter::Callback make_callback(uint64_t id, uint64_t slot, const char* errorMessage);
+    void set_response(uint64_t id, uint64_t slot, int code, const char* message, const Response::Ptr& response = Response::Ptr());
+
+    /// Sends the ready responses, returns false if the connection is closed
+    bool flush(uint64_t id);
+    bool send(const HttpConnection::Ptr& conn, const PendingResponse& pr);
 
     HttpMsgCreator _msgCreator;
     IAdapter& _backend;
@@ -61,10 +81,11 @@ private:
     io::MultipleTimers _timers;
     io::Address _bindAddress;
     io::TcpServer::Ptr _server;
-    std::map<uint64_t, HttpConnection::Ptr> _connections;
+    std::map<uint64_t, Connection> _connections;
     HttpUrl _currentUrl;
     io::SerializedMsg _headers;
-    io::SerializedMsg _body;
+    uint64_t _lastSlot = 0; // unique for all the connections, the late responses to the closed ones are ignored
+    bool _inRequest = false;
     //AccessControl _acl;
     IPAccessControl _acl;
     std::vector<uint32_t> _whitelist;
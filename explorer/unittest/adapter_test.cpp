@@ -13,9 +13,14 @@
 // limitations under the License.
 
 #include "explorer/adapter.h"
+#include "explorer/server.h"
+#include "http/http_client.h"
 #include "node/node.h"
 #include "utility/logger.h"
+#include "nlohmann/json.hpp"
 #include <future>
+#include <thread>
+#include <chrono>
 #include <boost/filesystem.hpp>
 #include <wallet/core/common_utils.h>
 
@@ -34,6 +39,7 @@ struct NodeParams {
 };
 
 static const uint16_t NODE_PORT=20000;
+static const uint16_t EXPLORER_PORT=20001;
 
 WaitHandle run_node(const NodeParams& params) {
     WaitHandle ret;
@@ -49,7 +55,7 @@ WaitHandle run_node(const NodeParams& params) {
             node.m_Cfg.m_Listen.ip(params.nodeAddress.ip());
             node.m_Cfg.m_MiningThreads = 1;
             node.m_Cfg.m_VerificationThreads = 1;
-            node.m_Cfg.m_TestMode.m_FakePowSolveTime_ms = 500;
+            node.m_Cfg.m_TestMode.m_FakePowSolveTime_ms = 200;
 
 			node.m_Keys.InitSingleKey(params.walletSeed);
 
@@ -61,10 +67,13 @@ WaitHandle run_node(const NodeParams& params) {
                 LOG_INFO() << "Treasury blocks read: " << node.m_Cfg.m_Treasury.size();
             }
 
-            explorer::IAdapter::Ptr adapter = explorer::create_adapter(node);
+            // the cache is small enough to evict the blocks
+            explorer::IAdapter::Ptr adapter = explorer::create_adapter(node, explorer::DEFAULT_WORKER_THREADS, 16 * 1024);
 
             LOG_INFO() << "starting a node on " << node.m_Cfg.m_Listen.port() << " port...";
             node.Initialize();
+
+            explorer::Server server(*adapter, *reactor, io::Address::localhost().port(EXPLORER_PORT), "", {});
             reactor->run();
         }
     );
@@ -73,6 +82,115 @@ WaitHandle run_node(const NodeParams& params) {
     return ret;
 }
 
+struct ExplorerClient {
+    using json = nlohmann::json;
+
+    struct Reply {
+        int status = 0;
+        std::string etag;
+        json body;
+    };
+
+    io::Reactor::Ptr reactor = io::Reactor::create();
+    HttpClient client;
+    int failures = 0;
+
+    ExplorerClient() : client(*reactor)
+    {}
+
+    Reply get(const std::string& path, const std::string& etag = "") {
+        Reply reply;
+
+        HeaderPair header("If-None-Match", etag.c_str());
+        HttpClient::Request request;
+        request
+            .address(io::Address::localhost().port(EXPLORER_PORT))
+            .pathAndQuery(path.c_str())
+            .headers(&header)
+            .numHeaders(etag.empty() ? 0 : 1)
+            .callback([this, &reply](uint64_t, const HttpMsgReader::Message& msg) -> bool {
+                if (msg.what == HttpMsgReader::http_message && msg.msg) {
+                    reply.status = msg.msg->get_status();
+                    reply.etag = msg.msg->get_header("ETag");
+                    size_t size = 0;
+                    auto body = static_cast<const char*>(msg.msg->get_body(size));
+                    if (size) {
+                        reply.body = json::parse(body, body + size, nullptr, false);
+                    }
+                }
+                reactor->stop();
+                return false;
+            });
+
+        if (client.send_request(request)) {
+            reactor->run();
+        }
+        return reply;
+    }
+
+    /// Polls /status until the height is reached, or the deadline passes. The node and the server start asynchronously
+    bool wait_for_height(Height h, int seconds) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+        while (true) {
+            Reply status = get("/status");
+            if (status.status == 200 && status.body.value("height", Height(0)) >= h) {
+                return true;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+
+    void check(bool ok, const char* what) {
+        if (!ok) {
+            LOG_ERROR() << "Explorer test failed: " << what;
+            failures++;
+        }
+    }
+
+    int test() {
+        Reply status = get("/status");
+        check(status.status == 200 && !status.etag.empty(), "status");
+
+        Height height = status.body.value("height", Height(0));
+        check(height >= Rules::HeightGenesis, "nothing mined");
+        if (!height) {
+            return failures;
+        }
+
+        uint64_t n = std::min(height, Height(5));
+        std::string range = "/blocks?height=1&n=" + std::to_string(n);
+
+        Reply blocks = get(range);
+        check(blocks.status == 200 && blocks.body.is_array() && blocks.body.size() == n, "blocks");
+        check(blocks.body[0]["height"] == n && blocks.body[n - 1]["height"] == 1, "blocks order");
+
+        // from the cache
+        Reply blocks2 = get(range);
+        check(blocks2.status == 200 && blocks2.body == blocks.body && blocks2.etag == blocks.etag, "cached blocks");
+        check(get(range, blocks.etag).status == 304, "blocks not modified");
+        check(get(range, "\"0000\"").status == 200, "blocks modified");
+
+        Reply block = get("/block?height=1");
+        check(block.status == 200 && block.body == blocks.body[n - 1], "block");
+        check(get("/block?height=1", block.etag).status == 304, "block not modified");
+
+        const json& kernels = block.body["kernels"];
+        check(kernels.is_array() && !kernels.empty(), "block kernels");
+        if (kernels.is_array() && !kernels.empty()) {
+            Reply byKernel = get("/block?kernel=" + kernels[0]["id"].get<std::string>());
+            check(byKernel.status == 200 && byKernel.body == block.body, "block by kernel");
+        }
+
+        Reply missing = get("/block?height=" + std::to_string(height + 1000));
+        check(missing.status == 200 && missing.body["found"] == false, "missing block");
+
+        return failures;
+    }
+};
+
 #define FILENAME "_xx"
 
 void cleanup_files() {
@@ -94,12 +212,14 @@ int test_adapter(int seconds) {
 
     WaitHandle nodeWH = run_node(nodeParams);
 
-    wait_for_termination(seconds);
+    ExplorerClient client;
+    client.check(client.wait_for_height(Rules::HeightGenesis, seconds), "node didn't mine in time");
+    int failures = client.test();
 
     nodeWH.reactor->stop();
     nodeWH.future.get();
 
-    return 0;
+    return failures;
 }
 
 } //namespace
@@ -122,13 +242,14 @@ int main(int argc, char* argv[]) {
     ECC::InitializeContext();
     Rules::get().DA.Target_s = 1; // 1 minute
     Rules::get().DA.Difficulty0 = 1;
+    Rules::get().TreasuryChecksum = Zero; // mine without treasury
 
     int seconds = 0;
     if (argc > 1) {
         seconds = atoi(argv[1]);
     }
     if (seconds == 0) {
-        seconds = 4;
+        seconds = 60; // deadline, the test proceeds as soon as the 1st block is mined
         Rules::get().FakePoW = true;
     }
 
@@ -283,6 +283,57 @@ namespace beam::wallet
         return Status::Success;
     }
 
+    IPrivateKeyKeeper2::Status::Type LocalPrivateKeyKeeper2::InvokeSync(Method::CreateOutputs& x)
+    {
+        struct MyTask
+            :public Executor::TaskSync
+        {
+            LocalPrivateKeyKeeper2* m_pThis;
+            Method::CreateOutput* m_pOutputs;
+            Status::Type* m_pStatus;
+            uint32_t m_Count;
+
+            virtual void Exec(Executor::Context& ctx) override
+            {
+                uint32_t i0, nCount;
+                ctx.get_Portion(i0, nCount, m_Count);
+
+                for (uint32_t i = 0; i < nCount; i++)
+                    m_pStatus[i0 + i] = m_pThis->InvokeSync(m_pOutputs[i0 + i]);
+            }
+
+        } t;
+
+        if (x.m_vOutputs.empty())
+            return Status::Success;
+
+        if (1 == x.m_vOutputs.size())
+            return InvokeSync(x.m_vOutputs.front());
+
+        // nonces are derived from the coin id, hence the result doesn't depend on the order of evaluation
+        std::vector<Status::Type> vStatus(x.m_vOutputs.size(), static_cast<Status::Type>(Status::Unspecified)); // by value, the constant has no definition
+
+        t.m_pThis = this;
+        t.m_pOutputs = &x.m_vOutputs.front();
+        t.m_pStatus = &vStatus.front();
+        t.m_Count = static_cast<uint32_t>(x.m_vOutputs.size());
+
+        if (Executor::s_pInstance)
+            Executor::s_pInstance->ExecAll(t);
+        else
+        {
+            ExecutorMT exec;
+            Executor::Scope scope(exec);
+            exec.ExecAll(t);
+        }
+
+        for (auto n : vStatus)
+            if (Status::Success != n)
+                return n;
+
+        return Status::Success;
+    }
+
     IPrivateKeyKeeper2::Status::Type LocalPrivateKeyKeeper2::InvokeSync(Method::CreateInputShielded& x)
     {
         assert(x.m_pKernel && x.m_pList);
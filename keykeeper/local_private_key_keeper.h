@@ -41,6 +41,9 @@ namespace beam::wallet
         KEY_KEEPER_METHODS(THE_MACRO)
 #undef THE_MACRO
 
+        // bulletproofs are generated in parallel, on the current executor if set
+        virtual Status::Type InvokeSync(Method::CreateOutputs& m) override;
+
     protected:
 
         ECC::Key::IKdf::Ptr m_pKdf;
@@ -0,0 +1,338 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bbs_store.h"
+#include "../core/serialization_adapters.h"
+#include "../utility/serialize.h"
+#include "../utility/logger.h"
+
+namespace beam {
+
+const uint32_t BbsStore::Journal::s_Version = 1;
+
+BbsStore::~BbsStore()
+{
+	if (m_Journal.m_Stream.IsOpen())
+	{
+		try {
+			m_Journal.m_Stream.Flush();
+		} catch (const std::exception& e) {
+			LOG_WARNING() << "Bbs journal flush failed: " << e.what();
+		}
+	}
+}
+
+size_t BbsStore::KeyHash::operator()(const Key& key) const
+{
+	// the key is already a hash
+	size_t ret;
+	memcpy(&ret, key.m_pData, sizeof(ret));
+	return ret;
+}
+
+const BbsStore::Msg* BbsStore::Find(const Key& key) const
+{
+	auto it = m_Keys.find(key);
+	return (m_Keys.end() == it) ? nullptr : it->second;
+}
+
+BbsStore::Msg& BbsStore::InsertInternal(const Key& key, BbsChannel channel, Timestamp ts, const Blob& msg, uint32_t nNonce)
+{
+	assert(!Find(key));
+
+	std::unique_ptr<Msg> pMsg = std::make_unique<Msg>();
+	Msg& x = *pMsg;
+
+	x.m_ID = ++m_LastID;
+	x.m_Key = key;
+	x.m_Channel = channel;
+	x.m_TimePosted = ts;
+	x.m_TimeMax = m_Msgs.empty() ? ts : std::max(ts, m_Msgs.back()->m_TimeMax);
+	x.m_Nonce = nNonce;
+	x.m_JournalSize = 0;
+	msg.Export(x.m_Message);
+
+	m_Msgs.push_back(std::move(pMsg));
+	m_Channels[channel].push_back(&x);
+	m_Keys[key] = &x;
+
+	m_Totals.m_Count++;
+	m_Totals.m_Size += msg.n;
+
+	return x;
+}
+
+const BbsStore::Msg& BbsStore::Insert(const Key& key, BbsChannel channel, Timestamp ts, const Blob& msg, uint32_t nNonce)
+{
+	Msg& x = InsertInternal(key, channel, ts, msg, nNonce);
+	if (m_Journal.m_Stream.IsOpen())
+		WriteJournal(x);
+	return x;
+}
+
+const BbsStore::Msg* BbsStore::get_Oldest() const
+{
+	return m_Msgs.empty() ? nullptr : m_Msgs.front().get();
+}
+
+void BbsStore::DeleteOldest()
+{
+	assert(!m_Msgs.empty());
+	const Msg& x = *m_Msgs.front();
+
+	auto itCh = m_Channels.find(x.m_Channel);
+	assert((m_Channels.end() != itCh) && (itCh->second.front() == &x));
+
+	itCh->second.pop_front();
+	if (itCh->second.empty())
+		m_Channels.erase(itCh);
+
+	m_Keys.erase(x.m_Key);
+
+	m_Totals.m_Count--;
+	m_Totals.m_Size -= x.m_Message.size();
+	m_Journal.m_SizeLive -= x.m_JournalSize;
+
+	m_Msgs.pop_front();
+}
+
+const BbsStore::Msg* BbsStore::get_Next(const Seq& seq, uint64_t id)
+{
+	auto it = std::upper_bound(seq.begin(), seq.end(), id, [](uint64_t id_, const Msg* p) { return id_ < p->m_ID; });
+	return (seq.end() == it) ? nullptr : *it;
+}
+
+const BbsStore::Msg* BbsStore::get_Next(uint64_t id) const
+{
+	if (m_Msgs.empty() || (id >= m_LastID))
+		return nullptr;
+
+	// IDs are sequential, no gaps
+	uint64_t id0 = m_Msgs.front()->m_ID;
+	if (id < id0)
+		return m_Msgs.front().get();
+
+	return m_Msgs[id - id0 + 1].get();
+}
+
+const BbsStore::Msg* BbsStore::get_Next(BbsChannel channel, uint64_t id) const
+{
+	auto it = m_Channels.find(channel);
+	return (m_Channels.end() == it) ? nullptr : get_Next(it->second, id);
+}
+
+uint64_t BbsStore::FindCursor(Timestamp ts) const
+{
+	// m_TimeMax is monotonic, the first msg with m_TimeMax >= ts is the first with m_TimePosted >= ts
+	auto it = std::lower_bound(m_Msgs.begin(), m_Msgs.end(), ts, [](const std::unique_ptr<Msg>& p, Timestamp ts_) { return p->m_TimeMax < ts_; });
+	return (m_Msgs.end() == it) ? (m_LastID + 1) : (*it)->m_ID;
+}
+
+Timestamp BbsStore::get_MaxTime() const
+{
+	return m_Msgs.empty() ? 0 : m_Msgs.back()->m_TimeMax;
+}
+
+/////////////////////////////
+// Journal
+// Header: version. Then records: key, channel, time posted, nonce, message.
+// The record that can't be read (i.e. incomplete last write) ends the journal.
+
+void BbsStore::WriteJournal(Msg& x)
+{
+	Serializer ser;
+	ser
+		& x.m_Key
+		& x.m_Channel
+		& x.m_TimePosted
+		& x.m_Nonce
+		& x.m_Message;
+
+	SerializeBuffer sb = ser.buffer();
+
+	try {
+		m_Journal.m_Stream.write(sb.first, sb.second);
+	} catch (const std::exception& e) {
+		LOG_WARNING() << "Bbs journal write failed: " << e.what() << ", journal disabled";
+		m_Journal.m_Stream.Close();
+		return;
+	}
+
+	x.m_JournalSize = static_cast<uint32_t>(sb.second);
+	m_Journal.m_Size += sb.second;
+	m_Journal.m_SizeLive += sb.second;
+}
+
+void BbsStore::LoadJournal()
+{
+	std::FStream fs;
+	if (!fs.Open(m_Journal.m_sPath.c_str(), true))
+		return;
+
+	bool bComplete = false;
+
+	try
+	{
+		yas::binary_iarchive<std::FStream, SERIALIZE_OPTIONS> der(fs);
+
+		uint32_t nVer = 0;
+		der & nVer;
+		if (Journal::s_Version != nVer)
+			throw std::runtime_error("unsupported version");
+
+		ByteBuffer buf;
+
+		while (true)
+		{
+			uint64_t nRemaining = fs.get_Remaining();
+			if (!nRemaining)
+				break;
+
+			Key key;
+			BbsChannel channel;
+			Timestamp ts;
+			uint32_t nNonce;
+
+			der
+				& key
+				& channel
+				& ts
+				& nNonce
+				& buf;
+
+			if (Find(key))
+				throw std::runtime_error("duplicate");
+
+			Msg& x = InsertInternal(key, channel, ts, buf, nNonce);
+			x.m_JournalSize = static_cast<uint32_t>(nRemaining - fs.get_Remaining());
+			m_Journal.m_SizeLive += x.m_JournalSize;
+		}
+
+		bComplete = true;
+	}
+	catch (const std::exception& e) {
+		LOG_WARNING() << "Bbs journal " << m_Journal.m_sPath << " truncated: " << e.what();
+	}
+
+	if (bComplete)
+		m_Journal.m_Size = fs.Tell();
+
+	LOG_INFO() << "Bbs journal loaded, " << m_Totals.m_Count << " msgs";
+}
+
+void BbsStore::OpenJournal(const std::string& sPath)
+{
+	assert(m_Msgs.empty() && !m_Journal.m_Stream.IsOpen());
+	m_Journal.m_sPath = sPath;
+
+	LoadJournal();
+
+	if (m_Journal.m_Size)
+	{
+		try {
+			m_Journal.m_Stream.Open(sPath.c_str(), false, true, true);
+		} catch (const std::exception& e) {
+			LOG_WARNING() << "Bbs journal open failed: " << e.what() << ", journal disabled";
+		}
+	}
+	else
+		RewriteJournal(); // new, or was damaged
+}
+
+void BbsStore::RewriteJournal()
+{
+	m_Journal.m_Stream.Close();
+	m_Journal.m_Size = 0;
+	m_Journal.m_SizeLive = 0;
+
+	std::string sTmp = m_Journal.m_sPath;
+	sTmp += ".tmp";
+
+	bool bOk = false;
+
+	try
+	{
+		m_Journal.m_Stream.Open(sTmp.c_str(), false, true);
+
+		Serializer ser;
+		ser & Journal::s_Version;
+		SerializeBuffer sb = ser.buffer();
+		m_Journal.m_Stream.write(sb.first, sb.second);
+		m_Journal.m_Size = sb.second;
+
+		for (const auto& pMsg : m_Msgs)
+		{
+			WriteJournal(*pMsg);
+			if (!m_Journal.m_Stream.IsOpen())
+				break;
+		}
+
+		if (m_Journal.m_Stream.IsOpen())
+		{
+			m_Journal.m_Stream.Flush();
+			bOk = true;
+		}
+	}
+	catch (const std::exception& e) {
+		LOG_WARNING() << "Bbs journal rewrite failed: " << e.what();
+	}
+
+	// reopen it for append after rename
+	m_Journal.m_Stream.Close();
+
+	if (bOk)
+	{
+#ifdef WIN32
+		bOk = MoveFileExW(Utf8toUtf16(sTmp.c_str()).c_str(), Utf8toUtf16(m_Journal.m_sPath.c_str()).c_str(), MOVEFILE_REPLACE_EXISTING);
+#else // WIN32
+		bOk = !rename(sTmp.c_str(), m_Journal.m_sPath.c_str());
+#endif // WIN32
+	}
+
+	if (bOk)
+		bOk = m_Journal.m_Stream.Open(m_Journal.m_sPath.c_str(), false, false, true);
+
+	if (!bOk)
+	{
+		LOG_WARNING() << "Bbs journal disabled";
+		beam::DeleteFile(sTmp.c_str());
+		for (const auto& pMsg : m_Msgs)
+			pMsg->m_JournalSize = 0;
+		m_Journal.m_Size = m_Journal.m_SizeLive = 0;
+	}
+}
+
+void BbsStore::FlushJournal()
+{
+	if (!m_Journal.m_Stream.IsOpen())
+		return;
+
+	// rewrite it once the removed msgs take more than the remaining
+	const uint64_t nMinDead = 1024 * 1024;
+	if (m_Journal.m_Size > m_Journal.m_SizeLive * 2 + nMinDead)
+	{
+		LOG_INFO() << "Bbs journal rewrite, size=" << m_Journal.m_Size << ", live=" << m_Journal.m_SizeLive;
+		RewriteJournal();
+		return;
+	}
+
+	try {
+		m_Journal.m_Stream.Flush();
+	} catch (const std::exception& e) {
+		LOG_WARNING() << "Bbs journal flush failed: " << e.what() << ", journal disabled";
+		m_Journal.m_Stream.Close();
+	}
+}
+
+} // namespace beam
@@ -0,0 +1,109 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include "../core/block_crypt.h"
+
+namespace beam {
+
+// In-memory storage of the bbs messages. They're transient, hence not kept in the node db.
+// Messages are kept in the order of arrival (IDs are increasing), globally and per channel, and are indexed by the key.
+// The oldest messages are removed first, so each sequence behaves like a ring buffer.
+// Optionally the messages are appended to the journal file, so that they survive the restart. Removals are not
+// journaled: on load the same limits are applied, and the journal is rewritten once it mostly consists of the removed messages.
+class BbsStore
+{
+public:
+
+	typedef ECC::Hash::Value Key;
+
+	struct Msg
+	{
+		uint64_t m_ID;
+		Key m_Key;
+		BbsChannel m_Channel;
+		Timestamp m_TimePosted;
+		Timestamp m_TimeMax; // max time posted up to this msg (including), used for search by time
+		uint32_t m_Nonce;
+		uint32_t m_JournalSize;
+		ByteBuffer m_Message;
+	};
+
+	struct Totals
+	{
+		uint32_t m_Count = 0;
+		uint64_t m_Size = 0;
+	};
+
+	~BbsStore();
+
+	const Msg* Find(const Key&) const;
+	const Msg& Insert(const Key&, BbsChannel, Timestamp, const Blob& msg, uint32_t nNonce); // must be unique
+
+	const Msg* get_Oldest() const;
+	void DeleteOldest();
+
+	// the first msg after the given ID, globally or within the channel
+	const Msg* get_Next(uint64_t id) const;
+	const Msg* get_Next(BbsChannel, uint64_t id) const;
+
+	uint64_t FindCursor(Timestamp) const; // ID of the first msg posted at or after the given time, or the next ID if none
+	uint64_t get_LastID() const { return m_LastID; }
+	Timestamp get_MaxTime() const;
+
+	const Totals& get_Totals() const { return m_Totals; }
+
+	// Loads the messages from the journal (if exists), and appends the new messages to it.
+	// Should be called on start, before anything is inserted. The caller should apply its limits right after.
+	void OpenJournal(const std::string& sPath);
+	void FlushJournal(); // flushes, and rewrites the journal if too much of it is removed
+
+private:
+
+	struct KeyHash {
+		size_t operator()(const Key&) const;
+	};
+
+	typedef std::deque<const Msg*> Seq;
+
+	std::deque<std::unique_ptr<Msg> > m_Msgs;
+	std::map<BbsChannel, Seq> m_Channels;
+	std::unordered_map<Key, const Msg*, KeyHash> m_Keys;
+
+	uint64_t m_LastID = 0;
+	Totals m_Totals;
+
+	struct Journal
+	{
+		std::string m_sPath;
+		std::FStream m_Stream;
+		uint64_t m_Size = 0; // total written
+		uint64_t m_SizeLive = 0; // of the msgs that are still present
+
+		static const uint32_t s_Version;
+	} m_Journal;
+
+	Msg& InsertInternal(const Key&, BbsChannel, Timestamp, const Blob& msg, uint32_t nNonce);
+	void WriteJournal(Msg&);
+	void RewriteJournal();
+	void LoadJournal();
+
+	static const Msg* get_Next(const Seq&, uint64_t id);
+};
+
+} // namespace beam
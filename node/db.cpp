@@ -784,89 +784,112 @@ void NodeDB::get_State(uint64_t rowid, Block::SystemState::Full& out)
 
 uint64_t NodeDB::InsertState(const Block::SystemState::Full& s, const PeerID& peer)
 {
-	assert(s.m_Height >= Rules::HeightGenesis);
+	return InsertStates(&s, 1, peer);
+}
 
-	// Is there a prev? Is it a tip currently?
-	Recordset rs(*this, Query::StateFind2, "SELECT rowid," TblStates_CountNext " FROM " TblStates " WHERE " TblStates_Height "=? AND " TblStates_Hash "=?");
-	rs.put(0, s.m_Height - 1);
-	rs.put(1, s.m_Prev);
+uint64_t NodeDB::InsertStates(const Block::SystemState::Full* pS, size_t nCount, const PeerID& peer)
+{
+	assert(nCount);
 
-	uint32_t nPrevCountNext = 0, nCountNextF = 0; // initialized to suppress warning, not really needed
-	uint64_t rowPrev;
+	uint64_t rowid = 0;
+	Merkle::Hash hash;
 
-	if (rs.Step())
+	for (size_t i = 0; i < nCount; i++)
 	{
-		rs.get(0, rowPrev);
-		rs.get(1, nPrevCountNext);
-	}
-	else
-		rowPrev = 0;
+		const Block::SystemState::Full& s = pS[i];
+		assert(s.m_Height >= Rules::HeightGenesis);
 
-	Merkle::Hash hash;
-	s.get_Hash(hash);
+		// Within the chain the prev is the one just inserted. It already accounts for this state in its next count, and isn't a tip
+		uint64_t rowPrev = rowid;
+		uint32_t nPrevCountNext = 0;
 
-	// Count next functional
-	rs.Reset(*this, Query::StateGetNextFCount, "SELECT COUNT() FROM " TblStates " WHERE " TblStates_Height "=? AND " TblStates_HashPrev "=? AND (" TblStates_Flags " & ?)");
-	rs.put(0, s.m_Height + 1);
-	rs.put(1, hash);
-	rs.put(2, StateFlags::Functional);
+		Recordset rs;
 
-    BEAM_VERIFY(rs.Step());
-	rs.get(0, nCountNextF);
+		if (!i)
+		{
+			// Is there a prev? Is it a tip currently?
+			rs.Reset(*this, Query::StateFind2, "SELECT rowid," TblStates_CountNext " FROM " TblStates " WHERE " TblStates_Height "=? AND " TblStates_Hash "=?");
+			rs.put(0, s.m_Height - 1);
+			rs.put(1, s.m_Prev);
 
-	// Insert row
+			if (rs.Step())
+			{
+				rs.get(0, rowPrev);
+				rs.get(1, nPrevCountNext);
+			}
+		}
+		else
+			assert(s.m_Height == pS[i - 1].m_Height + 1);
+
+		s.get_Hash(hash);
+
+		// Count next functional
+		rs.Reset(*this, Query::StateGetNextFCount, "SELECT COUNT() FROM " TblStates " WHERE " TblStates_Height "=? AND " TblStates_HashPrev "=? AND (" TblStates_Flags " & ?)");
+		rs.put(0, s.m_Height + 1);
+		rs.put(1, hash);
+		rs.put(2, StateFlags::Functional);
+
+		uint32_t nCountNextF = 0;
+		BEAM_VERIFY(rs.Step());
+		rs.get(0, nCountNextF);
+
+		// Insert row
 
 #define THE_MACRO_1(dbname, extname) TblStates_##dbname ","
 #define THE_MACRO_2(dbname, extname) "?,"
 
-	rs.Reset(*this, Query::StateIns, "INSERT INTO " TblStates
-		" (" TblStates_Hash "," StateCvt_Fields(THE_MACRO_1, THE_MACRO_NOP0) TblStates_Flags "," TblStates_CountNext "," TblStates_CountNextF "," TblStates_RowPrev "," TblStates_Peer ")"
-		" VALUES(?," StateCvt_Fields(THE_MACRO_2, THE_MACRO_NOP0) "0,0,?,?,?)");
+		rs.Reset(*this, Query::StateIns, "INSERT INTO " TblStates
+			" (" TblStates_Hash "," StateCvt_Fields(THE_MACRO_1, THE_MACRO_NOP0) TblStates_Flags "," TblStates_CountNext "," TblStates_CountNextF "," TblStates_RowPrev "," TblStates_Peer ")"
+			" VALUES(?," StateCvt_Fields(THE_MACRO_2, THE_MACRO_NOP0) "0,0,?,?,?)");
 
 #undef THE_MACRO_1
 #undef THE_MACRO_2
 
-	int iCol = 0;
-	rs.put(iCol++, hash);
+		int iCol = 0;
+		rs.put(iCol++, hash);
 
 #define THE_MACRO_1(dbname, extname) rs.put(iCol++, s.extname);
-	StateCvt_Fields(THE_MACRO_1, THE_MACRO_NOP0)
+		StateCvt_Fields(THE_MACRO_1, THE_MACRO_NOP0)
 #undef THE_MACRO_1
 
-	rs.put(iCol++, nCountNextF);
-	if (rowPrev)
-		rs.put(iCol, rowPrev); // otherwise it'd be NULL
-	iCol++;
+		rs.put(iCol++, nCountNextF);
+		if (rowPrev)
+			rs.put(iCol, rowPrev); // otherwise it'd be NULL
+		iCol++;
 
-	rs.put(iCol, peer);
+		rs.put(iCol, peer);
 
-	rs.Step();
-	TestChanged1Row();
+		rs.Step();
+		TestChanged1Row();
 
-	uint64_t rowid = get_LastInsertRowID();
-	assert(rowid);
+		rowid = get_LastInsertRowID();
+		assert(rowid);
 
-	if (rowPrev)
-	{
-		SetNextCount(rowPrev, nPrevCountNext + 1);
+		if (rowPrev && !i)
+		{
+			SetNextCount(rowPrev, nPrevCountNext + 1);
 
-		if (!nPrevCountNext)
-			TipDel(rowPrev, s.m_Height - 1);
-	}
+			if (!nPrevCountNext)
+				TipDel(rowPrev, s.m_Height - 1);
+		}
 
-	// Ancestors
-	rs.Reset(*this, Query::StateUpdPrevRow, "UPDATE " TblStates " SET " TblStates_RowPrev "=? WHERE " TblStates_Height "=? AND " TblStates_HashPrev "=?");
-	rs.put(0, rowid);
-	rs.put(1, s.m_Height + 1);
-	rs.put(2, hash);
+		// Ancestors
+		rs.Reset(*this, Query::StateUpdPrevRow, "UPDATE " TblStates " SET " TblStates_RowPrev "=? WHERE " TblStates_Height "=? AND " TblStates_HashPrev "=?");
+		rs.put(0, rowid);
+		rs.put(1, s.m_Height + 1);
+		rs.put(2, hash);
 
-	rs.Step();
-	uint32_t nCountAncestors = get_RowsChanged();
+		rs.Step();
+		uint32_t nCountAncestors = get_RowsChanged();
 
-	if (nCountAncestors)
-		SetNextCount(rowid, nCountAncestors);
-	else
-		TipAdd(rowid, s.m_Height);
+		if (i + 1 < nCount)
+			nCountAncestors++; // the next one in the chain
+
+		if (nCountAncestors)
+			SetNextCount(rowid, nCountAncestors);
+		else
+			TipAdd(rowid, s.m_Height);
+	}
 
 	return rowid;
 }
@@ -1966,6 +1989,12 @@ void NodeDB::BbsDel(uint64_t id)
 	TestChanged1Row();
 }
 
+void NodeDB::BbsDelAll()
+{
+	Recordset rs(*this, Query::BbsDelAll, "DELETE FROM " TblBbs);
+	rs.Step();
+}
+
 uint64_t NodeDB::BbsIns(const WalkerBbs::Data& d)
 {
 	Recordset rs(*this, Query::BbsIns, "INSERT INTO " TblBbs "(" TblBbs_InsFieldsListed ") VALUES(?,?,?,?,?)");
@@ -140,6 +140,7 @@ public:
 			BbsFind,
 			BbsFindCursor,
 			BbsDel,
+			BbsDelAll,
 			BbsIns,
 			BbsMaxTime,
 			BbsTotals,
@@ -296,6 +297,9 @@ public:
 	void ParamIntSet(uint32_t ID, uint64_t val);
 
 	uint64_t InsertState(const Block::SystemState::Full&, const PeerID&); // Fails if state already exists
+	// Inserts a chain of new states, each one is on top of the previous. The links within the chain are not queried,
+	// and intermediate states are not added to tips. Returns the row of the last one
+	uint64_t InsertStates(const Block::SystemState::Full*, size_t nCount, const PeerID&);
 
 	uint64_t FindActiveStateStrict(Height);
 	uint64_t StateFindSafe(const Block::SystemState::ID&);
@@ -440,6 +444,7 @@ public:
 	bool BbsFind(WalkerBbs&); // set Key
 	uint64_t BbsFind(const WalkerBbs::Key&);
 	void BbsDel(uint64_t id);
+	void BbsDelAll();
 	uint64_t BbsFindCursor(Timestamp);
 	Timestamp get_BbsMaxTime();
 	uint64_t get_BbsLastID();
@@ -29,6 +29,18 @@
 
 namespace beam {
 
+namespace {
+
+	template <typename T>
+	void UpdateMovingAvg(uint32_t& x, T val)
+	{
+		x = x ?
+			static_cast<uint32_t>((static_cast<uint64_t>(x) * 3 + val) / 4) :
+			static_cast<uint32_t>(val);
+	}
+
+} // namespace
+
 bool Node::SyncStatus::operator == (const SyncStatus& x) const
 {
 	return
@@ -193,12 +205,12 @@ void Node::WantedTx::OnExpired(const KeyType& key)
     }
 }
 
-void Node::Bbs::CalcMsgKey(NodeDB::WalkerBbs::Data& d)
+void Node::Bbs::CalcMsgKey(BbsStore::Key& key, BbsChannel channel, const Blob& msg)
 {
     ECC::Hash::Processor()
-        << d.m_Message
-        << d.m_Channel
-        >> d.m_Key;
+        << msg
+        << channel
+        >> key;
 }
 
 uint32_t Node::Bbs::WantedMsg::get_Timeout_ms()
@@ -371,6 +383,9 @@ bool Node::TryAssignTask(Task& t, Peer& p)
 		if (m_nTasksPackBody >= m_Cfg.m_MaxConcurrentBlocksRequest)
 			return false; // too many blocks requested
 
+		if (nBlocks >= p.get_MaxBodyTasks())
+			return false; // the peer's pipe is full, better give it to another one
+
 		Height hCountExtra = t.m_sidTrg.m_Height - t.m_Key.first.m_Height;
 
 		proto::GetBodyPack msg;
@@ -459,8 +474,8 @@ void Node::Peer::SetTimerWrtFirstTask()
 {
 	if (m_lstTasks.empty())
 	{
-		assert(m_pTimerRequest);
-		m_pTimerRequest->cancel();
+		m_TimerRequest.cancel();
+		m_TimerStraggle.cancel();
 	}
 	else
 	{
@@ -470,15 +485,96 @@ void Node::Peer::SetTimerWrtFirstTask()
 			m_This.m_Cfg.m_Timeout.m_GetBlock_ms :
 			m_This.m_Cfg.m_Timeout.m_GetState_ms;
 
-		if (!m_pTimerRequest)
-			m_pTimerRequest = io::Timer::create(io::Reactor::get_Current());
+		m_This.get_TimerWheel().arm(m_TimerRequest, timeout_ms, false, [this]() { OnRequestTimeout(); });
+
+		// end-game timer, w.r.t. the measured peer bandwidth
+		const Task& t = m_lstTasks.front();
+		uint32_t straggle_ms = 0;
+		if (t.m_Key.second && !t.m_bRelinquished)
+		{
+			const Config::BandwidthCtl& bwc = m_This.m_Cfg.m_BandwidthCtl;
+			uint64_t val = static_cast<uint64_t>(get_ExpectedTime_ms()) * bwc.m_StraggleFactor;
+			if (val)
+				straggle_ms = static_cast<uint32_t>(std::max<uint64_t>(val, bwc.m_StraggleMin_ms));
+		}
+
+		if (straggle_ms && (straggle_ms < timeout_ms))
+			m_This.get_TimerWheel().arm(m_TimerStraggle, straggle_ms, false, [this]() { OnStraggling(); });
+		else
+			m_TimerStraggle.cancel();
+	}
+}
+
+bool Node::TryReissueTask(Task& t)
+{
+	assert(t.m_pOwner && t.m_Key.second && !t.m_bRelinquished);
+	Peer& p0 = *t.m_pOwner;
+	uint32_t bps0 = p0.get_DownloadBps();
+
+	// The owner will respond anyway, and responses are matched to tasks in order.
+	// Leave a stub in place of the task, it'll consume the response
+	Task* pStub = new Task;
+	pStub->m_Key = t.m_Key;
+	pStub->m_bNeeded = false;
+	pStub->m_bRelinquished = true;
+	pStub->m_nCount = t.m_nCount;
+	pStub->m_TimeAssigned_ms = t.m_TimeAssigned_ms;
+	pStub->m_sidTrg = t.m_sidTrg;
+	pStub->m_h0 = t.m_h0;
+	pStub->m_hTxoLo = t.m_hTxoLo;
+	pStub->m_pOwner = &p0;
+
+	assert(m_nTasksPackBody >= t.m_nCount);
+	m_nTasksPackBody -= t.m_nCount;
+	t.m_nCount = 0;
+	t.m_pOwner = nullptr;
+
+	TaskList::iterator it = TaskList::s_iterator_to(t);
+	p0.m_lstTasks.insert(it, *pStub);
+	p0.m_lstTasks.erase(it);
+	m_lstTasksUnassigned.push_back(t);
+
+	for (PeerMan::LiveSet::iterator itP = m_PeerMan.m_LiveSet.begin(); m_PeerMan.m_LiveSet.end() != itP; itP++)
+	{
+		Peer& p = *itP->m_p;
+		if ((&p == &p0) || !p.m_lstTasks.empty() || (p.get_DownloadBps() <= bps0))
+			continue; // only idle and faster peers
 
-		m_pTimerRequest->start(timeout_ms, false, [this]() { OnRequestTimeout(); });
+		if (TryAssignTask(t, p))
+		{
+			LOG_INFO() << "End-game: " << t.m_Key.first << " re-issued from " << p0.m_RemoteAddr << " (" << bps0 / 1024 << " KB/s) to " << p.m_RemoteAddr << " (" << p.get_DownloadBps() / 1024 << " KB/s)";
+			return true;
+		}
 	}
+
+	// revert
+	m_lstTasksUnassigned.erase(TaskList::s_iterator_to(t));
+	it = TaskList::s_iterator_to(*pStub);
+	p0.m_lstTasks.insert(it, t);
+	p0.m_lstTasks.erase(it);
+
+	t.m_pOwner = &p0;
+	t.m_nCount = pStub->m_nCount;
+	m_nTasksPackBody += t.m_nCount;
+
+	delete pStub;
+	return false;
 }
 
-void Node::Processor::RequestData(const Block::SystemState::ID& id, bool bBlock, const NodeDB::StateID& sidTrg)
+void Node::Processor::RequestData(const Block::SystemState::ID& id_, bool bBlock, const NodeDB::StateID& sidTrg)
 {
+	Block::SystemState::ID id = id_;
+	if (!bBlock)
+	{
+		// the hdrs may be already received and verified now, then the following ones are requested
+		uint32_t nPending = get_ParentObj().m_HdrPacks.FindNext(id);
+		if (nPending)
+		{
+			if ((nPending >= HdrPacks::s_MaxPending) || (id.m_Height < Rules::HeightGenesis) || (id.m_Height < get_LowestReturnHeight()) || get_DB().StateFindSafe(id))
+				return;
+		}
+	}
+
 	Node::Task tKey;
     tKey.m_Key.first = id;
     tKey.m_Key.second = bBlock;
@@ -492,6 +588,7 @@ void Node::Processor::RequestData(const Block::SystemState::ID& id, bool bBlock,
         pTask->m_Key = tKey.m_Key;
         pTask->m_sidTrg = sidTrg;
 		pTask->m_bNeeded = true;
+		pTask->m_bRelinquished = false;
         pTask->m_nCount = 0;
         pTask->m_pOwner = NULL;
 
@@ -950,9 +1047,7 @@ void Node::Initialize(IExternalPOW* externalPOW)
 
     m_PeerMan.Initialize();
     m_Miner.Initialize(externalPOW);
-	m_Processor.get_DB().get_BbsTotals(m_Bbs.m_Totals);
-    m_Bbs.Cleanup();
-	m_Bbs.m_HighestPosted_s = m_Processor.get_DB().get_BbsMaxTime();
+	m_Bbs.Initialize();
 }
 
 uint32_t Node::get_AcessiblePeerCount() const
@@ -1069,32 +1164,76 @@ void Node::RefreshOwnedUtxos()
     }
 }
 
+void Node::Bbs::Initialize()
+{
+	const Config::Bbs& cfg = get_ParentObj().m_Cfg.m_Bbs;
+
+	if (cfg.IsEnabled() && !cfg.m_sPathJournal.empty())
+		m_Store.OpenJournal(cfg.m_sPathJournal);
+
+	ImportFromDB();
+
+	Cleanup();
+	m_HighestPosted_s = m_Store.get_MaxTime();
+}
+
+void Node::Bbs::ImportFromDB()
+{
+	// Older versions kept the messages in the node db. Move them to the store (once)
+	NodeDB& db = get_ParentObj().m_Processor.get_DB();
+
+	NodeDB::BbsTotals totals;
+	db.get_BbsTotals(totals);
+	if (!totals.m_Count)
+		return;
+
+	if (get_ParentObj().m_Cfg.m_Bbs.IsEnabled())
+	{
+		NodeDB::WalkerBbsLite wlk;
+		wlk.m_ID = 0;
+		for (db.EnumAllBbsSeq(wlk); wlk.MoveNext(); )
+		{
+			NodeDB::WalkerBbs wlkData;
+			wlkData.m_Data.m_Key = wlk.m_Key;
+			if (!db.BbsFind(wlkData) || m_Store.Find(wlk.m_Key))
+				continue;
+
+			const NodeDB::WalkerBbs::Data& d = wlkData.m_Data;
+			m_Store.Insert(d.m_Key, d.m_Channel, d.m_TimePosted, d.m_Message, d.m_Nonce);
+		}
+	}
+
+	db.BbsDelAll();
+	LOG_INFO() << "Bbs msgs moved from db: " << totals.m_Count;
+}
+
 bool Node::Bbs::IsInLimits() const
 {
 	const NodeDB::BbsTotals& lims = get_ParentObj().m_Cfg.m_Bbs.m_Limit;
+	const BbsStore::Totals& totals = m_Store.get_Totals();
 
 	return
-		(m_Totals.m_Count <= lims.m_Count) &&
-		(m_Totals.m_Size <= lims.m_Size);
+		(totals.m_Count <= lims.m_Count) &&
+		(totals.m_Size <= lims.m_Size);
 }
 
 void Node::Bbs::Cleanup()
 {
-	NodeDB& db = get_ParentObj().m_Processor.get_DB();
-	NodeDB::WalkerBbsTimeLen wlk;
-
 	Timestamp ts = getTimestamp() - get_ParentObj().m_Cfg.m_Bbs.m_MessageTimeout_s;
 
-	for (db.EnumAllBbs(wlk); wlk.MoveNext(); )
+	while (true)
 	{
-		if (IsInLimits() && (wlk.m_Time >= ts))
+		const BbsStore::Msg* pMsg = m_Store.get_Oldest();
+		if (!pMsg)
+			break;
+
+		if (IsInLimits() && (pMsg->m_TimePosted >= ts))
 			break;
 
-		db.BbsDel(wlk.m_ID);
-		m_Totals.m_Count--;
-		m_Totals.m_Size -= wlk.m_Size;
+		m_Store.DeleteOldest();
 	}
 
+	m_Store.FlushJournal();
 	m_LastCleanup_ms = GetTime_ms();
 }
 
@@ -1160,6 +1299,17 @@ void Node::Peer::OnRequestTimeout()
     DeleteSelf(false, ByeReason::Timeout);
 }
 
+void Node::Peer::OnStraggling()
+{
+	Task& t = get_FirstTask();
+	if (!t.m_Key.second || t.m_bRelinquished)
+		return;
+
+	if (!m_This.TryReissueTask(t))
+		// no faster idle peer at the moment, retry later
+		m_This.get_TimerWheel().arm(m_TimerStraggle, m_This.m_Cfg.m_BandwidthCtl.m_StraggleMin_ms, false, [this]() { OnStraggling(); });
+}
+
 void Node::Peer::OnResendPeers()
 {
     PeerMan& pm = m_This.m_PeerMan;
@@ -1467,6 +1617,14 @@ void Node::Peer::ReleaseTask(Task& t)
     assert(this == t.m_pOwner);
     t.m_pOwner = NULL;
 
+    if (t.m_bRelinquished)
+    {
+        // not tracked, its quota is already released
+        m_lstTasks.erase(TaskList::s_iterator_to(t));
+        delete &t;
+        return;
+    }
+
     if (t.m_nCount)
     {
         uint32_t& nCounter = t.m_Key.second ? m_This.m_nTasksPackBody : m_This.m_nTasksPackHdr;
@@ -1487,7 +1645,14 @@ void Node::Peer::ReleaseTask(Task& t)
 
 void Node::Peer::DeleteSelf(bool bIsError, uint8_t nByeReason)
 {
-    LOG_INFO() << "-Peer " << m_RemoteAddr;
+    if (m_Download.m_Bytes)
+    {
+        LOG_INFO() << "-Peer " << m_RemoteAddr << ", downloaded " << m_Download.m_Bytes << " bytes, " << m_Download.m_Bps / 1024 << " KB/s, rtt=" << m_Download.m_Rtt_ms << " ms";
+    }
+    else
+    {
+        LOG_INFO() << "-Peer " << m_RemoteAddr;
+    }
 
     if (nByeReason && (Flags::Connected & m_Flags))
     {
@@ -1692,6 +1857,71 @@ void Node::Peer::ModifyRatingWrtData(size_t nSize)
 	m_This.m_PeerMan.m_LiveSet.erase(PeerMan::LiveSet::s_iterator_to(Cast::Up<PeerMan::PeerInfoPlus>(m_pInfo)->m_Live));
 	m_This.m_PeerMan.SetRating(*m_pInfo, nRatingAvg);
 	m_This.m_PeerMan.m_LiveSet.insert(Cast::Up<PeerMan::PeerInfoPlus>(m_pInfo)->m_Live);
+
+	if (nSize)
+	{
+		// if the previous response came after this task was assigned - the request was queued behind it
+		uint32_t t_ms = tp.get();
+		bool bQueued = m_Download.m_LastResponse_ms && (static_cast<int32_t>(m_Download.m_LastResponse_ms - get_FirstTask().m_TimeAssigned_ms) > 0);
+		m_Download.OnResponse(nSize, bQueued ? (t_ms - m_Download.m_LastResponse_ms) : dt_ms, bQueued);
+		m_Download.m_LastResponse_ms = t_ms;
+	}
+}
+
+void Node::DownloadStats::OnResponse(size_t nSize, uint32_t dt_ms, bool bQueued)
+{
+	m_Bytes += nSize;
+
+	if (nSize < s_LatencyBound)
+	{
+		if (!bQueued)
+			UpdateMovingAvg(m_Rtt_ms, dt_ms);
+	}
+	else
+	{
+		// exclude the latency, unless the request was pipelined
+		uint32_t tx_ms = (bQueued || (dt_ms <= m_Rtt_ms)) ? dt_ms : (dt_ms - m_Rtt_ms);
+		uint64_t bps = static_cast<uint64_t>(nSize) * 1000 / std::max(tx_ms, 1U);
+		UpdateMovingAvg(m_Bps, std::min<uint64_t>(bps, std::numeric_limits<uint32_t>::max()));
+	}
+}
+
+uint32_t Node::Peer::get_DownloadBps() const
+{
+	if (m_Download.m_Bps)
+		return m_Download.m_Bps;
+
+	// not measured yet, the rating reflects the bandwidth too
+	return m_pInfo ? PeerManager::Rating::ToBps(m_pInfo->m_RawRating.m_Value) : 0;
+}
+
+uint32_t Node::DownloadStats::get_MaxTasks(uint32_t nAvgResponse, uint32_t nMax) const
+{
+	if (!m_Bps || !m_Rtt_ms || !nAvgResponse)
+		return nMax; // not measured yet
+
+	// requests to cover the bandwidth-delay product (rounded up), and one more to keep the pipe busy while the response is received
+	uint64_t nBdp = static_cast<uint64_t>(m_Bps) * m_Rtt_ms / 1000;
+	uint64_t n = (nBdp + nAvgResponse - 1) / nAvgResponse + 1;
+
+	return static_cast<uint32_t>(std::min<uint64_t>(n, nMax));
+}
+
+uint32_t Node::Peer::get_MaxBodyTasks() const
+{
+	return m_Download.get_MaxTasks(m_This.m_nAvgBodyResponse, std::max(m_This.m_Cfg.m_BandwidthCtl.m_MaxBodyTasksPerPeer, 1U));
+}
+
+uint32_t Node::Peer::get_ExpectedTime_ms() const
+{
+	uint32_t bps = get_DownloadBps();
+	if (!bps)
+		return 0;
+
+	uint64_t nSize = m_This.m_nAvgBodyResponse ? m_This.m_nAvgBodyResponse : m_This.m_Cfg.m_BandwidthCtl.m_MaxBodyPackSize;
+	uint64_t t_ms = nSize * 1000 / bps + m_Download.m_Rtt_ms;
+
+	return static_cast<uint32_t>(std::min<uint64_t>(t_ms, std::numeric_limits<uint32_t>::max()));
 }
 
 void Node::Peer::OnMsg(proto::DataMissing&&)
@@ -1757,12 +1987,11 @@ void Node::Peer::OnMsg(proto::GetHdrPack&& msg)
 		Send(msgOut);
 }
 
-bool Node::DecodeAndCheckHdrs(std::vector<Block::SystemState::Full>& v, const proto::HdrPack& msg)
+bool Node::DecodeHdrs(std::vector<Block::SystemState::Full>& v, const proto::HdrPack& msg)
 {
 	if (msg.m_vElements.empty() || (msg.m_vElements.size() > proto::g_HdrPackMaxSize))
 		return false;
 
-	// PoW verification is heavy for big packs. Do it in parallel
 	v.resize(msg.m_vElements.size());
 
 	Cast::Down<Block::SystemState::Sequence::Prefix>(v.front()) = msg.m_Prefix;
@@ -1779,35 +2008,164 @@ bool Node::DecodeAndCheckHdrs(std::vector<Block::SystemState::Full>& v, const pr
 		s1.m_ChainWork = s0.m_ChainWork + s1.m_PoW.m_Difficulty;
 	}
 
-	struct MyTask
-		:public Executor::TaskSync
+	return true;
+}
+
+struct Node::HdrPacks::Job
+	:public Executor::TaskAsync
+{
+	HdrPacks& m_This;
+	Pack::Ptr m_pPack;
+	uint32_t m_i0;
+	uint32_t m_i1;
+
+	Job(HdrPacks& x, const Pack::Ptr& pPack, uint32_t i0, uint32_t i1)
+		:m_This(x)
+		,m_pPack(pPack)
+		,m_i0(i0)
+		,m_i1(i1)
+	{
+	}
+
+	virtual ~Job() {}
+
+	virtual void Exec(Executor::Context&) override
+	{
+		bool bValid = true;
+		for (uint32_t i = m_i0; i < m_i1; i++)
+		{
+			if (!m_pPack->m_vStates[i].IsValid())
+			{
+				bValid = false;
+				break;
+			}
+		}
+
+		std::unique_lock<std::mutex> scope(m_This.m_Mutex);
+
+		if (!bValid)
+			m_pPack->m_Valid = false;
+
+		assert(m_pPack->m_Pending >= m_i1 - m_i0);
+		m_pPack->m_Pending -= m_i1 - m_i0;
+
+		assert(m_This.m_Jobs);
+		m_This.m_Jobs--;
+
+		m_This.m_pEvt->post(); // either the pack is done, or the following job can be queued
+	}
+};
+
+void Node::HdrPacks::Push(Pack::Ptr&& pPack)
+{
+	if (!m_pEvt)
+		m_pEvt = io::AsyncEvent::create(io::Reactor::get_Current(), [this]() { OnVerified(); });
+
+	pPack->m_Queued = 0;
+	pPack->m_Pending = static_cast<uint32_t>(pPack->m_vStates.size());
+	pPack->m_Valid = true;
+	m_Queue.push_back(std::move(pPack));
+
+	m_Stats.m_Pending = static_cast<uint32_t>(m_Queue.size());
+	std::setmax(m_Stats.m_PendingMax, m_Stats.m_Pending);
+
+	QueueJobs();
+}
+
+void Node::HdrPacks::QueueJobs()
+{
+	// PoW verification is heavy for big packs. Do it in parallel
+	Executor& ex = get_ParentObj().m_Processor.m_ExecutorMT;
+	uint32_t nJobsMax = std::max(ex.get_Threads(), 1U);
+
+	for (const auto& pPack : m_Queue)
+	{
+		Pack& p = *pPack;
+		uint32_t nCount = static_cast<uint32_t>(p.m_vStates.size());
+
+		while (p.m_Queued < nCount)
+		{
+			{
+				std::unique_lock<std::mutex> scope(m_Mutex);
+				if (m_Jobs >= nJobsMax)
+					return;
+				m_Jobs++;
+			}
+
+			uint32_t i0 = p.m_Queued;
+			p.m_Queued = std::min(i0 + s_HdrsPerJob, nCount);
+
+			ex.Push(std::make_unique<Job>(*this, pPack, i0, p.m_Queued));
+		}
+	}
+}
+
+uint32_t Node::HdrPacks::FindNext(Block::SystemState::ID& id) const
+{
+	uint32_t nRet = 0;
+	while (nRet < m_Queue.size())
 	{
-		const Block::SystemState::Full* m_pV;
-		uint32_t m_Count;
-		bool m_Valid;
+		// packs usually go down, the latest one is the most likely
+		auto it = std::find_if(m_Queue.rbegin(), m_Queue.rend(), [&id](const Pack::Ptr& pPack) { return pPack->m_idTop == id; });
+		if (m_Queue.rend() == it)
+			break;
 
-		virtual ~MyTask() {}
+		id = (*it)->m_idNext; // the one below may be pending too
+		nRet++;
+	}
+
+	return nRet;
+}
+
+void Node::HdrPacks::OnVerified()
+{
+	Node& n = get_ParentObj();
+	bool bDone = false;
+
+	while (!m_Queue.empty())
+	{
+		Pack& p = *m_Queue.front();
 
-		virtual void Exec(Executor::Context& ctx) override
 		{
-            uint32_t i0, nCount;
-            ctx.get_Portion(i0, nCount, m_Count);
-            nCount += i0;
+			std::unique_lock<std::mutex> scope(m_Mutex);
+			if (p.m_Pending)
+				break;
+		}
+
+		bDone = true;
 
-			for (; i0 < nCount; i0++)
-				if (!m_pV[i0].IsValid())
-					m_Valid = false;
+		if (p.m_Valid)
+		{
+			// though PoW is valid, header can still be invalid. For instance, due to improper Timestamp
+			if (NodeProcessor::DataStatus::Invalid == n.m_Processor.OnStatesSilent(&p.m_vStates.front(), p.m_vStates.size(), p.m_Peer))
+				p.m_Valid = false;
+		}
+		else
+		{
+			LOG_WARNING() << "Hdr pack " << p.m_vStates.front().m_Height << "-" << p.m_idTop << " PoW invalid";
+		}
+
+		if (!p.m_Valid)
+		{
+			n.m_Processor.OnPeerInsane(p.m_Peer);
+			m_Stats.m_Invalid++;
 		}
-	};
 
-    MyTask t;
-    t.m_pV = &v.front();
-    t.m_Count = static_cast<uint32_t>(v.size());
-    t.m_Valid = true;
+		m_Stats.m_Handled++;
+		m_Stats.m_idLastHandled = p.m_idTop;
+
+		m_Queue.pop_front();
+		m_Stats.m_Pending = static_cast<uint32_t>(m_Queue.size());
+	}
 
-    m_Processor.m_ExecutorMT.ExecAll(t);
+	if (bDone)
+	{
+		n.RefreshCongestions();
+		n.m_Processor.TryGoUpAsync();
+		n.UpdateSyncStatus();
+	}
 
-	return t.m_Valid;
+	QueueJobs();
 }
 
 void Node::Peer::OnMsg(proto::HdrPack&& msg)
@@ -1819,38 +2177,28 @@ void Node::Peer::OnMsg(proto::HdrPack&& msg)
 		ThrowUnexpected();
 	}
 
-	std::vector<Block::SystemState::Full> v;
-	if (!m_This.DecodeAndCheckHdrs(v, msg))
+	HdrPacks::Pack::Ptr pPack = std::make_shared<HdrPacks::Pack>();
+	std::vector<Block::SystemState::Full>& v = pPack->m_vStates;
+
+	if (!DecodeHdrs(v, msg))
         ThrowUnexpected();
 
 	// just to be pedantic
-	Block::SystemState::ID idLast;
-	v.back().get_ID(idLast);
-	if (idLast != t.m_Key.first)
+	v.back().get_ID(pPack->m_idTop);
+	if (pPack->m_idTop != t.m_Key.first)
 		ThrowUnexpected();
 
-    for (size_t i = 0; i < v.size(); i++)
-    {
-        NodeProcessor::DataStatus::Enum eStatus = m_This.m_Processor.OnStateSilent(v[i], m_pInfo->m_ID.m_Key, idLast, true);
-        switch (eStatus)
-        {
-        case NodeProcessor::DataStatus::Invalid:
-			// though PoW was already tested, header can still be invalid. For instance, due to improper Timestamp
-			ThrowUnexpected();
-			break;
-
-        case NodeProcessor::DataStatus::Accepted:
-			// no break;
-
-        default:
-            break; // suppress warning
-        }
-    }
+	pPack->m_idNext.m_Height = v.front().m_Height - 1;
+	pPack->m_idNext.m_Hash = v.front().m_Prev;
+	pPack->m_Peer = m_pInfo->m_ID.m_Key;
 
-	LOG_INFO() << "Hdr pack received " << msg.m_Prefix.m_Height << "-" << idLast;
+	LOG_INFO() << "Hdr pack received " << msg.m_Prefix.m_Height << "-" << pPack->m_idTop;
 
 	ModifyRatingWrtData(sizeof(msg.m_Prefix) + msg.m_vElements.size() * sizeof(msg.m_vElements.front()));
 
+	// verified and inserted asynchronously, the following pack is requested right away
+	m_This.m_HdrPacks.Push(std::move(pPack));
+
 	OnFirstTaskDone(NodeProcessor::DataStatus::Accepted);
 	m_This.UpdateSyncStatus();
 }
@@ -2005,7 +2353,9 @@ void Node::Peer::OnMsg(proto::Body&& msg)
 	if (!t.m_Key.second)
 		ThrowUnexpected();
 
-	ModifyRatingWrtData(msg.m_Body.m_Eternal.size() + msg.m_Body.m_Perishable.size());
+	size_t nSize = msg.m_Body.m_Eternal.size() + msg.m_Body.m_Perishable.size();
+	ModifyRatingWrtData(nSize);
+	UpdateMovingAvg(m_This.m_nAvgBodyResponse, nSize);
 
 	const Block::SystemState::ID& id = t.m_Key.first;
 	Height h = id.m_Height;
@@ -2046,6 +2396,7 @@ void Node::Peer::OnMsg(proto::BodyPack&& msg)
 			msg.m_Bodies[i].m_Perishable.size();
 	}
 	ModifyRatingWrtData(nSize);
+	UpdateMovingAvg(m_This.m_nAvgBodyResponse, nSize);
 
 	NodeProcessor::DataStatus::Enum eStatus = NodeProcessor::DataStatus::Rejected;
 	if (!msg.m_Bodies.empty() && ShouldAcceptBodyPack())
@@ -2053,7 +2404,7 @@ void Node::Peer::OnMsg(proto::BodyPack&& msg)
 		const uint64_t* pPtr = p.get_CachedRows(t.m_sidTrg, hCountExtra);
 		if (pPtr)
 		{
-			LOG_INFO() << id << " Block pack received " << id.m_Height << "-" << (id.m_Height + msg.m_Bodies.size() - 1);
+			LOG_INFO() << id << " Block pack received " << id.m_Height << "-" << (id.m_Height + msg.m_Bodies.size() - 1) << " from " << m_RemoteAddr << ", " << m_Download.m_Bps / 1024 << " KB/s, rtt=" << m_Download.m_Rtt_ms << " ms";
 
 			eStatus = NodeProcessor::DataStatus::Accepted;
 
@@ -2190,7 +2541,7 @@ uint8_t Node::ValidateTx(Transaction::Context& ctx, const Transaction& tx)
 
 void Node::LogTx(const Transaction& tx, uint8_t nStatus, const Transaction::KeyType& key)
 {
-	if (!m_Cfg.m_LogTxFluff)
+	if (!m_Cfg.m_LogTxFluff || !Logger::will_log(LOG_LEVEL_INFO))
 		return;
 
     std::ostringstream os;
@@ -2228,7 +2579,7 @@ void Node::LogTx(const Transaction& tx, uint8_t nStatus, const Transaction::KeyT
 
 void Node::LogTxStem(const Transaction& tx, const char* szTxt)
 {
-	if (!m_Cfg.m_LogTxStem)
+	if (!m_Cfg.m_LogTxStem || !Logger::will_log(LOG_LEVEL_INFO))
 		return;
 
 	std::ostringstream os;
@@ -2245,6 +2596,14 @@ void Node::LogTxStem(const Transaction& tx, const char* szTxt)
 	LOG_INFO() << os.str();
 }
 
+io::TimingWheel& Node::get_TimerWheel()
+{
+    if (!m_pTimerWheel)
+        m_pTimerWheel = io::TimingWheel::create(io::Reactor::get_Current(), 10);
+
+    return *m_pTimerWheel;
+}
+
 const ECC::uintBig& Node::NextNonce()
 {
     ECC::Scalar::Native sk;
@@ -2754,17 +3113,13 @@ void Node::Peer::OnLogin(proto::Login&& msg)
     {
         if (msg.m_Flags & proto::LoginFlags::SendPeers)
         {
-            if (!m_pTimerPeers)
-                m_pTimerPeers = io::Timer::create(io::Reactor::get_Current());
-
-            m_pTimerPeers->start(m_This.m_Cfg.m_Timeout.m_TopPeersUpd_ms, true, [this]() { OnResendPeers(); });
+            m_This.get_TimerWheel().arm(m_TimerPeers, m_This.m_Cfg.m_Timeout.m_TopPeersUpd_ms, true, [this]() { OnResendPeers(); });
 
             OnResendPeers();
         }
         else
         {
-            if (m_pTimerPeers)
-                m_pTimerPeers->cancel();
+            m_TimerPeers.cancel();
         }
     }
 
@@ -2873,22 +3228,19 @@ void Node::Peer::BroadcastBbs()
 
 	size_t nExtra = 0;
 
-	NodeDB& db = m_This.m_Processor.get_DB();
-	NodeDB::WalkerBbsLite wlk;
-
-	wlk.m_ID = m_CursorBbs;
-	for (db.EnumAllBbsSeq(wlk); wlk.MoveNext(); )
+	const BbsStore& store = m_This.m_Bbs.m_Store;
+	for (const BbsStore::Msg* pMsg = store.get_Next(m_CursorBbs); pMsg; pMsg = store.get_Next(m_CursorBbs))
 	{
 		proto::BbsHaveMsg msgOut;
-		msgOut.m_Key = wlk.m_Key;
+		msgOut.m_Key = pMsg->m_Key;
 		Send(msgOut);
 
-		nExtra += wlk.m_Size;
+		m_CursorBbs = pMsg->m_ID;
+
+		nExtra += pMsg->m_Message.size();
 		if (IsChocking(nExtra))
 			break;
 	}
-
-	m_CursorBbs = wlk.m_ID;
 }
 
 void Node::Peer::MaybeSendSerif()
@@ -3105,6 +3457,127 @@ void Node::Peer::OnMsg(proto::GetProofUtxo&& msg)
     Send(t.m_Msg);
 }
 
+void Node::Peer::OnMsg(proto::GetProofUtxoMulti&& msg)
+{
+    if (msg.m_Utxos.size() > proto::g_ProofsMultiMax)
+        ThrowUnexpected();
+
+    struct Traveler :public UtxoTree::ITraveler
+    {
+        proto::ProofUtxoMulti& m_Msg;
+        Merkle::MultiPath::Builder m_Bld;
+        UtxoTree& m_Utxos;
+        Merkle::Proof m_Suffix; // from the utxo tree root to the definition, same for all
+        Merkle::Proof m_Proof;
+        uint32_t m_Count = 0;
+
+        virtual bool OnLeaf(const RadixTree::Leaf& x) override {
+
+            const UtxoTree::MyLeaf& v = Cast::Up<UtxoTree::MyLeaf>(x);
+            UtxoTree::Key::Data d;
+            d = v.m_Key;
+
+            Input::State& s = m_Msg.m_States.emplace_back();
+            s.m_Count = v.get_Count();
+            s.m_Maturity = d.m_Maturity;
+
+            m_Proof.clear();
+            m_Utxos.get_Proof(m_Proof, *m_pCu);
+            m_Proof.insert(m_Proof.end(), m_Suffix.begin(), m_Suffix.end());
+            m_Bld.Add(m_Proof);
+
+            return ++m_Count < Input::Proof::s_EntriesMax;
+        }
+
+        Traveler(proto::ProofUtxoMulti& msgOut, UtxoTree& utxos)
+            :m_Msg(msgOut)
+            ,m_Bld(msgOut.m_Proofs)
+            ,m_Utxos(utxos)
+        {
+        }
+    };
+
+    proto::ProofUtxoMulti msgOut;
+
+    Processor& p = m_This.m_Processor;
+    if (!p.IsFastSync())
+    {
+        Traveler t(msgOut, p.get_Utxos());
+
+        struct MyProofBuilder
+            :public NodeProcessor::ProofBuilder
+        {
+            using ProofBuilder::ProofBuilder;
+            virtual bool get_Utxos(Merkle::Hash&) override { return false; }
+        };
+
+        MyProofBuilder pb(p, t.m_Suffix);
+        pb.GenerateProof();
+
+        msgOut.m_Counts.reserve(msg.m_Utxos.size());
+
+        for (const ECC::Point& comm : msg.m_Utxos)
+        {
+            UtxoTree::Cursor cu;
+            t.m_pCu = &cu;
+            t.m_Count = 0;
+
+            UtxoTree::Key kMin, kMax;
+
+            UtxoTree::Key::Data d;
+            d.m_Commitment = comm;
+            d.m_Maturity = 0;
+            kMin = d;
+            d.m_Maturity = Height(-1);
+            kMax = d;
+
+            t.m_pBound[0] = kMin.V.m_pData;
+            t.m_pBound[1] = kMax.V.m_pData;
+
+            p.get_Utxos().Traverse(t);
+            msgOut.m_Counts.push_back(t.m_Count);
+        }
+    }
+
+    Send(msgOut);
+}
+
+void Node::Peer::OnMsg(proto::GetProofKernelMulti&& msg)
+{
+    if (msg.m_IDs.size() > proto::g_ProofsMultiMax)
+        ThrowUnexpected();
+
+    proto::ProofKernelMulti msgOut;
+
+    Processor& p = m_This.m_Processor;
+    if (!p.IsFastSync())
+    {
+        Merkle::MultiPath::Builder bld(msgOut.m_Proofs);
+        Merkle::Proof proof;
+        msgOut.m_Heights.reserve(msg.m_IDs.size());
+
+        for (const Merkle::Hash& id : msg.m_IDs)
+        {
+            TxKernel::Ptr pKrn;
+            proof.clear();
+
+            Height h = p.get_ProofKernel(proof, msg.m_Fetch ? &pKrn : nullptr, id);
+            if (h < Rules::HeightGenesis)
+                h = 0;
+            msgOut.m_Heights.push_back(h);
+
+            if (h)
+            {
+                bld.Add(proof);
+                if (msg.m_Fetch)
+                    msgOut.m_Kernels.push_back(std::move(pKrn));
+            }
+        }
+    }
+
+    Send(msgOut);
+}
+
 void Node::Processor::GenerateProofShielded(Merkle::Proof& p, const uintBigFor<TxoID>::Type& mmrIdx)
 {
     TxoID nIdx;
@@ -3332,32 +3805,28 @@ void Node::Peer::OnMsg(proto::BbsMsg&& msg)
     if (msg.m_TimePosted + Rules::get().DA.MaxAhead_s < m_This.m_Bbs.m_HighestPosted_s)
         return; // don't allow too much out-of-order messages
 
-    NodeDB& db = m_This.m_Processor.get_DB();
-    NodeDB::WalkerBbs wlk;
-
-    wlk.m_Data.m_Channel = msg.m_Channel;
-    wlk.m_Data.m_TimePosted = msg.m_TimePosted;
-    wlk.m_Data.m_Message = Blob(msg.m_Message);
-	msg.m_Nonce.Export(wlk.m_Data.m_Nonce);
+    BbsStore& store = m_This.m_Bbs.m_Store;
 
-    Bbs::CalcMsgKey(wlk.m_Data);
+    BbsStore::Key hvKey;
+    Bbs::CalcMsgKey(hvKey, msg.m_Channel, msg.m_Message);
 
-    if (db.BbsFind(wlk.m_Data.m_Key))
+    if (store.Find(hvKey))
         return; // already have it
 
     m_This.m_Bbs.MaybeCleanup();
 
-    uint64_t id = db.BbsIns(wlk.m_Data);
-    m_This.m_Bbs.m_W.Delete(wlk.m_Data.m_Key);
+    uint32_t nNonce;
+    msg.m_Nonce.Export(nNonce);
+
+    const BbsStore::Msg& x = store.Insert(hvKey, msg.m_Channel, msg.m_TimePosted, msg.m_Message, nNonce);
+    m_This.m_Bbs.m_W.Delete(hvKey);
 
 	std::setmax(m_This.m_Bbs.m_HighestPosted_s, msg.m_TimePosted);
-	m_This.m_Bbs.m_Totals.m_Count++;
-	m_This.m_Bbs.m_Totals.m_Size += wlk.m_Data.m_Message.n;
 
     // 1. Send to other BBS-es
 
     proto::BbsHaveMsg msgOut;
-    msgOut.m_Key = wlk.m_Data.m_Key;
+    msgOut.m_Key = hvKey;
 
     for (PeerList::iterator it = m_This.m_lstPeers.begin(); m_This.m_lstPeers.end() != it; it++)
     {
@@ -3380,13 +3849,13 @@ void Node::Peer::OnMsg(proto::BbsMsg&& msg)
     for (std::pair<It, It> range = m_This.m_Bbs.m_Subscribed.equal_range(key); range.first != range.second; range.first++)
     {
         Bbs::Subscription& s = range.first->get_ParentObj();
-		assert(s.m_Cursor < id);
+		assert(s.m_Cursor < x.m_ID);
 
         if (s.m_pPeer->IsChocking())
             continue;
 
-        s.m_pPeer->SendBbsMsg(wlk.m_Data);
-		s.m_Cursor = id;
+        s.m_pPeer->SendBbsMsg(x);
+		s.m_Cursor = x.m_ID;
 
 		s.m_pPeer->IsChocking(); // in case it's chocking - for faster recovery recheck it ASAP
     }
@@ -3397,8 +3866,7 @@ void Node::Peer::OnMsg(proto::BbsHaveMsg&& msg)
     if (!m_This.m_Cfg.m_Bbs.IsEnabled())
 		ThrowUnexpected();
 
-    NodeDB& db = m_This.m_Processor.get_DB();
-	if (db.BbsFind(msg.m_Key)) {
+	if (m_This.m_Bbs.m_Store.Find(msg.m_Key)) {
 		// stupid compiler insists on parentheses here!
 		return; // already have it
 	}
@@ -3418,23 +3886,20 @@ void Node::Peer::OnMsg(proto::BbsGetMsg&& msg)
 	if (!m_This.m_Cfg.m_Bbs.IsEnabled())
 		ThrowUnexpected();
 
-	NodeDB& db = m_This.m_Processor.get_DB();
-    NodeDB::WalkerBbs wlk;
-
-    wlk.m_Data.m_Key = msg.m_Key;
-    if (!db.BbsFind(wlk))
+	const BbsStore::Msg* pMsg = m_This.m_Bbs.m_Store.Find(msg.m_Key);
+    if (!pMsg)
         return; // don't have it
 
-    SendBbsMsg(wlk.m_Data);
+    SendBbsMsg(*pMsg);
 }
 
-void Node::Peer::SendBbsMsg(const NodeDB::WalkerBbs::Data& d)
+void Node::Peer::SendBbsMsg(const BbsStore::Msg& x)
 {
 	proto::BbsMsg msgOut;
-	msgOut.m_Channel = d.m_Channel;
-	msgOut.m_TimePosted = d.m_TimePosted;
-	d.m_Message.Export(msgOut.m_Message);
-	msgOut.m_Nonce = d.m_Nonce;
+	msgOut.m_Channel = x.m_Channel;
+	msgOut.m_TimePosted = x.m_TimePosted;
+	msgOut.m_Message = x.m_Message;
+	msgOut.m_Nonce = x.m_Nonce;
 	Send(msgOut);
 }
 
@@ -3460,7 +3925,7 @@ void Node::Peer::OnMsg(proto::BbsSubscribe&& msg)
         m_This.m_Bbs.m_Subscribed.insert(pS->m_Bbs);
         m_Subscriptions.insert(pS->m_Peer);
 
-		pS->m_Cursor = m_This.m_Processor.get_DB().BbsFindCursor(msg.m_TimeFrom) - 1;
+		pS->m_Cursor = m_This.m_Bbs.m_Store.FindCursor(msg.m_TimeFrom) - 1;
 
 		BroadcastBbs(*pS);
     }
@@ -3473,20 +3938,15 @@ void Node::Peer::BroadcastBbs(Bbs::Subscription& s)
 	if (IsChocking())
 		return;
 
-	NodeDB& db = m_This.m_Processor.get_DB();
-	NodeDB::WalkerBbs wlk;
-
-	wlk.m_Data.m_Channel = s.m_Peer.m_Channel;
-	wlk.m_ID = s.m_Cursor;
-
-	for (db.EnumBbsCSeq(wlk); wlk.MoveNext(); )
+	const BbsStore& store = m_This.m_Bbs.m_Store;
+	for (const BbsStore::Msg* pMsg = store.get_Next(s.m_Peer.m_Channel, s.m_Cursor); pMsg; pMsg = store.get_Next(s.m_Peer.m_Channel, s.m_Cursor))
 	{
-		SendBbsMsg(wlk.m_Data);
+		SendBbsMsg(*pMsg);
+		s.m_Cursor = pMsg->m_ID;
+
 		if (IsChocking())
 			break;
 	}
-
-	s.m_Cursor = wlk.m_ID;
 }
 
 void Node::Peer::OnMsg(proto::BbsResetSync&& msg)
@@ -3494,7 +3954,7 @@ void Node::Peer::OnMsg(proto::BbsResetSync&& msg)
 	if (!m_This.m_Cfg.m_Bbs.IsEnabled())
 		ThrowUnexpected();
 
-	m_CursorBbs = m_This.m_Processor.get_DB().BbsFindCursor(msg.m_TimeFrom) - 1;
+	m_CursorBbs = m_This.m_Bbs.m_Store.FindCursor(msg.m_TimeFrom) - 1;
 	BroadcastBbs();
 }
 
@@ -4028,7 +4488,7 @@ IExternalPOW::BlockFoundResult Node::Miner::OnMinedExternal()
 	pTask->m_Hdr.m_PoW.m_Nonce = POW.m_Nonce;
 	pTask->m_Hdr.m_PoW.m_Indices = POW.m_Indices;
 
-    if (!pTask->m_Hdr.IsValidPoW())
+    if (!m_External.m_pSolver->verifies_solutions() && !pTask->m_Hdr.IsValidPoW())
     {
         LOG_INFO() << "invalid solution from external miner";
         return IExternalPOW::solution_rejected;
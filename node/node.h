@@ -15,7 +15,9 @@
 #pragma once
 
 #include "processor.h"
+#include "bbs_store.h"
 #include "utility/io/timer.h"
+#include "utility/io/timingwheel.h"
 #include "core/proto.h"
 #include "core/block_crypt.h"
 #include "core/shielded.h"
@@ -97,6 +99,9 @@ struct Node
 			uint32_t m_MessageTimeout_s = 3600 * 12; // 1/2 day
 			uint32_t m_CleanupPeriod_ms = 3600 * 1000; // 1 hour
 
+			// messages are kept in memory. Set the journal path to keep them across restarts
+			std::string m_sPathJournal;
+
 			NodeDB::BbsTotals m_Limit;
 
 			Bbs()
@@ -106,7 +111,8 @@ struct Node
 				// Means, for the default 12-hour lifetime it's about 1.5 mln, hence the following (20 mln) is more than enough
 				m_Limit.m_Count = 20000000;
 				// max bbs msg size is proto::Bbs::s_MaxMsgSize == 1Mb. However mostly they're much smaller.
-				m_Limit.m_Size = uint64_t(5) * 1024U * 1024U * 1024U; // 5Gb
+				// All the messages are kept in memory, so it's also the RAM budget.
+				m_Limit.m_Size = uint64_t(1) * 1024U * 1024U * 1024U; // 1Gb
 			}
 
 			bool IsEnabled() const { return m_Limit.m_Count > 0; }
@@ -121,6 +127,12 @@ struct Node
 			size_t m_MaxBodyPackSize = 1024 * 1024 * 5;
 			uint32_t m_MaxBodyPackCount = 3000;
 
+			// Block download scheduling. Body requests in-flight per peer are sized w.r.t. its bandwidth-delay product, up to this limit
+			uint32_t m_MaxBodyTasksPerPeer = 4;
+			// End-game: if a block request takes this many times longer than expected (but at least the min) - it's re-issued to a faster idle peer
+			uint32_t m_StraggleFactor = 3;
+			uint32_t m_StraggleMin_ms = 1000 * 3;
+
 		} m_BandwidthCtl;
 
 		struct TestMode {
@@ -197,6 +209,37 @@ struct Node
 
 	} m_SyncStatus;
 
+	// Per-peer download measurements, used for the block requests scheduling
+	struct DownloadStats
+	{
+		uint64_t m_Bytes = 0; // total received in response to our requests
+		uint32_t m_Bps = 0; // throughput, 0 if not measured yet
+		uint32_t m_Rtt_ms = 0; // latency, 0 if not measured yet
+		uint32_t m_LastResponse_ms = 0;
+
+		// responses smaller than this are dominated by the latency, larger ones - by the throughput
+		static const uint32_t s_LatencyBound = 1024 * 16;
+
+		void OnResponse(size_t nSize, uint32_t dt_ms, bool bQueued);
+
+		// num of requests to keep in-flight, w.r.t. bandwidth-delay product. nMax if not measured yet
+		uint32_t get_MaxTasks(uint32_t nAvgResponse, uint32_t nMax) const;
+	};
+
+	// Received hdr packs, verified asynchronously
+	struct HdrPackStats
+	{
+		uint32_t m_Pending = 0; // received, not handled yet
+		uint32_t m_PendingMax = 0;
+		uint32_t m_Handled = 0;
+		uint32_t m_Invalid = 0; // including those with invalid PoW
+		Block::SystemState::ID m_idLastHandled; // top of the last handled pack
+
+		HdrPackStats() { ZeroObject(m_idLastHandled); }
+	};
+
+	const HdrPackStats& get_HdrPackStats() const { return m_HdrPacks.m_Stats; }
+
 	uint32_t get_AcessiblePeerCount() const; // all the peers with known addresses. Including temporarily banned
     const PeerManager::AddrSet& get_AcessiblePeerAddrs() const;
 
@@ -209,7 +252,7 @@ struct Node
 
 	void RefreshCongestions(); // call explicitly if manual rollback or forbidden state is modified
 
-	bool DecodeAndCheckHdrs(std::vector<Block::SystemState::Full>&, const proto::HdrPack&);
+	static bool DecodeHdrs(std::vector<Block::SystemState::Full>&, const proto::HdrPack&); // PoW is not checked
 
 private:
 
@@ -280,6 +323,7 @@ private:
 		Key m_Key;
 
 		bool m_bNeeded;
+		bool m_bRelinquished; // re-issued to another peer, the owner's response is still expected but the task is not tracked anymore
 		uint32_t m_nCount;
 		uint32_t m_TimeAssigned_ms;
 		NodeDB::StateID m_sidTrg;
@@ -295,6 +339,7 @@ private:
 
 	uint32_t m_nTasksPackHdr = 0;
 	uint32_t m_nTasksPackBody = 0;
+	uint32_t m_nAvgBodyResponse = 0; // moving average of received block (pack) sizes, for the in-flight estimation
 
 	TaskList m_lstTasksUnassigned;
 	TaskSet m_setTasks;
@@ -304,8 +349,49 @@ private:
 
 	void TryAssignTask(Task&);
 	bool TryAssignTask(Task&, Peer&);
+	bool TryReissueTask(Task&);
 	void DeleteUnassignedTask(Task&);
 
+	struct HdrPacks
+	{
+		// Received hdr packs. Their PoW is verified on the executor, meanwhile the following packs are requested and downloaded.
+		// Verified packs are inserted in the order of arrival.
+		static const uint32_t s_MaxPending = 3;
+
+		// The executor is shared with the processor, and its ExecAll (block verification) waits for all the queued tasks.
+		// Hence the PoW is verified by small jobs, no more than a job per thread is queued at a time, the rest are queued as they complete.
+		static const uint32_t s_HdrsPerJob = 64;
+
+		struct Pack
+		{
+			typedef std::shared_ptr<Pack> Ptr;
+
+			std::vector<Block::SystemState::Full> m_vStates;
+			PeerID m_Peer;
+			Block::SystemState::ID m_idTop;
+			Block::SystemState::ID m_idNext; // the one below the pack
+			uint32_t m_Queued; // hdrs handed to the jobs
+			uint32_t m_Pending; // hdrs not verified yet, protected by the mutex
+			bool m_Valid;
+		};
+
+		struct Job;
+
+		std::mutex m_Mutex;
+		std::deque<Pack::Ptr> m_Queue;
+		uint32_t m_Jobs = 0; // queued on the executor, protected by the mutex
+		io::AsyncEvent::Ptr m_pEvt;
+		HdrPackStats m_Stats;
+
+		void Push(Pack::Ptr&&);
+		// If the hdrs are already received and pending - replaces the id by the one below them. Returns the num of pending packs skipped
+		uint32_t FindNext(Block::SystemState::ID&) const;
+		void OnVerified();
+		void QueueJobs();
+
+		IMPLEMENT_GET_PARENT_OBJ(Node, m_HdrPacks)
+	} m_HdrPacks;
+
 	void InitKeys();
 	void InitIDs();
 	void RefreshOwnedUtxos();
@@ -407,8 +493,10 @@ private:
 			IMPLEMENT_GET_PARENT_OBJ(Bbs, m_W)
 		} m_W;
 
-		static void CalcMsgKey(NodeDB::WalkerBbs::Data&);
+		static void CalcMsgKey(BbsStore::Key&, BbsChannel, const Blob& msg);
 		uint32_t m_LastCleanup_ms = 0;
+		void Initialize();
+		void ImportFromDB();
 		void Cleanup();
 		void MaybeCleanup();
 		bool IsInLimits() const;
@@ -437,7 +525,7 @@ private:
 		Subscription::BbsSet m_Subscribed;
 		Timestamp m_HighestPosted_s = 0;
 
-		NodeDB::BbsTotals m_Totals;
+		BbsStore m_Store;
 
 		IMPLEMENT_GET_PARENT_OBJ(Node, m_Bbs)
 	} m_Bbs;
@@ -520,8 +608,11 @@ private:
 
 		Bbs::Subscription::PeerSet m_Subscriptions;
 
-		io::Timer::Ptr m_pTimerRequest;
-		io::Timer::Ptr m_pTimerPeers;
+		io::TimingWheel::Timer m_TimerRequest;
+		io::TimingWheel::Timer m_TimerPeers;
+		io::TimingWheel::Timer m_TimerStraggle;
+
+		DownloadStats m_Download;
 
 		Peer(Node& n) :m_This(n) {}
 
@@ -532,8 +623,9 @@ private:
 		void Unsubscribe(Bbs::Subscription&);
 		void Unsubscribe();
 		void OnRequestTimeout();
+		void OnStraggling();
 		void OnResendPeers();
-		void SendBbsMsg(const NodeDB::WalkerBbs::Data&);
+		void SendBbsMsg(const BbsStore::Msg&);
 		void DeleteSelf(bool bIsError, uint8_t nByeReason);
 		void BroadcastTxs();
 		void BroadcastBbs();
@@ -551,6 +643,9 @@ private:
 		void OnFirstTaskDone();
 		void OnFirstTaskDone(NodeProcessor::DataStatus::Enum);
 		void ModifyRatingWrtData(size_t nSize);
+		uint32_t get_DownloadBps() const;
+		uint32_t get_MaxBodyTasks() const;
+		uint32_t get_ExpectedTime_ms() const;
 
 		void SendTx(Transaction::Ptr& ptx, bool bFluff);
 
@@ -583,6 +678,8 @@ private:
 		virtual void OnMsg(proto::GetProofKernel&&) override;
 		virtual void OnMsg(proto::GetProofKernel2&&) override;
 		virtual void OnMsg(proto::GetProofUtxo&&) override;
+		virtual void OnMsg(proto::GetProofUtxoMulti&&) override;
+		virtual void OnMsg(proto::GetProofKernelMulti&&) override;
 		virtual void OnMsg(proto::GetProofShieldedOutp&&) override;
 		virtual void OnMsg(proto::GetProofShieldedInp&&) override;
 		virtual void OnMsg(proto::GetProofAsset&&) override;
@@ -604,6 +701,10 @@ private:
 	typedef boost::intrusive::list<Peer> PeerList;
 	PeerList m_lstPeers;
 
+	// shared by per-peer timers, which are re-armed on every task assignment
+	io::TimingWheel::Ptr m_pTimerWheel;
+	io::TimingWheel& get_TimerWheel();
+
 	ECC::NoLeak<ECC::uintBig> m_NonceLast;
 	const ECC::uintBig& NextNonce();
 	void NextNonce(ECC::Scalar::Native&);
@@ -3968,6 +3968,41 @@ NodeProcessor::DataStatus::Enum NodeProcessor::OnStateSilent(const Block::System
 	return ret;
 }
 
+NodeProcessor::DataStatus::Enum NodeProcessor::OnStatesSilent(const Block::SystemState::Full* pS, size_t nCount, const PeerID& peer)
+{
+	std::vector<bool> vAccepted(nCount);
+	for (size_t i = 0; i < nCount; i++)
+	{
+		Block::SystemState::ID id;
+		DataStatus::Enum eStatus = OnStateInternal(pS[i], id, true);
+		if (DataStatus::Invalid == eStatus)
+			return eStatus;
+
+		vAccepted[i] = (DataStatus::Accepted == eStatus);
+	}
+
+	// insert the consecutive accepted headers at once
+	DataStatus::Enum ret = DataStatus::Rejected;
+	for (size_t i0 = 0; i0 < nCount; )
+	{
+		if (!vAccepted[i0])
+		{
+			i0++;
+			continue;
+		}
+
+		size_t i1 = i0 + 1;
+		while ((i1 < nCount) && vAccepted[i1])
+			i1++;
+
+		m_DB.InsertStates(pS + i0, i1 - i0, peer);
+		ret = DataStatus::Accepted;
+		i0 = i1;
+	}
+
+	return ret;
+}
+
 NodeProcessor::DataStatus::Enum NodeProcessor::OnBlock(const Block::SystemState::ID& id, const Blob& bbP, const Blob& bbE, const PeerID& peer)
 {
 	NodeDB::StateID sid;
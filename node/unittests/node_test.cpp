@@ -673,6 +673,75 @@ namespace beam
 		tr.Commit();
 	}
 
+	void TestNodeDBBatch(const char* sz)
+	{
+		NodeDB db;
+		db.Open(sz);
+
+		NodeDB::Transaction tr(db);
+
+		const uint32_t hMax = 100;
+		const uint32_t hFork0 = 30;
+
+		std::vector<Block::SystemState::Full> vStates;
+		vStates.resize(hMax);
+		memset0(&vStates.at(0), vStates.size());
+
+		for (uint32_t h = 0; h < hMax; h++)
+		{
+			Block::SystemState::Full& s = vStates[h];
+			s.m_Height = h + Rules::HeightGenesis;
+			s.m_ChainWork = h;
+
+			if (h)
+				vStates[h - 1].get_Hash(s.m_Prev);
+		}
+
+		PeerID peer;
+		memset(peer.m_pData, 0x66, peer.nBytes);
+
+		// the upper states arrive first, then the chain below them in packs, downwards
+		for (uint32_t h = hMax; h-- > 60; )
+			db.InsertState(vStates[h], peer);
+
+		db.InsertStates(&vStates[20], 40, peer);
+		verify_test(CountTips(db, false) == 1);
+
+		Block::SystemState::ID id;
+		vStates[19].get_ID(id);
+		verify_test(db.InsertStates(&vStates[0], 20, peer) == db.StateFindSafe(id));
+
+		NodeDB::StateID sid;
+		verify_test(CountTips(db, false, &sid) == 1);
+		verify_test(sid.m_Height == hMax - 1 + Rules::HeightGenesis);
+
+		std::vector<uint64_t> vRows;
+		vRows.push_back(sid.m_Row);
+		while (db.get_Prev(sid))
+			vRows.push_back(sid.m_Row);
+
+		verify_test(vRows.size() == hMax);
+		std::reverse(vRows.begin(), vRows.end());
+
+		// a branch
+		std::vector<Block::SystemState::Full> vFork(vStates.begin() + hFork0, vStates.begin() + hFork0 + 3);
+		vFork[0].m_Definition.Inc(); // alter
+		for (size_t i = 1; i < vFork.size(); i++)
+			vFork[i - 1].get_Hash(vFork[i].m_Prev);
+
+		db.InsertStates(&vFork.front(), vFork.size(), peer);
+		verify_test(CountTips(db, false) == 2);
+
+		for (uint32_t h = 1; h < hMax; h++)
+			db.SetStateFunctional(vRows[h]);
+		db.SetStateFunctional(vRows[0]);
+
+		verify_test(CountTips(db, true, &sid) == 1);
+		verify_test(sid.m_Row == vRows.back());
+
+		tr.Commit();
+	}
+
 #ifdef WIN32
 		const char* g_sz = "mytest.db";
 		const char* g_sz2 = "mytest2.db";
@@ -691,6 +760,110 @@ namespace beam
 			NodeDB db;
 			db.Open(g_sz); // test to open already-existing DB
 		}
+
+		TestNodeDBBatch(g_sz2);
+		DeleteFile(g_sz2);
+	}
+
+	void TestBbsStore()
+	{
+		std::string sPath = g_sz;
+		sPath += ".bbs";
+		DeleteFile(sPath.c_str());
+
+		auto fnKey = [](uint32_t i) {
+			BbsStore::Key key;
+			ECC::Hash::Processor() << "bbs" << i >> key;
+			return key;
+		};
+
+		const uint32_t nMsgs = 50;
+		std::vector<uint8_t> vBody(nMsgs * 2000, 0x5a);
+
+		{
+			BbsStore store;
+			store.OpenJournal(sPath);
+			verify_test(!store.get_Oldest() && (store.FindCursor(0) == 1));
+
+			for (uint32_t i = 0; i < nMsgs; i++)
+			{
+				Timestamp ts = 100 + i;
+				if (i == 20)
+					ts -= 10; // out-of-order
+
+				const BbsStore::Msg& x = store.Insert(fnKey(i), i % 7, ts, Blob(&vBody.front(), i * 2000), i);
+				verify_test(x.m_ID == i + 1);
+			}
+
+			verify_test(store.get_Totals().m_Count == nMsgs);
+			verify_test(store.get_MaxTime() == 100 + nMsgs - 1);
+
+			for (uint32_t i = 0; i < nMsgs; i++)
+			{
+				const BbsStore::Msg* pMsg = store.Find(fnKey(i));
+				verify_test(pMsg && (pMsg->m_ID == i + 1) && (pMsg->m_Message.size() == i * 2000));
+			}
+			verify_test(!store.Find(fnKey(nMsgs)));
+
+			// per-channel sequence
+			uint32_t nCount = 0;
+			for (const BbsStore::Msg* pMsg = store.get_Next(3, 0); pMsg; pMsg = store.get_Next(3, pMsg->m_ID), nCount++)
+				verify_test((pMsg->m_Channel == 3) && (pMsg->m_ID == 7 * nCount + 4));
+			verify_test(nCount == (nMsgs + 3) / 7);
+
+			verify_test(store.get_Next(10)->m_ID == 11);
+			verify_test(!store.get_Next(nMsgs));
+
+			verify_test(store.FindCursor(105) == 6);
+			verify_test(store.FindCursor(95) == 1);
+			verify_test(store.FindCursor(100 + nMsgs) == nMsgs + 1);
+
+			for (uint32_t i = 0; i < 10; i++)
+				store.DeleteOldest();
+
+			verify_test(store.get_Totals().m_Count == nMsgs - 10);
+			verify_test(!store.Find(fnKey(9)) && store.Find(fnKey(10)));
+			verify_test(store.get_Oldest()->m_ID == 11);
+			verify_test(store.get_Next(3)->m_ID == 11);
+			verify_test(store.get_Next(3, 0)->m_ID == 11);
+			verify_test(store.FindCursor(105) == 11);
+		}
+
+		{
+			// reload. Msgs removed before are loaded, the caller is supposed to clean them up
+			BbsStore store;
+			store.OpenJournal(sPath);
+			verify_test(store.get_Totals().m_Count == nMsgs);
+
+			for (uint32_t i = 0; i < nMsgs; i++)
+			{
+				const BbsStore::Msg* pMsg = store.Find(fnKey(i));
+				verify_test(pMsg && (pMsg->m_Channel == i % 7) && (pMsg->m_Nonce == i) && (pMsg->m_Message.size() == i * 2000));
+			}
+
+			while (store.get_Totals().m_Count > 5)
+				store.DeleteOldest();
+			store.FlushJournal(); // should rewrite it, most of it is removed
+
+			store.Insert(fnKey(nMsgs), 0, 200, Blob(&vBody.front(), 1), 0);
+		}
+
+		{
+			// append an incomplete record
+			std::FStream fs;
+			fs.Open(sPath.c_str(), false, true, true);
+			fs.write(&vBody.front(), 10);
+		}
+
+		{
+			BbsStore store;
+			store.OpenJournal(sPath);
+			verify_test(store.get_Totals().m_Count == 6);
+			verify_test(store.Find(fnKey(nMsgs)) && store.Find(fnKey(nMsgs - 5)) && !store.Find(fnKey(nMsgs - 6)));
+			verify_test(store.get_Oldest()->m_ID == 1);
+		}
+
+		DeleteFile(sPath.c_str());
 	}
 
 	struct MiniWallet
@@ -1576,6 +1749,581 @@ namespace beam
 		DeleteFile(g_sz3);
 	}
 
+	void TestNodeSyncHdrs()
+	{
+		// Node2 syncs from scratch a chain of several hdr packs, which are verified and inserted asynchronously
+
+		io::Reactor::Ptr pReactor(io::Reactor::create());
+		io::Reactor::Scope scope(*pReactor);
+
+		Node node, node2;
+		node.m_Cfg.m_sPathLocal = g_sz;
+		node.m_Cfg.m_Listen.port(g_Port);
+		node.m_Cfg.m_Listen.ip(INADDR_ANY);
+		node.m_Cfg.m_Treasury = g_Treasury;
+
+		node2.m_Cfg.m_sPathLocal = g_sz2;
+		node2.m_Cfg.m_Treasury = g_Treasury;
+		node2.m_Cfg.m_Connect.resize(1);
+		node2.m_Cfg.m_Connect[0].resolve("127.0.0.1");
+		node2.m_Cfg.m_Connect[0].port(g_Port);
+
+		ECC::SetRandom(node);
+		ECC::SetRandom(node2);
+
+		node.Initialize();
+
+		const Height hTrg = proto::g_HdrPackMaxSize * 2 + 100;
+
+		NodeProcessor& proc = node.get_Processor();
+		while (proc.m_Cursor.m_ID.m_Height < hTrg)
+		{
+			TxPool::Fluff txPool; // empty, no transactions
+			NodeProcessor::BlockContext bc(txPool, 0, *node.m_Keys.m_pMiner, *node.m_Keys.m_pMiner);
+
+			verify_test(proc.GenerateNewBlock(bc));
+			verify_test(proc.OnState(bc.m_Hdr, PeerID()) == NodeProcessor::DataStatus::Accepted);
+
+			Block::SystemState::ID id;
+			bc.m_Hdr.get_ID(id);
+
+			proc.OnBlock(id, bc.m_BodyP, bc.m_BodyE, PeerID());
+			proc.TryGoUp();
+		}
+
+		node2.Initialize();
+
+		struct MyTimer
+		{
+			io::Timer::Ptr m_pTimer;
+			Node* m_pNode;
+			uint32_t m_Cycles = 0;
+
+			void OnTimer()
+			{
+				if (m_pNode->get_Processor().m_Cursor.m_ID.m_Height >= hTrg)
+					io::Reactor::get_Current().stop();
+				else
+					if (++m_Cycles > 1200)
+					{
+						fail_test("Node2 didn't sync");
+						io::Reactor::get_Current().stop();
+					}
+			}
+		} t;
+
+		t.m_pNode = &node2;
+		t.m_pTimer = io::Timer::create(*pReactor);
+		t.m_pTimer->start(100, true, [&t]() { t.OnTimer(); });
+
+		pReactor->run();
+
+		verify_test(node2.get_Processor().m_Cursor.m_ID == proc.m_Cursor.m_ID);
+	}
+
+	void TestDownloadStats()
+	{
+		Node::DownloadStats ds;
+		const uint32_t nMax = 16;
+		const uint32_t nAvg = 1024 * 64; // typical body response
+
+		verify_test(ds.get_MaxTasks(nAvg, nMax) == nMax); // not measured yet
+
+		// small responses measure the latency
+		for (uint32_t i = 0; i < 8; i++)
+			ds.OnResponse(100, 50, false);
+		verify_test(ds.m_Rtt_ms == 50);
+		verify_test(!ds.m_Bps);
+		verify_test(ds.get_MaxTasks(nAvg, nMax) == nMax);
+
+		// 1MB/s, the latency is excluded. ~50KB in flight, less than a single response, yet the next request is sent before the response is received
+		for (uint32_t i = 0; i < 32; i++)
+			ds.OnResponse(1024 * 1024, 1000 + 50, false);
+		verify_test(ds.m_Bps == 1024 * 1024);
+		verify_test(ds.m_Rtt_ms == 50);
+		verify_test(ds.get_MaxTasks(nAvg, nMax) == 2);
+		verify_test(ds.get_MaxTasks(nAvg, 1) == 1);
+
+		// 12MB/s: ~600KB in flight
+		for (uint32_t i = 0; i < 32; i++)
+			ds.OnResponse(1024 * 1024 * 12, 1000 + 50, false);
+		verify_test(ds.get_MaxTasks(nAvg, nMax) == 11);
+
+		// larger responses - less of them in flight
+		verify_test(ds.get_MaxTasks(nAvg * 4, nMax) == 4);
+
+		// 40MB/s: limited by nMax
+		for (uint32_t i = 0; i < 32; i++)
+			ds.OnResponse(1024 * 1024 * 40, 1000 + 50, false);
+		verify_test(ds.get_MaxTasks(nAvg, nMax) == nMax);
+
+		// the rate drops, and so does the depth
+		for (uint32_t i = 0; i < 32; i++)
+			ds.OnResponse(1024 * 1024, 1000 + 50, false);
+		verify_test(ds.get_MaxTasks(nAvg, nMax) == 2);
+
+		// queued responses: the interval between them is the transfer time, they don't affect the latency
+		for (uint32_t i = 0; i < 32; i++)
+		{
+			ds.OnResponse(100, 5, true);
+			ds.OnResponse(1024 * 1024 * 12, 1000, true);
+		}
+		verify_test(ds.m_Rtt_ms == 50);
+		verify_test(ds.get_MaxTasks(nAvg, nMax) == 11);
+	}
+
+	// Emulated peer, serves the hdrs and blocks of the source node
+	struct EmulatedPeer
+		:public proto::NodeConnection
+	{
+		NodeProcessor* m_pSrc = nullptr;
+		uint32_t m_HdrsDelay_ms = 0; // lowers the peer rating
+		bool m_HoldBodies = false;
+		uint32_t m_BodyRequests = 0;
+		bool m_Pong = false;
+
+		// serves the 1st hdr pack with the real PoW verification turned on, while the hdrs are mined with the fake one. Holds the following requests
+		bool m_Insane = false;
+		bool m_Disconnected = false;
+		uint32_t m_HdrRequests = 0;
+		std::vector<Block::SystemState::ID> m_vHdrsServed; // tops of the packs
+
+		std::vector<proto::GetBodyPack> m_vHeld;
+		std::deque<proto::HdrPack> m_lstHdrs;
+		io::Timer::Ptr m_pTimer;
+
+		virtual void OnConnectedSecure() override
+		{
+			ECC::Scalar::Native sk;
+			ECC::SetRandom(sk);
+			ProveID(sk, proto::IDType::Node);
+
+			SendLogin();
+
+			proto::NewTip msg;
+			msg.m_Description = m_pSrc->m_Cursor.m_Full;
+			Send(msg);
+		}
+
+		virtual void OnDisconnect(const DisconnectReason&) override
+		{
+			m_Disconnected = true;
+			if (m_Insane)
+				return; // expected to be banned
+
+			fail_test("peer disconnected");
+			io::Reactor::get_Current().stop();
+		}
+
+		virtual void OnMsg(proto::GetHdrPack&& msg) override
+		{
+			m_HdrRequests++;
+			if (m_Insane && !m_vHdrsServed.empty())
+				return;
+
+			proto::HdrPack msgOut;
+
+			NodeDB& db = m_pSrc->get_DB();
+			NodeDB::StateID sid;
+			sid.m_Row = msg.m_Count ? db.StateFindSafe(msg.m_Top) : 0;
+			if (sid.m_Row)
+			{
+				sid.m_Height = msg.m_Top.m_Height;
+
+				NodeDB::WalkerSystemState wlk;
+				for (db.EnumSystemStatesBkwd(wlk, sid); wlk.MoveNext(); )
+				{
+					msgOut.m_vElements.push_back(wlk.m_State);
+					if (msgOut.m_vElements.size() == msg.m_Count)
+						break;
+				}
+
+				msgOut.m_Prefix = wlk.m_State;
+			}
+
+			if (msgOut.m_vElements.empty())
+			{
+				Send(proto::DataMissing(Zero));
+				return;
+			}
+
+			m_vHdrsServed.push_back(msg.m_Top);
+			if (m_Insane)
+				Rules::get().FakePoW = false;
+
+			if (!m_HdrsDelay_ms)
+			{
+				Send(msgOut);
+				return;
+			}
+
+			m_lstHdrs.push_back(std::move(msgOut));
+			if (!m_pTimer)
+				m_pTimer = io::Timer::create(io::Reactor::get_Current());
+
+			m_pTimer->start(m_HdrsDelay_ms, false, [this]() {
+				Send(m_lstHdrs.front());
+				m_lstHdrs.pop_front();
+			});
+		}
+
+		virtual void OnMsg(proto::GetBodyPack&& msg) override
+		{
+			m_BodyRequests++;
+			if (m_HoldBodies)
+				m_vHeld.push_back(std::move(msg));
+			else
+				SendBody(msg);
+		}
+
+		void SendBody(const proto::GetBodyPack& msg)
+		{
+			NodeDB::StateID sid;
+			sid.m_Row = m_pSrc->get_DB().StateFindSafe(msg.m_Top);
+			verify_test(sid.m_Row);
+
+			proto::BodyPack msgOut;
+			for (sid.m_Height = msg.m_Top.m_Height - msg.m_CountExtra; sid.m_Height <= msg.m_Top.m_Height; sid.m_Height++)
+			{
+				sid.m_Row = m_pSrc->FindActiveAtStrict(sid.m_Height);
+
+				proto::BodyBuffers& bb = msgOut.m_Bodies.emplace_back();
+				verify_test(m_pSrc->GetBlock(sid, &bb.m_Eternal, &bb.m_Perishable, msg.m_Height0, msg.m_HorizonLo1, msg.m_HorizonHi1, true));
+			}
+
+			if (msg.m_CountExtra)
+				Send(msgOut);
+			else
+			{
+				proto::Body msgBody;
+				msgBody.m_Body = std::move(msgOut.m_Bodies.front());
+				Send(msgBody);
+			}
+		}
+
+		virtual void OnMsg(proto::Pong&&) override
+		{
+			m_Pong = true;
+		}
+	};
+
+	void TestNodeHdrPacks()
+	{
+		// Hdr packs are verified asynchronously, and handled in the order of arrival.
+		// The 1st peer sends a pack with invalid PoW, it's banned. The 2nd peer serves the chain, while the verification is stuck, so that the packs accumulate
+
+		io::Reactor::Ptr pReactor(io::Reactor::create());
+		io::Reactor::Scope scope(*pReactor);
+
+		std::atomic<bool> bGateOpen(true); // blocks the verification thread when closed
+
+		struct Gate
+			:public Executor::TaskAsync
+		{
+			std::atomic<bool>& m_Open;
+			Gate(std::atomic<bool>& x) :m_Open(x) {}
+
+			virtual void Exec(Executor::Context&) override
+			{
+				while (!m_Open)
+					std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			}
+		};
+
+		struct MyObserver
+			:public Node::IObserver
+		{
+			Node* m_pNode = nullptr;
+			std::vector<Block::SystemState::ID> m_vHandled;
+
+			virtual void OnSyncProgress() override
+			{
+				const Block::SystemState::ID& id = m_pNode->get_HdrPackStats().m_idLastHandled;
+				if (id.m_Height && (m_vHandled.empty() || !(m_vHandled.back() == id)))
+					m_vHandled.push_back(id);
+			}
+		} obs;
+
+		Node nodeSrc, node;
+		nodeSrc.m_Cfg.m_sPathLocal = g_sz;
+		nodeSrc.m_Cfg.m_Treasury = g_Treasury;
+
+		node.m_Cfg.m_sPathLocal = g_sz2;
+		node.m_Cfg.m_Listen.port(g_Port);
+		node.m_Cfg.m_Listen.ip(INADDR_ANY);
+		node.m_Cfg.m_Treasury = g_Treasury;
+		node.m_Cfg.m_VerificationThreads = 1;
+		node.m_Cfg.m_Observer = &obs;
+		obs.m_pNode = &node;
+
+		ECC::SetRandom(nodeSrc);
+		ECC::SetRandom(node);
+
+		nodeSrc.Initialize();
+
+		const Height hTrg = proto::g_HdrPackMaxSize * 3 + 100;
+
+		NodeProcessor& proc = nodeSrc.get_Processor();
+		while (proc.m_Cursor.m_ID.m_Height < hTrg)
+		{
+			TxPool::Fluff txPool; // empty, no transactions
+			NodeProcessor::BlockContext bc(txPool, 0, *nodeSrc.m_Keys.m_pMiner, *nodeSrc.m_Keys.m_pMiner);
+
+			verify_test(proc.GenerateNewBlock(bc));
+			verify_test(proc.OnState(bc.m_Hdr, PeerID()) == NodeProcessor::DataStatus::Accepted);
+
+			Block::SystemState::ID id;
+			bc.m_Hdr.get_ID(id);
+
+			proc.OnBlock(id, bc.m_BodyP, bc.m_BodyE, PeerID());
+			proc.TryGoUp();
+		}
+
+		node.Initialize();
+
+		EmulatedPeer pInsane, pGood;
+		pInsane.m_pSrc = &proc;
+		pInsane.m_Insane = true;
+		pGood.m_pSrc = &proc;
+
+		io::Address addr;
+		addr.resolve("127.0.0.1");
+		addr.port(g_Port);
+
+		pInsane.Connect(addr);
+
+		struct MyTimer
+		{
+			io::Timer::Ptr m_pTimer;
+			Node* m_pNode;
+			EmulatedPeer* m_pInsane;
+			EmulatedPeer* m_pGood;
+			std::atomic<bool>* m_pGateOpen;
+			std::vector<Block::SystemState::ID>* m_pvHandled;
+			io::Address m_Addr;
+			uint32_t m_Stage = 0;
+			uint32_t m_Stable = 0;
+			uint32_t m_Cycles = 0;
+
+			void OnTimer()
+			{
+				const Node::HdrPackStats& hs = m_pNode->get_HdrPackStats();
+
+				switch (m_Stage)
+				{
+				case 0:
+					if (!m_pInsane->m_Disconnected)
+						break;
+
+					// the invalid pack is handled, the peer is banned
+					verify_test(m_pInsane->m_vHdrsServed.size() == 1);
+					verify_test(hs.m_Invalid == 1);
+					verify_test(hs.m_Handled == 1);
+					verify_test(!hs.m_Pending);
+					Rules::get().FakePoW = true;
+					m_pvHandled->clear();
+
+					// block the verification, and sync from the good peer
+					*m_pGateOpen = false;
+					m_pNode->get_Processor().get_Executor().Push(std::make_unique<Gate>(*m_pGateOpen));
+
+					m_pGood->Connect(m_Addr);
+					m_Stage++;
+					break;
+
+				case 1:
+					if (m_pGood->m_vHdrsServed.empty() || (m_pGood->m_vHdrsServed.size() != hs.m_Pending))
+					{
+						m_Stable = 0;
+						break;
+					}
+
+					if (++m_Stable < 5)
+						break;
+
+					// several packs are pending, no more are requested beyond the limit
+					verify_test(hs.m_Pending > 1);
+					verify_test(hs.m_PendingMax == hs.m_Pending);
+					verify_test(m_pGood->m_vHdrsServed.size() * proto::g_HdrPackMaxSize < hTrg);
+					verify_test(m_pNode->get_Processor().m_Cursor.m_ID.m_Height < Rules::HeightGenesis);
+
+					*m_pGateOpen = true;
+					m_Stage++;
+					break;
+
+				default:
+					if (m_pNode->get_Processor().m_Cursor.m_ID.m_Height >= hTrg)
+					{
+						io::Reactor::get_Current().stop();
+						return;
+					}
+				}
+
+				if (++m_Cycles > 600)
+				{
+					fail_test("Node didn't sync");
+					io::Reactor::get_Current().stop();
+				}
+			}
+		} t;
+
+		t.m_pNode = &node;
+		t.m_pInsane = &pInsane;
+		t.m_pGood = &pGood;
+		t.m_pGateOpen = &bGateOpen;
+		t.m_pvHandled = &obs.m_vHandled;
+		t.m_Addr = addr;
+		t.m_pTimer = io::Timer::create(*pReactor);
+		t.m_pTimer->start(100, true, [&t]() { t.OnTimer(); });
+
+		pReactor->run();
+
+		bGateOpen = true;
+		Rules::get().FakePoW = true;
+
+		verify_test(node.get_Processor().m_Cursor.m_ID == proc.m_Cursor.m_ID);
+
+		// the packs are handled in the order of arrival
+		const Node::HdrPackStats& hs = node.get_HdrPackStats();
+		verify_test(hs.m_Invalid == 1);
+		verify_test(hs.m_Handled == pGood.m_vHdrsServed.size() + 1);
+		verify_test(hs.m_idLastHandled == pGood.m_vHdrsServed.back());
+
+		size_t iServed = 0;
+		for (const auto& id : obs.m_vHandled)
+		{
+			while ((iServed < pGood.m_vHdrsServed.size()) && !(pGood.m_vHdrsServed[iServed] == id))
+				iServed++;
+			verify_test(iServed < pGood.m_vHdrsServed.size());
+		}
+	}
+
+	void TestNodeStraggler()
+	{
+		// End-game: the block request to a slow peer is re-issued to a faster idle peer, then the late response of the slow peer arrives.
+		// Both peers are emulated, they serve the data of the source node
+
+		io::Reactor::Ptr pReactor(io::Reactor::create());
+		io::Reactor::Scope scope(*pReactor);
+
+		Node nodeSrc, node;
+		nodeSrc.m_Cfg.m_sPathLocal = g_sz;
+		nodeSrc.m_Cfg.m_Treasury = g_Treasury;
+
+		node.m_Cfg.m_sPathLocal = g_sz2;
+		node.m_Cfg.m_Listen.port(g_Port);
+		node.m_Cfg.m_Listen.ip(INADDR_ANY);
+		node.m_Cfg.m_Treasury = g_Treasury;
+		node.m_Cfg.m_Timeout.m_GetBlock_ms = 1000 * 60;
+		node.m_Cfg.m_Timeout.m_GetState_ms = 1000 * 60;
+		node.m_Cfg.m_BandwidthCtl.m_MaxBodyPackSize = 1024 * 16; // the expected response size until measured
+		node.m_Cfg.m_BandwidthCtl.m_StraggleMin_ms = 500;
+
+		ECC::SetRandom(nodeSrc);
+		ECC::SetRandom(node);
+
+		nodeSrc.Initialize();
+
+		const Height hTrg = 20;
+
+		NodeProcessor& proc = nodeSrc.get_Processor();
+		while (proc.m_Cursor.m_ID.m_Height < hTrg)
+		{
+			TxPool::Fluff txPool; // empty, no transactions
+			NodeProcessor::BlockContext bc(txPool, 0, *nodeSrc.m_Keys.m_pMiner, *nodeSrc.m_Keys.m_pMiner);
+
+			verify_test(proc.GenerateNewBlock(bc));
+			verify_test(proc.OnState(bc.m_Hdr, PeerID()) == NodeProcessor::DataStatus::Accepted);
+
+			Block::SystemState::ID id;
+			bc.m_Hdr.get_ID(id);
+
+			proc.OnBlock(id, bc.m_BodyP, bc.m_BodyE, PeerID());
+			proc.TryGoUp();
+		}
+
+		node.Initialize();
+
+		EmulatedPeer pSlow, pFast;
+		pSlow.m_pSrc = &proc;
+		pSlow.m_HdrsDelay_ms = 400;
+		pSlow.m_HoldBodies = true;
+		pFast.m_pSrc = &proc;
+
+		io::Address addr;
+		addr.resolve("127.0.0.1");
+		addr.port(g_Port);
+
+		// only the slow peer is connected at first, it gets all the requests
+		pSlow.Connect(addr);
+
+		struct MyTimer
+		{
+			io::Timer::Ptr m_pTimer;
+			Node* m_pNode;
+			EmulatedPeer* m_pSlow;
+			EmulatedPeer* m_pFast;
+			io::Address m_Addr;
+			uint32_t m_Stage = 0;
+			uint32_t m_Cycles = 0;
+
+			void OnTimer()
+			{
+				switch (m_Stage)
+				{
+				case 0:
+					if (m_pSlow->m_vHeld.empty())
+						break;
+
+					// the block request is stuck, an idle and faster peer appears
+					m_pFast->Connect(m_Addr);
+					m_Stage++;
+					break;
+
+				case 1:
+					if (m_pNode->get_Processor().m_Cursor.m_ID.m_Height < hTrg)
+						break;
+
+					// synced from the fast peer. Now the slow one responds, and the node should consume the response
+					verify_test(m_pFast->m_BodyRequests);
+
+					for (const auto& msg : m_pSlow->m_vHeld)
+						m_pSlow->SendBody(msg);
+					m_pSlow->m_vHeld.clear();
+
+					m_pSlow->Send(proto::Ping(Zero));
+					m_Stage++;
+					break;
+
+				default:
+					if (m_pSlow->m_Pong)
+					{
+						io::Reactor::get_Current().stop();
+						return;
+					}
+				}
+
+				if (++m_Cycles > 300)
+				{
+					fail_test("Node didn't sync");
+					io::Reactor::get_Current().stop();
+				}
+			}
+		} t;
+
+		t.m_pNode = &node;
+		t.m_pSlow = &pSlow;
+		t.m_pFast = &pFast;
+		t.m_Addr = addr;
+		t.m_pTimer = io::Timer::create(*pReactor);
+		t.m_pTimer->start(100, true, [&t]() { t.OnTimer(); });
+
+		pReactor->run();
+
+		verify_test(node.get_Processor().m_Cursor.m_ID == proc.m_Cursor.m_ID);
+		verify_test(pSlow.m_BodyRequests == 1); // the request wasn't re-sent to the slow peer
+	}
+
 
 
 	void TestNodeClientProto()
@@ -1618,6 +2366,8 @@ namespace beam
 			std::list<ECC::Point> m_queProofsExpected;
 			std::list<uint32_t> m_queProofsStateExpected;
 			std::list<uint32_t> m_queProofsKrnExpected;
+			std::list<std::vector<ECC::Point> > m_queProofsMultiExpected;
+			std::list<uint32_t> m_queProofsKrnMultiExpected;
 			uint32_t m_nChainWorkProofsPending = 0;
 			uint32_t m_nBbsMsgsPending = 0;
 			uint32_t m_nRecoveryPending = 0;
@@ -1694,6 +2444,8 @@ namespace beam
 				return
 					m_queProofsExpected.empty() &&
 					m_queProofsKrnExpected.empty() &&
+					m_queProofsMultiExpected.empty() &&
+					m_queProofsKrnMultiExpected.empty() &&
 					m_queProofsStateExpected.empty() &&
 					!m_nChainWorkProofsPending;
 			}
@@ -2068,6 +2820,8 @@ namespace beam
 					Send(msgOut2);
 				}
 
+				proto::GetProofUtxoMulti msgMulti;
+
 				for (auto it = m_Wallet.m_MyUtxos.begin(); m_Wallet.m_MyUtxos.end() != it; it++)
 				{
 					const MiniWallet::MyUtxo& utxo = it->second;
@@ -2081,9 +2835,21 @@ namespace beam
 					{
 						Send(msgOut2);
 						m_queProofsExpected.push_back(msgOut2.m_Utxo);
+
+						if (msgMulti.m_Utxos.size() < proto::g_ProofsMultiMax)
+							msgMulti.m_Utxos.push_back(msgOut2.m_Utxo);
 					}
 				}
 
+				if (!msgMulti.m_Utxos.empty())
+				{
+					Send(msgMulti);
+					m_queProofsMultiExpected.push_back(std::move(msgMulti.m_Utxos));
+				}
+
+				proto::GetProofKernelMulti msgKrnMulti;
+				msgKrnMulti.m_Fetch = true;
+
 				for (uint32_t i = 0; i < m_Wallet.m_MyKernels.size(); i++)
 				{
 					const MiniWallet::MyKernel mk = m_Wallet.m_MyKernels[i];
@@ -2103,6 +2869,15 @@ namespace beam
 					Send(msgOut3);
 
 					m_queProofsKrnExpected.push_back(i);
+
+					if (msgKrnMulti.m_IDs.size() < proto::g_ProofsMultiMax)
+						msgKrnMulti.m_IDs.push_back(krn.m_Internal.m_ID);
+				}
+
+				if (!msgKrnMulti.m_IDs.empty())
+				{
+					Send(msgKrnMulti);
+					m_queProofsKrnMultiExpected.push_back(static_cast<uint32_t>(msgKrnMulti.m_IDs.size()));
 				}
 
 				{
@@ -2298,6 +3073,73 @@ namespace beam
 					fail_test("unexpected proof");
 			}
 
+			virtual void OnMsg(proto::ProofUtxoMulti&& msg) override
+			{
+				if (!m_queProofsMultiExpected.empty())
+				{
+					const std::vector<ECC::Point>& vComm = m_queProofsMultiExpected.front();
+					verify_test(msg.m_Counts.size() == vComm.size());
+
+					Merkle::MultiPath::Reader rd(msg.m_Proofs);
+					size_t iState = 0;
+
+					for (size_t i = 0; i < vComm.size(); i++)
+					{
+						verify_test(msg.m_Counts[i]);
+
+						for (uint32_t j = 0; j < msg.m_Counts[i]; j++)
+						{
+							verify_test(iState < msg.m_States.size());
+
+							Input::Proof proof;
+							proof.m_State = msg.m_States[iState++];
+							verify_test(rd.Read(proof.m_Proof));
+							verify_test(m_vStates.back().IsValidProofUtxo(vComm[i], proof));
+						}
+					}
+
+					Merkle::Proof proof;
+					verify_test(!rd.Read(proof));
+
+					m_queProofsMultiExpected.pop_front();
+				}
+				else
+					fail_test("unexpected proof");
+			}
+
+			virtual void OnMsg(proto::ProofKernelMulti&& msg) override
+			{
+				if (!m_queProofsKrnMultiExpected.empty())
+				{
+					verify_test(msg.m_Heights.size() == m_queProofsKrnMultiExpected.front());
+					m_queProofsKrnMultiExpected.pop_front();
+
+					Merkle::MultiPath::Reader rd(msg.m_Proofs);
+					size_t iKrn = 0;
+
+					for (size_t i = 0; i < msg.m_Heights.size(); i++)
+					{
+						Height h = msg.m_Heights[i];
+						if (!h)
+							continue;
+
+						verify_test((iKrn < msg.m_Kernels.size()) && msg.m_Kernels[iKrn]);
+						const TxKernel& krn = *msg.m_Kernels[iKrn++];
+
+						Merkle::Proof proof;
+						verify_test(rd.Read(proof));
+
+						Merkle::Hash hv = krn.m_Internal.m_ID;
+						Merkle::Interpret(hv, proof);
+
+						verify_test(h <= m_vStates.size());
+						verify_test(m_vStates[h - 1].m_Kernels == hv);
+					}
+				}
+				else
+					fail_test("unexpected proof");
+			}
+
 			virtual void OnMsg(proto::ProofKernel2&& msg) override
 			{
 				if (!m_queProofsKrnExpected.empty())
@@ -2827,6 +3669,7 @@ namespace beam
 							addr.resolve("127.0.0.1");
 							addr.port(g_Port);
 				net.m_Cfg.m_vNodes.resize(4, addr); // create several connections, let the compete
+				net.m_Cfg.m_MaxPendingRequests = 2; // spread them
 
 				net.Connect();
 
@@ -2862,6 +3705,14 @@ namespace beam
 				m_bRunning = true;
 				io::Reactor::get_Current().run();
 				KillTimer();
+				// all the requests that were sent are answered (the aborted ones are dropped before sent)
+				uint64_t nAnswered = 0;
+				for (const auto& c : net.m_Connections)
+				{
+					nAnswered += c.m_Stats.m_Requests;
+					verify_test(!c.m_Stats.m_Timeouts);
+				}
+				verify_test(nAnswered >= 20);
 			}
 		};
 
@@ -2913,6 +3764,172 @@ namespace beam
 		verify_test(!fc.m_Hist.m_Map.empty() && fc.m_Hist.m_Map.rbegin()->second.m_Height == hThrd2);
 	}
 
+	void TestFlyClientStalled()
+	{
+		// One of the nodes accepts the requests, but never responds. The requests are retried via the other node after the timeout
+
+		io::Reactor::Ptr pReactor(io::Reactor::create());
+		io::Reactor::Scope scope(*pReactor);
+
+		Node node;
+		node.m_Cfg.m_sPathLocal = g_sz;
+		node.m_Cfg.m_Listen.port(g_Port);
+		node.m_Cfg.m_Listen.ip(INADDR_ANY);
+		node.m_Cfg.m_MiningThreads = 0;
+		node.m_Cfg.m_Treasury = g_Treasury;
+
+		ECC::SetRandom(node);
+
+		node.Initialize();
+		RaiseHeightTo(node, 20);
+
+		struct StalledPeer
+			:public proto::NodeConnection
+		{
+			NodeProcessor* m_pSrc = nullptr;
+			uint32_t m_Requests = 0;
+
+			virtual void OnConnectedSecure() override
+			{
+				ECC::Scalar::Native sk;
+				ECC::SetRandom(sk);
+				ProveID(sk, proto::IDType::Node);
+
+				SendLogin();
+
+				proto::NewTip msg;
+				msg.m_Description = m_pSrc->m_Cursor.m_Full;
+				Send(msg);
+			}
+
+			virtual void OnDisconnect(const DisconnectReason&) override {}
+
+			virtual void OnMsg(proto::GetProofKernel&&) override
+			{
+				m_Requests++; // no response
+			}
+		};
+
+		struct StalledServer
+			:public proto::NodeConnection::Server
+		{
+			NodeProcessor* m_pSrc = nullptr;
+			std::list<StalledPeer> m_lstPeers;
+
+			virtual void OnAccepted(io::TcpStream::Ptr&& newStream, int errorCode) override
+			{
+				if (!newStream)
+					return;
+
+				m_lstPeers.emplace_back();
+				StalledPeer& p = m_lstPeers.back();
+				p.m_pSrc = m_pSrc;
+				p.Accept(std::move(newStream));
+				p.SecureConnect();
+			}
+		} srv;
+
+		srv.m_pSrc = &node.get_Processor();
+		srv.Listen(io::Address(INADDR_ANY, g_Port + 1));
+
+		struct MyFlyClient
+			:public proto::FlyClient
+			,public proto::FlyClient::Request::IHandler
+		{
+			Block::SystemState::HistoryMap m_Hist;
+			io::Timer::Ptr m_pTimer;
+			NetworkStd* m_pNet = nullptr;
+			bool m_bPosted = false;
+			uint32_t m_nPending = 0;
+			uint32_t m_Cycles = 0;
+
+			virtual Block::SystemState::IHistory& get_History() override
+			{
+				return m_Hist;
+			}
+
+			virtual void OnComplete(Request& r) override
+			{
+				verify_test(this == r.m_pTrg);
+				verify_test(m_nPending);
+				if (!--m_nPending)
+					io::Reactor::get_Current().stop();
+			}
+
+			void OnTimer()
+			{
+				if (!m_bPosted)
+				{
+					// post the requests once both nodes are at tip, so that they're spread between them
+					uint32_t nAtTip = 0;
+					for (const auto& c : m_pNet->m_Connections)
+						if (c.IsAtTip())
+							nAtTip++;
+
+					if (nAtTip == m_pNet->m_Connections.size())
+					{
+						for (uint32_t i = 0; i < 6; i++)
+						{
+							RequestKernel::Ptr pKrnl(new RequestKernel);
+							ECC::SetRandom(pKrnl->m_Msg.m_ID);
+							m_pNet->PostRequest(*pKrnl, *this);
+							m_nPending++;
+						}
+
+						m_bPosted = true;
+					}
+				}
+
+				if (++m_Cycles > 300)
+				{
+					fail_test("FlyClient requests not completed");
+					io::Reactor::get_Current().stop();
+				}
+			}
+		} fc;
+
+		proto::FlyClient::NetworkStd net(fc);
+
+		io::Address addr;
+		addr.resolve("127.0.0.1");
+		addr.port(g_Port + 1);
+		net.m_Cfg.m_vNodes.push_back(addr); // stalled
+		addr.port(g_Port);
+		net.m_Cfg.m_vNodes.push_back(addr);
+
+		net.m_Cfg.m_RequestTimeout_ms = 1000;
+		net.m_Cfg.m_ReconnectTimeout_ms = 1000 * 60; // don't return to the stalled node during the test
+
+		net.Connect();
+
+		fc.m_pNet = &net;
+		fc.m_pTimer = io::Timer::create(*pReactor);
+		fc.m_pTimer->start(100, true, [&fc]() { fc.OnTimer(); });
+
+		pReactor->run();
+
+		verify_test(fc.m_bPosted && !fc.m_nPending);
+
+		uint32_t nStalled = 0;
+		for (const auto& p : srv.m_lstPeers)
+			nStalled += p.m_Requests;
+		verify_test(nStalled); // the stalled node got some of the requests
+
+		for (const auto& c : net.m_Connections)
+		{
+			if (c.m_Addr.port() == g_Port)
+			{
+				verify_test(!c.m_Stats.m_Timeouts);
+				verify_test(c.m_Stats.m_Requests == 6); // including those retried
+			}
+			else
+			{
+				verify_test(c.m_Stats.m_Timeouts == 1);
+				verify_test(!c.m_Stats.m_Requests);
+			}
+		}
+	}
+
 	void TestHalving()
 	{
 		HeightRange hr;
@@ -2989,6 +4006,16 @@ void TestAll()
 		beam::TestNodeDB();
 		beam::DeleteFile(beam::g_sz);
 
+		printf("BbsStore test...\n");
+		fflush(stdout);
+
+		beam::TestBbsStore();
+
+		printf("Download stats test...\n");
+		fflush(stdout);
+
+		beam::TestDownloadStats();
+
 		{
 			printf("NodeProcessor test1...\n");
 			fflush(stdout);
@@ -3019,6 +4046,27 @@ void TestAll()
 		beam::TestNodeConversation();
 		beam::DeleteFile(beam::g_sz);
 		beam::DeleteFile(beam::g_sz2);
+
+		printf("NodeX2 hdr packs sync test...\n");
+		fflush(stdout);
+
+		beam::TestNodeSyncHdrs();
+		beam::DeleteFile(beam::g_sz);
+		beam::DeleteFile(beam::g_sz2);
+
+		printf("NodeX2 hdr packs verification test...\n");
+		fflush(stdout);
+
+		beam::TestNodeHdrPacks();
+		beam::DeleteFile(beam::g_sz);
+		beam::DeleteFile(beam::g_sz2);
+
+		printf("NodeX2 end-game test...\n");
+		fflush(stdout);
+
+		beam::TestNodeStraggler();
+		beam::DeleteFile(beam::g_sz);
+		beam::DeleteFile(beam::g_sz2);
 	}
 
 	beam::Rules::get().pForks[2].m_Height = 17;
@@ -3055,6 +4103,12 @@ void TestAll()
 
 	beam::TestFlyClient();
 	beam::DeleteFile(beam::g_sz);
+
+	printf("Node <---> FlyClient stalled node test...\n");
+	fflush(stdout);
+
+	beam::TestFlyClientStalled();
+	beam::DeleteFile(beam::g_sz);
 }
 
 int main()
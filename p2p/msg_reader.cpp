@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "msg_reader.h"
+#include "utility/io/bufferpool.h"
 #include <assert.h>
 #include <algorithm>
 
@@ -29,8 +30,9 @@ MsgReader::MsgReader(ProtocolBase& protocol, uint64_t streamId, size_t defaultSi
 	*_pAlive = true;
 
     assert(_defaultSize >= MsgHeader::SIZE);
-    _msgBuffer.resize(_defaultSize);
-    _cursor = _msgBuffer.data();
+    _msgBuffer = (uint8_t*)io::BufferPool::alloc(_defaultSize, _msgBufferCapacity);
+    _msgSize = MsgHeader::SIZE;
+    _cursor = _msgBuffer;
 
     // by default, all message types are allowed
     enable_all_msg_types();
@@ -40,12 +42,32 @@ MsgReader::~MsgReader()
 {
 	if (_pAlive)
 		*_pAlive = false;
+
+    io::BufferPool::release(_msgBuffer, _msgBufferCapacity);
+}
+
+void MsgReader::reserve(size_t size) {
+    if (size <= _msgBufferCapacity) return;
+
+    size_t capacity = 0;
+    uint8_t* buf = (uint8_t*)io::BufferPool::alloc(size, capacity);
+    memcpy(buf, _msgBuffer, MsgHeader::SIZE);
+    io::BufferPool::release(_msgBuffer, _msgBufferCapacity);
+    _msgBuffer = buf;
+    _msgBufferCapacity = capacity;
+}
+
+void MsgReader::realloc(size_t size) {
+    io::BufferPool::release(_msgBuffer, _msgBufferCapacity);
+    _msgBuffer = nullptr;
+    _msgBuffer = (uint8_t*)io::BufferPool::alloc(size, _msgBufferCapacity);
 }
 
 void MsgReader::reset() {
     _bytesLeft = MsgHeader::SIZE;
     _state = reading_header;
-    _cursor = _msgBuffer.data();
+    _msgSize = MsgHeader::SIZE;
+    _cursor = _msgBuffer;
 }
 
 void MsgReader::change_id(uint64_t newStreamId) {
@@ -92,7 +114,7 @@ bool MsgReader::new_data_from_stream(io::ErrorCode connectionStatus, const void*
 		sz -= _bytesLeft;
 		p += _bytesLeft;
 
-		MsgHeader header(_msgBuffer.data());
+		MsgHeader header(_msgBuffer);
 
 		if (_state == reading_header)
 		{
@@ -115,8 +137,9 @@ bool MsgReader::new_data_from_stream(io::ErrorCode connectionStatus, const void*
 
 			// header deserialized successfully
 			_bytesLeft = header.size;
-			_msgBuffer.resize(MsgHeader::SIZE + _bytesLeft);
-			_cursor = _msgBuffer.data() + MsgHeader::SIZE;
+			_msgSize = MsgHeader::SIZE + _bytesLeft;
+			reserve(_msgSize);
+			_cursor = _msgBuffer + MsgHeader::SIZE;
 
 			_state = reading_message;
 
@@ -124,13 +147,13 @@ bool MsgReader::new_data_from_stream(io::ErrorCode connectionStatus, const void*
 		else
 		{
 			// whole message has been read
-			if (!_protocol.VerifyMsg(_msgBuffer.data(), static_cast<uint32_t>(_msgBuffer.size())))
+			if (!_protocol.VerifyMsg(_msgBuffer, static_cast<uint32_t>(_msgSize)))
 			{
 				_protocol.on_corrupt_msg(_streamId);
 				return false;
 			}
 
-            if (!_protocol.on_new_message(_streamId, header.type, _msgBuffer.data() + MsgHeader::SIZE, header.size - _protocol.get_MacSize())) {
+            if (!_protocol.on_new_message(_streamId, header.type, _msgBuffer + MsgHeader::SIZE, header.size - _protocol.get_MacSize())) {
                 // at this moment, the *this* may be deleted
                 if (bAlive) {
                     reset();
@@ -141,18 +164,16 @@ bool MsgReader::new_data_from_stream(io::ErrorCode connectionStatus, const void*
 			if (!bAlive)
 				return false;
 
-			if (_msgBuffer.size() > 2 * _defaultSize) {
-				{
-					std::vector<uint8_t> newBuffer;
-					_msgBuffer.swap(newBuffer);
-				}
-				// preventing from excessive memory consumption per individual stream
-				_msgBuffer.resize(_defaultSize);
+			if (_msgBufferCapacity > 2 * _defaultSize) {
+				// preventing from excessive memory consumption per individual stream,
+				// large buffer goes back to the pool and is reused by other streams
+				realloc(_defaultSize);
 			}
 			_bytesLeft = MsgHeader::SIZE;
+			_msgSize = MsgHeader::SIZE;
 			_state = reading_header;
 
-			_cursor = _msgBuffer.data();
+			_cursor = _msgBuffer;
 		}
 	}
 
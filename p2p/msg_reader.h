@@ -26,6 +26,9 @@ public:
     MsgReader(ProtocolBase& protocol, uint64_t streamId, size_t defaultSize);
 	~MsgReader();
 
+    MsgReader(const MsgReader&) = delete;
+    MsgReader& operator=(const MsgReader&) = delete;
+
     uint64_t id() const { return _streamId; }
     void change_id(uint64_t newStreamId);
 
@@ -49,6 +52,12 @@ public:
     void reset();
 
 private:
+    /// Grows the buffer if needed, keeps the header
+    void reserve(size_t size);
+
+    /// Returns the buffer to the pool and takes a new one
+    void realloc(size_t size);
+
     /// 2 states of the reader
     enum State { reading_header, reading_message };
 
@@ -67,8 +76,14 @@ private:
     /// Current state
     State _state;
 
-    /// Message buffer, grows if needed
-    std::vector<uint8_t> _msgBuffer;
+    /// Message buffer from the buffer pool, grows if needed
+    uint8_t* _msgBuffer;
+
+    /// Actual size of the message buffer
+    size_t _msgBufferCapacity;
+
+    /// Size of the current message incl. header
+    size_t _msgSize;
 
     /// Cursor inside the buffer
     uint8_t* _cursor;
@@ -65,6 +65,9 @@ public:
 
     virtual void get_last_found_block(std::string& jobID, Height& jobHeight, Block::PoW& pow) = 0;
 
+    // true if the solution is verified before BlockFound is called, so that the caller doesn't need to verify it again
+    virtual bool verifies_solutions() const { return false; }
+
     virtual void stop_current() = 0;
 
     virtual void stop() = 0;
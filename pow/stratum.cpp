@@ -126,6 +126,7 @@ template<> void parse(const json& o, Result& m) {
     m.code = o[l_code];
     m.description = o[l_description].get<std::string>();
     m.nonceprefix = o.value(l_nonceprefix, std::string());
+    m.blockhash = o.value(l_blockhash, std::string());
 }
 
 } //namespace
@@ -36,8 +36,11 @@ namespace stratum {
 
 static const uint64_t SERVER_RESTART_TIMER = 1;
 static const uint64_t ACL_REFRESH_TIMER = 2;
+static const uint64_t SHARE_STATS_TIMER = 3;
 static const unsigned SERVER_RESTART_INTERVAL = 1000;
 static const unsigned ACL_REFRESH_INTERVAL = 5000;
+static const unsigned SHARE_STATS_INTERVAL = 60000;
+static const size_t MAX_RECENT_JOBS = 64; // the same as the node keeps
 
 static const char STS[] = "stratum server ";
 
@@ -59,8 +62,60 @@ Server::Server(const IExternalPOW::Options& o, io::Reactor& reactor, io::Address
     if (_prefixDigits > 0) {
         ECC::GenRandom(&_prefixSeed, 8);
     }
+    _timers.set_timer(SHARE_STATS_TIMER, SHARE_STATS_INTERVAL, BIND_THIS_MEMFN(log_share_stats));
+
+    _verifiedEvent = io::AsyncEvent::create(reactor, BIND_THIS_MEMFN(on_solutions_verified));
+
+    _executor = Executor::s_pInstance;
+    if (!_executor) {
+        _ownExecutor = std::make_unique<ExecutorMT>();
+        _executor = _ownExecutor.get();
+    }
+}
+
+Server::~Server() {
+    // pending verifications would finish (or be dropped if the executor is stopped) soon
+    std::unique_lock<std::mutex> lock(_verifyMutex);
+    while (_verifyTasks) {
+        _verifyDone.wait(lock);
+    }
+    lock.unlock();
+
+    _ownExecutor.reset();
 }
 
+struct Server::Verification : public Executor::TaskAsync {
+    Server& _server;
+    VerifiedSolution _solution;
+    Merkle::Hash _input;
+
+    Verification(Server& server, VerifiedSolution&& solution, const Merkle::Hash& input) :
+        _server(server),
+        _solution(std::move(solution)),
+        _input(input)
+    {}
+
+    ~Verification() {
+        std::unique_lock<std::mutex> lock(_server._verifyMutex);
+        assert(_server._verifyTasks);
+        if (!--_server._verifyTasks) {
+            _server._verifyDone.notify_all();
+        }
+    }
+
+    void Exec(Executor::Context&) override {
+        uint32_t t0 = GetTime_ms();
+        _solution.valid = Rules::get().FakePoW || _solution.pow.IsValid(_input.m_pData, _input.nBytes, _solution.height);
+        _solution.time_ms = GetTime_ms() - t0;
+
+        {
+            std::unique_lock<std::mutex> lock(_server._verifyMutex);
+            _server._verified.push_back(std::move(_solution));
+        }
+        _server._verifiedEvent->post();
+    }
+};
+
 void Server::start_server() {
     try {
         if (_options.privKeyFile.empty() || _options.certFile.empty()) {
@@ -120,6 +175,21 @@ std::string Server::gen_nonceprefix(uint64_t connId) {
     return x;
 }
 
+io::SharedBuffer Server::take_current_msg() {
+    io::SharedBuffer msg = io::normalize(_currentMsg);
+    _currentMsg.clear();
+    return msg;
+}
+
+bool Server::send_result(uint64_t from, const std::string& id, ResultCode code, bool shutdown) {
+    auto it = _connections.find(from);
+    if (it == _connections.end()) return false;
+
+    Result res(id, code);
+    append_json_msg(_fw, res);
+    return it->second->send_msg(take_current_msg(), true, shutdown);
+}
+
 bool Server::on_login(uint64_t from, const Login& login) {
     assert(_connections.count(from) > 0);
 
@@ -138,8 +208,7 @@ bool Server::on_login(uint64_t from, const Login& login) {
     res.forkheight2 = Rules::get().pForks[2].m_Height;
     std::cout << "Fork Heights: " << Rules::get().pForks[1].m_Height << " " <<  Rules::get().pForks[2].m_Height << std::endl;
     append_json_msg(_fw, res);
-    bool sent = conn->send_msg(_currentMsg, false, !loginSuccess);
-    _currentMsg.clear();
+    bool sent = conn->send_msg(take_current_msg(), false, !loginSuccess);
 
     if (!sent || !loginSuccess)
         return false;
@@ -150,40 +219,114 @@ bool Server::on_login(uint64_t from, const Login& login) {
 bool Server::on_solution(uint64_t from, const Solution& sol) {
 	LOG_DEBUG() << TRACE(sol.nonce) << TRACE(sol.output);
 
+    _shareStats.submitted++;
+
 	if (_prefixDigits > 0) {
 	    const std::string& nonceprefix = _connections[from]->get_nonceprefix();
 	    if (
 	        sol.nonce.size() < _prefixDigits ||
 	        memcmp(sol.nonce.c_str(), nonceprefix.c_str(), _prefixDigits) != 0
 	    ) {
-            Result res(sol.id, stratum::solution_rejected);
-            //res.nonceprefix = nonceprefix;
-            append_json_msg(_fw, res);
-            _connections[from]->send_msg(_currentMsg, true, true);
-            _currentMsg.clear();
+            _shareStats.rejected++;
+            send_result(from, sol.id, stratum::solution_rejected, true);
             return false;
 	    }
 	}
 
-	_recentResult.id = sol.id;
-    sol.fill_pow(_recentResult.pow);
+    auto it = std::find_if(_jobs.begin(), _jobs.end(), [&sol](const JobData& job) { return job.id == sol.id; });
+    if (it == _jobs.end()) {
+        LOG_INFO() << STS << "solution to unknown job " << sol.id << " from " << io::Address::from_u64(from);
+        _shareStats.expired++;
+        return send_result(from, sol.id, stratum::solution_expired);
+    }
+
+    VerifiedSolution x;
+    x.from = from;
+    x.id = sol.id;
+    x.pow = it->pow;
+    x.height = it->height;
+    x.valid = false;
+    x.time_ms = 0;
+
+    if (!sol.fill_pow(x.pow)) {
+        _shareStats.rejected++;
+        return send_result(from, sol.id, stratum::solution_rejected);
+    }
 
     LOG_INFO() << STS << "solution to " << sol.id << " from " << io::Address::from_u64(from);
-	IExternalPOW::BlockFoundResult result = _recentResult.onBlockFound();
-    stratum::ResultCode stratumCode = stratum::solution_rejected;
-    if (result == IExternalPOW::solution_accepted) {
-        stratumCode = stratum::solution_accepted;
-    } else if (result == IExternalPOW::solution_expired) {
-        stratumCode = stratum::solution_expired;
+
+    {
+        std::unique_lock<std::mutex> lock(_verifyMutex);
+        _verifyTasks++;
     }
-    Result res(sol.id, stratumCode);
-    if (result == IExternalPOW::solution_accepted) {
-        res.blockhash = result._blockhash;
+    _executor->Push(std::make_unique<Verification>(*this, std::move(x), it->input));
+    return true;
+}
+
+void Server::on_solutions_verified() {
+    std::deque<VerifiedSolution> verified;
+    {
+        std::unique_lock<std::mutex> lock(_verifyMutex);
+        verified.swap(_verified);
     }
-    append_json_msg(_fw, res);
-    bool sent = _connections[from]->send_msg(_currentMsg, true);
-    _currentMsg.clear();
-    return sent;
+
+    for (const auto& x : verified) {
+        _shareStats.verified++;
+        _shareStats.verifyTime_ms += x.time_ms;
+
+        stratum::ResultCode stratumCode = stratum::solution_rejected;
+        std::string blockhash;
+
+        if (x.valid) {
+            _recentResult.id = x.id;
+            _recentResult.height = x.height;
+            _recentResult.pow = x.pow;
+
+            IExternalPOW::BlockFoundResult result = _recentResult.onBlockFound();
+            if (result == IExternalPOW::solution_accepted) {
+                stratumCode = stratum::solution_accepted;
+                blockhash = result._blockhash;
+            } else if (result == IExternalPOW::solution_expired) {
+                stratumCode = stratum::solution_expired;
+            }
+        } else {
+            LOG_INFO() << STS << "invalid solution to " << x.id << " from " << io::Address::from_u64(x.from);
+        }
+
+        switch (stratumCode) {
+        case stratum::solution_accepted: _shareStats.accepted++; break;
+        case stratum::solution_expired: _shareStats.expired++; break;
+        default: _shareStats.rejected++;
+        }
+
+        auto it = _connections.find(x.from);
+        if (it == _connections.end()) continue; // disconnected meanwhile
+
+        Result res(x.id, stratumCode);
+        res.blockhash = blockhash;
+        append_json_msg(_fw, res);
+        if (!it->second->send_msg(take_current_msg(), true)) {
+            on_bad_peer(x.from);
+        }
+    }
+}
+
+void Server::log_share_stats() {
+    const ShareStats& s0 = _shareStatsLogged;
+    const ShareStats& s1 = _shareStats;
+
+    uint64_t submitted = s1.submitted - s0.submitted;
+    if (submitted) {
+        uint64_t verified = s1.verified - s0.verified;
+        LOG_INFO() << STS << "shares in " << SHARE_STATS_INTERVAL / 1000 << " sec: submitted=" << submitted
+            << " accepted=" << (s1.accepted - s0.accepted)
+            << " rejected=" << (s1.rejected - s0.rejected)
+            << " expired=" << (s1.expired - s0.expired)
+            << " verify_avg=" << (verified ? (s1.verifyTime_ms - s0.verifyTime_ms) / verified : 0) << " msec";
+    }
+
+    _shareStatsLogged = _shareStats;
+    _timers.set_timer(SHARE_STATS_TIMER, SHARE_STATS_INTERVAL, BIND_THIS_MEMFN(log_share_stats));
 }
 
 void Server::on_bad_peer(uint64_t from) {
@@ -205,10 +348,14 @@ void Server::new_job(
 
     LOG_INFO() << STS << "new job " << id << " will be sent to " << _connections.size() << " connected peers";
 
+    _jobs.push_back(JobData{ id, input, pow, height });
+    if (_jobs.size() > MAX_RECENT_JOBS) {
+        _jobs.pop_front();
+    }
+
     Job jobMsg(id, input, pow, height);
     append_json_msg(_fw, jobMsg);
-	_recentJob.msg.swap(_currentMsg);
-    _currentMsg.clear();
+	_recentJob.msg = take_current_msg();
 
     for (auto& p : _connections) {
         if (!p.second->send_msg(_recentJob.msg, true)) {
@@ -308,7 +455,7 @@ bool Server::Connection::on_stream_data(io::ErrorCode errorCode, void* data, siz
     return true;
 }
 
-bool Server::Connection::send_msg(const io::SerializedMsg& msg, bool onlyIfLoggedIn, bool shutdown) {
+bool Server::Connection::send_msg(const io::SharedBuffer& msg, bool onlyIfLoggedIn, bool shutdown) {
     if (onlyIfLoggedIn && !_loggedIn) return true;
     bool sent = _stream && _stream->write(msg);
     if (sent && shutdown) {
@@ -18,8 +18,13 @@
 #include "p2p/line_protocol.h"
 #include "utility/io/tcpserver.h"
 #include "utility/io/coarsetimer.h"
+#include "utility/io/asyncevent.h"
+#include "utility/executor.h"
 #include <set>
 #include <map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 
 namespace beam { namespace stratum {
 
@@ -34,6 +39,19 @@ struct ConnectionToServer {
 class Server : public IExternalPOW, public ConnectionToServer {
 public:
     Server(const IExternalPOW::Options& o, io::Reactor& reactor, io::Address listenTo, unsigned noncePrefixDigits);
+    ~Server();
+
+    // solutions received, in total
+    struct ShareStats {
+        uint64_t submitted = 0;
+        uint64_t accepted = 0;
+        uint64_t rejected = 0;
+        uint64_t expired = 0;
+        uint64_t verified = 0;
+        uint64_t verifyTime_ms = 0; // of the verified, total
+    };
+
+    const ShareStats& get_share_stats() const { return _shareStats; }
 
 private:
     class AccessControl {
@@ -58,7 +76,7 @@ private:
 
         const std::string& get_nonceprefix() { return _nonceprefix; }
 
-        bool send_msg(const io::SerializedMsg& msg, bool onlyIfLoggedIn, bool shutdown=false);
+        bool send_msg(const io::SharedBuffer& msg, bool onlyIfLoggedIn, bool shutdown=false);
 
     private:
         bool on_message(const Login& login) override;
@@ -89,6 +107,14 @@ private:
 
     std::string gen_nonceprefix(uint64_t connId);
 
+    io::SharedBuffer take_current_msg();
+
+    bool send_result(uint64_t from, const std::string& id, ResultCode code, bool shutdown=false);
+
+    void on_solutions_verified();
+
+    void log_share_stats();
+
     bool on_login(uint64_t from, const Login& login) override;
     bool on_solution(uint64_t from, const Solution& solution) override;
     void on_bad_peer(uint64_t from) override;
@@ -102,6 +128,7 @@ private:
     ) override;
 
     void get_last_found_block(std::string& jobID, Height& jobHeight, Block::PoW& pow) override;
+    bool verifies_solutions() const override { return true; }
     void stop_current() override;
     void stop() override;
 
@@ -115,10 +142,43 @@ private:
     AccessControl _acl;
 
 	struct RecentJob {
-		io::SerializedMsg msg;
+		io::SharedBuffer msg; // serialized once, sent to all the logged in connections
 		std::string id;
 	} _recentJob;
 
+    // the solutions are verified against the job they refer to
+    struct JobData {
+        std::string id;
+        Merkle::Hash input;
+        Block::PoW pow;
+        Height height;
+    };
+
+    std::deque<JobData> _jobs; // recent, the newest is the last
+
+    // solution verification, on the executor threads. The results are handled on the reactor
+    struct Verification;
+
+    struct VerifiedSolution {
+        uint64_t from;
+        std::string id;
+        Block::PoW pow;
+        Height height;
+        bool valid;
+        uint32_t time_ms;
+    };
+
+    std::mutex _verifyMutex;
+    std::condition_variable _verifyDone;
+    uint32_t _verifyTasks = 0; // pushed to the executor, and not destroyed yet
+    std::deque<VerifiedSolution> _verified;
+    io::AsyncEvent::Ptr _verifiedEvent;
+    Executor* _executor = nullptr;
+    std::unique_ptr<ExecutorMT> _ownExecutor;
+
+    ShareStats _shareStats;
+    ShareStats _shareStatsLogged; // at the last log
+
 	struct RecentResult {
 		std::string id;
 		Height height;
@@ -89,9 +89,155 @@ void TestArrayExpanding()
     TestArrayExpanding(96, 5);
 }
 
+// BeamHash III (Fork2) known answer
+namespace BeamHashIII
+{
+    // PoW input (hash of the header) and nonce
+    const uint8_t g_pInput[] = {
+        0x5a, 0x7f, 0x10, 0x35, 0xce, 0xe3, 0x84, 0x59,
+        0x72, 0x17, 0x28, 0xcd, 0xe6, 0xbb, 0x5c, 0x71,
+        0x0a, 0x2f, 0xc0, 0xe5, 0xbe, 0x53, 0x74, 0x09,
+        0x22, 0xc7, 0x98, 0xbd, 0x56, 0x6b, 0x0c, 0x21,
+    };
+
+    const uint8_t g_pNonce[] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef };
+
+    // 32 indices, 25 bits each, followed by the 4-byte extra nonce
+    const uint8_t g_pSolution[] = {
+        0x86, 0xc6, 0x07, 0x88, 0x6d, 0x8b, 0x3b, 0x40,
+        0x97, 0x08, 0xd4, 0x5d, 0xe7, 0xfe, 0x46, 0xcb,
+        0xd3, 0xce, 0x1f, 0x46, 0xb8, 0x2e, 0xa7, 0xa0,
+        0xd3, 0xb2, 0xb8, 0x19, 0x44, 0x4e, 0x93, 0x6e,
+        0x47, 0xa7, 0x73, 0xbc, 0xf5, 0xe7, 0x02, 0x31,
+        0xc4, 0x04, 0x9a, 0xcd, 0xfd, 0x18, 0x19, 0x45,
+        0x69, 0xd6, 0xf5, 0xb9, 0x87, 0xb6, 0x77, 0xfb,
+        0x02, 0xbd, 0x3d, 0x6c, 0x4e, 0xd3, 0xae, 0x1b,
+        0xf1, 0xeb, 0xef, 0xa2, 0x2d, 0x8f, 0x78, 0x50,
+        0x60, 0x96, 0xac, 0xcb, 0xfb, 0x8b, 0xf2, 0x7f,
+        0x92, 0xf2, 0x89, 0x05, 0xb5, 0xa2, 0x6f, 0x7b,
+        0xe0, 0x40, 0x8d, 0xb8, 0x30, 0x5d, 0x90, 0x5d,
+        0xe0, 0x0a, 0x79, 0xfd, 0x00, 0x00, 0x00, 0x00,
+    };
+
+    const uint32_t nIndices = 32;
+    const uint32_t nIndexBits = 25;
+
+    void GetIndices(const beam::Block::PoW& pow, uint32_t* pIdx)
+    {
+        for (uint32_t i = 0; i < nIndices; i++)
+        {
+            pIdx[i] = 0;
+            for (uint32_t j = 0; j < nIndexBits; j++)
+            {
+                uint32_t nBit = i * nIndexBits + j;
+                if (1 & (pow.m_Indices[nBit >> 3] >> (nBit & 7)))
+                    pIdx[i] |= 1U << j;
+            }
+        }
+    }
+
+    void SetIndices(beam::Block::PoW& pow, const uint32_t* pIdx)
+    {
+        for (uint32_t i = 0; i < nIndices; i++)
+        {
+            for (uint32_t j = 0; j < nIndexBits; j++)
+            {
+                uint32_t nBit = i * nIndexBits + j;
+                uint8_t nMsk = uint8_t(1 << (nBit & 7));
+                if (1 & (pIdx[i] >> j))
+                    pow.m_Indices[nBit >> 3] |= nMsk;
+                else
+                    pow.m_Indices[nBit >> 3] &= ~nMsk;
+            }
+        }
+    }
+}
+
+void TestBeamHashIII()
+{
+    cout << "Test BeamHash III known answer...\n";
+
+    beam::Rules::get().pForks[1].m_Height = 321321;
+    beam::Rules::get().pForks[2].m_Height = 777777;
+    const beam::Height h = beam::Rules::get().pForks[2].m_Height + 1000;
+
+    const uint8_t* pInput = BeamHashIII::g_pInput;
+    const uint32_t nInput = sizeof(BeamHashIII::g_pInput);
+
+    beam::Block::PoW pow;
+    pow.m_Difficulty.m_Packed = 0;
+    static_assert(sizeof(BeamHashIII::g_pNonce) == sizeof(pow.m_Nonce.m_pData), "");
+    memcpy(pow.m_Nonce.m_pData, BeamHashIII::g_pNonce, sizeof(BeamHashIII::g_pNonce));
+    static_assert(sizeof(BeamHashIII::g_pSolution) == sizeof(pow.m_Indices), "");
+    memcpy(&pow.m_Indices.front(), BeamHashIII::g_pSolution, sizeof(BeamHashIII::g_pSolution));
+
+    WALLET_CHECK(pow.IsValid(pInput, nInput, h));
+
+    // prior to Fork2 another scheme is used
+    WALLET_CHECK(!pow.IsValid(pInput, nInput, beam::Rules::get().pForks[2].m_Height - 1));
+
+    {
+        // different input
+        uint8_t pInput2[sizeof(BeamHashIII::g_pInput)];
+        memcpy(pInput2, pInput, nInput);
+        pInput2[7] ^= 1;
+        WALLET_CHECK(!pow.IsValid(pInput2, nInput, h));
+
+        beam::Block::PoW pow2 = pow;
+        pow2.m_Nonce.Inc();
+        WALLET_CHECK(!pow2.IsValid(pInput, nInput, h));
+    }
+
+    uint32_t pIdx[BeamHashIII::nIndices];
+    BeamHashIII::GetIndices(pow, pIdx);
+
+    {
+        // the packing is restored exactly
+        beam::Block::PoW pow2 = pow;
+        BeamHashIII::SetIndices(pow2, pIdx);
+        WALLET_CHECK(pow2.m_Indices == pow.m_Indices);
+    }
+
+    {
+        // swapped pair, the order is wrong
+        uint32_t pIdx2[BeamHashIII::nIndices];
+        memcpy(pIdx2, pIdx, sizeof(pIdx));
+        std::swap(pIdx2[0], pIdx2[1]);
+
+        beam::Block::PoW pow2 = pow;
+        BeamHashIII::SetIndices(pow2, pIdx2);
+        WALLET_CHECK(!pow2.IsValid(pInput, nInput, h));
+    }
+
+    {
+        // duplicated index. The order of the subtrees is still valid (the 1st index of each is less than the 1st of its sibling)
+        uint32_t pIdx2[BeamHashIII::nIndices];
+        memcpy(pIdx2, pIdx, sizeof(pIdx));
+        WALLET_CHECK(pIdx2[0] < pIdx2[2]);
+        pIdx2[1] = pIdx2[2];
+
+        beam::Block::PoW pow2 = pow;
+        BeamHashIII::SetIndices(pow2, pIdx2);
+        WALLET_CHECK(!pow2.IsValid(pInput, nInput, h));
+    }
+
+    {
+        // flipped bit of an index, its hash doesn't collide
+        beam::Block::PoW pow2 = pow;
+        pow2.m_Indices[50] ^= 0x10;
+        WALLET_CHECK(!pow2.IsValid(pInput, nInput, h));
+
+        // flipped bit of the extra nonce
+        pow2 = pow;
+        pow2.m_Indices.back() ^= 1;
+        WALLET_CHECK(!pow2.IsValid(pInput, nInput, h));
+    }
+}
+
 int main()
 {
     TestArrayExpanding();
+    TestBeamHashIII();
     
     // commented since it doesn't complete in 10 minutes and failes auto tests
 /*
@@ -0,0 +1,183 @@
+// Copyright 2020 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// BeamHash III: header verification (as for each element of HdrPack), the step element pipeline, and the CPU solver
+// Usage: pow_bench [verifications] [solutions]
+// The solver needs several GB of memory, hence it's not run by default
+
+#include "core/block_crypt.h"
+#include "3rdparty/crypto/beamHashIII.h"
+#include "utility/test_helpers.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+using namespace beam;
+
+namespace {
+
+void print(const char* name, uint32_t count, const char* unit, const helpers::StopWatch& sw) {
+    double seconds = sw.seconds() > 0 ? sw.seconds() : 1e-6;
+    cout << name << ": count=" << count
+         << " time=" << sw.milliseconds() << "ms"
+         << " rate=" << uint64_t(count / seconds) << " " << unit << "/s" << endl;
+}
+
+Height get_height() {
+    return Rules::get().pForks[2].m_Height;
+}
+
+// random solution with distinct ordered indices, so that it isn't rejected before the hashing
+void generate_solution(Block::PoW& pow) {
+    ECC::GenRandom(pow.m_Indices.data(), static_cast<uint32_t>(pow.m_Indices.size()));
+
+    uint32_t pIdx[32];
+    for (uint32_t i = 0; i < 32; i++) {
+        pIdx[i] = (i << 20) | (pow.m_Indices[i] << 8) | pow.m_Indices[i + 32];
+    }
+
+    std::fill_n(pow.m_Indices.begin(), 100, 0);
+    for (uint32_t i = 0; i < 32; i++) {
+        uint32_t pos = i * 25;
+        uint64_t val = uint64_t(pIdx[i]) << (pos & 7);
+        for (uint32_t j = pos >> 3; val; j++, val >>= 8) {
+            pow.m_Indices[j] |= uint8_t(val);
+        }
+    }
+}
+
+bool run_verify(uint32_t count) {
+    ECC::Hash::Value hvInput;
+    ECC::GenRandom(hvInput);
+
+    std::vector<Block::PoW> vPow(count);
+    for (Block::PoW& pow : vPow) {
+        pow.m_Difficulty = Difficulty(0);
+        ECC::GenRandom(pow.m_Nonce);
+        generate_solution(pow);
+    }
+
+    uint32_t valid = 0;
+    Height h = get_height();
+
+    helpers::StopWatch sw;
+    sw.start();
+
+    for (const Block::PoW& pow : vPow) {
+        if (pow.IsValid(hvInput.m_pData, hvInput.nBytes, h)) {
+            valid++;
+        }
+    }
+
+    sw.stop();
+    print("verify", count, "verifications", sw);
+
+    // random solutions are never valid
+    return !valid;
+}
+
+// the complete work of a valid solution verification: 32 elements, all the mixes and merges
+bool run_rounds(uint32_t count) {
+    uint64_t prePow[4];
+    ECC::GenRandom(prePow, sizeof(prePow));
+
+    uint32_t zeros = 0;
+
+    helpers::StopWatch sw;
+    sw.start();
+
+    for (uint32_t n = 0; n < count; n++) {
+        std::vector<stepElem> X;
+        X.reserve(32);
+        for (uint32_t i = 0; i < 32; i++) {
+            X.emplace_back(prePow, (n << 5) | i);
+        }
+
+        for (uint32_t round = 1; X.size() > 1; round++) {
+            uint32_t remLen = workBitSize - (round - 1) * collisionBitSize;
+            if (round == 5) remLen -= 64;
+
+            uint32_t remLenOut = workBitSize - round * collisionBitSize;
+            if (round == 4) remLenOut -= 64;
+            if (round == 5) remLenOut = collisionBitSize;
+
+            std::vector<stepElem> Xtmp;
+            for (size_t i = 0; i < X.size(); i += 2) {
+                X[i].applyMix(remLen);
+                X[i + 1].applyMix(remLen);
+                Xtmp.emplace_back(X[i], X[i + 1], remLenOut);
+            }
+            X.swap(Xtmp);
+        }
+
+        if (X[0].isZero()) {
+            zeros++;
+        }
+    }
+
+    sw.stop();
+    print("step elements, all rounds", count, "solution trees", sw);
+
+    return !zeros;
+}
+
+bool run_solve(uint32_t count) {
+    ECC::Hash::Value hvInput;
+    ECC::GenRandom(hvInput);
+
+    Block::PoW pow;
+    pow.m_Difficulty = Difficulty(0);
+    ECC::GenRandom(pow.m_Nonce);
+
+    bool ok = true;
+    Height h = get_height();
+
+    helpers::StopWatch sw;
+    sw.start();
+
+    for (uint32_t i = 0; i < count; i++) {
+        ok &= pow.Solve(hvInput.m_pData, hvInput.nBytes, h);
+        ok &= pow.IsValid(hvInput.m_pData, hvInput.nBytes, h);
+        pow.m_Nonce.Inc();
+    }
+
+    sw.stop();
+    print("solve", count, "solutions", sw);
+
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint32_t verifications = 20000;
+    uint32_t solutions = 0;
+    if (argc > 1) {
+        verifications = static_cast<uint32_t>(strtoul(argv[1], nullptr, 10));
+    }
+    if (argc > 2) {
+        solutions = static_cast<uint32_t>(strtoul(argv[2], nullptr, 10));
+    }
+
+    bool ok = true;
+
+    ok &= run_verify(verifications);
+    ok &= run_rounds(verifications / 10);
+
+    if (solutions) {
+        ok &= run_solve(solutions);
+    }
+
+    return ok ? 0 : 1;
+}
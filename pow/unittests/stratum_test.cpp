@@ -13,11 +13,14 @@
 // limitations under the License.
 
 #include "pow/stratum.h"
+#include "pow/external_pow.h"
 #include "core/ecc.h"
 #include "utility/io/json_serializer.h"
 #include "p2p/line_protocol.h"
 #include "utility/helpers.h"
 #include "utility/logger.h"
+#include "utility/io/timer.h"
+#include "utility/io/tcpstream.h"
 
 using namespace beam;
 
@@ -106,6 +109,143 @@ void gen_examples() {
     reader.new_data_from_stream((void*)buf.data, buf.size);
 }
 
+// a pool proxy: logs in and submits solutions to the job, which the server verifies off the reactor
+struct TestProxy : stratum::ParserCallback {
+    io::Reactor& reactor;
+    io::TcpStream::Ptr stream;
+    LineReader lineReader;
+    std::vector<stratum::Result> results;
+    std::function<void()> onResult;
+    bool jobReceived = false;
+
+    explicit TestProxy(io::Reactor& r) :
+        reactor(r),
+        lineReader([this](void* data, size_t size) { return stratum::parse_json_msg(data, size, *this); })
+    {}
+
+    template <typename M> void send(const M& m) {
+        io::SerializedMsg msg;
+        LineProtocol packer(
+            [](void*, size_t) -> bool { return false; },
+            [&msg](io::SharedBuffer&& fragment) { msg.push_back(fragment); }
+        );
+        append_json_msg(packer, m);
+        stream->write(msg);
+    }
+
+    bool on_message(const stratum::Job&) override {
+        jobReceived = true;
+        return true;
+    }
+
+    bool on_message(const stratum::Result& r) override {
+        if (r.id != "login") {
+            results.push_back(r);
+            onResult();
+        }
+        return true;
+    }
+};
+
+int solution_verification_test() {
+    using namespace beam::stratum;
+
+    int nErrors = 0;
+
+    io::Reactor::Ptr reactor = io::Reactor::create();
+    io::Reactor::Scope scope(*reactor);
+
+    io::Address address = io::Address::localhost().port(20302);
+    IExternalPOW::Options options; // no TLS, no ACL
+    auto server = IExternalPOW::create(options, *reactor, address, 0);
+
+    if (!server->verifies_solutions()) {
+        LOG_ERROR() << "stratum server should verify solutions";
+        ++nErrors;
+    }
+
+    Block::PoW pow;
+    ZeroObject(pow);
+    Merkle::Hash input;
+    ECC::GenRandom(input.m_pData, input.nBytes);
+
+    unsigned blocksFound = 0;
+    server->new_job("1", input, pow, 500,
+        [&]() {
+            ++blocksFound;
+            IExternalPOW::BlockFoundResult res(IExternalPOW::solution_accepted);
+            res._blockhash = "0123";
+            return res;
+        },
+        []() { return false; }
+    );
+
+    bool fakePoW = Rules::get().FakePoW;
+    Rules::get().FakePoW = false;
+
+    ECC::GenRandom(pow.m_Nonce.m_pData, Block::PoW::NonceType::nBytes);
+    ECC::GenRandom(pow.m_Indices.data(), Block::PoW::nSolutionBytes);
+
+    TestProxy proxy(*reactor);
+    proxy.onResult = [&]() {
+        if (proxy.results.size() == 2) {
+            // now let any solution pass the verification
+            Rules::get().FakePoW = true;
+            proxy.send(Solution("1", pow));
+        } else if (proxy.results.size() == 3) {
+            reactor->stop();
+        }
+    };
+
+    io::Timer::Ptr timer = io::Timer::create(*reactor);
+    timer->start(100, false, [&]() {
+        reactor->tcp_connect(address, 1, [&](uint64_t, io::TcpStream::Ptr&& newStream, io::ErrorCode status) {
+            if (!newStream) {
+                LOG_ERROR() << "cannot connect to stratum server: " << io::error_str(status);
+                reactor->stop();
+                return;
+            }
+
+            proxy.stream = std::move(newStream);
+            proxy.stream->enable_read([&](io::ErrorCode errorCode, void* data, size_t size) {
+                return !errorCode && proxy.lineReader.new_data_from_stream(data, size);
+            });
+
+            proxy.send(Login("key"));
+            proxy.send(Solution("1", pow)); // invalid, verified on the executor
+            proxy.send(Solution("2", pow)); // unknown job
+        });
+
+        // stop anyway
+        timer->start(10000, false, [&]() { reactor->stop(); });
+    });
+
+    reactor->run();
+    Rules::get().FakePoW = fakePoW;
+
+    if (!proxy.jobReceived) {
+        LOG_ERROR() << "job not received";
+        ++nErrors;
+    }
+
+    auto count = [&proxy](ResultCode code) {
+        return std::count_if(proxy.results.begin(), proxy.results.end(), [code](const Result& r) { return r.code == code; });
+    };
+
+    if (proxy.results.size() != 3 ||
+        count(solution_rejected) != 1 ||
+        count(solution_expired) != 1 ||
+        proxy.results.back().code != solution_accepted ||
+        proxy.results.back().blockhash != "0123" ||
+        blocksFound != 1
+    ) {
+        LOG_ERROR() << "unexpected solution results";
+        ++nErrors;
+    }
+
+    return nErrors;
+}
+
 } //namespace
 
 int main() {
@@ -116,6 +256,7 @@ int main() {
     auto logger = Logger::create(logLevel, logLevel);
     auto res = json_creation_test();
     gen_examples();
+    res += solution_verification_test();
     return res;
 }
 
@@ -183,6 +183,8 @@ namespace beam
         const char* KEY_MINE = "key_mine"; // deprecated
         const char* MINER_KEY = "miner_key";
         const char* BBS_ENABLE = "bbs_enable";
+        const char* BBS_JOURNAL = "bbs_journal";
+        const char* BBS_TAG_RECIPIENT = "bbs_tag_recipient";
         const char* NEW_ADDRESS = "new_addr";
         const char* GET_ADDRESS = "get_address";
         const char* SET_CONFIRMATIONS_COUNT = "set_confirmations_count";
@@ -212,6 +214,7 @@ namespace beam
         const char* LOG_VERBOSE = "verbose";
         const char* LOG_CLEANUP_DAYS = "log_cleanup_days";
         const char* LOG_UTXOS = "log_utxos";
+        const char* LOG_ASYNC = "log_async";
         const char* VERSION = "version";
         const char* VERSION_FULL = "version,v";
         const char* GIT_COMMIT_HASH = "git_commit_hash";
@@ -276,6 +279,7 @@ namespace beam
         const char* API_TLS_REJECT_UNAUTHORIZED = "tls_reject_unauthorized";
         const char* API_USE_ACL= "use_acl";
         const char* API_ACL_PATH = "acl_path";
+        const char* API_THREADS = "api_threads";
 
         // treasury
         const char* TR_OPCODE = "tr_op";
@@ -381,6 +385,7 @@ namespace beam
             (cli::CHECKDB, po::value<bool>()->default_value(false), "DB integrity check")
             (cli::VACUUM, po::value<bool>()->default_value(false), "DB vacuum (compact)")
             (cli::BBS_ENABLE, po::value<bool>()->default_value(true), "Enable SBBS messaging")
+            (cli::BBS_JOURNAL, po::value<string>()->default_value("node_bbs.dat"), "SBBS messages journal path, to keep them across restarts. Set empty to disable")
             (cli::CRASH, po::value<int>()->default_value(0), "Induce crash (test proper handling)")
             (cli::OWNER_KEY, po::value<string>(), "Owner viewer key")
             (cli::KEY_OWNER, po::value<string>(), "Owner viewer key (deprecated)")
@@ -388,6 +393,7 @@ namespace beam
             (cli::KEY_MINE, po::value<string>(), "Standalone miner key (deprecated)")
             (cli::PASS, po::value<string>(), "password for keys")
             (cli::LOG_UTXOS, po::value<bool>()->default_value(false), "Log recovered UTXOs (make sure the log file is not exposed)")
+            (cli::LOG_ASYNC, po::value<bool>()->default_value(false), "Write log from a background thread, messages are dropped (and counted) if it falls behind")
             (cli::FAST_SYNC, po::value<bool>(), "Fast sync on/off (override horizons)")
             (cli::GENERATE_RECOVERY_PATH, po::value<string>(), "Recovery file to generate immediately after start")
             (cli::RECOVERY_AUTO_PATH, po::value<string>(), "path and file prefix for recovery auto-generation")
@@ -427,7 +433,8 @@ namespace beam
             (cli::MAX_PRIVACY, po::bool_switch()->default_value(false), "send max privacy transaction")
             (cli::MAX_PRIVACY_ONLINE, po::bool_switch()->default_value(false), "generate online max privacy transaction")
             (cli::MAX_PRIVACY_OFFLINE, po::value<Positive<uint32_t>>(), "generate offline max privacy transaction address with given number of payments")
-            (cli::PUBLIC_OFFLINE, po::bool_switch()->default_value(false), "generate an offline public address for donates (less secure, but more convenient)");
+            (cli::PUBLIC_OFFLINE, po::bool_switch()->default_value(false), "generate an offline public address for donates (less secure, but more convenient)")
+            (cli::BBS_TAG_RECIPIENT, po::value<bool>()->default_value(false), "tag outgoing SBBS messages, so that the recipient finds its address without trial decryption (the recipient's wallet must support it)");
 
         po::options_description wallet_treasury_options("Wallet treasury options");
         wallet_treasury_options.add_options()
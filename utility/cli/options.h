@@ -83,6 +83,8 @@ namespace beam
         extern const char* KEY_MINE;  // deprecated
         extern const char* MINER_KEY;
         extern const char* BBS_ENABLE;
+        extern const char* BBS_JOURNAL;
+        extern const char* BBS_TAG_RECIPIENT;
         extern const char* NEW_ADDRESS;
         extern const char* GET_ADDRESS;
         extern const char* SET_CONFIRMATIONS_COUNT;
@@ -112,6 +114,7 @@ namespace beam
         extern const char* LOG_VERBOSE;
         extern const char* LOG_CLEANUP_DAYS;
         extern const char* LOG_UTXOS;
+        extern const char* LOG_ASYNC;
         extern const char* VERSION;
         extern const char* VERSION_FULL;
         extern const char* GIT_COMMIT_HASH;
@@ -177,6 +180,7 @@ namespace beam
         extern const char* API_TLS_REJECT_UNAUTHORIZED;
         extern const char* API_USE_ACL;
         extern const char* API_ACL_PATH;
+        extern const char* API_THREADS;
 
         // treasury
         extern const char* TR_OPCODE;
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "buffer.h"
+#include "bufferpool.h"
 #include <string>
 #include <stdexcept>
 
@@ -36,21 +37,17 @@ struct AllocatedMemory {
 
 struct HeapAllocatedMemory : AllocatedMemory {
     explicit HeapAllocatedMemory(size_t s) {
-        size = s;
-        if (size) {
-            data = malloc(size);
-            if (!data) throw std::runtime_error("HeapAllocatedMemory: out of memory");
-        } else {
-            data = 0;
+        if (s) {
+            data = BufferPool::alloc(s, capacity);
         }
     }
 
     ~HeapAllocatedMemory() {
-        if (data) free(data);
+        BufferPool::release(data, capacity);
     }
 
-    size_t size;
-    void* data;
+    size_t capacity=0;
+    void* data=0;
 };
 
 #ifdef WIN32
@@ -138,9 +135,10 @@ struct ReadOnlyMappedFile : AllocatedMemory {
 
 std::pair<uint8_t*, SharedMem> alloc_heap(size_t size) {
     std::pair<uint8_t*, SharedMem> p;
-    HeapAllocatedMemory* mem = new HeapAllocatedMemory(size);
+    // object and control block in one allocation, data block comes from the thread's pool
+    auto mem = std::make_shared<HeapAllocatedMemory>(size);
     p.first = (uint8_t*)mem->data;
-    p.second.reset(mem);
+    p.second = std::move(mem);
     return p;
 }
 
@@ -83,7 +83,7 @@ struct IOVec {
 /// Allows for sharing const memory regions
 using SharedMem = std::shared_ptr<struct AllocatedMemory>;
 
-/// Allocs shared memory from heap, throws on error
+/// Allocs shared memory from the thread's buffer pool (see bufferpool.h), throws on error
 std::pair<uint8_t*, SharedMem> alloc_heap(size_t size);
 
 struct SharedBuffer : IOVec {
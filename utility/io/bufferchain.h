@@ -15,6 +15,7 @@
 #pragma once
 #include "buffer.h"
 #include <vector>
+#include <utility>
 
 namespace beam { namespace io {
 
@@ -53,8 +54,16 @@ public:
 
     void advance(size_t nBytes);
 
+    /// Keeps the capacity of internal vectors
     void clear();
 
+    void swap(BufferChain& bc) {
+        _iovecs.swap(bc._iovecs);
+        _guards.swap(bc._guards);
+        std::swap(_totalSize, bc._totalSize);
+        std::swap(_index, bc._index);
+    }
+
     bool empty() const {
         return _totalSize == 0;
     }
@@ -0,0 +1,149 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bufferpool.h"
+#include <stdexcept>
+#include <stdlib.h>
+#include <assert.h>
+
+namespace beam { namespace io {
+
+namespace {
+
+// stays valid after the pool is destroyed at thread exit, buffers may be released later by other thread-locals
+thread_local bool t_poolDestroyed = false;
+
+struct ThreadPool {
+    BufferPool pool;
+
+    ~ThreadPool() {
+        t_poolDestroyed = true;
+    }
+};
+
+thread_local ThreadPool t_pool;
+
+/// Returns class index and size, 4 classes per power of 2
+unsigned size_class(size_t size, size_t& classSize) {
+    if (size <= BufferPool::MIN_BLOCK_SIZE) {
+        classSize = BufferPool::MIN_BLOCK_SIZE;
+        return 0;
+    }
+
+    size_t v = size - 1;
+    unsigned e = 6; // log2(MIN_BLOCK_SIZE)
+    while (v >> (e + 1)) ++e;
+
+    unsigned sub = unsigned(v >> (e - 2)) & 3;
+    classSize = size_t(4 + sub + 1) << (e - 2);
+    return 1 + (e - 6) * 4 + sub;
+}
+
+void* heap_alloc(size_t size) {
+    void* ptr = malloc(size);
+    if (!ptr) throw std::runtime_error("BufferPool: out of memory");
+    return ptr;
+}
+
+} //namespace
+
+BufferPool* BufferPool::get_current() {
+    return t_poolDestroyed ? nullptr : &t_pool.pool;
+}
+
+void* BufferPool::alloc(size_t size, size_t& capacity) {
+    BufferPool* pool = get_current();
+    if (!pool) {
+        capacity = size;
+        return heap_alloc(size);
+    }
+    return pool->take(size, capacity);
+}
+
+void BufferPool::release(void* ptr, size_t capacity) {
+    if (!ptr) return;
+    BufferPool* pool = get_current();
+    if (!pool) {
+        free(ptr);
+        return;
+    }
+    pool->give(ptr, capacity);
+}
+
+void* BufferPool::take(size_t size, size_t& capacity) {
+    if (size > MAX_POOLED_SIZE) {
+        ++_stats.oversized;
+        capacity = size;
+        return heap_alloc(size);
+    }
+
+    unsigned idx = size_class(size, capacity);
+    assert(idx < NUM_CLASSES);
+
+    auto& blocks = _free[idx];
+    if (!blocks.empty()) {
+        void* ptr = blocks.back();
+        blocks.pop_back();
+        ++_stats.hits;
+        _stats.residentBytes -= capacity;
+        return ptr;
+    }
+
+    ++_stats.misses;
+    return heap_alloc(capacity);
+}
+
+void BufferPool::give(void* ptr, size_t capacity) {
+    size_t classSize = 0;
+    if (capacity > MAX_POOLED_SIZE) {
+        free(ptr);
+        return;
+    }
+
+    unsigned idx = size_class(capacity, classSize);
+    if (classSize != capacity || _stats.residentBytes + capacity > _maxResidentSize) {
+        // not ours (allocated while the pool was unavailable) or the cache is full
+        ++_stats.dropped;
+        free(ptr);
+        return;
+    }
+
+    _free[idx].push_back(ptr);
+    ++_stats.released;
+    _stats.residentBytes += capacity;
+}
+
+void BufferPool::set_max_resident_size(size_t maxSize) {
+    _maxResidentSize = maxSize;
+    if (_stats.residentBytes > _maxResidentSize) {
+        shrink();
+    }
+}
+
+void BufferPool::shrink() {
+    for (auto& blocks : _free) {
+        for (void* ptr : blocks) {
+            free(ptr);
+        }
+        blocks.clear();
+        blocks.shrink_to_fit();
+    }
+    _stats.residentBytes = 0;
+}
+
+BufferPool::~BufferPool() {
+    shrink();
+}
+
+}} //namespaces
@@ -0,0 +1,87 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace beam { namespace io {
+
+/// Size-classed cache of raw memory blocks for message buffers and fragments.
+/// There's one pool per thread (i.e. per reactor), blocks released from any thread go to the pool of that thread.
+/// Size classes are 4 per power of 2 (waste < 25%) from 64 bytes up to MAX_POOLED_SIZE,
+/// larger blocks go directly to/from heap
+class BufferPool {
+public:
+    static constexpr size_t MIN_BLOCK_SIZE = 64;
+    static constexpr size_t MAX_POOLED_SIZE = size_t(4) << 20;
+    static constexpr size_t DEF_MAX_RESIDENT_SIZE = size_t(32) << 20;
+
+    struct Stats {
+        /// Allocations served from cached blocks
+        uint64_t hits = 0;
+
+        /// Allocations that went to heap
+        uint64_t misses = 0;
+
+        /// Allocations larger than MAX_POOLED_SIZE
+        uint64_t oversized = 0;
+
+        /// Blocks returned to the cache
+        uint64_t released = 0;
+
+        /// Blocks freed because the cache was full
+        uint64_t dropped = 0;
+
+        /// Bytes held by cached (free) blocks
+        size_t residentBytes = 0;
+    };
+
+    /// Allocates block of at least size bytes from the calling thread's pool,
+    /// capacity receives the actual block size. Throws on out of memory
+    static void* alloc(size_t size, size_t& capacity);
+
+    /// Returns block to the calling thread's pool or frees it
+    static void release(void* ptr, size_t capacity);
+
+    /// Pool of the calling thread, nullptr if the thread is exiting
+    static BufferPool* get_current();
+
+    const Stats& stats() const { return _stats; }
+
+    /// Limits bytes held by cached blocks
+    void set_max_resident_size(size_t maxSize);
+
+    /// Frees all cached blocks
+    void shrink();
+
+    BufferPool() = default;
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    ~BufferPool();
+
+private:
+    static constexpr unsigned NUM_CLASSES = 65;
+
+    void* take(size_t size, size_t& capacity);
+    void give(void* ptr, size_t capacity);
+
+    std::vector<void*> _free[NUM_CLASSES];
+    size_t _maxResidentSize = DEF_MAX_RESIDENT_SIZE;
+    Stats _stats;
+};
+
+}} //namespaces
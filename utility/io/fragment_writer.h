@@ -20,7 +20,8 @@ namespace beam { namespace io {
 
 /// For long messages, it collects raw bytes of unknown size (typically from serializer)
 /// and arranges them into fixed-length shared fragments to be forwarded to network.
-/// For small messages, it reuses shared regions and minimizes allocation calls
+/// For small messages, it reuses shared regions and minimizes allocation calls.
+/// Fragments come from the thread's BufferPool and return there once all the messages sharing them are sent
 class FragmentWriter {
 public:
     /// Called when either current fragment is filled or current message is finalized
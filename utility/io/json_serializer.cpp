@@ -15,6 +15,7 @@
 #include "json_serializer.h"
 #include "nlohmann/json.hpp"
 #include "utility/logger.h"
+#include <assert.h>
 
 namespace beam {
 
@@ -38,6 +39,14 @@ namespace {
 
 } //namespace
 
+struct JsonStreamWriter::Impl {
+    explicit Impl(io::FragmentWriter& fw) :
+        serializer(std::make_shared<JsonOutputAdapter>(fw), ' ')
+    {}
+
+    nlohmann::detail::serializer<json> serializer;
+};
+
 bool serialize_json_msg(io::FragmentWriter& packer, const nlohmann::json& o) {
     bool result = true;
     try {
@@ -55,6 +64,65 @@ bool serialize_json_msg(io::FragmentWriter& packer, const nlohmann::json& o) {
     return result;
 }
 
-} //namespace
+JsonStreamWriter::JsonStreamWriter(io::FragmentWriter& packer) :
+    _packer(packer),
+    _impl(std::make_unique<Impl>(packer))
+{}
+
+JsonStreamWriter::~JsonStreamWriter() = default;
+
+void JsonStreamWriter::write_separator(const char* key) {
+    if (!_hasItems.empty()) {
+        if (_hasItems.back()) _packer.write(",", 1);
+        _hasItems.back() = true;
+    }
+    if (key) {
+        dump(json(key));
+        _packer.write(":", 1);
+    }
+}
+
+void JsonStreamWriter::dump(const json& value) {
+    try {
+        _impl->serializer.dump(value, false, false, 0);
+    } catch (const std::exception& e) {
+        LOG_ERROR() << "dump json: " << e.what();
+        _ok = false;
+    }
+}
+
+void JsonStreamWriter::begin_object(const char* key) {
+    write_separator(key);
+    _packer.write("{", 1);
+    _hasItems.push_back(false);
+}
 
+void JsonStreamWriter::end_object() {
+    assert(!_hasItems.empty());
+    _hasItems.pop_back();
+    _packer.write("}", 1);
+}
 
+void JsonStreamWriter::begin_array(const char* key) {
+    write_separator(key);
+    _packer.write("[", 1);
+    _hasItems.push_back(false);
+}
+
+void JsonStreamWriter::end_array() {
+    assert(!_hasItems.empty());
+    _hasItems.pop_back();
+    _packer.write("]", 1);
+}
+
+void JsonStreamWriter::write(const char* key, const json& value) {
+    write_separator(key);
+    dump(value);
+}
+
+bool JsonStreamWriter::finalize() {
+    _packer.finalize();
+    return _ok;
+}
+
+} //namespace
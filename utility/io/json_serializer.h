@@ -15,11 +15,46 @@
 #pragma once
 #include "utility/io/fragment_writer.h"
 #include "nlohmann/json_fwd.hpp"
+#include <memory>
+#include <vector>
 
 namespace beam {
 
 // appends json msg to out by fragment writer
 bool serialize_json_msg(io::FragmentWriter& packer, const nlohmann::json& o);
 
+// writes json msg to fragment writer part by part, so long arrays are not built as json tree in memory
+class JsonStreamWriter {
+public:
+    explicit JsonStreamWriter(io::FragmentWriter& packer);
+    ~JsonStreamWriter();
+
+    // key is null for array items and for the root
+    void begin_object(const char* key=nullptr);
+    void end_object();
+    void begin_array(const char* key=nullptr);
+    void end_array();
+    void write(const char* key, const nlohmann::json& value);
+
+    void write(const nlohmann::json& value) {
+        write(nullptr, value);
+    }
+
+    // finalizes the writer, returns false if something failed. Unlike serialize_json_msg doesn't append eol,
+    // so the messages can be framed by the caller
+    bool finalize();
+
+private:
+    struct Impl;
+
+    void write_separator(const char* key);
+    void dump(const nlohmann::json& value);
+
+    io::FragmentWriter& _packer;
+    std::unique_ptr<Impl> _impl;
+    std::vector<bool> _hasItems; // per nesting level
+    bool _ok = true;
+};
+
 } //namespace
 
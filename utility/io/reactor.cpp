@@ -283,7 +283,16 @@ public:
         uv_write_t* req = _writeRequestsPool.alloc();
 
         size_t nBytes = unsent.size();
-        auto p = _data.insert({ req, Ctx{ this, std::move(unsent), cb, nBytes } });
+
+        // the caller gets back an empty chain with already grown vectors, so appending to it won't reallocate
+        BufferChain chain;
+        if (!_spareChains.empty()) {
+            chain.swap(_spareChains.back());
+            _spareChains.pop_back();
+        }
+        chain.swap(unsent);
+
+        auto p = _data.insert({ req, Ctx{ this, std::move(chain), cb, nBytes } });
 
         assert (p.second);
         Ctx* ctx = &p.first->second;
@@ -328,7 +337,15 @@ private:
     };
 
     void release_request(uv_write_t* req) {
-        _data.erase(req);
+        auto it = _data.find(req);
+        if (it != _data.end()) {
+            BufferChain& chain = it->second.unsent;
+            chain.clear();
+            if (_spareChains.size() < MAX_SPARE_CHAINS) {
+                _spareChains.push_back(std::move(chain));
+            }
+            _data.erase(it);
+        }
         _writeRequests.erase(req);
         _writeRequestsPool.release(req);
     }
@@ -337,6 +354,9 @@ private:
     MemPool<uv_write_t, sizeof(uv_write_t)> _writeRequestsPool;
     std::unordered_set<uv_write_t*> _writeRequests;
     std::unordered_map<uv_write_t*, Ctx> _data;
+
+    static const size_t MAX_SPARE_CHAINS = 16;
+    std::vector<BufferChain> _spareChains;
 };
 
 Reactor::Ptr Reactor::create() {
@@ -0,0 +1,214 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "timingwheel.h"
+#include "utility/helpers.h"
+#include <assert.h>
+
+#ifndef LOG_VERBOSE_ENABLED
+    #define LOG_VERBOSE_ENABLED 0
+#endif
+#include "utility/logger.h"
+
+namespace beam { namespace io {
+
+static inline uint64_t mono_clock() {
+    return uv_hrtime() / 1000000; //nsec->msec, monotonic clock
+}
+
+TimingWheel::Ptr TimingWheel::create(Reactor& reactor, unsigned resolutionMsec) {
+    assert(resolutionMsec > 0);
+
+    if (!resolutionMsec) IO_EXCEPTION(EC_EINVAL);
+
+    return TimingWheel::Ptr(new TimingWheel(resolutionMsec, io::Timer::create(reactor)));
+}
+
+TimingWheel::TimingWheel(unsigned resolutionMsec, io::Timer::Ptr&& timer) :
+    _resolution(resolutionMsec),
+    _origin(mono_clock()),
+    _timer(std::move(timer))
+{
+    auto result = _timer->start(unsigned(-1), false, BIND_THIS_MEMFN(on_timer));
+    if (!result) IO_EXCEPTION(result.error());
+}
+
+TimingWheel::~TimingWheel() {
+    assert(!_insideCallback && "attempt to delete timing wheel from inside its callback, unsupported feature");
+    // slots unlink the remaining timers
+}
+
+uint64_t TimingWheel::current_tick() const {
+    return (mono_clock() - _origin) / _resolution;
+}
+
+void TimingWheel::arm(Timer& timer, unsigned intervalMsec, bool isPeriodic, Callback&& callback) {
+    assert(callback);
+    timer._callback = std::move(callback);
+    rearm(timer, intervalMsec, isPeriodic);
+}
+
+void TimingWheel::rearm(Timer& timer, unsigned intervalMsec, bool isPeriodic) {
+    assert(timer._callback);
+    timer.cancel();
+
+    uint64_t now = current_tick();
+    if (_wakeTick == NEVER && !_insideCallback && empty()) {
+        // nothing is pending, skip idle ticks at once
+        _now = now;
+    }
+
+    uint64_t ticks = (uint64_t(intervalMsec) + _resolution - 1) / _resolution;
+    if (!ticks) ticks = 1;
+
+    timer._expires = now + ticks;
+    timer._periodMsec = isPeriodic ? intervalMsec : 0;
+    insert(timer);
+
+    if (!_insideCallback) {
+        uint64_t wake = timer._expires;
+        if (timer._expires - _now >= SLOTS) {
+            // goes to upper level, should be woken up on the next cascade
+            wake = (_now | (SLOTS - 1)) + 1;
+        }
+        if (wake < _wakeTick) schedule(wake);
+    }
+}
+
+void TimingWheel::insert(Timer& timer) {
+    assert(timer._expires > _now);
+    uint64_t delta = timer._expires - _now;
+
+    unsigned level = 0;
+    while ((level + 1 < LEVELS) && (delta >= (uint64_t(1) << (SLOT_BITS * (level + 1))))) {
+        ++level;
+    }
+
+    if (delta >= (uint64_t(1) << (SLOT_BITS * LEVELS))) {
+        // beyond the wheel range, will be re-inserted on cascade
+        timer._expires = _now + (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+    }
+
+    unsigned idx = unsigned(timer._expires >> (SLOT_BITS * level)) & (SLOTS - 1);
+    _slots[level][idx].push_back(timer);
+}
+
+void TimingWheel::cascade(unsigned level) {
+    unsigned idx = unsigned(_now >> (SLOT_BITS * level)) & (SLOTS - 1);
+    if (idx == 0 && level + 1 < LEVELS) {
+        cascade(level + 1);
+    }
+
+    Slot pending;
+    pending.swap(_slots[level][idx]);
+    while (!pending.empty()) {
+        Timer& t = pending.front();
+        pending.pop_front();
+        if (t._expires <= _now) {
+            // due right now, goes to the slot processed next
+            _slots[0][_now & (SLOTS - 1)].push_back(t);
+        } else {
+            insert(t);
+        }
+    }
+}
+
+void TimingWheel::advance(uint64_t tick) {
+    while (_now < tick) {
+        ++_now;
+
+        unsigned idx = unsigned(_now) & (SLOTS - 1);
+        if (!idx) cascade(1);
+
+        Slot due;
+        due.swap(_slots[0][idx]);
+        while (!due.empty()) {
+            Timer& t = due.front();
+            due.pop_front();
+
+            // the owner may be deleted or re-arm the timer inside the callback
+            Callback cb = t._callback;
+            if (t._periodMsec) {
+                rearm(t, t._periodMsec, true);
+            }
+            cb();
+        }
+    }
+}
+
+uint64_t TimingWheel::next_wake() const {
+    // level 0 holds timers due within SLOTS ticks, the slot index determines the tick
+    uint64_t tick0 = NEVER;
+    for (unsigned i = 1; i < SLOTS; ++i) {
+        if (!_slots[0][(_now + i) & (SLOTS - 1)].empty()) {
+            tick0 = _now + i;
+            break;
+        }
+    }
+
+    uint64_t nextCascade = (_now | (SLOTS - 1)) + 1;
+    if (tick0 <= nextCascade) return tick0;
+
+    for (unsigned level = 1; level < LEVELS; ++level) {
+        for (const auto& slot : _slots[level]) {
+            if (!slot.empty()) return nextCascade;
+        }
+    }
+
+    return tick0;
+}
+
+bool TimingWheel::empty() const {
+    for (const auto& level : _slots) {
+        for (const auto& slot : level) {
+            if (!slot.empty()) return false;
+        }
+    }
+    return true;
+}
+
+void TimingWheel::schedule(uint64_t tick) {
+    if (tick == NEVER) {
+        if (_wakeTick != NEVER) {
+            _timer->cancel();
+            _timer->start(unsigned(-1), false, BIND_THIS_MEMFN(on_timer));
+            _wakeTick = NEVER;
+        }
+        return;
+    }
+
+    uint64_t wakeMsec = _origin + tick * _resolution;
+    uint64_t now = mono_clock();
+    unsigned intervalMsec = (wakeMsec > now) ? unsigned(wakeMsec - now) : 0;
+
+    LOG_VERBOSE() << TRACE(tick) << TRACE(intervalMsec);
+
+    Result res = _timer->restart(intervalMsec, false);
+    if (!res) {
+        LOG_ERROR() << "cannot restart timer, code=" << res.error();
+        _wakeTick = NEVER;
+    } else {
+        _wakeTick = tick;
+    }
+}
+
+void TimingWheel::on_timer() {
+    _wakeTick = NEVER;
+    _insideCallback = true;
+    advance(current_tick());
+    _insideCallback = false;
+    schedule(next_wake());
+}
+
+}} //namespaces
@@ -0,0 +1,101 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include "timer.h"
+#include <boost/intrusive/list.hpp>
+#include <limits>
+
+namespace beam { namespace io {
+
+/// Hierarchical timing wheel: many coarse one-shot/periodic timers driven by a single libuv timer.
+/// Arm and cancel are O(1), the uv timer is woken only when a slot is due (or a cascade is needed).
+/// Must be used from the reactor's thread only.
+class TimingWheel {
+public:
+    using Ptr = std::unique_ptr<TimingWheel>;
+    using Callback = std::function<void()>;
+
+    /// Intrusive timer entry, embed it into the owner object.
+    /// Unlinks itself on destruction, so the owner may be deleted at any moment (also from inside the callback)
+    class Timer
+        :public boost::intrusive::list_base_hook<boost::intrusive::link_mode<boost::intrusive::auto_unlink> >
+    {
+    public:
+        Timer() = default;
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        bool is_armed() const { return is_linked(); }
+
+        /// O(1), no-op if not armed
+        void cancel() { unlink(); }
+
+    private:
+        friend class TimingWheel;
+
+        Callback _callback;
+        uint64_t _expires = 0; // in ticks
+        unsigned _periodMsec = 0;
+    };
+
+    /// Creates the wheel, throws on errors
+    static Ptr create(Reactor& reactor, unsigned resolutionMsec);
+
+    /// Arms (or re-arms) the timer. Interval is rounded up to the wheel resolution
+    void arm(Timer& timer, unsigned intervalMsec, bool isPeriodic, Callback&& callback);
+
+    /// Re-arms the timer with its current callback
+    void rearm(Timer& timer, unsigned intervalMsec, bool isPeriodic);
+
+    unsigned resolution() const { return _resolution; }
+
+    ~TimingWheel();
+
+private:
+    TimingWheel(unsigned resolutionMsec, io::Timer::Ptr&& timer);
+
+    static constexpr unsigned SLOT_BITS = 8;
+    static constexpr unsigned SLOTS = 1U << SLOT_BITS;
+    static constexpr unsigned LEVELS = 4;
+    static constexpr uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+
+    using Slot = boost::intrusive::list<Timer, boost::intrusive::constant_time_size<false> >;
+
+    uint64_t current_tick() const;
+    void insert(Timer& timer);
+    void advance(uint64_t tick);
+    void cascade(unsigned level);
+    uint64_t next_wake() const;
+    bool empty() const;
+    void schedule(uint64_t tick);
+    void on_timer();
+
+    const unsigned _resolution;
+    const uint64_t _origin; // msec
+
+    Slot _slots[LEVELS][SLOTS];
+
+    /// Last processed tick
+    uint64_t _now = 0;
+
+    /// Tick the uv timer is set to
+    uint64_t _wakeTick = NEVER;
+
+    bool _insideCallback = false;
+
+    io::Timer::Ptr _timer;
+};
+
+}} //namespaces
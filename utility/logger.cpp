@@ -34,6 +34,10 @@
 #include <iostream>
 #include <fstream>
 #include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <vector>
 #include <algorithm>
 
 namespace beam {
@@ -41,6 +45,7 @@ namespace beam {
 using namespace std;
 
 Logger* Logger::g_logger = 0;
+int Logger::g_minLevel = LOG_LEVEL_CRITICAL + 1;
 
 class LoggerImpl : public Logger {
 protected:
@@ -66,12 +71,6 @@ protected:
         if (minLevel <= 0) throw runtime_error("logger: minimal level out of range");
     }
 
-    virtual ~LoggerImpl() {
-        if (this == g_logger) {
-            g_logger = 0;
-        }
-    }
-
     void set_header_formatter(LogMessageHeaderFormatter formatter) override {
         if (formatter) _headerFormatter = formatter;
     }
@@ -87,15 +86,9 @@ protected:
     }
 
     void write_message(const LogMessageHeader& header, const char* buf, size_t size) override {
-        char timestampFormatted[MAX_TIMESTAMP_SIZE];
         char headerFormatted[MAX_HEADER_SIZE];
-        if (!_timeFormat.empty()) {
-            format_timestamp(timestampFormatted, MAX_TIMESTAMP_SIZE, _timeFormat.c_str(), header.timestamp, _printMilliseconds);
-        } else {
-            timestampFormatted[0] = 0;
-        }
-        size_t headerSize = _headerFormatter(headerFormatted, MAX_HEADER_SIZE, timestampFormatted, header);
-        write_impl(header.level, headerFormatted, headerSize, buf, size);
+        size_t headerSize = format_header(headerFormatted, header);
+        write_formatted(header.level, headerFormatted, headerSize, buf, size, true);
     }
 
     const FileNameType& get_current_file_name() override {
@@ -104,17 +97,56 @@ protected:
     }
 
 public:
+    static const size_t MAX_FORMATTED_HEADER_SIZE = MAX_HEADER_SIZE;
+
+    virtual ~LoggerImpl() {
+        if (this == g_logger) {
+            g_logger = 0;
+            g_minLevel = LOG_LEVEL_CRITICAL + 1;
+        }
+    }
+
     bool level_accepted(int level) override {
         return level >= _minLevel;
     }
 
-    void write_impl(int level, const char* header, size_t headerSize, const char* msg, size_t size) {
+    int min_level() const {
+        return _minLevel;
+    }
+
+    int flush_level() const {
+        return _flushLevel;
+    }
+
+    /// Formats timestamp and header into buf of MAX_HEADER_SIZE bytes, returns header size
+    size_t format_header(char* buf, const LogMessageHeader& header) {
+        char timestampFormatted[MAX_TIMESTAMP_SIZE];
+        if (!_timeFormat.empty()) {
+            format_timestamp(timestampFormatted, MAX_TIMESTAMP_SIZE, _timeFormat.c_str(), header.timestamp, _printMilliseconds);
+        } else {
+            timestampFormatted[0] = 0;
+        }
+        size_t headerSize = _headerFormatter(buf, MAX_HEADER_SIZE, timestampFormatted, header);
+        return std::min(headerSize, MAX_HEADER_SIZE - 1);
+    }
+
+    /// Writes formatted message to the sink(s) accepting the level. Async writer passes canFlush=false and flushes once per batch
+    virtual void write_formatted(int level, const char* header, size_t headerSize, const char* msg, size_t size, bool canFlush) {
+        write_impl(level, header, headerSize, msg, size, canFlush);
+    }
+
+    virtual void flush() {
+        lock_guard<mutex> lock(_mutex);
+        if (_sink) fflush(_sink);
+    }
+
+    void write_impl(int level, const char* header, size_t headerSize, const char* msg, size_t size, bool canFlush=true) {
         if (!_sink) return; 
         lock_guard<mutex> lock(_mutex);
         if (!_sink) return; // double check
         fwrite(header, 1, headerSize, _sink);
         fwrite(msg, 1, size, _sink);
-        if (level >= _flushLevel) fflush(_sink);
+        if (canFlush && level >= _flushLevel) fflush(_sink);
     }
 };
 
@@ -225,23 +257,20 @@ public:
         _consoleSink(flushLevel, consoleLevel)
     {}
 
-    void write_message(const LogMessageHeader& header, const char* buf, size_t size) override {
-        char timestampFormatted[MAX_TIMESTAMP_SIZE];
-        char headerFormatted[MAX_HEADER_SIZE];
-        if (!_timeFormat.empty()) {
-            format_timestamp(timestampFormatted, MAX_TIMESTAMP_SIZE, _timeFormat.c_str(), header.timestamp, _printMilliseconds);
-        } else {
-            timestampFormatted[0] = 0;
-        }
-        size_t headerSize = _headerFormatter(headerFormatted, MAX_HEADER_SIZE, timestampFormatted, header);
-        if (_consoleSink.level_accepted(header.level)) {
-            _consoleSink.write_impl(header.level, headerFormatted, headerSize, buf, size);
+    void write_formatted(int level, const char* header, size_t headerSize, const char* msg, size_t size, bool canFlush) override {
+        if (_consoleSink.level_accepted(level)) {
+            _consoleSink.write_impl(level, header, headerSize, msg, size, canFlush);
         }
-        if (_fileSink.level_accepted(header.level)) {
-            _fileSink.write_impl(header.level, headerFormatted, headerSize, buf, size);
+        if (_fileSink.level_accepted(level)) {
+            _fileSink.write_impl(level, header, headerSize, msg, size, canFlush);
         }
     }
 
+    void flush() override {
+        _consoleSink.flush();
+        _fileSink.flush();
+    }
+
     const FileNameType& get_current_file_name() override {
         return _fileSink.get_current_file_name();
     }
@@ -251,18 +280,263 @@ public:
     }
 };
 
+/// Single producer byte ring owned by one logging thread, drained by the async writer.
+/// Records are [RecordHeader][header+message bytes] aligned to 8 bytes and never wrap around the buffer end
+class LogRing {
+public:
+    explicit LogRing(size_t size) :
+        _size(round_up_pow2(size)),
+        _buf(new char[_size])
+    {}
+
+    /// Called by the owning thread, returns false if there's no room
+    bool push(int level, const char* header, size_t headerSize, const char* msg, size_t size) {
+        size_t need = aligned(sizeof(RecordHeader) + headerSize + size);
+        if (need > _size / 2) return false;
+
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t head = _head.load(std::memory_order_acquire);
+        size_t offset = tail & (_size - 1);
+        size_t toEnd = _size - offset;
+        size_t total = (toEnd < need) ? toEnd + need : need;
+        if (tail + total - head > _size) return false;
+
+        if (toEnd < need) {
+            // skip the rest of the buffer, the record goes to its beginning
+            reinterpret_cast<RecordHeader*>(_buf.get() + offset)->level = SKIP_LEVEL;
+            tail += toEnd;
+            offset = 0;
+        }
+
+        char* p = _buf.get() + offset;
+        RecordHeader* rh = reinterpret_cast<RecordHeader*>(p);
+        rh->level = level;
+        rh->size = uint32_t(headerSize + size);
+        p += sizeof(RecordHeader);
+        memcpy(p, header, headerSize);
+        memcpy(p + headerSize, msg, size);
+
+        _tail.store(tail + need, std::memory_order_release);
+        return true;
+    }
+
+    /// Called by the writer thread, func(level, data, size) for each published record.
+    /// Returns max level drained or 0 if the ring was empty
+    template <typename Func> int drain(Func&& func) {
+        int maxLevel = 0;
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t tail = _tail.load(std::memory_order_acquire);
+        while (head != tail) {
+            size_t offset = head & (_size - 1);
+            const RecordHeader* rh = reinterpret_cast<const RecordHeader*>(_buf.get() + offset);
+            if (rh->level == SKIP_LEVEL) {
+                head += _size - offset;
+                continue;
+            }
+            func(rh->level, reinterpret_cast<const char*>(rh + 1), size_t(rh->size));
+            maxLevel = std::max(maxLevel, rh->level);
+            head += aligned(sizeof(RecordHeader) + rh->size);
+        }
+        _head.store(head, std::memory_order_release);
+        return maxLevel;
+    }
+
+    bool empty() const {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+    /// Set when the owning thread exits, writer removes the ring once it's drained
+    std::atomic<bool> orphaned { false };
+
+private:
+    struct RecordHeader {
+        int32_t level;
+        uint32_t size;
+    };
+
+    static constexpr int32_t SKIP_LEVEL = -1;
+
+    static size_t aligned(size_t n) {
+        return (n + 7) & ~size_t(7);
+    }
+
+    static size_t round_up_pow2(size_t n) {
+        size_t r = 4096;
+        while (r < n) r <<= 1;
+        return r;
+    }
+
+    const size_t _size;
+    std::unique_ptr<char[]> _buf;
+    std::atomic<size_t> _head { 0 };
+    std::atomic<size_t> _tail { 0 };
+};
+
+/// Logging thread's ring, re-registered if the logger is re-created
+struct ThreadLogRing {
+    std::shared_ptr<LogRing> ring;
+    uint64_t loggerId = 0;
+
+    ~ThreadLogRing() {
+        if (ring) ring->orphaned = true;
+    }
+};
+
+/// Formats messages in calling threads, queues them to per-thread lock-free rings and writes them to sinks
+/// from a background thread in batches. Sinks (and rotation) are the ones of the wrapped logger
+class AsyncLogger : public Logger {
+public:
+    AsyncLogger(std::unique_ptr<LoggerImpl>&& impl, size_t ringSize) :
+        _impl(std::move(impl)),
+        _ringSize(ringSize),
+        _id(++_lastId)
+    {
+        _thread = std::thread(&AsyncLogger::thread_func, this);
+    }
+
+    ~AsyncLogger() {
+        _stop = true;
+        _cv.notify_one();
+        _thread.join();
+        if (this == g_logger) {
+            g_logger = 0;
+            g_minLevel = LOG_LEVEL_CRITICAL + 1;
+        }
+    }
+
+    void set_header_formatter(LogMessageHeaderFormatter formatter) override {
+        static_cast<Logger*>(_impl.get())->set_header_formatter(formatter);
+    }
+
+    void set_time_format(const char* format, bool printMilliseconds) override {
+        static_cast<Logger*>(_impl.get())->set_time_format(format, printMilliseconds);
+    }
+
+    const FileNameType& get_current_file_name() override {
+        return static_cast<Logger*>(_impl.get())->get_current_file_name();
+    }
+
+    void rotate() override {
+        // sinks are switched under their own mutex, the writer thread just continues with the new file
+        _impl->rotate();
+    }
+
+    uint64_t get_dropped_count() const override {
+        return _dropped.load();
+    }
+
+protected:
+    bool level_accepted(int level) override {
+        return _impl->level_accepted(level);
+    }
+
+    void write_message(const LogMessageHeader& header, const char* buf, size_t size) override {
+        char headerFormatted[LoggerImpl::MAX_FORMATTED_HEADER_SIZE];
+        size_t headerSize = _impl->format_header(headerFormatted, header);
+
+        static thread_local ThreadLogRing t;
+        if (t.loggerId != _id) {
+            if (t.ring) t.ring->orphaned = true;
+            t.ring = std::make_shared<LogRing>(_ringSize);
+            t.loggerId = _id;
+            lock_guard<mutex> lock(_ringsMutex);
+            _rings.push_back(t.ring);
+        }
+
+        if (!t.ring->push(header.level, headerFormatted, headerSize, buf, size)) {
+            ++_dropped;
+            return;
+        }
+
+        if (header.level >= _impl->flush_level()) {
+            _cv.notify_one();
+        }
+    }
+
+private:
+    static constexpr unsigned WRITE_PERIOD_MSEC = 50;
+
+    void thread_func() {
+        while (!_stop) {
+            {
+                std::unique_lock<mutex> lock(_cvMutex);
+                _cv.wait_for(lock, std::chrono::milliseconds(WRITE_PERIOD_MSEC));
+            }
+            write_pending();
+        }
+        write_pending();
+    }
+
+    void write_pending() {
+        {
+            lock_guard<mutex> lock(_ringsMutex);
+            _ringsCopy = _rings;
+        }
+
+        int maxLevel = 0;
+        for (const auto& ring : _ringsCopy) {
+            int level = ring->drain([this](int level, const char* data, size_t size) {
+                _impl->write_formatted(level, data, size, "", 0, false);
+            });
+            maxLevel = std::max(maxLevel, level);
+        }
+        _ringsCopy.clear();
+
+        uint64_t dropped = _dropped.load();
+        if (dropped != _droppedReported) {
+            char headerFormatted[LoggerImpl::MAX_FORMATTED_HEADER_SIZE];
+            size_t headerSize = _impl->format_header(headerFormatted, LogMessageHeader(LOG_LEVEL_WARNING, 0, 0, 0));
+            char msg[100];
+            int size = snprintf(msg, sizeof(msg), "logger: %llu messages dropped, log ring is full\n", (unsigned long long)(dropped - _droppedReported));
+            _impl->write_formatted(LOG_LEVEL_WARNING, headerFormatted, headerSize, msg, size_t(size), false);
+            _droppedReported = dropped;
+            maxLevel = std::max(maxLevel, int(LOG_LEVEL_WARNING));
+        }
+
+        if (maxLevel > 0) {
+            _impl->flush();
+        }
+
+        lock_guard<mutex> lock(_ringsMutex);
+        _rings.erase(
+            std::remove_if(_rings.begin(), _rings.end(), [](const std::shared_ptr<LogRing>& r) { return r->orphaned && r->empty(); }),
+            _rings.end()
+        );
+    }
+
+    std::unique_ptr<LoggerImpl> _impl;
+    const size_t _ringSize;
+    const uint64_t _id;
+    static std::atomic<uint64_t> _lastId;
+
+    mutex _ringsMutex;
+    std::vector<std::shared_ptr<LogRing>> _rings;
+    std::vector<std::shared_ptr<LogRing>> _ringsCopy; // writer thread only
+
+    std::atomic<uint64_t> _dropped { 0 };
+    uint64_t _droppedReported = 0;
+
+    std::atomic<bool> _stop { false };
+    mutex _cvMutex;
+    std::condition_variable _cv;
+    std::thread _thread;
+};
+
+std::atomic<uint64_t> AsyncLogger::_lastId { 0 };
+
 std::shared_ptr<Logger> Logger::create(
     int flushLevel,
     int consoleLevel,
     int fileLevel,
     const std::string& fileNamePrefix,
-    const std::string& dstPath
+    const std::string& dstPath,
+    size_t asyncRingSize
 ) {
     if (g_logger) {
         throw runtime_error("logger already initialized");
     }
 
-    std::shared_ptr<Logger> logger;
+    std::unique_ptr<LoggerImpl> impl;
 
     int what = 0;
 
@@ -271,19 +545,29 @@ std::shared_ptr<Logger> Logger::create(
 
     switch (what) {
         case 3:
-            logger.reset(new CombinedLogger(flushLevel, consoleLevel, fileLevel, fileNamePrefix, dstPath));
+            impl.reset(new CombinedLogger(flushLevel, consoleLevel, fileLevel, fileNamePrefix, dstPath));
             break;
         case 2:
-            logger.reset(new FileLogger(flushLevel, fileLevel, fileNamePrefix, dstPath));
+            impl.reset(new FileLogger(flushLevel, fileLevel, fileNamePrefix, dstPath));
             break;
         case 1:
-            logger.reset(new ConsoleLogger(flushLevel, consoleLevel));
+            impl.reset(new ConsoleLogger(flushLevel, consoleLevel));
             break;
         default:
             throw runtime_error("no logger sink configured");
     }
 
+    int minLevel = impl->min_level();
+
+    std::shared_ptr<Logger> logger;
+    if (asyncRingSize) {
+        logger = std::make_shared<AsyncLogger>(std::move(impl), asyncRingSize);
+    } else {
+        logger.reset(impl.release());
+    }
+
     g_logger = logger.get();
+    g_minLevel = minLevel;
     return logger;
 }
 
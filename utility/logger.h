@@ -144,9 +144,16 @@ public:
         const std::string& fileNamePrefix = std::string(),
 
         // path to log file
-        const std::string& dstPath = std::string()
+        const std::string& dstPath = std::string(),
+
+        // size in bytes of per-thread ring buffers for async mode, 0 means synchronous writes.
+        // In async mode messages are formatted by the calling thread and written to sinks by a background thread
+        size_t asyncRingSize = 0
     );
 
+    /// Default ring size for async mode
+    static constexpr size_t DEF_ASYNC_RING_SIZE = 1 << 20;
+
     virtual ~Logger() {}
 
     /// Sets custom msg header formatter, default is def_header_formatter
@@ -167,8 +174,12 @@ public:
     /// Rotates file name, called externally
     virtual void rotate() = 0;
 
+    /// Returns number of messages lost in async mode because the producer's ring was full
+    virtual uint64_t get_dropped_count() const { return 0; }
+
+    /// Cheap check, call before formatting anything expensive
     static bool will_log(int level) {
-        return g_logger && g_logger->level_accepted(level);
+        return level >= g_minLevel && g_logger;
     }
 
     static Logger* get() {
@@ -185,6 +196,9 @@ protected:
     virtual void write_message(const LogMessageHeader& header, const char* buf, size_t size) = 0;
 
     static Logger* g_logger;
+
+    /// Minimal level accepted by g_logger, cached to avoid virtual calls
+    static int g_minLevel;
 };
 
 struct FlushCheckpoint {};
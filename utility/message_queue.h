@@ -16,15 +16,20 @@
 #include "io/asyncevent.h"
 #include <mutex>
 #include <deque>
+#include <atomic>
+#include <memory>
 #include <assert.h>
 
 namespace beam {
 
 /// Inter-thread message queue, backend for RX and TX sides (see below)
-/// Current impl (may be changed if performance bottleneck detected):
+/// Current impl:
 /// 1) unlimited size - should be controlled by channel sides explicitly;
-/// 2) std::deque and std::mutex inside
+/// 2) std::deque and std::mutex inside, receiver takes all pending messages at once
 /// Message type (class T) requirement: default constructible + callable *or* movable (see send() functions)
+///
+/// Every queue type used with RX/TX provides the same interface:
+/// send(), receive(), receive_all(), current_size(), close_rx()
 template <class T> class MessageQueue {
 public:
     /// Called from sender thread via TX object
@@ -58,6 +63,22 @@ public:
         return true;
     }
 
+    /// Called from receiver thread via RX object, takes the lock once per batch
+    /// Returns the number of messages passed to func
+    template <typename Func> size_t receive_all(Func&& func) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_queue.empty()) return 0;
+            _batch.swap(_queue);
+        }
+        size_t n = _batch.size();
+        for (auto& m : _batch) {
+            func(std::move(m));
+        }
+        _batch.clear();
+        return n;
+    }
+
     /// Called by RX to indicate that the channel is being closed
     void close_rx() {
         std::lock_guard<std::mutex> lock(_mutex);
@@ -66,54 +87,263 @@ public:
 
 private:
     std::mutex _mutex;
-    // TODO consider spinlock
-
     std::deque<T> _queue;
 
+    /// Receiver-owned, keeps its capacity between batches
+    std::deque<T> _batch;
+
     bool _rxClosed=false;
-    // TODO consider atomic flag
+};
+
+namespace detail {
+
+static constexpr size_t QUEUE_CACHE_LINE = 64;
+
+inline size_t round_up_pow2(size_t n) {
+    size_t r = 2;
+    while (r < n) r <<= 1;
+    return r;
+}
+
+} //namespace detail
+
+/// Bounded lock-free single producer / single consumer ring buffer
+/// send() fails if the queue is full or RX side is closed, caller decides what to do with the message
+template <class T> class SPSCQueue {
+public:
+    explicit SPSCQueue(size_t capacity) :
+        _mask(detail::round_up_pow2(capacity) - 1),
+        _cells(new T[_mask + 1])
+    {}
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    /// Called from the (only) sender thread via TX object
+    bool send(const T& message) {
+        T m(message);
+        return send(std::move(m));
+    }
+
+    /// Called from the (only) sender thread via TX object
+    bool send(T&& message) {
+        if (_rxClosed.load(std::memory_order_relaxed)) return false;
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _headCached > _mask) {
+            _headCached = _head.load(std::memory_order_acquire);
+            if (tail - _headCached > _mask) return false;
+        }
+        _cells[tail & _mask] = std::move(message);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// May be called by both TX and RX, the value is approximate
+    size_t current_size() {
+        size_t head = _head.load(std::memory_order_acquire);
+        return _tail.load(std::memory_order_acquire) - head;
+    }
+
+    /// Called from receiver thread via RX object
+    bool receive(T& message) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) return false;
+        message = std::move(_cells[head & _mask]);
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Called from receiver thread via RX object, consumes everything published so far
+    template <typename Func> size_t receive_all(Func&& func) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t tail = _tail.load(std::memory_order_acquire);
+        size_t n = tail - head;
+        for (; head != tail; ++head) {
+            T m(std::move(_cells[head & _mask]));
+            // slots are released one by one so that the sender may proceed while callbacks run
+            _head.store(head + 1, std::memory_order_release);
+            func(std::move(m));
+        }
+        return n;
+    }
+
+    /// Called by RX to indicate that the channel is being closed
+    void close_rx() {
+        _rxClosed.store(true, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return _mask + 1; }
+
+private:
+    const size_t _mask;
+    std::unique_ptr<T[]> _cells;
+
+    alignas(detail::QUEUE_CACHE_LINE) std::atomic<size_t> _head { 0 };
+    alignas(detail::QUEUE_CACHE_LINE) std::atomic<size_t> _tail { 0 };
+    /// Sender's copy of _head, refreshed only when the ring looks full
+    size_t _headCached = 0;
+    std::atomic<bool> _rxClosed { false };
+};
+
+/// Bounded lock-free multiple producers / single consumer ring buffer
+/// Each cell carries a sequence number (D.Vyukov's scheme), producers claim cells with CAS on tail
+template <class T> class MPSCQueue {
+public:
+    explicit MPSCQueue(size_t capacity) :
+        _mask(detail::round_up_pow2(capacity) - 1),
+        _cells(new Cell[_mask + 1])
+    {
+        for (size_t i = 0; i <= _mask; ++i) {
+            _cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    /// Called from any sender thread via TX object
+    bool send(const T& message) {
+        T m(message);
+        return send(std::move(m));
+    }
+
+    /// Called from any sender thread via TX object
+    bool send(T&& message) {
+        if (_rxClosed.load(std::memory_order_relaxed)) return false;
+        size_t pos = _tail.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        for (;;) {
+            cell = &_cells[pos & _mask];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = _tail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(message);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// May be called by both TX and RX, the value is approximate
+    size_t current_size() {
+        size_t head = _head.load(std::memory_order_acquire);
+        size_t tail = _tail.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    /// Called from receiver thread via RX object
+    bool receive(T& message) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        Cell& cell = _cells[head & _mask];
+        if (cell.seq.load(std::memory_order_acquire) != head + 1) return false;
+        message = std::move(cell.data);
+        cell.seq.store(head + _mask + 1, std::memory_order_release);
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Called from receiver thread via RX object, stops at the first cell not yet published
+    /// At most capacity() messages are taken per call so that busy senders cannot starve the reactor
+    template <typename Func> size_t receive_all(Func&& func) {
+        size_t n = 0;
+        for (; n <= _mask; ++n) {
+            size_t head = _head.load(std::memory_order_relaxed);
+            Cell& cell = _cells[head & _mask];
+            if (cell.seq.load(std::memory_order_acquire) != head + 1) break;
+            T m(std::move(cell.data));
+            cell.seq.store(head + _mask + 1, std::memory_order_release);
+            _head.store(head + 1, std::memory_order_release);
+            func(std::move(m));
+        }
+        return n;
+    }
+
+    /// Called by RX to indicate that the channel is being closed
+    void close_rx() {
+        _rxClosed.store(true, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return _mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    const size_t _mask;
+    std::unique_ptr<Cell[]> _cells;
+
+    alignas(detail::QUEUE_CACHE_LINE) std::atomic<size_t> _head { 0 };
+    alignas(detail::QUEUE_CACHE_LINE) std::atomic<size_t> _tail { 0 };
+    std::atomic<bool> _rxClosed { false };
+};
+
+/// Queue + wake-up state shared between RX and its TXes
+/// The async event is posted only when the receiver is idle, i.e. on the empty->non-empty transition,
+/// so a burst of messages costs a single uv_async_send
+template <class T, class Queue> struct ChannelState {
+    template <typename... Args> explicit ChannelState(Args&&... args) :
+        queue(std::forward<Args>(args)...)
+    {}
+
+    Queue queue;
+    std::atomic<bool> signalled { false };
 };
 
 /// Transmitter side of inter-thread channel
-template <class T> class TX {
+template <class T, class Queue = MessageQueue<T>> class TX {
 public:
 
     bool send(const T& message) {
-        return _queue->send(message) && _asyncEvent();
+        return _state->queue.send(message) && notify();
     }
 
     bool send(T&& message) {
-        return _queue->send(std::move(message)) && _asyncEvent();
+        return _state->queue.send(std::move(message)) && notify();
     }
 
     size_t queue_size() {
-        return _queue.current_size();
+        return _state->queue.current_size();
     }
 
 private:
-    template <class> friend class RX; // friend because RX creates TX-es
+    template <class, class> friend class RX; // friend because RX creates TX-es
+
+    using State = ChannelState<T, Queue>;
 
     /// Ctor called by RX, see friendship
-    TX(const std::shared_ptr<MessageQueue<T>>& queue, const io::AsyncEvent::Ptr& asyncEvent) :
-        _queue(queue), _asyncEvent(asyncEvent)
+    TX(const std::shared_ptr<State>& state, const io::AsyncEvent::Ptr& asyncEvent) :
+        _state(state), _asyncEvent(asyncEvent)
     {}
 
+    bool notify() {
+        if (_state->signalled.exchange(true)) return true; // receiver is already woken up
+        return bool(_asyncEvent());
+    }
+
     /// Queue
-    std::shared_ptr<MessageQueue<T>> _queue;
+    std::shared_ptr<State> _state;
 
     /// io::Reactor event that can be called from another thread
     io::AsyncEvent::Trigger _asyncEvent;
 };
 
 /// Receiver side of inter=thread channel
-template <class T> class RX {
+template <class T, class Queue = MessageQueue<T>> class RX {
 public:
     /// Message callback, called from reactor thread
     using Callback = std::function<void(T&& message)>;
 
-    /// Ctor called by receiver side
-    explicit RX(io::Reactor& reactor, Callback&& callback) :
-        _queue(std::make_shared<MessageQueue<T>>()),
+    /// Ctor called by receiver side, extra args go to the queue ctor (e.g. capacity for bounded queues)
+    template <typename... QueueArgs>
+    explicit RX(io::Reactor& reactor, Callback&& callback, QueueArgs&&... queueArgs) :
+        _state(std::make_shared<State>(std::forward<QueueArgs>(queueArgs)...)),
         _asyncEvent(io::AsyncEvent::create(reactor, [this]() { on_receive(); } )),
         _callback(std::move(callback))
     {
@@ -127,32 +357,38 @@ public:
     }
 
     /// RX creates TXes
-    TX<T> get_tx() {
-        return TX<T>(_queue, _asyncEvent);
+    TX<T, Queue> get_tx() {
+        return TX<T, Queue>(_state, _asyncEvent);
     }
 
     size_t queue_size() {
-        return _queue.current_size();
+        return _state->queue.current_size();
     }
 
     void close() {
-        _queue->close_rx();
+        _state->queue.close_rx();
     }
 
 private:
+    using State = ChannelState<T, Queue>;
+
     void on_receive() {
-        while (_queue->receive(_msg)) {
-            _callback(std::move(_msg));
-        }
+        // Reset before draining: a sender that comes after this point posts the event again,
+        // the one that came before is drained below
+        _state->signalled.store(false);
+        _state->queue.receive_all([this](T&& msg) { _callback(std::move(msg)); });
     }
 
-    std::shared_ptr<MessageQueue<T>> _queue;
+    std::shared_ptr<State> _state;
     io::AsyncEvent::Ptr _asyncEvent;
     Callback _callback;
-
-    /// Message must be default-constructible
-    T _msg;
 };
 
+/// Bounded lock-free channels, TX::send() returns false when the ring is full
+template <class T> using SPSC_RX = RX<T, SPSCQueue<T>>;
+template <class T> using SPSC_TX = TX<T, SPSCQueue<T>>;
+template <class T> using MPSC_RX = RX<T, MPSCQueue<T>>;
+template <class T> using MPSC_TX = TX<T, MPSCQueue<T>>;
+
 } //namespace
 
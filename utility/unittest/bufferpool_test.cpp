@@ -0,0 +1,167 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "utility/io/bufferpool.h"
+#include "utility/io/fragment_writer.h"
+#include "utility/io/bufferchain.h"
+#include <thread>
+#include <vector>
+#include <iostream>
+
+using namespace beam;
+using namespace beam::io;
+using namespace std;
+
+namespace {
+
+int g_errors = 0;
+
+#define CHECK(x) if (!(x)) { ++g_errors; cout << __LINE__ << ": CHECK failed: " #x << endl; }
+
+void size_classes_test() {
+    BufferPool* pool = BufferPool::get_current();
+    CHECK(pool);
+    pool->shrink();
+
+    struct { size_t size; size_t expected; } cases[] = {
+        { 0, 64 }, { 1, 64 }, { 64, 64 }, { 65, 80 }, { 80, 80 }, { 81, 96 }, { 128, 128 },
+        { 129, 160 }, { 20000, 20480 }, { 65536, 65536 }, { 65537, 81920 },
+        { BufferPool::MAX_POOLED_SIZE, BufferPool::MAX_POOLED_SIZE },
+        { BufferPool::MAX_POOLED_SIZE + 1, BufferPool::MAX_POOLED_SIZE + 1 }
+    };
+
+    for (const auto& c : cases) {
+        size_t capacity = 0;
+        void* p = BufferPool::alloc(c.size, capacity);
+        CHECK(p);
+        CHECK(capacity == c.expected);
+        memset(p, 0xAA, capacity);
+        BufferPool::release(p, capacity);
+    }
+
+    CHECK(pool->stats().oversized == 1);
+}
+
+void reuse_test() {
+    BufferPool* pool = BufferPool::get_current();
+    pool->shrink();
+    BufferPool::Stats s0 = pool->stats();
+
+    std::vector<std::pair<void*, size_t>> blocks;
+    for (size_t i = 0; i < 100; ++i) {
+        size_t capacity = 0;
+        void* p = BufferPool::alloc(1000 + i * 100, capacity);
+        blocks.emplace_back(p, capacity);
+    }
+    CHECK(pool->stats().misses - s0.misses == 100);
+    CHECK(pool->stats().residentBytes == 0);
+
+    size_t total = 0;
+    for (const auto& b : blocks) {
+        total += b.second;
+        BufferPool::release(b.first, b.second);
+    }
+    CHECK(pool->stats().released - s0.released == 100);
+    CHECK(pool->stats().residentBytes == total);
+
+    for (auto& b : blocks) {
+        size_t capacity = 0;
+        void* p = BufferPool::alloc(b.second, capacity);
+        CHECK(capacity == b.second);
+        b.first = p;
+    }
+    CHECK(pool->stats().hits - s0.hits == 100);
+    CHECK(pool->stats().residentBytes == 0);
+
+    // resident size limit
+    pool->set_max_resident_size(total / 2);
+    for (const auto& b : blocks) {
+        BufferPool::release(b.first, b.second);
+    }
+    CHECK(pool->stats().residentBytes <= total / 2);
+    CHECK(pool->stats().dropped > s0.dropped);
+
+    pool->set_max_resident_size(BufferPool::DEF_MAX_RESIDENT_SIZE);
+    pool->shrink();
+    CHECK(pool->stats().residentBytes == 0);
+}
+
+void foreign_thread_test() {
+    // buffers serialized in one thread and released in another must go to the releasing thread's pool
+    BufferPool* pool = BufferPool::get_current();
+    pool->shrink();
+
+    SerializedMsg msg;
+    for (int i = 0; i < 10; ++i) {
+        msg.push_back(SharedBuffer("0123456789", 10));
+    }
+
+    uint64_t released = 0;
+    std::thread t([&msg, &released]() {
+        BufferPool* p = BufferPool::get_current();
+        msg.clear();
+        released = p->stats().released;
+    });
+    t.join();
+
+    CHECK(released == 10);
+    CHECK(pool->stats().residentBytes == 0);
+}
+
+void fragments_test() {
+    BufferPool* pool = BufferPool::get_current();
+    pool->shrink();
+
+    static const size_t FRAGMENT_SIZE = 20000;
+    const char str[] = "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef";
+    uint64_t hits = pool->stats().hits;
+
+    for (int r = 0; r < 10; ++r) {
+        BufferChain chain;
+        {
+            FragmentWriter w(FRAGMENT_SIZE, 8, [&chain](SharedBuffer&& f) { chain.append(f); });
+            for (int i = 0; i < 2000; ++i) {
+                w.write(str, sizeof(str) - 1);
+                if (i % 10 == 9) w.finalize();
+            }
+            w.finalize();
+        }
+        CHECK(chain.size() == 2000 * (sizeof(str) - 1));
+
+        size_t n = chain.size();
+        while (!chain.empty()) {
+            chain.advance(n < 1000 ? n : 1000);
+            n = chain.size();
+        }
+    }
+
+    // first round allocates fragments, the rest reuse them
+    CHECK(pool->stats().hits - hits >= 9 * (2000 * (sizeof(str) - 1) / FRAGMENT_SIZE));
+}
+
+} //namespace
+
+int main() {
+    size_classes_test();
+    reuse_test();
+    foreign_thread_test();
+    fragments_test();
+
+    BufferPool* pool = BufferPool::get_current();
+    const BufferPool::Stats& s = pool->stats();
+    cout << "hits=" << s.hits << " misses=" << s.misses << " oversized=" << s.oversized
+         << " released=" << s.released << " dropped=" << s.dropped << " resident=" << s.residentBytes << endl;
+
+    return g_errors;
+}
@@ -0,0 +1,115 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Throughput of RX/TX channels over different queue backends
+// Usage: channel_bench [messages per producer]
+
+#include "utility/message_queue.h"
+#include "utility/test_helpers.h"
+#include <future>
+#include <thread>
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+using namespace beam;
+
+namespace {
+
+struct Message {
+    uint64_t n = 0;
+    uint64_t payload = 0;
+};
+
+template <typename RXType, typename TXType, typename... QueueArgs>
+bool run_bench(const char* name, size_t producers, uint64_t count, QueueArgs&&... queueArgs) {
+    io::Reactor::Ptr reactor = io::Reactor::create();
+    size_t stopsLeft = producers;
+    uint64_t received = 0;
+    uint64_t sum = 0;
+    size_t fullRetries = 0;
+
+    RXType rx(
+        *reactor,
+        [&](Message&& msg) {
+            if (msg.n == 0) {
+                if (--stopsLeft == 0) reactor->stop();
+                return;
+            }
+            ++received;
+            sum += msg.payload;
+        },
+        std::forward<QueueArgs>(queueArgs)...
+    );
+
+    std::vector<TXType> txs;
+    for (size_t p = 0; p < producers; ++p) {
+        txs.push_back(rx.get_tx());
+    }
+
+    helpers::StopWatch sw;
+    sw.start();
+
+    std::future<void> f = std::async(std::launch::async, [&reactor]() { reactor->run(); });
+
+    std::vector<std::future<size_t>> senders;
+    for (size_t p = 0; p < producers; ++p) {
+        senders.push_back(std::async(std::launch::async, [&txs, p, count]() {
+            size_t retries = 0;
+            TXType& tx = txs[p];
+            for (uint64_t i = 1; i <= count + 1; ++i) {
+                Message msg { i <= count ? i : 0, i };
+                while (!tx.send(std::move(msg))) {
+                    ++retries;
+                    std::this_thread::yield();
+                }
+            }
+            return retries;
+        }));
+    }
+
+    for (auto& s : senders) fullRetries += s.get();
+    f.get();
+    sw.stop();
+
+    uint64_t expected = producers * count;
+    double seconds = sw.seconds() > 0 ? sw.seconds() : 1e-6;
+    cout << name << ": producers=" << producers << " messages=" << received
+         << " time=" << sw.milliseconds() << "ms"
+         << " rate=" << uint64_t(received / seconds) << " msg/s"
+         << " full_retries=" << fullRetries << endl;
+
+    return received == expected && sum == producers * count * (count + 1) / 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t count = 200000;
+    if (argc > 1) {
+        count = strtoull(argv[1], nullptr, 10);
+    }
+
+    static const size_t capacity = 4096;
+    bool ok = true;
+
+    ok &= run_bench<RX<Message>, TX<Message>>("mutex deque", 1, count);
+    ok &= run_bench<SPSC_RX<Message>, SPSC_TX<Message>>("spsc ring", 1, count, capacity);
+    ok &= run_bench<MPSC_RX<Message>, MPSC_TX<Message>>("mpsc ring", 1, count, capacity);
+
+    ok &= run_bench<RX<Message>, TX<Message>>("mutex deque", 4, count);
+    ok &= run_bench<MPSC_RX<Message>, MPSC_TX<Message>>("mpsc ring", 4, count, capacity);
+
+    return ok ? 0 : 1;
+}
@@ -15,6 +15,7 @@
 #include "utility/message_queue.h"
 #include <future>
 #include <iostream>
+#include <thread>
 #include <assert.h>
 
 using namespace std;
@@ -22,6 +23,16 @@ using namespace beam;
 
 static const string testStr("some moveble data");
 
+static int error_count = 0;
+
+#define CHECK(s) \
+do {\
+    if (!(s)) {\
+        ++error_count;\
+        assert(false && #s);\
+    }\
+} while(false)
+
 struct Message {
     int n=0;
     unique_ptr<string> d;
@@ -88,7 +99,114 @@ void simplex_channel_test() {
     assert(remote.received == sent);
 }
 
+template <typename RXType> struct BoundedRXThread : SomeAsyncObject {
+    RXType rx;
+    std::vector<std::vector<int>> received;
+    size_t stopsLeft;
+
+    BoundedRXThread(size_t capacity, size_t producers) :
+        rx(
+            *reactor,
+            [this](Message&& msg) {
+                if (msg.n == 0) {
+                    if (--stopsLeft == 0) reactor->stop();
+                    return;
+                }
+                size_t producer = size_t(msg.n) >> 24;
+                int n = msg.n & 0xffffff;
+                received[producer].push_back(*msg.d != testStr ? 0 : n);
+            },
+            capacity
+        ),
+        received(producers),
+        stopsLeft(producers)
+    {}
+};
+
+template <typename TXType> void send_until_accepted(TXType& tx, Message&& msg) {
+    // bounded queue: the sender owns the back-pressure policy
+    while (!tx.send(std::move(msg))) {
+        std::this_thread::yield();
+    }
+}
+
+void spsc_channel_test() {
+    BoundedRXThread<SPSC_RX<Message>> remote(64, 1);
+    SPSC_TX<Message> tx = remote.rx.get_tx();
+    std::vector<int> sent;
+
+    remote.run();
+
+    for (int i=1; i<=100500; ++i) {
+        send_until_accepted(tx, Message { i, make_unique<string>(testStr) } );
+        sent.push_back(i);
+    }
+
+    send_until_accepted(tx, Message { 0, make_unique<string>(testStr) } );
+
+    remote.wait();
+
+    CHECK(remote.received[0] == sent);
+}
+
+void mpsc_channel_test() {
+    static const size_t producers = 4;
+    static const int count = 50000;
+
+    BoundedRXThread<MPSC_RX<Message>> remote(128, producers);
+    std::vector<int> sent;
+    for (int i=1; i<=count; ++i) sent.push_back(i);
+
+    remote.run();
+
+    std::vector<std::thread> threads;
+    for (size_t p=0; p<producers; ++p) {
+        threads.emplace_back([&remote, p]() {
+            MPSC_TX<Message> tx = remote.rx.get_tx();
+            for (int i=1; i<=count; ++i) {
+                send_until_accepted(tx, Message { int(p << 24) | i, make_unique<string>(testStr) } );
+            }
+            send_until_accepted(tx, Message { 0, make_unique<string>(testStr) } );
+        });
+    }
+
+    for (auto& t : threads) t.join();
+    remote.wait();
+
+    for (size_t p=0; p<producers; ++p) {
+        CHECK(remote.received[p] == sent);
+    }
+}
+
+void bounded_queue_test() {
+    SPSCQueue<int> spsc(5);
+    CHECK(spsc.capacity() == 8);
+    for (int i=0; i<8; ++i) CHECK(spsc.send(i));
+    CHECK(!spsc.send(8));
+    CHECK(spsc.current_size() == 8);
+    int x = -1;
+    CHECK(spsc.receive(x) && x == 0);
+    CHECK(spsc.send(8));
+    std::vector<int> got;
+    CHECK(spsc.receive_all([&got](int&& v) { got.push_back(v); }) == 8);
+    CHECK(got == std::vector<int>({ 1, 2, 3, 4, 5, 6, 7, 8 }));
+    spsc.close_rx();
+    CHECK(!spsc.send(9));
+
+    MPSCQueue<int> mpsc(4);
+    for (int i=0; i<4; ++i) CHECK(mpsc.send(i));
+    CHECK(!mpsc.send(4));
+    got.clear();
+    CHECK(mpsc.receive_all([&got](int&& v) { got.push_back(v); }) == 4);
+    CHECK(got == std::vector<int>({ 0, 1, 2, 3 }));
+    CHECK(mpsc.current_size() == 0);
+}
+
 int main() {
+    bounded_queue_test();
     simplex_channel_test();
+    spsc_channel_test();
+    mpsc_channel_test();
+    return error_count;
 }
 
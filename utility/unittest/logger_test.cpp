@@ -15,6 +15,11 @@
 #include "utility/logger_checkpoints.h"
 #include "utility/helpers.h"
 #include <thread>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <boost/filesystem.hpp>
 
 using namespace beam;
 
@@ -79,7 +84,66 @@ void test_ndc_2(bool exc)
     }
 }
 
+int test_async_logger() {
+    int errors = 0;
+    static const int threads = 4;
+    static const int messagesPerThread = 1000;
+
+    Logger::FileNameType fileName;
+    uint64_t dropped = 0;
+    {
+        auto logger = Logger::create(LOG_LEVEL_CRITICAL, LOG_SINK_DISABLED, LOG_LEVEL_INFO, "Async_", "", Logger::DEF_ASYNC_RING_SIZE);
+        fileName = logger->get_current_file_name();
+
+        if (Logger::will_log(LOG_LEVEL_DEBUG)) ++errors; // cheap level check must follow the configured level
+
+        std::vector<std::thread> producers;
+        for (int t = 0; t < threads; ++t) {
+            producers.emplace_back([t]() {
+                for (int i = 0; i < messagesPerThread; ++i) {
+                    LOG_INFO() << "async " << t << " " << i;
+                }
+            });
+        }
+        for (auto& p : producers) p.join();
+
+        dropped = logger->get_dropped_count();
+        // logger dtor drains the rings of exited threads
+    }
+
+    std::ifstream f(fileName);
+    std::string line;
+    int lines = 0;
+    while (std::getline(f, line)) {
+        if (line.find("async ") != std::string::npos) ++lines;
+    }
+    f.close();
+    boost::filesystem::remove(fileName);
+
+    if (dropped != 0 || lines != threads * messagesPerThread) {
+        printf("async logger: %d lines written, %llu dropped\n", lines, (unsigned long long)dropped);
+        ++errors;
+    }
+    return errors;
+}
+
+int test_async_logger_overflow() {
+    // smallest ring and a writer that cannot keep up with a burst: the excess is counted, not blocked
+    auto logger = Logger::create(LOG_LEVEL_CRITICAL, LOG_SINK_DISABLED, LOG_LEVEL_INFO, "AsyncOverflow_", "", 1);
+    Logger::FileNameType fileName = logger->get_current_file_name();
+    std::string payload(200, 'x');
+    for (int i = 0; i < 10000; ++i) {
+        LOG_INFO() << payload;
+    }
+    uint64_t dropped = logger->get_dropped_count();
+    logger.reset();
+    boost::filesystem::remove(fileName);
+    return dropped > 0 ? 0 : 1;
+}
+
 int main() {
+    int errors = test_async_logger();
+    errors += test_async_logger_overflow();
     test_logger_1();
     test_ndc_1();
     test_ndc_2(false);
@@ -87,4 +151,5 @@ int main() {
         test_ndc_2(true);
     }
     catch(...) {}
+    return errors;
 }
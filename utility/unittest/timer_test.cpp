@@ -13,7 +13,9 @@
 // limitations under the License.
 
 #include "utility/io/coarsetimer.h"
+#include "utility/io/timingwheel.h"
 #include <set>
+#include <vector>
 
 #ifndef LOG_VERBOSE_ENABLED
     #define LOG_VERBOSE_ENABLED 1
@@ -99,6 +101,76 @@ void coarsetimer_test() {
     LOG_DEBUG() << "Stopping";
 }
 
+static int wheelErrors = 0;
+
+void timingwheel_test() {
+    reactor = Reactor::create();
+    TimingWheel::Ptr wheel = TimingWheel::create(*reactor, 5);
+
+    struct Entry {
+        TimingWheel::Timer timer;
+        uint64_t armedAt = 0;
+        unsigned interval = 0;
+        bool fired = false;
+    };
+
+    // intervals up to 3 sec with 5 msec resolution, i.e. beyond the 1st level of the wheel
+    static const unsigned N = 300;
+    std::vector<std::unique_ptr<Entry>> entries;
+    unsigned pending = 0;
+
+    for (unsigned i = 0; i < N; ++i) {
+        entries.push_back(std::make_unique<Entry>());
+        Entry& e = *entries.back();
+        e.interval = 10 + i * 10;
+        e.armedAt = uv_hrtime() / 1000000;
+        wheel->arm(e.timer, e.interval, false, [&e, &pending]() {
+            uint64_t now = uv_hrtime() / 1000000;
+            if (now + 1 < e.armedAt + e.interval) {
+                LOG_ERROR() << "wheel timer fired too early, interval=" << e.interval;
+                ++wheelErrors;
+            }
+            e.fired = true;
+            if (!--pending) reactor->stop();
+        });
+        ++pending;
+    }
+
+    for (unsigned i = 0; i < N; i += 3) {
+        entries[i]->timer.cancel();
+        --pending;
+    }
+
+    // deleting the owner from inside the callback
+    Entry* selfDeleting = new Entry;
+    wheel->arm(selfDeleting->timer, 20, false, [&selfDeleting]() {
+        delete selfDeleting;
+        selfDeleting = nullptr;
+    });
+
+    // periodic timer, cancelled after 5 rounds
+    TimingWheel::Timer periodic;
+    unsigned rounds = 0;
+    wheel->arm(periodic, 30, true, [&]() {
+        if (++rounds == 5) periodic.cancel();
+    });
+
+    reactor->run();
+
+    for (unsigned i = 0; i < N; ++i) {
+        bool expected = (i % 3) != 0;
+        if (entries[i]->fired != expected) {
+            LOG_ERROR() << "wheel timer " << i << (expected ? " not fired" : " fired after cancel");
+            ++wheelErrors;
+        }
+    }
+
+    if (selfDeleting || rounds != 5 || periodic.is_armed()) {
+        LOG_ERROR() << "wheel: self-deleting or periodic timer failed";
+        ++wheelErrors;
+    }
+}
+
 int main() {
     int logLevel = LOG_LEVEL_DEBUG;
 #if LOG_VERBOSE_ENABLED
@@ -107,5 +179,7 @@ int main() {
     auto logger = Logger::create(logLevel, logLevel);
     timer_test();
     coarsetimer_test();
+    timingwheel_test();
+    return wheelErrors;
 }
 
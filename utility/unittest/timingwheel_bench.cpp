@@ -0,0 +1,128 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Timing wheel vs per-object libuv timers
+// Usage: timingwheel_bench [peers] [wanted items]
+
+#include "utility/io/timingwheel.h"
+#include "utility/test_helpers.h"
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+
+using namespace std;
+using namespace beam;
+using namespace beam::io;
+
+namespace {
+
+static const unsigned REARMS_PER_PEER = 100;
+
+void print(const char* name, uint64_t ops, const helpers::StopWatch& sw) {
+    double ns = ops ? (sw.microseconds() * 1000.0 / ops) : 0;
+    cout << name << ": ops=" << ops << " time=" << sw.milliseconds() << "ms " << ns << " ns/op" << endl;
+}
+
+// Each peer re-arms its request timer on every task assignment/completion, and has a periodic peers timer
+void peers_uv_timers(Reactor& reactor, size_t peers) {
+    std::vector<Timer::Ptr> request(peers), resend(peers);
+
+    helpers::StopWatch sw;
+    sw.start();
+    for (size_t i = 0; i < peers; ++i) {
+        request[i] = Timer::create(reactor);
+        resend[i] = Timer::create(reactor);
+        resend[i]->start(600000, true, []() {});
+    }
+    for (unsigned r = 0; r < REARMS_PER_PEER; ++r) {
+        for (size_t i = 0; i < peers; ++i) {
+            request[i]->start(30000 + unsigned(i % 1000), false, []() {});
+        }
+    }
+    for (size_t i = 0; i < peers; ++i) {
+        request[i]->cancel();
+    }
+    sw.stop();
+    print("peers, uv timers", peers * (REARMS_PER_PEER + 2), sw);
+}
+
+void peers_wheel(Reactor& reactor, size_t peers) {
+    TimingWheel::Ptr wheel = TimingWheel::create(reactor, 10);
+    std::vector<TimingWheel::Timer> request(peers), resend(peers);
+
+    helpers::StopWatch sw;
+    sw.start();
+    for (size_t i = 0; i < peers; ++i) {
+        wheel->arm(resend[i], 600000, true, []() {});
+    }
+    for (unsigned r = 0; r < REARMS_PER_PEER; ++r) {
+        for (size_t i = 0; i < peers; ++i) {
+            wheel->arm(request[i], 30000 + unsigned(i % 1000), false, []() {});
+        }
+    }
+    for (size_t i = 0; i < peers; ++i) {
+        request[i].cancel();
+    }
+    sw.stop();
+    print("peers, timing wheel", peers * (REARMS_PER_PEER + 2), sw);
+}
+
+// Wanted items: armed on advertisement, most are cancelled when the data arrives, the rest expire
+bool wanted_wheel(Reactor& reactor, size_t items) {
+    TimingWheel::Ptr wheel = TimingWheel::create(reactor, 10);
+    std::vector<TimingWheel::Timer> wanted(items);
+    size_t expected = 0;
+    size_t expired = 0;
+
+    helpers::StopWatch sw;
+    sw.start();
+    for (size_t i = 0; i < items; ++i) {
+        wheel->arm(wanted[i], 100 + unsigned(i % 400), false, [&]() {
+            if (++expired == expected) reactor.stop();
+        });
+    }
+    sw.stop();
+    print("wanted, arm", items, sw);
+
+    sw.start();
+    for (size_t i = 0; i < items; ++i) {
+        if (i % 4) wanted[i].cancel();
+        else ++expected;
+    }
+    sw.stop();
+    print("wanted, cancel", items - expected, sw);
+
+    sw.start();
+    reactor.run();
+    sw.stop();
+    print("wanted, expire (incl. waiting)", expired, sw);
+
+    return expired == expected;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t peers = 10000;
+    size_t items = 1000000;
+    if (argc > 1) peers = strtoul(argv[1], nullptr, 10);
+    if (argc > 2) items = strtoul(argv[2], nullptr, 10);
+
+    Reactor::Ptr reactor = Reactor::create();
+
+    peers_uv_timers(*reactor, peers);
+    peers_wheel(*reactor, peers);
+
+    return wanted_wheel(*reactor, items) ? 0 : 1;
+}
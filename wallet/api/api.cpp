@@ -304,22 +304,67 @@ boost::optional<Asset::ID> readAssetIdParameter(const JsonRpcId& id, const json&
     return boost::optional<Asset::ID>();
 }
 
-bool readAssetsParameter(const JsonRpcId& id, const json& params)
+bool readBoolParameter(const JsonRpcId& id, const json& params, const std::string& name)
 {
-    if (Api::existsJsonParam(params, "assets"))
+    if (Api::existsJsonParam(params, name))
     {
-        if (params["assets"].is_boolean())
+        if (params[name].is_boolean())
         {
-            return params["assets"].get<bool>();
+            return params[name].get<bool>();
         }
         else
         {
-            throw Api::jsonrpc_exception{ ApiError::InvalidJsonRpc, "assets parameter must be boolean", id };
+            throw Api::jsonrpc_exception{ ApiError::InvalidJsonRpc, name + " parameter must be boolean", id };
         }
     }
     return false;
 }
 
+bool readAssetsParameter(const JsonRpcId& id, const json& params)
+{
+    return readBoolParameter(id, params, "assets");
+}
+
+boost::optional<uint64_t> readUnsignedParameter(const JsonRpcId& id, const json& params, const std::string& name)
+{
+    if (Api::existsJsonParam(params, name))
+    {
+        if (!params[name].is_number_unsigned())
+        {
+            throw Api::jsonrpc_exception{ ApiError::InvalidJsonRpc, name + " must be 64bit unsigned integer", id };
+        }
+        return params[name].get<uint64_t>();
+    }
+    return boost::optional<uint64_t>();
+}
+
+void readPagingParameters(const JsonRpcId& id, const json& params, int& skip, int& count)
+{
+    if (Api::existsJsonParam(params, "count"))
+    {
+        if (params["count"] > 0)
+        {
+            count = params["count"];
+        }
+        else
+        {
+            throw Api::jsonrpc_exception{ ApiError::InvalidJsonRpc, "Invalid 'count' parameter.", id };
+        }
+    }
+
+    if (Api::existsJsonParam(params, "skip"))
+    {
+        if (params["skip"] >= 0)
+        {
+            skip = params["skip"];
+        }
+        else
+        {
+            throw Api::jsonrpc_exception{ ApiError::InvalidJsonRpc, "Invalid 'skip' parameter.", id };
+        }
+    }
+}
+
 // return 0 if parameter not found
 Amount readBeamFeeParameter(const JsonRpcId& id, const json& params,
     const std::string& paramName = "fee",
@@ -734,6 +779,39 @@ OfferInput collectOfferInput(const JsonRpcId& id, const json& params)
         {
             json msg = json::parse(data, data + size);
 
+            if (msg.is_array())
+            {
+                if (msg.empty())
+                    throw jsonrpc_exception{ ApiError::InvalidJsonRpc, "Empty JSON-RPC batch." };
+
+                _handler.onBeginBatch();
+                for (auto& request : msg)
+                {
+                    processRequest(request, data, size);
+                }
+                _handler.onEndBatch();
+            }
+            else
+            {
+                processRequest(msg, data, size);
+            }
+        }
+        catch (const jsonrpc_exception& e)
+        {
+            onRequestError(e);
+        }
+        catch (const std::exception& e)
+        {
+            onRequestError(e);
+        }
+
+        return true;
+    }
+
+    void Api::processRequest(json& msg, const char* data, size_t size)
+    {
+        try
+        {
             if(!msg["id"].is_number_integer() && !msg["id"].is_string())
                 throw jsonrpc_exception{ ApiError::InvalidJsonRpc, "ID can be integer or string only." };
 
@@ -788,44 +866,52 @@ OfferInput collectOfferInput(const JsonRpcId& id, const json& params)
         }
         catch (const jsonrpc_exception& e)
         {
-            json msg
-            {
-                {JsonRpcHrd, JsonRpcVerHrd},
-                {"error",
-                    {
-                        {"code", e.code},
-                        {"message", getErrorMessage(e.code)},
-                    }
-                }
-            };
-
-            if (!e.data.empty())
-            {
-                msg["error"]["data"] = e.data;
-            }
-
-            if (e.id.is_number_integer() || e.id.is_string()) msg["id"] = e.id;
-            else msg.erase("id");
-
-            _handler.onInvalidJsonRpc(msg);
+            onRequestError(e);
         }
         catch (const std::exception& e)
         {
-            json msg
-            {
-                {JsonRpcHrd, JsonRpcVerHrd},
-                {"error",
-                    {
-                        {"code", ApiError::InternalErrorJsonRpc},
-                        {"message", e.what()},
-                    }
+            onRequestError(e);
+        }
+    }
+
+    void Api::onRequestError(const jsonrpc_exception& e)
+    {
+        json msg
+        {
+            {JsonRpcHrd, JsonRpcVerHrd},
+            {"error",
+                {
+                    {"code", e.code},
+                    {"message", getErrorMessage(e.code)},
                 }
-            };
+            }
+        };
 
-            _handler.onInvalidJsonRpc(msg);
+        if (!e.data.empty())
+        {
+            msg["error"]["data"] = e.data;
         }
 
-        return true;
+        if (e.id.is_number_integer() || e.id.is_string()) msg["id"] = e.id;
+        else msg.erase("id");
+
+        _handler.onInvalidJsonRpc(msg);
+    }
+
+    void Api::onRequestError(const std::exception& e)
+    {
+        json msg
+        {
+            {JsonRpcHrd, JsonRpcVerHrd},
+            {"error",
+                {
+                    {"code", ApiError::InternalErrorJsonRpc},
+                    {"message", e.what()},
+                }
+            }
+        };
+
+        _handler.onInvalidJsonRpc(msg);
     }
 
     // static
@@ -896,6 +982,7 @@ OfferInput collectOfferInput(const JsonRpcId& id, const json& params)
 
         AddrList addrList;
         addrList.own = params["own"];
+        readPagingParameters(id, params, addrList.skip, addrList.count);
 
         getHandler().onMessage(id, addrList);
     }
@@ -1153,6 +1240,24 @@ OfferInput collectOfferInput(const JsonRpcId& id, const json& params)
         getHandler().onMessage(id, data);
     }
 
+    void WalletApi::onEvSubscribeMessage(const JsonRpcId& id, const json& params)
+    {
+        EvSubscribe data;
+        data.systemState = readBoolParameter(id, params, "ev_system_state");
+        data.utxosChanged = readBoolParameter(id, params, "ev_utxos_changed");
+        data.txsChanged = readBoolParameter(id, params, "ev_txs_changed");
+
+        if (existsJsonParam(params, "resume"))
+        {
+            if (!params["resume"].is_string())
+                throw jsonrpc_exception{ ApiError::InvalidJsonRpc, "Invalid 'resume' parameter.", id };
+
+            data.resume = params["resume"].get<std::string>();
+        }
+
+        getHandler().onMessage(id, data);
+    }
+
     void WalletApi::onTxAssetInfoMessage(const JsonRpcId& id, const json& params)
     {
         checkCAEnabled(id);
@@ -1168,33 +1273,51 @@ OfferInput collectOfferInput(const JsonRpcId& id, const json& params)
     {
         GetUtxo getUtxo;
         getUtxo.withAssets = readAssetsParameter(id, params);
+        readPagingParameters(id, params, getUtxo.skip, getUtxo.count);
 
-        if (existsJsonParam(params, "count"))
+        if (existsJsonParam(params, "filter"))
         {
-            if (params["count"] > 0)
-            {
-                getUtxo.count = params["count"];
-            }
-            else
+            const json& filter = params["filter"];
+            getUtxo.filter.assetId = readAssetIdParameter(id, filter);
+
+            if (existsJsonParam(filter, "status"))
             {
-                throw jsonrpc_exception{ ApiError::InvalidJsonRpc, "Invalid 'count' parameter.", id};
+                const json& status = filter["status"];
+                for (const auto& s : status.is_array() ? status : json::array({ status }))
+                {
+                    if (!s.is_number_unsigned() || s.get<uint32_t>() >= Coin::Status::count)
+                    {
+                        throw jsonrpc_exception{ ApiError::InvalidJsonRpc, "Invalid 'status' parameter.", id };
+                    }
+                    getUtxo.filter.statuses.push_back(static_cast<Coin::Status>(s.get<uint32_t>()));
+                }
             }
-        }
 
-        if (existsJsonParam(params, "filter"))
-        {
-            getUtxo.filter.assetId = readAssetIdParameter(id, params["filter"]);
+            getUtxo.filter.minAmount = readUnsignedParameter(id, filter, "min_amount");
+            getUtxo.filter.maxAmount = readUnsignedParameter(id, filter, "max_amount");
+            getUtxo.filter.minMaturity = readUnsignedParameter(id, filter, "min_maturity");
+            getUtxo.filter.maxMaturity = readUnsignedParameter(id, filter, "max_maturity");
         }
 
-        if (existsJsonParam(params, "skip"))
+        if (existsJsonParam(params, "sort"))
         {
-            if (params["skip"] >= 0)
+            const json& sort = params["sort"];
+            if (existsJsonParam(sort, "field"))
             {
-                getUtxo.skip = params["skip"];
+                if (sort["field"] == "amount")
+                    getUtxo.sortBy = CoinsFilter::SortBy::Amount;
+                else if (sort["field"] == "maturity")
+                    getUtxo.sortBy = CoinsFilter::SortBy::Maturity;
+                else if (sort["field"] != "id")
+                    throw jsonrpc_exception{ ApiError::InvalidJsonRpc, "Invalid 'sort.field' parameter.", id };
             }
-            else
+
+            if (existsJsonParam(sort, "direction"))
             {
-                throw jsonrpc_exception{ApiError::InvalidJsonRpc, "Invalid 'skip' parameter.", id};
+                if (sort["direction"] == "desc")
+                    getUtxo.sortDescending = true;
+                else if (sort["direction"] != "asc")
+                    throw jsonrpc_exception{ ApiError::InvalidJsonRpc, "Invalid 'sort.direction' parameter.", id };
             }
         }
 
@@ -1506,6 +1629,27 @@ OfferInput collectOfferInput(const JsonRpcId& id, const json& params)
         };
     }
 
+    json WalletApi::getAddressJson(const WalletAddress& addr)
+    {
+        json res =
+        {
+            {"address", std::to_string(addr.m_walletID)},
+            {"comment", addr.m_label},
+            {"category", addr.m_category},
+            {"create_time", addr.getCreateTime()},
+            {"duration", addr.m_duration},
+            {"expired", addr.isExpired()},
+            {"own", addr.isOwn()},
+            {"own_id", addr.m_OwnID},
+            {"own_id_str", std::to_string(addr.m_OwnID)},
+        };
+        if (addr.m_Identity != Zero)
+        {
+            res.push_back({ "identity", std::to_string(addr.m_Identity) });
+        }
+        return res;
+    }
+
     void WalletApi::getResponse(const JsonRpcId& id, const AddrList::Response& res, json& msg)
     {
         msg = json
@@ -1517,22 +1661,7 @@ OfferInput collectOfferInput(const JsonRpcId& id, const json& params)
 
         for (auto& addr : res.list)
         {
-            msg["result"].push_back(
-            {
-                {"address", std::to_string(addr.m_walletID)},
-                {"comment", addr.m_label},
-                {"category", addr.m_category},
-                {"create_time", addr.getCreateTime()},
-                {"duration", addr.m_duration},
-                {"expired", addr.isExpired()},
-                {"own", addr.isOwn()},
-                {"own_id", addr.m_OwnID},
-                {"own_id_str", std::to_string(addr.m_OwnID)},
-            });
-            if (addr.m_Identity != Zero)
-            {
-                msg["result"].back().push_back({ "identity", std::to_string(addr.m_Identity) });
-            }
+            msg["result"].push_back(getAddressJson(addr));
         }
     }
 
@@ -1551,6 +1680,26 @@ OfferInput collectOfferInput(const JsonRpcId& id, const json& params)
         };
     }
 
+    json WalletApi::getUtxoJson(const Coin& utxo, uint32_t confirmations)
+    {
+        std::string createTxId = utxo.m_createTxId.is_initialized() ? TxIDToString(*utxo.m_createTxId) : "";
+        std::string spentTxId = utxo.m_spentTxId.is_initialized() ? TxIDToString(*utxo.m_spentTxId) : "";
+
+        return json
+        {
+            {"id", utxo.toStringID()},
+            {"asset_id", utxo.m_ID.m_AssetID},
+            {"amount", utxo.m_ID.m_Value},
+            {"type", (const char*)FourCC::Text(utxo.m_ID.m_Type)},
+            {"maturity", utxo.get_Maturity(confirmations)},
+            {"createTxId", createTxId},
+            {"spentTxId", spentTxId},
+            {"status", utxo.m_status},
+            {"status_string", utxo.getStatusString()},
+            {"session", utxo.m_sessionId}
+        };
+    }
+
     void WalletApi::getResponse(const JsonRpcId& id, const GetUtxo::Response& res, json& msg)
     {
         msg = json
@@ -1562,22 +1711,7 @@ OfferInput collectOfferInput(const JsonRpcId& id, const json& params)
 
         for (auto& utxo : res.utxos)
         {
-            std::string createTxId = utxo.m_createTxId.is_initialized() ? TxIDToString(*utxo.m_createTxId) : "";
-            std::string spentTxId = utxo.m_spentTxId.is_initialized() ? TxIDToString(*utxo.m_spentTxId) : "";
-
-            msg["result"].push_back(
-            { 
-                {"id", utxo.toStringID()},
-                {"asset_id", utxo.m_ID.m_AssetID},
-                {"amount", utxo.m_ID.m_Value},
-                {"type", (const char*)FourCC::Text(utxo.m_ID.m_Type)},
-                {"maturity", utxo.get_Maturity(res.confirmations_count)},
-                {"createTxId", createTxId},
-                {"spentTxId", spentTxId},
-                {"status", utxo.m_status},
-                {"status_string", utxo.getStatusString()},
-                {"session", utxo.m_sessionId}
-            });
+            msg["result"].push_back(getUtxoJson(utxo, res.confirmations_count));
         }
     }
 
@@ -1679,6 +1813,97 @@ OfferInput collectOfferInput(const JsonRpcId& id, const json& params)
         };
     }
 
+    void WalletApi::getResponse(const JsonRpcId& id, const EvSubscribe::Response& res, json& msg)
+    {
+        msg = json
+        {
+            {JsonRpcHrd, JsonRpcVerHrd},
+            {"id", id},
+            {"result",
+                {
+                    {"token", res.token},
+                    {"resumed", res.resumed}
+                }
+            }
+        };
+    }
+
+    void WalletApi::getNotification(uint64_t seq, const std::string& token, const EvSystemState& data, json& msg)
+    {
+        msg = json
+        {
+            {JsonRpcHrd, JsonRpcVerHrd},
+            {"method", "ev_system_state"},
+            {"params",
+                {
+                    {"seq", seq},
+                    {"token", token},
+                    {"current_height", data.stateID.m_Height},
+                    {"current_state_hash", to_hex(data.stateID.m_Hash.m_pData, data.stateID.m_Hash.nBytes)}
+                }
+            }
+        };
+    }
+
+    void WalletApi::getNotification(uint64_t seq, const std::string& token, const EvUtxosChanged& data, json& msg)
+    {
+        msg = json
+        {
+            {JsonRpcHrd, JsonRpcVerHrd},
+            {"method", "ev_utxos_changed"},
+            {"params",
+                {
+                    {"seq", seq},
+                    {"token", token},
+                    {"reset", data.reset},
+                    {"changed", json::array()},
+                    {"removed", json::array()}
+                }
+            }
+        };
+
+        auto& params = msg["params"];
+        for (const auto& utxo : data.changed)
+        {
+            params["changed"].push_back(getUtxoJson(utxo, data.confirmations));
+        }
+
+        for (const auto& cid : data.removed)
+        {
+            params["removed"].push_back(toString(cid));
+        }
+    }
+
+    void WalletApi::getNotification(uint64_t seq, const std::string& token, const EvTxsChanged& data, json& msg)
+    {
+        msg = json
+        {
+            {JsonRpcHrd, JsonRpcVerHrd},
+            {"method", "ev_txs_changed"},
+            {"params",
+                {
+                    {"seq", seq},
+                    {"token", token},
+                    {"changed", json::array()},
+                    {"removed", json::array()}
+                }
+            }
+        };
+
+        auto& params = msg["params"];
+        for (const auto& item : data.changed)
+        {
+            json tx = {};
+            GetStatusResponseJson(item.tx, tx, item.txHeight, item.systemHeight);
+            params["changed"].push_back(tx);
+        }
+
+        for (const auto& txId : data.removed)
+        {
+            params["removed"].push_back(TxIDToString(txId));
+        }
+    }
+
     void WalletApi::getResponse(const JsonRpcId& id, const Consume::Response& res, json& msg)
     {
         msg = json
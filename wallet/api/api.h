@@ -98,6 +98,7 @@ namespace beam::wallet
     macro(GetAssetInfo,       "get_asset_info",       API_READ_ACCESS)    \
     macro(SetConfirmationsCount, "set_confirmations_count", API_WRITE_ACCESS)    \
     macro(GetConfirmationsCount, "get_confirmations_count", API_READ_ACCESS)    \
+    macro(EvSubscribe,        "ev_subscribe",         API_READ_ACCESS)    \
     SWAP_OFFER_API_METHODS(macro)
 
 #if defined(BEAM_ATOMIC_SWAP_SUPPORT)
@@ -285,6 +286,8 @@ namespace beam::wallet
     struct AddrList
     {
         bool own;
+        int count = 0;
+        int skip = 0;
 
         struct Response
         {
@@ -422,8 +425,16 @@ namespace beam::wallet
         struct
         {
             boost::optional<Asset::ID> assetId;
+            std::vector<Coin::Status> statuses;
+            boost::optional<Amount> minAmount;
+            boost::optional<Amount> maxAmount;
+            boost::optional<Height> minMaturity;
+            boost::optional<Height> maxMaturity;
         } filter;
 
+        CoinsFilter::SortBy sortBy = CoinsFilter::SortBy::None;
+        bool sortDescending = false;
+
         struct Response
         {
             std::vector<Coin> utxos;
@@ -542,10 +553,51 @@ namespace beam::wallet
         };
     };
 
+    struct EvSubscribe
+    {
+        // all false means unsubscribe
+        bool systemState = false;
+        bool utxosChanged = false;
+        bool txsChanged = false;
+        // token of the last event received, missed events are sent after the response
+        boost::optional<std::string> resume;
+
+        struct Response
+        {
+            std::string token;
+            bool resumed = false;
+        };
+    };
+
+    // ev_subscribe notifications, each one carries sequence number and token to resume from
+    struct EvSystemState
+    {
+        Block::SystemState::ID stateID;
+    };
+
+    struct EvUtxosChanged
+    {
+        // coins were reset, the list should be requested again
+        bool reset = false;
+        std::vector<Coin> changed;
+        std::vector<Coin::ID> removed;
+        uint32_t confirmations = 0;
+    };
+
+    struct EvTxsChanged
+    {
+        std::vector<Status::Response> changed;
+        std::vector<TxID> removed;
+    };
+
     class IApiHandler
     {
     public:
         virtual void onInvalidJsonRpc(const json& msg) = 0;
+
+        // requests of JSON-RPC batch are handled between these calls, responses should be sent as one array
+        virtual void onBeginBatch() {}
+        virtual void onEndBatch() {}
     };
 
     class IWalletApiHandler : public IApiHandler
@@ -609,6 +661,11 @@ namespace beam::wallet
 
         std::unordered_map<std::string, FuncInfo> _methods;
         ACL _acl;
+
+    private:
+        void processRequest(json& msg, const char* data, size_t size);
+        void onRequestError(const jsonrpc_exception& e);
+        void onRequestError(const std::exception& e);
     };
 
     class WalletApi : public Api
@@ -623,6 +680,14 @@ namespace beam::wallet
 
 #undef RESPONSE_FUNC
 
+        // list items, also used to stream long lists item by item
+        static json getUtxoJson(const Coin& utxo, uint32_t confirmations);
+        static json getAddressJson(const WalletAddress& addr);
+
+        static void getNotification(uint64_t seq, const std::string& token, const EvSystemState& data, json& msg);
+        static void getNotification(uint64_t seq, const std::string& token, const EvUtxosChanged& data, json& msg);
+        static void getNotification(uint64_t seq, const std::string& token, const EvTxsChanged& data, json& msg);
+
     private:
         IWalletApiHandler& getHandler() const;
 
@@ -29,7 +29,6 @@
 #include "utility/io/timer.h"
 #include "utility/io/tcpserver.h"
 #include "utility/io/sslserver.h"
-#include "utility/io/json_serializer.h"
 #include "utility/string_helpers.h"
 #include "utility/log_rotation.h"
 
@@ -65,7 +64,6 @@
 using json = nlohmann::json;
 
 static const unsigned LOG_ROTATION_PERIOD = 3 * 60 * 60 * 1000; // 3 hours
-static const size_t PACKER_FRAGMENTS_SIZE = 4096;
 
 using namespace beam;
 using namespace beam::wallet;
@@ -229,7 +227,8 @@ class WalletApiServer
 {
 public:
     WalletApiServer(IWalletDB::Ptr walletDB, Wallet::Ptr wallet, io::Reactor& reactor,
-        io::Address listenTo, bool useHttp, WalletApi::ACL acl, const TlsOptions& tlsOptions, const std::vector<uint32_t>& whitelist)
+        io::Address listenTo, bool useHttp, WalletApi::ACL acl, const TlsOptions& tlsOptions, const std::vector<uint32_t>& whitelist,
+        WalletApiHandler::ReadOnlyExecutor* readOnlyExecutor)
         : _reactor(reactor)
         , _bindAddress(listenTo)
         , _useHttp(useHttp)
@@ -238,7 +237,13 @@ public:
         , _wallet(wallet)
         , _acl(acl)
         , _whitelist(whitelist)
+        , _readOnlyExecutor(readOnlyExecutor)
     {
+        if (!_useHttp)
+        {
+            _eventSource = std::make_unique<WalletApiHandler::EventSource>(_reactor, _walletDB);
+        }
+
         start();
     }
 
@@ -395,16 +400,20 @@ private:
         struct WalletData : WalletApiHandler::IWalletData
         {
             #ifdef BEAM_ATOMIC_SWAP_SUPPORT
-            WalletData(IWalletDB::Ptr walletDB, Wallet::Ptr wallet, IAtomicSwapProvider& atomicSwapProvider)
+            WalletData(IWalletDB::Ptr walletDB, Wallet::Ptr wallet, WalletApiHandler::ReadOnlyExecutor* readOnlyExecutor, WalletApiHandler::EventSource* eventSource, IAtomicSwapProvider& atomicSwapProvider)
                 : m_atomicSwapProvider(atomicSwapProvider)
                 , m_walletDB(walletDB)
                 , m_wallet(wallet)
+                , m_readOnlyExecutor(readOnlyExecutor)
+                , m_eventSource(eventSource)
             {
             }
             #else
-            WalletData(IWalletDB::Ptr walletDB, Wallet::Ptr wallet)
+            WalletData(IWalletDB::Ptr walletDB, Wallet::Ptr wallet, WalletApiHandler::ReadOnlyExecutor* readOnlyExecutor, WalletApiHandler::EventSource* eventSource)
                 : m_walletDB(walletDB)
                 , m_wallet(wallet)
+                , m_readOnlyExecutor(readOnlyExecutor)
+                , m_eventSource(eventSource)
             {
             }
             #endif  // BEAM_ATOMIC_SWAP_SUPPORT
@@ -421,6 +430,16 @@ private:
                 return m_wallet;
             }
 
+            WalletApiHandler::ReadOnlyExecutor* getReadOnlyExecutor() override
+            {
+                return m_readOnlyExecutor;
+            }
+
+            WalletApiHandler::EventSource* getEventSource() override
+            {
+                return m_eventSource;
+            }
+
             #ifdef BEAM_ATOMIC_SWAP_SUPPORT
             const IAtomicSwapProvider& getAtomicSwapProvider() const override
             {
@@ -431,6 +450,8 @@ private:
 
             IWalletDB::Ptr m_walletDB;
             Wallet::Ptr m_wallet;
+            WalletApiHandler::ReadOnlyExecutor* m_readOnlyExecutor;
+            WalletApiHandler::EventSource* m_eventSource;
         };
 
     template<typename T>
@@ -439,9 +460,9 @@ private:
         if (!_walletData)
         {
             #ifdef BEAM_ATOMIC_SWAP_SUPPORT
-            _walletData = std::make_unique<WalletData>(_walletDB, _wallet, *this);
+            _walletData = std::make_unique<WalletData>(_walletDB, _wallet, _readOnlyExecutor, _eventSource.get(), *this);
             #else
-            _walletData = std::make_unique<WalletData>(_walletDB, _wallet);
+            _walletData = std::make_unique<WalletData>(_walletDB, _wallet, _readOnlyExecutor, _eventSource.get());
             #endif
         }
 
@@ -491,7 +512,7 @@ private:
         : WalletApiHandler(walletData , acl)
         , _server(server)
         , _stream(std::move(newStream))
-        , _lineProtocol(BIND_THIS_MEMFN(on_raw_message), BIND_THIS_MEMFN(on_write))
+        , _lineReader(BIND_THIS_MEMFN(on_raw_message))
         {
             _stream->enable_keepalive(2);
             _stream->enable_read(BIND_THIS_MEMFN(on_stream_data));
@@ -502,19 +523,19 @@ private:
 
         }
 
-        void serializeMsg(const json& msg) override
+        void sendMsg(io::SerializedMsg& msg) override
         {
-            serialize_json_msg(_lineProtocol, msg);
+            _stream->write(msg);
         }
 
-        void on_write(io::SharedBuffer&& msg)
+        bool canSendNotifications() const override
         {
-            _stream->write(msg);
+            return true;
         }
 
         bool on_raw_message(void* data, size_t size)
         {
-            return _api.parse(static_cast<const char*>(data), size);
+            return processRequest(static_cast<const char*>(data), size);
         }
 
         bool on_stream_data(io::ErrorCode errorCode, void* data, size_t size)
@@ -526,7 +547,7 @@ private:
                 return false;
             }
 
-            if (!_lineProtocol.new_data_from_stream(data, size))
+            if (!_lineReader.new_data_from_stream(data, size))
             {
                 LOG_INFO() << "stream corrupted";
                 _server.closeConnection(_stream->peer_address().u64());
@@ -539,7 +560,7 @@ private:
     private:
         IWalletApiServer& _server;
         io::TcpStream::Ptr _stream;
-        LineProtocol _lineProtocol;
+        LineReader _lineReader;
     };
 
     class HttpApiConnection : public WalletApiHandler
@@ -555,8 +576,8 @@ private:
                 , acl)
             , _server(server)
             , _keepalive(false)
+            , _inRequest(false)
             , _msgCreator(2000)
-            , _packer(PACKER_FRAGMENTS_SIZE)
         {
             newStream->enable_keepalive(1);
             auto peer = newStream->peer_address();
@@ -573,10 +594,17 @@ private:
 
         virtual ~HttpApiConnection() {}
 
-        void serializeMsg(const json& msg) override
+        void sendMsg(io::SerializedMsg& msg) override
         {
-            serialize_json_msg(_body, _packer, msg);                
+            _body = std::move(msg);
             _keepalive = send(_connection, 200, "OK");
+
+            if (!_keepalive && !_inRequest)
+            {
+                // response to the request handled asynchronously
+                _connection->shutdown();
+                _server.closeConnection(_connection->id());
+            }
         }
 
     private:
@@ -606,7 +634,15 @@ private:
                 size_t size = 0;
                 auto data = msg.msg->get_body(size);
 
-                _api.parse((char*)data, size);
+                _inRequest = true;
+                processRequest((char*)data, size);
+                _inRequest = false;
+
+                if (hasPendingResponses())
+                {
+                    // connection is closed once the response is sent, if needed
+                    return true;
+                }
             }
 
             if (!_keepalive)
@@ -655,9 +691,9 @@ private:
         HttpConnection::Ptr _connection;
         IWalletApiServer& _server;
         bool _keepalive;
+        bool _inRequest;
 
         HttpMsgCreator _msgCreator;
-        HttpMsgCreator _packer;
         io::SerializedMsg _headers;
         io::SerializedMsg _body;
     };
@@ -677,6 +713,9 @@ private:
     std::vector<uint64_t> _pendingToClose;
     WalletApi::ACL _acl;
     std::vector<uint32_t> _whitelist;
+    WalletApiHandler::ReadOnlyExecutor* _readOnlyExecutor;
+    // destroyed first, unsubscribes the connections
+    std::unique_ptr<WalletApiHandler::EventSource> _eventSource;
 };
 }  // namespace
 
@@ -703,6 +742,8 @@ int main(int argc, char* argv[])
             std::string whitelist;
 
             uint32_t logCleanupPeriod;
+            uint32_t apiThreads;
+            bool bbsTagRecipient;
 
         } options;
 
@@ -711,6 +752,7 @@ int main(int argc, char* argv[])
         io::Address node_addr;
         IWalletDB::Ptr walletDB;
         io::Reactor::Ptr reactor = io::Reactor::create();
+        std::unique_ptr<WalletApiHandler::ReadOnlyExecutor> readOnlyExecutor;
         WalletApi::ACL acl;
         std::vector<uint32_t> whitelist;
 
@@ -726,7 +768,9 @@ int main(int argc, char* argv[])
                 (cli::IP_WHITELIST, po::value<std::string>(&options.whitelist)->default_value(""), "IP whitelist")
                 (cli::LOG_CLEANUP_DAYS, po::value<uint32_t>(&options.logCleanupPeriod)->default_value(5), "old logfiles cleanup period(days)")
                 (cli::NODE_POLL_PERIOD, po::value<Nonnegative<uint32_t>>(&options.pollPeriod_ms)->default_value(Nonnegative<uint32_t>(0)), "Node poll period in milliseconds. Set to 0 to keep connection. Anyway poll period would be no less than the expected rate of blocks if it is less then it will be rounded up to block rate value.")
-                (cli::WITH_ASSETS,    po::bool_switch()->default_value(false), "enable confidential assets transactions");
+                (cli::WITH_ASSETS,    po::bool_switch()->default_value(false), "enable confidential assets transactions")
+                (cli::API_THREADS, po::value<uint32_t>(&options.apiThreads)->default_value(2), "number of threads executing read-only requests (tx_list, get_utxo, wallet_status, addr_list, tx_status), 0 to execute them on the wallet thread")
+                (cli::BBS_TAG_RECIPIENT, po::value<bool>(&options.bbsTagRecipient)->default_value(false), "tag outgoing SBBS messages, so that the recipient finds its address without trial decryption (the recipient's wallet must support it)");
             ;
 
             po::options_description authDesc("User authorization options");
@@ -844,6 +888,12 @@ int main(int argc, char* argv[])
             walletDB = WalletDB::open(options.walletPath, pass);
             LOG_INFO() << "wallet sucessfully opened...";
 
+            if (options.apiThreads)
+            {
+                readOnlyExecutor = std::make_unique<WalletApiHandler::ReadOnlyExecutor>(*reactor,
+                    std::static_pointer_cast<WalletDB>(walletDB), options.walletPath, pass, options.apiThreads);
+            }
+
             // this should be exactly CLI flag value to print correct error messages
             // Rules::CA.Enabled would be checked as well but later
             wallet::g_AssetsEnabled = vm[cli::WITH_ASSETS].as<bool>();
@@ -877,11 +927,12 @@ int main(int argc, char* argv[])
         nnet->Connect();
 
         auto wnet = std::make_shared<WalletNetworkViaBbs>(*wallet, nnet, walletDB);
+        wnet->m_TagOutgoing = options.bbsTagRecipient;
 		wallet->AddMessageEndpoint(wnet);
         wallet->SetNodeEndpoint(nnet);
 
         WalletApiServer server(walletDB, wallet, *reactor, 
-            listenTo, options.useHttp, acl, tlsOptions, whitelist);
+            listenTo, options.useHttp, acl, tlsOptions, whitelist, readOnlyExecutor.get());
 
 #if defined(BEAM_ATOMIC_SWAP_SUPPORT)
         RegisterSwapTxCreators(wallet, walletDB);
@@ -144,6 +144,11 @@ namespace
 
 #endif  // BEAM_ATOMIC_SWAP_SUPPORT
 
+    const size_t kResponseFragmentSize = 4096;
+
+    // response of the read-only request being executed by the worker thread
+    thread_local beam::io::SerializedMsg* t_pWorkerResponse = nullptr;
+
 }  // namespace
 
 namespace beam::wallet
@@ -158,6 +163,521 @@ namespace beam::wallet
 
     WalletApiHandler::~WalletApiHandler()
     {
+        if (_evMask)
+        {
+            _walletData.getEventSource()->unsubscribe(*this);
+        }
+    }
+
+    bool WalletApiHandler::processRequest(const char* data, size_t size)
+    {
+        assert(!_processing);
+        _responses.emplace_back();
+        _processing = true;
+
+        auto closeSlot = [this]()
+        {
+            _responses.back().open = false;
+            _processing = false;
+
+            if (!_notifications.empty())
+            {
+                _responses.emplace_back();
+                _responses.back().open = false;
+                _responses.back().items.swap(_notifications);
+            }
+        };
+
+        bool res = false;
+        try
+        {
+            res = _api.parse(data, size);
+        }
+        catch (...)
+        {
+            closeSlot();
+            throw;
+        }
+
+        closeSlot();
+        flushResponses();
+        return res;
+    }
+
+    bool WalletApiHandler::hasPendingResponses() const
+    {
+        return !_responses.empty();
+    }
+
+    void WalletApiHandler::serializeMsg(const json& msg)
+    {
+        streamMsg([&msg](JsonStreamWriter& writer)
+        {
+            writer.write(msg);
+        });
+    }
+
+    void WalletApiHandler::streamMsg(const StreamMsgFunc& func)
+    {
+        io::SerializedMsg msg;
+        bool ok = false;
+        {
+            io::FragmentWriter packer(kResponseFragmentSize, 0, [&msg](io::SharedBuffer&& fragment)
+            {
+                msg.push_back(std::move(fragment));
+            });
+            JsonStreamWriter writer(packer);
+            func(writer);
+            ok = writer.finalize();
+        }
+
+        if (ok)
+        {
+            addResponse(std::move(msg));
+        }
+    }
+
+    void WalletApiHandler::addResponse(io::SerializedMsg&& msg)
+    {
+        if (t_pWorkerResponse)
+        {
+            *t_pWorkerResponse = std::move(msg);
+            return;
+        }
+
+        if (!_processing)
+        {
+            // not a response to the current request, but it should not overtake pending ones
+            _responses.emplace_back();
+            _responses.back().open = false;
+        }
+
+        _responses.back().items.push_back(std::move(msg));
+
+        if (!_processing)
+        {
+            flushResponses();
+        }
+    }
+
+    void WalletApiHandler::sendNotification(const io::SerializedMsg& msg)
+    {
+        if (_processing)
+        {
+            _notifications.push_back(msg);
+            return;
+        }
+
+        addResponse(io::SerializedMsg(msg));
+    }
+
+    void WalletApiHandler::flushResponses()
+    {
+        static const char eol = '\n';
+
+        while (!_responses.empty() && !_responses.front().open && !_responses.front().pending)
+        {
+            ResponseSlot slot = std::move(_responses.front());
+            _responses.pop_front();
+            ++_firstSlotID;
+
+            if (!slot.batch)
+            {
+                for (auto& item : slot.items)
+                {
+                    if (item.empty())
+                        continue;
+
+                    item.emplace_back(&eol, 1);
+                    sendMsg(item);
+                }
+                continue;
+            }
+
+            // nothing is sent if there's no responses in the batch (i.e. all requests are notifications)
+            io::SerializedMsg msg;
+            for (auto& item : slot.items)
+            {
+                if (item.empty())
+                    continue;
+
+                msg.emplace_back(msg.empty() ? "[" : ",", 1);
+                msg.insert(msg.end(), std::make_move_iterator(item.begin()), std::make_move_iterator(item.end()));
+            }
+
+            if (!msg.empty())
+            {
+                msg.emplace_back("]\n", 2);
+                sendMsg(msg);
+            }
+        }
+    }
+
+    void WalletApiHandler::onBeginBatch()
+    {
+        if (_processing)
+        {
+            _responses.back().batch = true;
+        }
+    }
+
+    void WalletApiHandler::onEndBatch()
+    {
+    }
+
+    struct WalletApiHandler::ReadOnlyExecutor::Request
+    {
+        std::shared_ptr<WalletApiHandler> handler;
+        uint64_t slotID = 0;
+        size_t item = 0;
+        JsonRpcId id;
+        ReadOnlyFunc func;
+        io::SerializedMsg response;
+    };
+
+    struct WalletApiHandler::ReadOnlyExecutor::Task : public Executor::TaskAsync
+    {
+        std::unique_ptr<Request> m_pRequest;
+
+        void Exec(Executor::Context& ctx) override
+        {
+            auto& executor = static_cast<ReadOnlyExecutor&>(*ctx.m_pThis);
+            auto& walletDB = *executor._readers[ctx.m_iThread];
+            auto& handler = *m_pRequest->handler;
+
+            t_pWorkerResponse = &m_pRequest->response;
+            try
+            {
+                walletDB.syncReadOnly();
+                m_pRequest->func(walletDB);
+            }
+            catch (const std::exception& e)
+            {
+                LOG_ERROR() << "error while executing read-only request: " << e.what();
+                handler.doError(m_pRequest->id, ApiError::InternalErrorJsonRpc, e.what());
+            }
+            t_pWorkerResponse = nullptr;
+
+            // request is released on the reactor thread, the handler should not be destroyed here
+            m_pRequest->func = nullptr;
+            executor.onRequestDone(std::move(m_pRequest));
+        }
+    };
+
+    WalletApiHandler::ReadOnlyExecutor::ReadOnlyExecutor(io::Reactor& reactor, std::shared_ptr<WalletDB> walletDB, const std::string& path, const SecString& password, uint32_t threads)
+        : _walletDB(walletDB)
+        , _doneEvent(io::AsyncEvent::create(reactor, [this]() { onDoneEvent(); }))
+    {
+        assert(threads);
+        _walletDB->enableWAL();
+
+        for (uint32_t i = 0; i < threads; ++i)
+        {
+            _readers.push_back(WalletDB::openReadOnly(path, password));
+        }
+        set_Threads(threads);
+    }
+
+    WalletApiHandler::ReadOnlyExecutor::~ReadOnlyExecutor()
+    {
+        Stop();
+    }
+
+    void WalletApiHandler::ReadOnlyExecutor::push(std::unique_ptr<Request>&& request)
+    {
+        // make the recent changes visible for the readers
+        _walletDB->flushDB();
+
+        auto task = std::make_unique<Task>();
+        task->m_pRequest = std::move(request);
+        Push(std::move(task));
+    }
+
+    void WalletApiHandler::ReadOnlyExecutor::onRequestDone(std::unique_ptr<Request>&& request)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _done.push_back(std::move(request));
+        }
+        _doneEvent->post();
+    }
+
+    void WalletApiHandler::ReadOnlyExecutor::onDoneEvent()
+    {
+        std::vector<std::unique_ptr<Request>> done;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            done.swap(_done);
+        }
+
+        for (auto& request : done)
+        {
+            request->handler->onReadOnlyDone(request->slotID, request->item, request->response);
+        }
+    }
+
+    void WalletApiHandler::runReadOnly(const JsonRpcId& id, ReadOnlyFunc&& func)
+    {
+        auto executor = _walletData.getReadOnlyExecutor();
+        if (!executor || !_processing)
+        {
+            auto walletDB = _walletData.getWalletDBPtr();
+            if (!walletDB) {
+                return doError(id, ApiError::NotOpenedError);
+            }
+
+            func(*walletDB);
+            return;
+        }
+
+        auto& slot = _responses.back();
+
+        auto request = std::make_unique<ReadOnlyExecutor::Request>();
+        request->handler = shared_from_this();
+        request->slotID = _firstSlotID + _responses.size() - 1;
+        request->item = slot.items.size();
+        request->id = id;
+        request->func = std::move(func);
+
+        slot.items.emplace_back();
+        ++slot.pending;
+
+        executor->push(std::move(request));
+    }
+
+    void WalletApiHandler::onReadOnlyDone(uint64_t slotID, size_t item, io::SerializedMsg& msg)
+    {
+        assert(slotID >= _firstSlotID && slotID - _firstSlotID < _responses.size());
+        auto& slot = _responses[slotID - _firstSlotID];
+
+        assert(slot.pending && item < slot.items.size());
+        slot.items[item] = std::move(msg);
+        --slot.pending;
+
+        flushResponses();
+    }
+
+    WalletApiHandler::EventSource::EventSource(io::Reactor& reactor, IWalletDB::Ptr walletDB, size_t historySize, unsigned coalescingPeriod_ms)
+        : _walletDB(walletDB)
+        , _timer(io::Timer::create(reactor))
+        , _historySize(historySize)
+        , _coalescingPeriod_ms(coalescingPeriod_ms)
+    {
+        assert(_historySize);
+        ECC::GenRandom(&_epoch, sizeof(_epoch));
+        _walletDB->Subscribe(this);
+    }
+
+    WalletApiHandler::EventSource::~EventSource()
+    {
+        _walletDB->Unsubscribe(this);
+
+        for (auto handler : _subscribers)
+        {
+            handler->_evMask = 0;
+        }
+    }
+
+    std::string WalletApiHandler::EventSource::getToken() const
+    {
+        return getToken(_lastSeq);
+    }
+
+    std::string WalletApiHandler::EventSource::getToken(uint64_t seq) const
+    {
+        return to_hex(&_epoch, sizeof(_epoch)) + ":" + std::to_string(seq);
+    }
+
+    void WalletApiHandler::EventSource::subscribe(WalletApiHandler& handler)
+    {
+        assert(std::find(_subscribers.begin(), _subscribers.end(), &handler) == _subscribers.end());
+        _subscribers.push_back(&handler);
+    }
+
+    void WalletApiHandler::EventSource::unsubscribe(WalletApiHandler& handler)
+    {
+        auto it = std::find(_subscribers.begin(), _subscribers.end(), &handler);
+        if (it != _subscribers.end())
+        {
+            _subscribers.erase(it);
+        }
+    }
+
+    bool WalletApiHandler::EventSource::getEventsAfter(const std::string& token, uint32_t mask, std::vector<const io::SerializedMsg*>& events) const
+    {
+        std::string epoch = to_hex(&_epoch, sizeof(_epoch));
+        if (token.size() <= epoch.size() + 1 || token.compare(0, epoch.size(), epoch) || token[epoch.size()] != ':')
+        {
+            return false;
+        }
+
+        const char* str = token.c_str() + epoch.size() + 1;
+        char* end = nullptr;
+        uint64_t seq = std::strtoull(str, &end, 10);
+        if (*end || !isdigit(*str) || seq > _lastSeq)
+        {
+            return false;
+        }
+
+        uint64_t firstSeq = _history.empty() ? _lastSeq + 1 : _history.front().seq;
+        if (seq + 1 < firstSeq)
+        {
+            return false;
+        }
+
+        for (auto it = _history.begin() + (seq + 1 - firstSeq); it != _history.end(); ++it)
+        {
+            if (it->type & mask)
+            {
+                events.push_back(&it->msg);
+            }
+        }
+        return true;
+    }
+
+    void WalletApiHandler::EventSource::onCoinsChanged(ChangeAction action, const std::vector<Coin>& items)
+    {
+        if (action == ChangeAction::Reset)
+        {
+            _utxosReset = true;
+            _utxos.clear();
+        }
+
+        for (const auto& coin : items)
+        {
+            _utxos[coin.toStringID()] = std::make_pair(coin, action == ChangeAction::Removed);
+        }
+
+        schedule();
+    }
+
+    void WalletApiHandler::EventSource::onTransactionChanged(ChangeAction action, const std::vector<TxDescription>& items)
+    {
+        for (const auto& tx : items)
+        {
+            // same types as tx_list reports
+            if (tx.m_txType != TxType::Simple && (tx.m_txType < TxType::AssetIssue || tx.m_txType > TxType::AssetInfo))
+                continue;
+
+            if (action == ChangeAction::Removed)
+                _txs[tx.m_txId] = boost::none;
+            else
+                _txs[tx.m_txId] = tx;
+        }
+
+        schedule();
+    }
+
+    void WalletApiHandler::EventSource::onSystemStateChanged(const Block::SystemState::ID& stateID)
+    {
+        _stateID = stateID;
+        schedule();
+    }
+
+    void WalletApiHandler::EventSource::schedule()
+    {
+        if (!_scheduled)
+        {
+            _scheduled = true;
+            _timer->start(_coalescingPeriod_ms, false, [this]() { onTimer(); });
+        }
+    }
+
+    void WalletApiHandler::EventSource::onTimer()
+    {
+        _scheduled = false;
+
+        if (_stateID)
+        {
+            addEvent(SystemState, EvSystemState{ *_stateID });
+            _stateID.reset();
+        }
+
+        if (_utxosReset || !_utxos.empty())
+        {
+            EvUtxosChanged ev;
+            ev.reset = _utxosReset;
+            ev.confirmations = _walletDB->getCoinConfirmationsOffset();
+            for (const auto& item : _utxos)
+            {
+                if (item.second.second)
+                    ev.removed.push_back(item.second.first.m_ID);
+                else
+                    ev.changed.push_back(item.second.first);
+            }
+
+            addEvent(UtxosChanged, ev);
+            _utxosReset = false;
+            _utxos.clear();
+        }
+
+        if (!_txs.empty())
+        {
+            Block::SystemState::ID stateID = {};
+            _walletDB->getSystemStateID(stateID);
+
+            EvTxsChanged ev;
+            for (const auto& item : _txs)
+            {
+                if (!item.second)
+                {
+                    ev.removed.push_back(item.first);
+                    continue;
+                }
+
+                Status::Response tx;
+                tx.tx = *item.second;
+                tx.txHeight = storage::DeduceTxProofHeight(*_walletDB, tx.tx);
+                tx.systemHeight = stateID.m_Height;
+                tx.confirmations = 0;
+                ev.changed.push_back(std::move(tx));
+            }
+
+            addEvent(TxsChanged, ev);
+            _txs.clear();
+        }
+    }
+
+    template<typename T>
+    void WalletApiHandler::EventSource::addEvent(Type type, const T& data)
+    {
+        uint64_t seq = ++_lastSeq;
+
+        json msg;
+        WalletApi::getNotification(seq, getToken(seq), data, msg);
+
+        // serialized once for all the subscribers
+        Event ev{ seq, type, {} };
+        {
+            io::FragmentWriter packer(kResponseFragmentSize, 0, [&ev](io::SharedBuffer&& fragment)
+            {
+                ev.msg.push_back(std::move(fragment));
+            });
+            JsonStreamWriter writer(packer);
+            writer.write(msg);
+            if (!writer.finalize())
+            {
+                ev.msg.clear();
+            }
+        }
+
+        _history.push_back(std::move(ev));
+        while (_history.size() > _historySize)
+        {
+            _history.pop_front();
+        }
+
+        const auto& added = _history.back().msg;
+        if (added.empty())
+            return;
+
+        for (auto handler : _subscribers)
+        {
+            if (handler->_evMask & type)
+            {
+                handler->sendNotification(added);
+            }
+        }
     }
 
     void WalletApiHandler::doError(const JsonRpcId& id, ApiError code, const std::string& data)
@@ -289,12 +809,23 @@ namespace beam::wallet
     {
         LOG_DEBUG() << "AddrList(id = " << id << ")";
 
-        auto walletDB = _walletData.getWalletDBPtr();
-        if (!walletDB) {
-            return doError(id, ApiError::NotOpenedError);
-        }
-
-        doResponse(id, AddrList::Response{walletDB->getAddresses(data.own)});
+        runReadOnly(id, [this, id, data](IWalletDB& walletDB)
+        {
+            streamMsg([&](JsonStreamWriter& writer)
+            {
+                writer.begin_object();
+                writer.write(WalletApi::JsonRpcHrd, WalletApi::JsonRpcVerHrd);
+                writer.write("id", id);
+                writer.begin_array("result");
+                walletDB.visitAddresses(data.own, data.skip, data.count > 0 ? data.count : std::numeric_limits<int>::max(), [&writer](const WalletAddress& addr)
+                {
+                    writer.write(WalletApi::getAddressJson(addr));
+                    return true;
+                });
+                writer.end_array();
+                writer.end_object();
+            });
+        });
     }
 
     void WalletApiHandler::onMessage(const JsonRpcId& id, const ValidateAddress& data)
@@ -589,6 +1120,53 @@ namespace beam::wallet
         doResponse(id, GetConfirmationsCount::Response{ walletDB->getCoinConfirmationsOffset() });
     }
 
+    void WalletApiHandler::onMessage(const JsonRpcId& id, const EvSubscribe& data)
+    {
+        LOG_DEBUG() << "EvSubscribe(id = " << id << ")";
+
+        auto eventSource = _walletData.getEventSource();
+        if (!eventSource || !canSendNotifications())
+        {
+            return doError(id, ApiError::NotSupported, "Notifications are not supported by the connection.");
+        }
+
+        uint32_t mask = 0;
+        if (data.systemState)
+            mask |= EventSource::SystemState;
+        if (data.utxosChanged)
+            mask |= EventSource::UtxosChanged;
+        if (data.txsChanged)
+            mask |= EventSource::TxsChanged;
+
+        if (_evMask)
+        {
+            eventSource->unsubscribe(*this);
+        }
+
+        _evMask = mask;
+
+        EvSubscribe::Response res;
+        res.token = eventSource->getToken();
+
+        std::vector<const io::SerializedMsg*> missed;
+        if (data.resume && mask)
+        {
+            res.resumed = eventSource->getEventsAfter(*data.resume, mask, missed);
+        }
+
+        doResponse(id, res);
+
+        for (auto msg : missed)
+        {
+            sendNotification(*msg);
+        }
+
+        if (_evMask)
+        {
+            eventSource->subscribe(*this);
+        }
+    }
+
     void WalletApiHandler::onMessage(const JsonRpcId& id, const TxAssetInfo& data)
     {
         LOG_DEBUG() << " AssetInfo" << "(id = " << id << " asset_id = "
@@ -637,30 +1215,28 @@ namespace beam::wallet
     {
         LOG_DEBUG() << "Status(txId = " << to_hex(data.txId.data(), data.txId.size()) << ")";
 
-        auto walletDB = _walletData.getWalletDBPtr();
-        if (!walletDB) {
-            return doError(id, ApiError::NotOpenedError);
-        }
-
-        auto tx = walletDB->getTx(data.txId);
-
-        if (tx)
+        runReadOnly(id, [this, id, data](IWalletDB& walletDB)
         {
-            Block::SystemState::ID stateID = {};
-            walletDB->getSystemStateID(stateID);
+            auto tx = walletDB.getTx(data.txId);
 
-            Status::Response result;
-            result.tx            = *tx;
-            result.systemHeight  = stateID.m_Height;
-            result.confirmations = 0;
-            result.txHeight      = storage::DeduceTxProofHeight(*walletDB, *tx);
+            if (tx)
+            {
+                Block::SystemState::ID stateID = {};
+                walletDB.getSystemStateID(stateID);
 
-            doResponse(id, result);
-        }
-        else
-        {
-            doError(id, ApiError::InvalidParamsJsonRpc, "Unknown transaction ID.");
-        }
+                Status::Response result;
+                result.tx            = *tx;
+                result.systemHeight  = stateID.m_Height;
+                result.confirmations = 0;
+                result.txHeight      = storage::DeduceTxProofHeight(walletDB, *tx);
+
+                doResponse(id, result);
+            }
+            else
+            {
+                doError(id, ApiError::InvalidParamsJsonRpc, "Unknown transaction ID.");
+            }
+        });
     }
 
     void WalletApiHandler::onMessage(const JsonRpcId& id, const Split& data)
@@ -779,69 +1355,90 @@ namespace beam::wallet
                     << " asset_id = " << (data.filter.assetId ? *data.filter.assetId : 0)
                     << ")";
 
-        auto walletDB = _walletData.getWalletDBPtr();
-        if (!walletDB) {
-            return doError(id, ApiError::NotOpenedError);
-        }
+        runReadOnly(id, [this, id, data](IWalletDB& walletDB)
+        {
+            uint32_t confirmations = walletDB.getCoinConfirmationsOffset();
+
+            // asset filter selects only asset coins, and only if assets are enabled
+            bool matchesNothing = data.filter.assetId && (!data.withAssets || *data.filter.assetId == Asset::s_BeamID);
 
-        GetUtxo::Response response;
-        response.confirmations_count = walletDB->getCoinConfirmationsOffset();
-        walletDB->visitCoins([&response, &data](const Coin& c)->bool {
-            if(!data.withAssets && c.isAsset())
+            CoinsFilter filter;
+            filter.m_AssetID = data.filter.assetId;
+            filter.m_WithAssets = data.withAssets;
+            filter.m_Statuses = data.filter.statuses;
+            filter.m_MinAmount = data.filter.minAmount;
+            filter.m_MaxAmount = data.filter.maxAmount;
+            // reported maturity includes confirmations offset
+            if (data.filter.minMaturity)
             {
-                return true;
+                filter.m_MinMaturity = *data.filter.minMaturity > confirmations ? *data.filter.minMaturity - confirmations : 0;
             }
-            if (data.filter.assetId && !c.isAsset(*data.filter.assetId))
+            if (data.filter.maxMaturity)
             {
-                return true;
+                matchesNothing |= *data.filter.maxMaturity < confirmations;
+                filter.m_MaxMaturity = *data.filter.maxMaturity - confirmations;
             }
-            response.utxos.push_back(c);
-            return true;
-        });
+            filter.m_SortBy = data.sortBy;
+            filter.m_Descending = data.sortDescending;
 
-        doPagination(data.skip, data.count, response.utxos);
-        doResponse(id, response);
+            streamMsg([&](JsonStreamWriter& writer)
+            {
+                writer.begin_object();
+                writer.write(WalletApi::JsonRpcHrd, WalletApi::JsonRpcVerHrd);
+                writer.write("id", id);
+                writer.begin_array("result");
+                if (!matchesNothing)
+                {
+                    walletDB.visitCoins(filter, data.skip, data.count > 0 ? data.count : std::numeric_limits<int>::max(), [&writer, confirmations](const Coin& c)
+                    {
+                        writer.write(WalletApi::getUtxoJson(c, confirmations));
+                        return true;
+                    });
+                }
+                writer.end_array();
+                writer.end_object();
+            });
+        });
     }
 
     void WalletApiHandler::onMessage(const JsonRpcId& id, const WalletStatus& data)
     {
         LOG_DEBUG() << "WalletStatus(id = " << id << ")";
 
-        WalletStatus::Response response;
-        auto walletDB = _walletData.getWalletDBPtr();
-        if (!walletDB) {
-            return doError(id, ApiError::NotOpenedError);
-        }
-
+        runReadOnly(id, [this, id, data](IWalletDB& walletDB)
         {
-            Block::SystemState::ID stateID = {};
-            walletDB->getSystemStateID(stateID);
+            WalletStatus::Response response;
 
-            response.currentHeight = stateID.m_Height;
-            response.currentStateHash = stateID.m_Hash;
-        }
+            {
+                Block::SystemState::ID stateID = {};
+                walletDB.getSystemStateID(stateID);
 
-        {
-            Block::SystemState::Full state;
-            walletDB->get_History().get_Tip(state);
-            response.prevStateHash = state.m_Prev;
-            response.difficulty = state.m_PoW.m_Difficulty.ToFloat();
-        }
+                response.currentHeight = stateID.m_Height;
+                response.currentStateHash = stateID.m_Hash;
+            }
 
-        storage::Totals allTotals(*walletDB);
-        const auto& totals = allTotals.GetBeamTotals();
+            {
+                Block::SystemState::Full state;
+                walletDB.get_History().get_Tip(state);
+                response.prevStateHash = state.m_Prev;
+                response.difficulty = state.m_PoW.m_Difficulty.ToFloat();
+            }
 
-        response.available = AmountBig::get_Lo(totals.Avail);
-        response.receiving = AmountBig::get_Lo(totals.Incoming);
-        response.sending   = AmountBig::get_Lo(totals.Outgoing);
-        response.maturing  = AmountBig::get_Lo(totals.Maturing);
+            storage::Totals allTotals(walletDB);
+            const auto& totals = allTotals.GetBeamTotals();
 
-        if (data.withAssets)
-        {
-            response.totals = allTotals;
-        }
+            response.available = AmountBig::get_Lo(totals.Avail);
+            response.receiving = AmountBig::get_Lo(totals.Incoming);
+            response.sending   = AmountBig::get_Lo(totals.Outgoing);
+            response.maturing  = AmountBig::get_Lo(totals.Maturing);
 
-        doResponse(id, response);
+            if (data.withAssets)
+            {
+                response.totals = allTotals;
+            }
+
+            doResponse(id, response);
+        });
     }
 
     void WalletApiHandler::onMessage(const JsonRpcId& id, const GenerateTxId& data)
@@ -887,68 +1484,53 @@ namespace beam::wallet
     {
         LOG_DEBUG() << "List(filter.status = " << (data.filter.status ? std::to_string((uint32_t)*data.filter.status) : "nul") << ")";
 
-        TxList::Response res;
-
+        runReadOnly(id, [this, id, data](IWalletDB& walletDB)
         {
-            auto walletDB = _walletData.getWalletDBPtr();
-            if (!walletDB) {
-                return doError(id, ApiError::NotOpenedError);
-            }
+            TxList::Response res;
 
-            auto txList = walletDB->getTxHistory(TxType::Simple);
+            TxHistoryFilter filter;
+            filter.m_Types.push_back(TxType::Simple);
+            filter.m_Status = data.filter.status;
+            filter.m_AssetID = data.filter.assetId;
+            filter.m_ProofHeight = data.filter.height;
+            filter.m_OrderByMinHeight = true;
 
             if (data.withAssets)
             {
-                auto txIssue = walletDB->getTxHistory(TxType::AssetIssue);
-                auto txConsume = walletDB->getTxHistory(TxType::AssetConsume);
-                auto txInfo = walletDB->getTxHistory(TxType::AssetInfo);
-
-                txList.insert(txList.end(), txIssue.begin(), txIssue.end());
-                txList.insert(txList.end(), txConsume.begin(), txConsume.end());
-                txList.insert(txList.end(), txInfo.begin(), txInfo.end());
+                filter.m_Types.push_back(TxType::AssetIssue);
+                filter.m_Types.push_back(TxType::AssetConsume);
+                filter.m_Types.push_back(TxType::AssetInfo);
+            }
+            else if (!data.filter.assetId)
+            {
+                filter.m_AssetID = Asset::ID(Asset::s_InvalidID); // by value, the constant has no definition
+            }
+            else if (*data.filter.assetId != Asset::s_InvalidID)
+            {
+                return doResponse(id, res);
             }
 
-            std::sort(txList.begin(), txList.end(), [](const TxDescription& a, const TxDescription& b) -> bool {
-                return a.m_minHeight > b.m_minHeight;
-             });
+            // count == 0 means all transactions
+            uint64_t start = data.count > 0 ? std::max(data.skip, 0) : 0;
+            int count = data.count > 0 ? data.count : std::numeric_limits<int>::max();
+            auto txList = walletDB.getTxHistory(filter, start, count);
 
             Block::SystemState::ID stateID = {};
-            walletDB->getSystemStateID(stateID);
+            walletDB.getSystemStateID(stateID);
 
+            res.resultList.reserve(txList.size());
             for (const auto& tx : txList)
             {
-                if (!data.withAssets && tx.m_assetId != Asset::s_InvalidID)
-                {
-                    continue;
-                }
-
-                if (data.filter.assetId && tx.m_assetId != *data.filter.assetId)
-                {
-                    continue;
-                }
-
-                if (data.filter.status && tx.m_status != *data.filter.status)
-                {
-                    continue;
-                }
-
-                const auto height = storage::DeduceTxProofHeight(*walletDB, tx);
-                if (data.filter.height && height != *data.filter.height)
-                {
-                    continue;
-                }
-
                 Status::Response item;
                 item.tx = tx;
-                item.txHeight = height;
+                item.txHeight = storage::DeduceTxProofHeight(walletDB, tx);
                 item.systemHeight = stateID.m_Height;
                 item.confirmations = 0;
                 res.resultList.push_back(item);
             }
-        }
 
-        doPagination(data.skip, data.count, res.resultList);
-        doResponse(id, res);
+            doResponse(id, res);
+        });
     }
 
     void WalletApiHandler::onMessage(const JsonRpcId& id, const ExportPaymentProof& data)
@@ -19,12 +19,22 @@
 #include "wallet/api/i_atomic_swap_provider.h"
 #endif  // BEAM_ATOMIC_SWAP_SUPPORT
 #include "wallet/core/wallet_db.h"
+#include "utility/io/json_serializer.h"
+#include "utility/io/asyncevent.h"
+#include "utility/io/timer.h"
+#include "utility/executor.h"
+#include <deque>
 
 namespace beam::wallet
 {
-class WalletApiHandler : public IWalletApiHandler
+class WalletApiHandler
+    : public IWalletApiHandler
+    , public std::enable_shared_from_this<WalletApiHandler>
 {
 public:
+    class ReadOnlyExecutor;
+    class EventSource;
+
     struct IWalletData
     {
         virtual IWalletDB::Ptr getWalletDBPtr() = 0;
@@ -32,6 +42,10 @@ public:
 #ifdef BEAM_ATOMIC_SWAP_SUPPORT
         virtual const IAtomicSwapProvider& getAtomicSwapProvider() const = 0;
 #endif  // BEAM_ATOMIC_SWAP_SUPPORT
+        // read-only requests are executed in place if there's no executor
+        virtual ReadOnlyExecutor* getReadOnlyExecutor() { return nullptr; }
+        // ev_subscribe is not supported if there's no event source
+        virtual EventSource* getEventSource() { return nullptr; }
     };
     WalletApiHandler(
         IWalletData& walletData
@@ -39,7 +53,20 @@ public:
     );
     virtual ~WalletApiHandler();
 
-    virtual void serializeMsg(const json& msg) = 0;
+    // sends complete response (or JSON-RPC batch of responses) to the client
+    virtual void sendMsg(io::SerializedMsg& msg) = 0;
+    // connection can deliver messages which are not responses to the requests
+    virtual bool canSendNotifications() const { return false; }
+
+    // parses the request, responses are sent in order of requests
+    bool processRequest(const char* data, size_t size);
+    bool hasPendingResponses() const;
+
+    void serializeMsg(const json& msg);
+
+    // writes message by parts, for the long lists
+    using StreamMsgFunc = std::function<void(JsonStreamWriter&)>;
+    void streamMsg(const StreamMsgFunc& func);
 
     template<typename T>
     void doResponse(const JsonRpcId& id, const T& response)
@@ -52,6 +79,8 @@ public:
     void doError(const JsonRpcId& id, ApiError code, const std::string& data = "");
 
     void onInvalidJsonRpc(const json& msg) override;
+    void onBeginBatch() override;
+    void onEndBatch() override;
 
     void FillAddressData(const AddressData& data, WalletAddress& address);
 
@@ -64,25 +93,6 @@ public:
 
     void doTxAlreadyExistsError(const JsonRpcId& id);
 
-    template<typename T>
-    static void doPagination(size_t skip, size_t count, std::vector<T>& res)
-    {
-        if (count > 0)
-        {
-            size_t start = skip;
-            size_t end = start + count;
-            size_t size = res.size();
-
-            if (start < size)
-            {
-                if (end > size) end = size;
-
-                res = std::vector<T>(res.begin() + start, res.begin() + end);
-            }
-            else res = {};
-        }
-    }
-
     template<typename T>
     void onIssueConsumeMessage(bool issue, const JsonRpcId& id, const T& data);
 
@@ -92,6 +102,128 @@ public:
 protected:
     IWalletData& _walletData;
     WalletApi _api;
+
+private:
+    // Read-only request body. It may run on the worker thread, so it should access nothing but
+    // the given db and the captured request data, and respond with doResponse/doError/streamMsg only
+    using ReadOnlyFunc = std::function<void(IWalletDB&)>;
+    void runReadOnly(const JsonRpcId& id, ReadOnlyFunc&& func);
+    void onReadOnlyDone(uint64_t slotID, size_t item, io::SerializedMsg& msg);
+
+    void addResponse(io::SerializedMsg&& msg);
+    void flushResponses();
+
+    friend class EventSource;
+    void sendNotification(const io::SerializedMsg& msg);
+
+    // responses to one request (or batch), they're sent once all are ready
+    struct ResponseSlot
+    {
+        std::vector<io::SerializedMsg> items;
+        size_t pending = 0;
+        bool batch = false;
+        bool open = true;
+    };
+
+    std::deque<ResponseSlot> _responses;
+    uint64_t _firstSlotID = 0;
+    bool _processing = false;
+    // sent after the responses to the request being processed
+    std::vector<io::SerializedMsg> _notifications;
+    uint32_t _evMask = 0;
 };
-} // beam::wallet
 
+// Executes read-only requests on the worker threads, each worker has its own read-only db connection.
+// The wallet db is switched to WAL mode, so the workers and the wallet don't block each other.
+// Pending changes of the wallet db are committed before the request is passed to the worker,
+// hence the request sees everything made by the previous ones
+class WalletApiHandler::ReadOnlyExecutor : public ExecutorMT
+{
+public:
+    ReadOnlyExecutor(io::Reactor& reactor, std::shared_ptr<WalletDB> walletDB, const std::string& path, const SecString& password, uint32_t threads);
+    ~ReadOnlyExecutor();
+
+private:
+    friend class WalletApiHandler;
+
+    struct Request;
+    struct Task;
+
+    void push(std::unique_ptr<Request>&& request);
+    void onRequestDone(std::unique_ptr<Request>&& request);
+    void onDoneEvent();
+
+    std::shared_ptr<WalletDB> _walletDB;
+    std::vector<std::shared_ptr<WalletDB>> _readers; // one per thread
+    io::AsyncEvent::Ptr _doneEvent;
+
+    std::mutex _mutex;
+    std::vector<std::unique_ptr<Request>> _done;
+};
+
+// Collects the wallet db changes for the ev_subscribe subscribers. Changes made within the coalescing
+// period are merged and sent as one event per type, events are numbered in sequence and the recent ones
+// are kept, so the client can resume the subscription after reconnect without missing anything
+class WalletApiHandler::EventSource : private IWalletDbObserver
+{
+public:
+    enum Type : uint32_t
+    {
+        SystemState = 1,
+        UtxosChanged = 2,
+        TxsChanged = 4
+    };
+
+    static const size_t kDefaultHistorySize = 1024;
+    static const unsigned kDefaultCoalescingPeriod_ms = 100;
+
+    EventSource(io::Reactor& reactor, IWalletDB::Ptr walletDB, size_t historySize = kDefaultHistorySize, unsigned coalescingPeriod_ms = kDefaultCoalescingPeriod_ms);
+    ~EventSource();
+
+    // token of the last event
+    std::string getToken() const;
+
+private:
+    friend class WalletApiHandler;
+
+    struct Event
+    {
+        uint64_t seq;
+        Type type;
+        io::SerializedMsg msg;
+    };
+
+    void subscribe(WalletApiHandler& handler);
+    void unsubscribe(WalletApiHandler& handler);
+    // returns false if the token is unknown or the events after it are not kept anymore
+    bool getEventsAfter(const std::string& token, uint32_t mask, std::vector<const io::SerializedMsg*>& events) const;
+
+    void onCoinsChanged(ChangeAction action, const std::vector<Coin>& items) override;
+    void onTransactionChanged(ChangeAction action, const std::vector<TxDescription>& items) override;
+    void onSystemStateChanged(const Block::SystemState::ID& stateID) override;
+
+    void schedule();
+    void onTimer();
+    template<typename T>
+    void addEvent(Type type, const T& data);
+    std::string getToken(uint64_t seq) const;
+
+    IWalletDB::Ptr _walletDB;
+    io::Timer::Ptr _timer;
+    bool _scheduled = false;
+    size_t _historySize;
+    unsigned _coalescingPeriod_ms;
+
+    // tokens of the previous runs are not valid
+    uint64_t _epoch;
+    uint64_t _lastSeq = 0;
+    std::deque<Event> _history;
+    std::vector<WalletApiHandler*> _subscribers;
+
+    // changes since the last event
+    boost::optional<Block::SystemState::ID> _stateID;
+    bool _utxosReset = false;
+    std::map<std::string, std::pair<Coin, bool>> _utxos; // coin by its string id, true if removed
+    std::map<TxID, boost::optional<TxDescription>> _txs; // boost::none if removed
+};
+} // beam::wallet
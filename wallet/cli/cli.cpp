@@ -2067,7 +2067,9 @@ namespace
             {
                 return -1;
             }
-            wallet->AddMessageEndpoint(make_shared<WalletNetworkViaBbs>(*wallet, nnet, walletDB));
+            auto wnet = make_shared<WalletNetworkViaBbs>(*wallet, nnet, walletDB);
+            wnet->m_TagOutgoing = vm[cli::BBS_TAG_RECIPIENT].as<bool>();
+            wallet->AddMessageEndpoint(wnet);
             wallet->SetNodeEndpoint(nnet);
 
             int res = func(vm, wallet, walletDB, currentTxID, isFork1);
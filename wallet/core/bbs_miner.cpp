@@ -17,96 +17,170 @@
 namespace beam::wallet
 {
 
-void BbsMiner::Stop()
+struct BbsMiner::Job
+    :public Executor::TaskAsync
 {
-    if (!m_vThreads.empty())
+    BbsMiner& m_Miner;
+    Task::Ptr m_pTask;
+    uint32_t m_iJob;
+    uint32_t m_nJobs;
+
+    Job(BbsMiner& miner, const Task::Ptr& pTask, uint32_t iJob, uint32_t nJobs)
+        :m_Miner(miner)
+        ,m_pTask(pTask)
+        ,m_iJob(iJob)
+        ,m_nJobs(nJobs)
     {
-        {
-            std::unique_lock<std::mutex> scope(m_Mutex);
-            m_Shutdown = true;
-            m_NewTask.notify_all();
-        }
+    }
+
+    ~Job()
+    {
+        // may be destroyed without execution, if the executor is stopped
+        std::unique_lock<std::mutex> scope(m_Miner.m_Mutex);
+        assert(m_Miner.m_Jobs);
+        if (!--m_Miner.m_Jobs)
+            m_Miner.m_JobsDone.notify_all();
+    }
+
+    void Exec(Executor::Context&) override
+    {
+        Timestamp ts;
+        uint32_t nonce;
+        if (Mine(*m_pTask, m_iJob, m_nJobs, ts, nonce, m_Miner.m_Shutdown))
+            m_Miner.OnMined(m_pTask, ts, nonce);
+    }
+};
+
+void BbsMiner::Start(io::AsyncEvent::Ptr&& pEvt)
+{
+    assert(!IsStarted());
+
+    m_pEvt = std::move(pEvt);
+    m_Shutdown = false;
 
-        for (size_t i = 0; i < m_vThreads.size(); i++)
-            if (m_vThreads[i].joinable())
-                m_vThreads[i].join();
+    m_pExecutor = Executor::s_pInstance;
+    if (!m_pExecutor)
+    {
+        m_pOwnExecutor = std::make_unique<ExecutorMT>();
+
+        uint32_t nThreads = std::thread::hardware_concurrency();
+        nThreads = (nThreads > 1) ? (nThreads - 1) : 1; // leave at least 1 vacant core for other things
+        m_pOwnExecutor->set_Threads(nThreads);
 
-        m_vThreads.clear();
-        m_pEvt.reset();
+        m_pExecutor = m_pOwnExecutor.get();
     }
 }
 
-void BbsMiner::Thread(uint32_t iThread)
+void BbsMiner::Push(const Task::Ptr& pTask)
 {
-    proto::Bbs::NonceType nStep = static_cast<uint32_t>(m_vThreads.size());
+    assert(IsStarted());
+    uint32_t nJobs = std::max(m_pExecutor->get_Threads(), 1U);
 
-    while (true)
     {
-        Task::Ptr pTask;
+        std::unique_lock<std::mutex> scope(m_Mutex);
+        m_Jobs += nJobs;
+    }
 
-        for (std::unique_lock<std::mutex> scope(m_Mutex); ; m_NewTask.wait(scope))
-        {
-            if (m_Shutdown)
-                return;
+    for (uint32_t i = 0; i < nJobs; i++)
+        m_pExecutor->Push(std::make_unique<Job>(*this, pTask, i, nJobs));
+}
 
-            if (!m_Pending.empty())
-            {
-                pTask = m_Pending.front();
-                break;
-            }
-        }
+void BbsMiner::Stop()
+{
+    if (!IsStarted())
+        return;
 
-        Timestamp ts = 0;
-        proto::Bbs::NonceType nonce = iThread;
-        bool bSuccess = false;
+    std::unique_lock<std::mutex> scope(m_Mutex);
+    m_Shutdown = true;
 
-        for (uint32_t i = 0; ; i++)
-        {
-            if (pTask->m_Done || m_Shutdown)
-                break;
+    // pending jobs would quit immediately
+    while (m_Jobs)
+        m_JobsDone.wait(scope);
 
-            if (!(i & 0xff))
-                ts = getTimestamp();
+    scope.unlock();
 
-            // attempt to mine it
-            ECC::Hash::Value hv;
-            ECC::Hash::Processor hp = pTask->m_hpPartial;
-            hp
-                << ts
-                << nonce
-                >> hv;
+    m_pOwnExecutor.reset();
+    m_pExecutor = nullptr;
+    m_pEvt.reset();
+}
 
-            if (proto::Bbs::IsHashValid(hv))
+bool BbsMiner::Mine(const Task& t, uint32_t iJob, uint32_t nJobs, Timestamp& ts, uint32_t& nonce, const volatile bool& bStop)
+{
+    const uint32_t nLanes = ECC::Hash::Processor::s_Lanes;
+    const uint32_t nNonceSize = proto::Bbs::NonceType::nBytes;
+    const uint32_t nTsSizeMax = (sizeof(Timestamp) * 8 + 6) / 7;
+
+    // tails are: ts (in the format of ECC::Hash::Processor), nonce
+    uint8_t pTails[nLanes * (nTsSizeMax + nNonceSize)];
+    uint32_t nTail = 0;
+
+    ECC::Hash::Value pRes[nLanes];
+    uint32_t nonce0 = iJob * nLanes;
+    ts = 0;
+
+    for (uint32_t i = 0; ; i++)
+    {
+        if (t.m_Done || bStop)
+            return false;
+
+        if (!(i & 0xf))
+        {
+            Timestamp tsNew = getTimestamp();
+            if (tsNew != ts)
             {
-                bSuccess = true;
-                break;
-            }
+                ts = tsNew;
 
-            nonce += nStep;
+                uint8_t pTs[nTsSizeMax];
+                uint32_t nTs = 0;
+
+                Timestamp val = ts;
+                for (; val >= 0x80; val >>= 7)
+                    pTs[nTs++] = uint8_t(uint8_t(val) | 0x80);
+                pTs[nTs++] = uint8_t(val);
+
+                nTail = nTs + nNonceSize;
+                for (uint32_t j = 0; j < nLanes; j++)
+                    memcpy(pTails + j * nTail, pTs, nTs);
+            }
         }
 
-        if (bSuccess)
+        for (uint32_t j = 0; j < nLanes; j++)
         {
-            std::unique_lock<std::mutex> scope(m_Mutex);
-
-            if (pTask->m_Done)
-                bSuccess = false;
-            else
-            {
-                assert(m_Pending.front() == pTask);
+            proto::Bbs::NonceType val = nonce0 + j;
+            memcpy(pTails + (j + 1) * nTail - nNonceSize, val.m_pData, nNonceSize);
+        }
 
-                pTask->m_Msg.m_TimePosted = ts;
-                pTask->m_Msg.m_Nonce = nonce;
+        t.m_hpPartial.FinalizeLanes(pRes, pTails, nTail);
 
-                pTask->m_Done = true;
-                m_Pending.pop_front();
-                m_Done.push_back(std::move(pTask));
+        for (uint32_t j = 0; j < nLanes; j++)
+        {
+            if (proto::Bbs::IsHashValid(pRes[j]))
+            {
+                nonce = nonce0 + j;
+                return true;
             }
         }
 
-        if (bSuccess)
-            m_pEvt->post();
+        nonce0 += nJobs * nLanes;
+    }
+}
+
+void BbsMiner::OnMined(const Task::Ptr& pTask, Timestamp ts, uint32_t nonce)
+{
+    {
+        std::unique_lock<std::mutex> scope(m_Mutex);
+
+        if (pTask->m_Done)
+            return;
+
+        pTask->m_Msg.m_TimePosted = ts;
+        pTask->m_Msg.m_Nonce = nonce;
+
+        pTask->m_Done = true;
+        m_Done.push_back(pTask);
     }
+
+    m_pEvt->post();
 }
-    
+
 }  // namespace beam::wallet
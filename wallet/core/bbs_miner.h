@@ -16,26 +16,30 @@
 
 #include <deque>
 #include <mutex>
-#include <thread>
-#include <vector>
+#include <condition_variable>
 
 #include "core/ecc_native.h"
 #include "core/proto.h"
 #include "utility/io/asyncevent.h"
+#include "utility/executor.h"
 
 namespace beam::wallet
 {
 
 struct BbsMiner
 {
-    // message mining
-    std::vector<std::thread> m_vThreads;
+    // message mining, on the executor threads.
+    // Each task is split into jobs (one per executor thread), each job tests ECC::Hash::Processor::s_Lanes nonces at once
     std::mutex m_Mutex;
-    std::condition_variable m_NewTask;
+    std::condition_variable m_JobsDone;
+    uint32_t m_Jobs = 0; // pushed to the executor, and not destroyed yet
 
     volatile bool m_Shutdown;
     io::AsyncEvent::Ptr m_pEvt;
 
+    Executor* m_pExecutor = nullptr;
+    std::unique_ptr<ExecutorMT> m_pOwnExecutor;
+
     struct Task
     {
         proto::BbsMsg m_Msg;
@@ -48,14 +52,23 @@ struct BbsMiner
 
     typedef std::deque<Task::Ptr> TaskQueue;
 
-    TaskQueue m_Pending;
     TaskQueue m_Done;
 
     BbsMiner() :m_Shutdown(false) {}
     ~BbsMiner() { Stop(); }
 
+    // Uses the executor of the current scope (if set), otherwise creates its own, with all cores but one.
+    // The event is posted when tasks are moved to m_Done
+    void Start(io::AsyncEvent::Ptr&&);
+    bool IsStarted() const { return m_pEvt != nullptr; }
+    void Push(const Task::Ptr&);
     void Stop();
-    void Thread(uint32_t);
 
+    // Searches the nonces in the given stride, returns false if stopped before found
+    static bool Mine(const Task&, uint32_t iJob, uint32_t nJobs, Timestamp&, uint32_t& nonce, const volatile bool& bStop);
+
+private:
+    struct Job;
+    void OnMined(const Task::Ptr&, Timestamp, uint32_t nonce);
 };
 }  // namespace beam::wallet
@@ -70,6 +70,43 @@ namespace beam::wallet
 	KEY_KEEPER_METHODS(THE_MACRO)
 #undef THE_MACRO
 
+	////////////////////////////////
+	// Outputs batch, by default made of the single outputs
+	struct IPrivateKeyKeeper2::HandlerBatch
+		:public Handler
+	{
+		Handler::Ptr m_pHandler;
+		size_t m_Pending;
+		Status::Type m_Status = Status::Success;
+
+		virtual void OnDone(Status::Type nRes) override
+		{
+			if (Status::Success == m_Status)
+				m_Status = nRes;
+
+			assert(m_Pending);
+			if (!--m_Pending)
+				m_pHandler->OnDone(m_Status);
+		}
+	};
+
+	IPrivateKeyKeeper2::Status::Type IPrivateKeyKeeper2::InvokeSync(Method::CreateOutputs& m)
+	{
+		return InvokeSyncInternal(m);
+	}
+
+	void IPrivateKeyKeeper2::InvokeAsync(Method::CreateOutputs& m, const Handler::Ptr& pHandler)
+	{
+		auto p = std::make_shared<HandlerBatch>();
+		p->m_pHandler = pHandler;
+		p->m_Pending = m.m_vOutputs.size() + 1; // the extra one is released after all are issued, in case some complete immediately
+
+		for (auto& x : m.m_vOutputs)
+			InvokeAsync(x, p);
+
+		p->OnDone(Status::Success);
+	}
+
 	////////////////////////////////
 	// misc
 	IPrivateKeyKeeper2::Status::Type IPrivateKeyKeeper2::get_Commitment(ECC::Point::Native& res, const CoinID& cid)
@@ -184,18 +221,65 @@ namespace beam::wallet
 	KEY_KEEPER_METHODS(THE_MACRO)
 #undef THE_MACRO
 
+	void PrivateKeyKeeper_AsyncNotify::InvokeAsync(Method::CreateOutputs& m, const Handler::Ptr& p)
+	{
+		Status::Type res = InvokeSync(m);
+		PushOut(res, p);
+	}
+
 	////////////////////////////////
 	// ThreadedPrivateKeyKeeper
+	const char* ThreadedPrivateKeyKeeper::get_MethodName(MethodID::Enum e)
+	{
+		switch (e)
+		{
+#define THE_MACRO(method) case MethodID::method: return #method;
+		KEY_KEEPER_METHODS(THE_MACRO)
+#undef THE_MACRO
+		case MethodID::CreateOutputs: return "CreateOutputs";
+		default: return "";
+		}
+	}
+
+	ThreadedPrivateKeyKeeper::Queue::Enum ThreadedPrivateKeyKeeper::get_Queue(MethodID::Enum e)
+	{
+		switch (e)
+		{
+		case MethodID::get_Kdf:
+		case MethodID::get_NumSlots:
+		case MethodID::SignReceiver:
+		case MethodID::SignSender:
+		case MethodID::SignSplit:
+			return Queue::Light;
+
+		default:
+			return Queue::Heavy; // bulletproofs, lelantus proofs
+		}
+	}
+
+	void ThreadedPrivateKeyKeeper::SharedExecutor::ExecAll(TaskSync& t)
+	{
+		std::unique_lock<std::mutex> scope(m_MutexExec);
+		ExecutorMT::ExecAll(t);
+	}
+
 	void ThreadedPrivateKeyKeeper::PushIn(Task::Ptr& p)
 	{
+		Task& t = Cast::Up<Task>(*p);
+		t.m_Pushed_ms = GetTime_ms();
+
+		Queue::Enum eQueue = get_Queue(t.m_Method);
+
 		std::unique_lock<std::mutex> scope(m_MutexIn);
 
-		if (m_queIn.Push(p))
-			m_NewIn.notify_one();
+		m_pQueIn[eQueue].Push(p);
+		m_pNewIn[eQueue].notify_one(); // there may be several workers, each one should be woken
 	}
 
-	void ThreadedPrivateKeyKeeper::Thread()
+	void ThreadedPrivateKeyKeeper::Thread(Queue::Enum eQueue)
 	{
+		Executor::Scope scopeExec(m_Executor);
+
 		while (true)
 		{
 			Task::Ptr pTask;
@@ -207,45 +291,85 @@ namespace beam::wallet
 					if (!m_Run)
 						return;
 
-					if (!m_queIn.empty())
+					if (!m_pQueIn[eQueue].empty())
 					{
-						m_queIn.Pop(pTask);
+						m_pQueIn[eQueue].Pop(pTask);
 						break;
 					}
 
-					m_NewIn.wait(scope);
+					m_pNewIn[eQueue].wait(scope);
 				}
 			}
 
 			assert(pTask);
-			Cast::Up<Task>(*pTask).Exec(*m_pKeyKeeper);
+			Task& t = Cast::Up<Task>(*pTask);
+
+			uint32_t t0_ms, t1_ms;
+			{
+				std::unique_lock<std::mutex> scope(m_MutexKeeper, std::defer_lock);
+				if (!m_Concurrent)
+					scope.lock();
+
+				t0_ms = GetTime_ms();
+				t.Exec(*m_pKeyKeeper);
+				t1_ms = GetTime_ms();
+			}
+
+			{
+				uint32_t nWait_ms = t0_ms - t.m_Pushed_ms;
+				uint32_t nExec_ms = t1_ms - t0_ms;
+
+				std::unique_lock<std::mutex> scope(m_MutexStats);
+				Stats& s = m_pStats[t.m_Method];
+
+				s.m_Count++;
+				s.m_Wait_ms += nWait_ms;
+				s.m_Exec_ms += nExec_ms;
+				std::setmax(s.m_WaitMax_ms, nWait_ms);
+				std::setmax(s.m_ExecMax_ms, nExec_ms);
+			}
 
 			PushOut(pTask);
 		}
 	}
 
-	ThreadedPrivateKeyKeeper::ThreadedPrivateKeyKeeper(const IPrivateKeyKeeper2::Ptr& p)
+	ThreadedPrivateKeyKeeper::ThreadedPrivateKeyKeeper(const IPrivateKeyKeeper2::Ptr& p, uint32_t nHeavyWorkers /* = 1 */, bool bConcurrent /* = false */)
 		:m_pKeyKeeper(p)
+		,m_Concurrent(bConcurrent)
 	{
 		EnsureEvtOut();
-		m_Thread = std::thread(&ThreadedPrivateKeyKeeper::Thread, this);
+
+		// the light methods may modify the keeper state (nonce slots), hence there's only one worker for them.
+		// A heavy worker runs alongside anyway, so unless the keeper is declared thread-safe they're serialized by m_MutexKeeper
+		m_vThreads.emplace_back(&ThreadedPrivateKeyKeeper::Thread, this, Queue::Light);
+
+		for (uint32_t i = 0; i < std::max(nHeavyWorkers, 1U); i++)
+			m_vThreads.emplace_back(&ThreadedPrivateKeyKeeper::Thread, this, Queue::Heavy);
 	}
 
 	ThreadedPrivateKeyKeeper::~ThreadedPrivateKeyKeeper()
 	{
-		if (m_Thread.joinable())
 		{
-			{
-				std::unique_lock<std::mutex> scope(m_MutexIn);
-				m_Run = false;
-				m_NewIn.notify_one();
-			}
-			m_Thread.join();
+			std::unique_lock<std::mutex> scope(m_MutexIn);
+			m_Run = false;
+
+			for (auto& cv : m_pNewIn)
+				cv.notify_all();
 		}
+
+		for (auto& t : m_vThreads)
+			if (t.joinable())
+				t.join();
+	}
+
+	ThreadedPrivateKeyKeeper::Stats ThreadedPrivateKeyKeeper::get_Stats(MethodID::Enum e)
+	{
+		std::unique_lock<std::mutex> scope(m_MutexStats);
+		return m_pStats[e];
 	}
 
 	template <typename TMethod>
-	void ThreadedPrivateKeyKeeper::InvokeAsyncInternal(TMethod& m, const Handler::Ptr& pHandler)
+	void ThreadedPrivateKeyKeeper::InvokeAsyncInternal(TMethod& m, const Handler::Ptr& pHandler, MethodID::Enum eMethod)
 	{
 		struct MyTask :public Task {
 			TMethod* m_pM;
@@ -255,6 +379,7 @@ namespace beam::wallet
 		Task::Ptr pTask(new MyTask);
 		pTask->m_pHandler = pHandler;
 		Cast::Up<MyTask>(*pTask).m_pM = &m;
+		Cast::Up<MyTask>(*pTask).m_Method = eMethod;
 
 		PushIn(pTask);
 	}
@@ -262,12 +387,15 @@ namespace beam::wallet
 #define THE_MACRO(method) \
 	void ThreadedPrivateKeyKeeper::InvokeAsync(Method::method& m, const Handler::Ptr& pHandler) \
 	{ \
-		InvokeAsyncInternal<Method::method>(m, pHandler); \
+		InvokeAsyncInternal<Method::method>(m, pHandler, MethodID::method); \
 	}
 
 	KEY_KEEPER_METHODS(THE_MACRO)
 #undef THE_MACRO
 
-
+	void ThreadedPrivateKeyKeeper::InvokeAsync(Method::CreateOutputs& m, const Handler::Ptr& pHandler)
+	{
+		InvokeAsyncInternal<Method::CreateOutputs>(m, pHandler, MethodID::CreateOutputs);
+	}
 
 } // namespace beam::wallet
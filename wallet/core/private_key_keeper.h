@@ -15,6 +15,7 @@
 #pragma once
 
 #include "common.h"
+#include "utility/executor.h"
 #include <boost/intrusive/list.hpp>
 
 namespace beam::wallet
@@ -93,6 +94,10 @@ namespace beam::wallet
                 CreateOutput() { ZeroObject(m_User); }
             };
 
+            struct CreateOutputs {
+                std::vector<CreateOutput> m_vOutputs; // may be created in parallel, the order is preserved
+            };
+
             struct CreateInputShielded
                 :public ShieldedTxo::ID
             {
@@ -183,6 +188,10 @@ namespace beam::wallet
         KEY_KEEPER_METHODS(THE_MACRO)
 #undef THE_MACRO
 
+        // batch of outputs. By default each one is created asynchronously via CreateOutput, the first failure is returned
+        virtual Status::Type InvokeSync(Method::CreateOutputs&);
+        virtual void InvokeAsync(Method::CreateOutputs&, const Handler::Ptr&);
+
         virtual ~IPrivateKeyKeeper2() {}
 
         // synthetic functions (in terms of underlying ones)
@@ -190,6 +199,7 @@ namespace beam::wallet
 
     private:
         struct HandlerSync;
+        struct HandlerBatch;
 
         template <typename TMethod>
         Status::Type InvokeSyncInternal(TMethod& m);
@@ -252,37 +262,96 @@ namespace beam::wallet
 		KEY_KEEPER_METHODS(THE_MACRO)
 #undef THE_MACRO
 
+		void InvokeAsync(Method::CreateOutputs& m, const Handler::Ptr& pHandler) override;
 	};
 
+	// Runs the methods of the underlying key keeper on the worker threads.
+	// Cheap methods (kdf, signatures) have their own worker, so that they don't wait in queue behind the proofs.
+	// Expensive methods (outputs, shielded inputs/outputs, vouchers) are run by the pool of workers.
+	// Unless bConcurrent is specified the invocations of the underlying key keeper are serialized, i.e. a cheap method
+	// still waits for the expensive one in progress. With bConcurrent the underlying key keeper must be thread-safe:
+	// the cheap and expensive methods run simultaneously even with a single heavy worker
 	class ThreadedPrivateKeyKeeper
 		:public PrivateKeyKeeper_WithMarshaller
 	{
+    public:
+
+#define THE_MACRO(method) method,
+        struct MethodID {
+            enum Enum {
+                KEY_KEEPER_METHODS(THE_MACRO)
+                CreateOutputs,
+                count
+            };
+        };
+#undef THE_MACRO
+
+        struct Queue {
+            enum Enum {
+                Light, // the higher priority
+                Heavy,
+                count
+            };
+        };
+
+        struct Stats
+        {
+            uint32_t m_Count = 0;
+            uint64_t m_Wait_ms = 0; // total time in queue
+            uint64_t m_Exec_ms = 0; // total execution time
+            uint32_t m_WaitMax_ms = 0;
+            uint32_t m_ExecMax_ms = 0;
+        };
+
+        static const char* get_MethodName(MethodID::Enum);
+        static Queue::Enum get_Queue(MethodID::Enum);
+
+    private:
+
         IPrivateKeyKeeper2::Ptr m_pKeyKeeper;
+		bool m_Concurrent;
+		std::mutex m_MutexKeeper; // if not concurrent
 
-		std::thread m_Thread;
+		std::vector<std::thread> m_vThreads;
 		bool m_Run = true;
 
 		std::mutex m_MutexIn;
-		std::condition_variable m_NewIn;
+		std::condition_variable m_pNewIn[Queue::count];
 
         struct Task
             :public TaskFin
         {
+            MethodID::Enum m_Method;
+            uint32_t m_Pushed_ms;
+
             virtual void Exec(IPrivateKeyKeeper2&) = 0;
         };
 
-		TaskList m_queIn;
+		TaskList m_pQueIn[Queue::count];
+
+		std::mutex m_MutexStats;
+		Stats m_pStats[MethodID::count];
+
+		// shared by the keeper methods, that can be parallelized (bulletproofs of the output batch, etc.)
+		struct SharedExecutor
+			:public ExecutorMT
+		{
+			std::mutex m_MutexExec; // heavy workers may ask for it simultaneously
+			void ExecAll(TaskSync&) override;
+		} m_Executor;
 
         void PushIn(Task::Ptr& p);
-        void Thread();
+        void Thread(Queue::Enum);
 
     public:
 
-        ThreadedPrivateKeyKeeper(const IPrivateKeyKeeper2::Ptr& p);
+        ThreadedPrivateKeyKeeper(const IPrivateKeyKeeper2::Ptr& p, uint32_t nHeavyWorkers = 1, bool bConcurrent = false);
         ~ThreadedPrivateKeyKeeper();
 
+        Stats get_Stats(MethodID::Enum);
+
 		template <typename TMethod>
-        void InvokeAsyncInternal(TMethod& m, const Handler::Ptr& pHandler);
+        void InvokeAsyncInternal(TMethod& m, const Handler::Ptr& pHandler, MethodID::Enum);
 
 #define THE_MACRO(method) \
 		void InvokeAsync(Method::method& m, const Handler::Ptr& pHandler) override;
@@ -290,6 +359,7 @@ namespace beam::wallet
 		KEY_KEEPER_METHODS(THE_MACRO)
 #undef THE_MACRO
 
+		void InvokeAsync(Method::CreateOutputs& m, const Handler::Ptr& pHandler) override;
 	};
 
 }
@@ -1102,6 +1102,7 @@ namespace beam::wallet
             :public proto::Event::IGroupParser
         {
             Wallet& m_This;
+            std::vector<UtxoEvent> m_Utxos;
             MyParser(Wallet& x) :m_This(x) {}
 
             virtual void OnEventType(proto::Event::Shielded& evt) override
@@ -1121,12 +1122,13 @@ namespace beam::wallet
                     return;
 
                 bool bAdd = 0 != (proto::Event::Flags::Add & evt.m_Flags);
-                m_This.ProcessEventUtxo(evt.m_Cid, m_Height, evt.m_Maturity, bAdd, evt.m_User);
+                m_Utxos.push_back({ evt.m_Cid, m_Height, evt.m_Maturity, bAdd, evt.m_User });
             }
 
         } p(*this);
         
         uint32_t nCount = p.Proceed(r.m_Res.m_Events);
+        ProcessEventsUtxo(p.m_Utxos);
 
         if (nCount < r.m_Max)
         {
@@ -1162,48 +1164,116 @@ namespace beam::wallet
 
     void Wallet::ProcessEventUtxo(const CoinID& cid, Height h, Height hMaturity, bool bAdd, const Output::User& user)
     {
-        Coin c;
-        c.m_ID = cid;
-        bool bExists = m_WalletDB->findCoin(c);
-        c.m_maturity = hMaturity;
+        ProcessEventsUtxo({ { cid, h, hMaturity, bAdd, user } });
+    }
 
+    void Wallet::ProcessEventsUtxo(const std::vector<UtxoEvent>& events)
+    {
+        if (events.empty())
+            return;
 
-        const auto* data = Output::User::ToPacked(user);
-        if (!memis0(data->m_TxID.m_pData, sizeof(TxID)))
+        // the whole batch is applied at once: one lookup, one write and one notification
+        std::unordered_map<std::string, Coin> found;
         {
-            c.m_createTxId.emplace();
-            std::copy_n(data->m_TxID.m_pData, sizeof(TxID), c.m_createTxId->begin());
+            CoinIDList ids;
+            ids.reserve(events.size());
+            for (const auto& evt : events)
+                ids.push_back(evt.m_Cid);
+
+            for (auto& c : m_WalletDB->findCoins(ids))
+                found.emplace(c.toStringID(), std::move(c));
         }
 
-        LOG_INFO() << "CoinID: " << c.m_ID << " Maturity=" << hMaturity << (bAdd ? " Confirmed" : " Spent") << ", Height=" << h;
+        // inputs of the active transactions, loaded on demand
+        std::unordered_map<std::string, TxID> activeInputs;
+        bool bActiveInputsLoaded = false;
+
+        std::vector<Coin> coins;
+        std::unordered_map<std::string, size_t> changed; // the same coin may be created and spent within the batch
+        coins.reserve(events.size());
 
-        if (bAdd)
+        for (const auto& evt : events)
         {
-            std::setmin(c.m_confirmHeight, h); // in case of std utxo proofs - the event height may be bigger than actual utxo height
+            std::string sid = toString(evt.m_Cid);
+            auto itChanged = changed.find(sid);
+
+            Coin c;
+            bool bExists = true;
+            if (changed.end() != itChanged)
+            {
+                c = coins[itChanged->second];
+            }
+            else
+            {
+                auto itFound = found.find(sid);
+                if (found.end() != itFound)
+                {
+                    c = itFound->second;
+                }
+                else
+                {
+                    c.m_ID = evt.m_Cid;
+                    bExists = false;
+                }
+            }
+
+            c.m_maturity = evt.m_Maturity;
+
+            const auto* data = Output::User::ToPacked(evt.m_User);
+            if (!memis0(data->m_TxID.m_pData, sizeof(TxID)))
+            {
+                c.m_createTxId.emplace();
+                std::copy_n(data->m_TxID.m_pData, sizeof(TxID), c.m_createTxId->begin());
+            }
+
+            LOG_INFO() << "CoinID: " << c.m_ID << " Maturity=" << evt.m_Maturity << (evt.m_Add ? " Confirmed" : " Spent") << ", Height=" << evt.m_Height;
 
-            // Check if this Coin participates in any active transaction
-            // if it does and mark it as outgoing (bug: ux_504)
-            for (const auto& [txid, txptr] : m_ActiveTransactions)
+            if (evt.m_Add)
             {
-                std::vector<Coin::ID> icoins;
-                txptr->GetParameter(TxParameterID::InputCoins, icoins);
-                if (std::find(icoins.begin(), icoins.end(), c.m_ID) != icoins.end())
+                std::setmin(c.m_confirmHeight, evt.m_Height); // in case of std utxo proofs - the event height may be bigger than actual utxo height
+
+                // Check if this Coin participates in any active transaction
+                // if it does and mark it as outgoing (bug: ux_504)
+                if (!bActiveInputsLoaded)
+                {
+                    bActiveInputsLoaded = true;
+                    for (const auto& [txid, txptr] : m_ActiveTransactions)
+                    {
+                        std::vector<Coin::ID> icoins;
+                        txptr->GetParameter(TxParameterID::InputCoins, icoins);
+                        for (const auto& cid : icoins)
+                            activeInputs[toString(cid)] = txid;
+                    }
+                }
+
+                auto itInput = activeInputs.find(sid);
+                if (activeInputs.end() != itInput)
                 {
                     c.m_status = Coin::Status::Outgoing;
-                    c.m_spentTxId = txid;
+                    c.m_spentTxId = itInput->second;
                     LOG_INFO() << "CoinID: " << c.m_ID << " marked as Outgoing";
                 }
             }
-        }
-        else
-        {
-            if (!bExists)
-                return; // should alert!
+            else
+            {
+                if (!bExists)
+                    continue; // should alert!
 
-            std::setmin(c.m_spentHeight, h); // reported spend height may be bigger than it actuall was (in case of macroblocks)
+                std::setmin(c.m_spentHeight, evt.m_Height); // reported spend height may be bigger than it actuall was (in case of macroblocks)
+            }
+
+            if (changed.end() != itChanged)
+            {
+                coins[itChanged->second] = std::move(c);
+            }
+            else
+            {
+                changed.emplace(std::move(sid), coins.size());
+                coins.push_back(std::move(c));
+            }
         }
 
-        m_WalletDB->saveCoin(c);
+        m_WalletDB->saveCoins(coins);
     }
 
     void Wallet::ProcessEventAsset(const proto::Event::AssetCtl& assetCtl, Height h)
@@ -1712,11 +1782,15 @@ namespace beam::wallet
             if (message->m_maxPrivacyMinAnonimitySet)
                 params.SetParameter(TxParameterID::MaxPrivacyMinAnonimitySet, message->m_maxPrivacyMinAnonimitySet);
 
-            auto packed = params.Pack();
-            for (const auto& p : packed)
+            std::vector<TxParameter> packed;
+            for (const auto& p : params.Pack())
             {
-                storage::setTxParameter(*m_WalletDB, *params.GetTxID(), p.first, p.second, true);
+                auto& param = packed.emplace_back();
+                param.m_txID = *params.GetTxID();
+                param.m_paramID = static_cast<int>(p.first);
+                param.m_value = p.second;
             }
+            m_WalletDB->setTxParameters(packed, true);
         }
     }
 }
@@ -216,7 +216,16 @@ namespace beam::wallet
         void saveKnownState();
         void RequestEvents();
         void AbortEvents();
+        struct UtxoEvent
+        {
+            CoinID m_Cid;
+            Height m_Height;
+            Height m_Maturity;
+            bool m_Add;
+            Output::User m_User;
+        };
         void ProcessEventUtxo(const CoinID&, Height h, Height hMaturity, bool bAdd, const Output::User& user);
+        void ProcessEventsUtxo(const std::vector<UtxoEvent>&);
         void ProcessEventAsset(const proto::Event::AssetCtl& assetCtl, Height h);
         void SetEventsHeight(Height);
         Height GetEventsHeightNext();
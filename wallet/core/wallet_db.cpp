@@ -30,6 +30,7 @@
 #include "strings_resources.h"
 #include "core/uintBig.h"
 #include <queue>
+#include <list>
 
 #define NOSEP
 #define COMMA ", "
@@ -63,6 +64,7 @@
 
 #define BIND_LIST(name, member, type, obj) "?"
 #define SET_LIST(name, member, type, obj) #name "=?"
+#define EXCLUDED_SET_LIST(name, member, type, obj) #name "=excluded." #name
 
 #define STORAGE_FIELDS ENUM_ALL_STORAGE_FIELDS(LIST, COMMA, )
 
@@ -73,6 +75,7 @@
 #define VARIABLES_NAME "variables"
 #define ADDRESSES_NAME "addresses"
 #define TX_PARAMS_NAME "txparams"
+#define TX_SUMMARY_NAME "txsummary"
 #define PRIVATE_VARIABLES_NAME "PrivateVariables"
 #define WALLET_MESSAGE_NAME "WalletMessages"
 #define INCOMING_WALLET_MESSAGE_NAME "IncomingWalletMessages"
@@ -85,6 +88,7 @@
 #define NOTIFICATIONS_NAME "notifications"
 #define EXCHANGE_RATES_NAME "exchangeRates"
 #define VOUCHERS_NAME "vouchers"
+#define TOTALS_NAME "totals"
 #define COIN_CONFIRMATIONS_COUNT "confirmations_count"
 
 #define ENUM_VARIABLES_FIELDS(each, sep, obj) \
@@ -112,6 +116,28 @@
 
 #define TX_PARAMS_FIELDS ENUM_TX_PARAMS_FIELDS(LIST, COMMA, )
 
+// Materialized view of the default sub-transaction parameters used in tx history queries,
+// maintained by setTxParameter/delTxParameter
+#define ENUM_TX_SUMMARY_FIELDS(each, sep, obj) \
+    each(txID,                 txID,                 BLOB NOT NULL PRIMARY KEY, obj) sep \
+    each(txType,               txType,               INTEGER NOT NULL, obj) sep \
+    each(status,               status,               INTEGER NOT NULL, obj) sep \
+    each(assetId,              assetId,              INTEGER NOT NULL, obj) sep \
+    each(minHeight,            minHeight,            INTEGER NOT NULL, obj) sep \
+    each(createTime,           createTime,           INTEGER NOT NULL, obj) sep \
+    each(kernelProofHeight,    kernelProofHeight,    INTEGER NOT NULL, obj) sep \
+    each(assetConfirmedHeight, assetConfirmedHeight, INTEGER NOT NULL, obj) sep \
+    each(flags,                flags,                INTEGER NOT NULL, obj)
+
+#define TX_SUMMARY_FIELDS ENUM_TX_SUMMARY_FIELDS(LIST, COMMA, )
+
+// Serialized storage::Totals::AssetTotals
+#define ENUM_TOTALS_FIELDS(each, sep, obj) \
+    each(assetId,        assetId,        INTEGER NOT NULL PRIMARY KEY, obj) sep \
+    each(value,          value,          BLOB NOT NULL, obj)
+
+#define TOTALS_FIELDS ENUM_TOTALS_FIELDS(LIST, COMMA, )
+
 #define ENUM_WALLET_MESSAGE_FIELDS(each, sep, obj) \
     each(ID,  ID,  INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, obj) sep \
     each(PeerID, PeerID,   BLOB, obj) sep \
@@ -489,26 +515,102 @@ namespace beam::wallet
 
     namespace sqlite
     {
+        // LRU cache of prepared statements keyed by connection and sql text.
+        // Statement takes the prepared one out while in use and puts it back reset on destruction
+        struct StatementCache
+        {
+            static const size_t MaxSize = 128;
+
+            ~StatementCache()
+            {
+                clear();
+            }
+
+            sqlite3_stmt* take(sqlite3* db, const char* sql)
+            {
+                auto it = m_Index.find(Key(db, sql));
+                if (it == m_Index.end())
+                    return nullptr;
+
+                sqlite3_stmt* stm = it->second->second;
+                m_Lru.erase(it->second);
+                m_Index.erase(it);
+                return stm;
+            }
+
+            void put(sqlite3* db, sqlite3_stmt* stm)
+            {
+                sqlite3_reset(stm);
+                sqlite3_clear_bindings(stm);
+
+                Key key(db, sqlite3_sql(stm));
+                if (m_Index.find(key) != m_Index.end())
+                {
+                    // the same request was used recursively, keep one
+                    sqlite3_finalize(stm);
+                    return;
+                }
+
+                m_Lru.emplace_front(key, stm);
+                m_Index.emplace(std::move(key), m_Lru.begin());
+
+                if (m_Lru.size() > MaxSize)
+                {
+                    m_Index.erase(m_Lru.back().first);
+                    sqlite3_finalize(m_Lru.back().second);
+                    m_Lru.pop_back();
+                }
+            }
+
+            void clear()
+            {
+                for (auto& x : m_Lru)
+                {
+                    sqlite3_finalize(x.second);
+                }
+                m_Lru.clear();
+                m_Index.clear();
+            }
+
+        private:
+            using Key = std::pair<sqlite3*, std::string>;
+            using List = std::list<std::pair<Key, sqlite3_stmt*>>;
+            List m_Lru; // most recently used first
+            std::map<Key, List::iterator> m_Index;
+        };
+
         struct Statement
         {
             Statement(const WalletDB* db, const char* sql, bool privateDB = false)
                 : _walletDB(nullptr)
                 , _db(privateDB ? db->m_PrivateDB : db->_db)
                 , _stm(nullptr)
+                , _cache(db->m_pStatementCache.get())
             {
-                int ret = sqlite3_prepare_v2(_db, sql, -1, &_stm, nullptr);
-                throwIfError(ret, _db);
+                prepare(sql);
             }
 
             Statement(WalletDB* db, const char* sql, bool privateDB = false)
                 : _walletDB(db)
                 , _db(privateDB ? db->m_PrivateDB : db->_db)
                 , _stm(nullptr)
+                , _cache(db->m_pStatementCache.get())
             {
                 if (_walletDB)
                 {
                     _walletDB->onPrepareToModify();
                 }
+                prepare(sql);
+            }
+
+            void prepare(const char* sql)
+            {
+                if (_cache)
+                {
+                    _stm = _cache->take(_db, sql);
+                    if (_stm)
+                        return;
+                }
                 int ret = sqlite3_prepare_v2(_db, sql, -1, &_stm, nullptr);
                 throwIfError(ret, _db);
             }
@@ -687,6 +789,11 @@ namespace beam::wallet
                 val = sqlite3_column_int(_stm, col);
             }
 
+            void get(int col, uint8_t& val)
+            {
+                val = static_cast<uint8_t>(sqlite3_column_int(_stm, col));
+            }
+
             template<typename EnumType, typename = EnumTypesOnly<EnumType>>
             void get(int col, EnumType& enumValue)
             {
@@ -835,12 +942,20 @@ namespace beam::wallet
 
             ~Statement()
             {
-                sqlite3_finalize(_stm);
+                if (_cache && _stm)
+                {
+                    _cache->put(_db, _stm);
+                }
+                else
+                {
+                    sqlite3_finalize(_stm);
+                }
             }
         private:
             WalletDB* _walletDB;
             sqlite3 * _db;
             sqlite3_stmt* _stm;
+            StatementCache* _cache;
             std::vector<ByteBuffer> _buffers;
         };
 
@@ -895,7 +1010,10 @@ namespace beam::wallet
         const char* LastUpdateTimeName = "LastUpdateTime";
         const char* kStateSummaryShieldedOutsDBPath = "StateSummaryShieldedOuts";
         const int BusyTimeoutMs = 5000;
-        const int DbVersion   = 24;
+        const int DbVersion   = 27;
+        const int DbVersion26 = 26;
+        const int DbVersion25 = 25;
+        const int DbVersion24 = 24;
         const int DbVersion23 = 23;
         const int DbVersion22 = 22;
         const int DbVersion21 = 21;
@@ -910,6 +1028,79 @@ namespace beam::wallet
         const int DbVersion12 = 12;
         const int DbVersion11 = 11;
         const int DbVersion10 = 10;
+
+        struct TxSummary
+        {
+            enum Flags : uint32_t
+            {
+                // mandatory parameters, see WalletDB::m_mandatoryTxParams
+                HasTransactionType = 1,
+                HasAmount = 2,
+                HasMyID = 4,
+                HasCreateTime = 8,
+                HasIsSender = 16,
+
+                Complete = HasTransactionType | HasAmount | HasMyID | HasCreateTime | HasIsSender
+            };
+
+            TxID m_txID;
+            TxType m_txType = TxType::Simple;
+            TxStatus m_status = TxStatus::Pending;
+            Asset::ID m_assetId = Asset::s_InvalidID;
+            Height m_minHeight = 0;
+            Timestamp m_createTime = 0;
+            Height m_kernelProofHeight = 0;
+            Height m_assetConfirmedHeight = 0;
+            uint32_t m_flags = 0;
+
+            static bool IsSummaryParam(TxParameterID paramID)
+            {
+                switch (paramID)
+                {
+                case TxParameterID::TransactionType:
+                case TxParameterID::Amount:
+                case TxParameterID::MyID:
+                case TxParameterID::CreateTime:
+                case TxParameterID::IsSender:
+                case TxParameterID::Status:
+                case TxParameterID::AssetID:
+                case TxParameterID::MinHeight:
+                case TxParameterID::KernelProofHeight:
+                case TxParameterID::AssetConfirmedHeight:
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            // blob == nullptr means the parameter has been deleted
+            void Apply(TxParameterID paramID, const ByteBuffer* blob)
+            {
+                static const ByteBuffer s_Empty;
+                const ByteBuffer& b = blob ? *blob : s_Empty;
+                uint32_t flag = 0;
+
+                switch (paramID)
+                {
+                case TxParameterID::TransactionType: fromByteBuffer(b, m_txType); flag = HasTransactionType; break;
+                case TxParameterID::Amount: flag = HasAmount; break;
+                case TxParameterID::MyID: flag = HasMyID; break;
+                case TxParameterID::CreateTime: fromByteBuffer(b, m_createTime); flag = HasCreateTime; break;
+                case TxParameterID::IsSender: flag = HasIsSender; break;
+                case TxParameterID::Status: fromByteBuffer(b, m_status); break;
+                case TxParameterID::AssetID: fromByteBuffer(b, m_assetId); break;
+                case TxParameterID::MinHeight: fromByteBuffer(b, m_minHeight); break;
+                case TxParameterID::KernelProofHeight: fromByteBuffer(b, m_kernelProofHeight); break;
+                case TxParameterID::AssetConfirmedHeight: fromByteBuffer(b, m_assetConfirmedHeight); break;
+                default: break;
+                }
+
+                if (blob)
+                    m_flags |= flag;
+                else
+                    m_flags &= ~flag;
+            }
+        };
     }
 
     Coin::Coin(Amount amount /* = 0 */, Key::Type keyType /* = Key::Type::Regular */, Asset::ID assetId /* = 0 */)
@@ -1256,6 +1447,93 @@ namespace beam::wallet
             throwIfError(ret, db);
         }
 
+        void CreateTxSummaryTable(sqlite3* db)
+        {
+            const char* req = "CREATE TABLE " TX_SUMMARY_NAME " (" ENUM_TX_SUMMARY_FIELDS(LIST_WITH_TYPES, COMMA, ) ") WITHOUT ROWID;"
+                "CREATE INDEX TxSummaryTypeIndex ON " TX_SUMMARY_NAME "(txType, createTime);"
+                "CREATE INDEX TxSummaryStatusIndex ON " TX_SUMMARY_NAME "(status);"
+                "CREATE INDEX TxSummaryAssetIndex ON " TX_SUMMARY_NAME "(assetId);"
+                "CREATE INDEX TxSummaryHeightIndex ON " TX_SUMMARY_NAME "(minHeight, createTime);";
+            int ret = sqlite3_exec(db, req, nullptr, nullptr, nullptr);
+            throwIfError(ret, db);
+        }
+
+        void CreateTotalsTable(sqlite3* db)
+        {
+            const char* req = "CREATE TABLE " TOTALS_NAME " (" ENUM_TOTALS_FIELDS(LIST_WITH_TYPES, COMMA, ) ");";
+            int ret = sqlite3_exec(db, req, nullptr, nullptr, nullptr);
+            throwIfError(ret, db);
+        }
+
+        // Coins affected by tx status and height changes, used to adjust totals
+        void CreateCoinsTotalsIndexes(sqlite3* db)
+        {
+            const char* req = "CREATE INDEX IF NOT EXISTS CoinMaturityIndex ON " STORAGE_NAME "(maturity);"
+                "CREATE INDEX IF NOT EXISTS CoinCreateTxIndex ON " STORAGE_NAME "(createTxId);"
+                "CREATE INDEX IF NOT EXISTS CoinSpentTxIndex ON " STORAGE_NAME "(spentTxId);"
+                "CREATE INDEX IF NOT EXISTS " SHIELDED_COINS_NAME "ConfirmIdx ON " SHIELDED_COINS_NAME "(confirmHeight);"
+                "CREATE INDEX IF NOT EXISTS " SHIELDED_COINS_NAME "CreateTxIdx ON " SHIELDED_COINS_NAME "(createTxId);"
+                "CREATE INDEX IF NOT EXISTS " SHIELDED_COINS_NAME "SpentTxIdx ON " SHIELDED_COINS_NAME "(spentTxId);";
+            int ret = sqlite3_exec(db, req, nullptr, nullptr, nullptr);
+            throwIfError(ret, db);
+        }
+
+        // Indexes for filtered and paged coin and address listings
+        void CreateCoinsQueryIndexes(sqlite3* db)
+        {
+            const char* req = "CREATE INDEX IF NOT EXISTS CoinAssetAmountIndex ON " STORAGE_NAME "(assetId, amount);"
+                "CREATE INDEX IF NOT EXISTS AddressesCreateTimeIndex ON " ADDRESSES_NAME "(createTime);";
+            int ret = sqlite3_exec(db, req, nullptr, nullptr, nullptr);
+            throwIfError(ret, db);
+        }
+
+        void FillTxSummaryTable(WalletDB* db)
+        {
+            sqlite::Statement stm(db, "SELECT " TX_PARAMS_FIELDS " FROM " TX_PARAMS_NAME " WHERE subTxID=?1 ORDER BY txID;");
+            stm.bind(1, kDefaultSubTxID);
+
+            sqlite::Statement insertStm(db, "INSERT INTO " TX_SUMMARY_NAME " (" TX_SUMMARY_FIELDS ") VALUES(" ENUM_TX_SUMMARY_FIELDS(BIND_LIST, COMMA, ) ");");
+            auto insert = [&insertStm](const TxSummary& summary)
+            {
+                auto& stm = insertStm;
+                stm.Reset();
+                int colIdx = 0;
+                ENUM_TX_SUMMARY_FIELDS(STM_BIND_LIST, NOSEP, summary);
+                stm.step();
+            };
+
+            boost::optional<TxSummary> summary;
+            while (stm.step())
+            {
+                TxParameter parameter = {};
+                int colIdx = 0;
+                ENUM_TX_PARAMS_FIELDS(STM_GET_LIST, NOSEP, parameter);
+
+                if (summary && summary->m_txID != parameter.m_txID)
+                {
+                    insert(*summary);
+                    summary.reset();
+                }
+
+                if (!summary)
+                {
+                    summary.emplace();
+                    summary->m_txID = parameter.m_txID;
+                }
+
+                auto paramID = static_cast<TxParameterID>(parameter.m_paramID);
+                if (TxSummary::IsSummaryParam(paramID))
+                {
+                    summary->Apply(paramID, &parameter.m_value);
+                }
+            }
+
+            if (summary)
+            {
+                insert(*summary);
+            }
+        }
+
         void OpenAndMigrateIfNeeded(const string& path, sqlite3** db, const SecString& password)
         {
             int ret = sqlite3_open_v2(path.c_str(), db, SQLITE_OPEN_READWRITE, nullptr);
@@ -1362,6 +1640,7 @@ namespace beam::wallet
         CreateVariablesTable(db);
         CreateAddressesTable(db);
         CreateTxParamsTable(db);
+        CreateTxSummaryTable(db);
         CreateStatesTable(db);
         CreateLaserTables(db);
         CreateAssetsTable(db);
@@ -1370,6 +1649,9 @@ namespace beam::wallet
         CreateNotificationsTable(db);
         CreateExchangeRatesTable(db);
         CreateVouchersTable(db);
+        CreateTotalsTable(db);
+        CreateCoinsTotalsIndexes(db);
+        CreateCoinsQueryIndexes(db);
     }
 
     std::shared_ptr<WalletDB> WalletDB::initBase(const string& path, const SecString& password, bool separateDBForPrivateData)
@@ -1844,6 +2126,24 @@ namespace beam::wallet
                         AddVouchersFlagsColumn(db);
                     }
 
+                    // no break
+
+                case DbVersion24:
+                    LOG_INFO() << "Converting DB from format 24...";
+                    CreateTxSummaryTable(walletDB->_db);
+                    FillTxSummaryTable(walletDB.get());
+                    // no break
+
+                case DbVersion25:
+                    LOG_INFO() << "Converting DB from format 25...";
+                    CreateTotalsTable(walletDB->_db);
+                    CreateCoinsTotalsIndexes(walletDB->_db);
+                    // no break
+
+                case DbVersion26:
+                    LOG_INFO() << "Converting DB from format 26...";
+                    CreateCoinsQueryIndexes(walletDB->_db);
+
                     storage::setVar(*walletDB, Version, DbVersion);
                     // no break
 
@@ -1931,6 +2231,40 @@ namespace beam::wallet
         return static_pointer_cast<IWalletDB>(walletDB);
     }
 
+    std::shared_ptr<WalletDB> WalletDB::openReadOnly(const string& path, const SecString& password)
+    {
+        if (!isInitialized(path))
+        {
+            LOG_ERROR() << path << " not found, please init the wallet before.";
+            throw DatabaseNotFoundException();
+        }
+
+        sqlite3* db = nullptr;
+        int ret = sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr);
+        throwIfError(ret, db);
+        enterKey(db, password);
+
+        auto walletDB = make_shared<WalletDB>(db);
+        walletDB->m_ReadOnly = true;
+        {
+            ret = sqlite3_busy_timeout(walletDB->_db, BusyTimeoutMs);
+            throwIfError(ret, walletDB->_db);
+        }
+        {
+            int version = 0;
+            storage::getVar(*walletDB, Version, version);
+            if (version != DbVersion)
+            {
+                // should be opened (and migrated) by the main connection first
+                throw InvalidDatabaseVersionException();
+            }
+        }
+
+        walletDB->syncReadOnly();
+        walletDB->m_Initialized = true;
+        return walletDB;
+    }
+
     void WalletDB::MigrateCoins()
     {
         // migrate coins
@@ -1993,6 +2327,7 @@ namespace beam::wallet
             TxParameterID::MyID,
             TxParameterID::CreateTime,
             TxParameterID::IsSender }
+        , m_pStatementCache(std::make_unique<sqlite::StatementCache>())
     {
 
     }
@@ -2013,6 +2348,7 @@ namespace beam::wallet
                 }
                 m_DbTransaction.reset();
             }
+            m_pStatementCache.reset(); // statements should be finalized before closing
             BEAM_VERIFY(SQLITE_OK == sqlite3_close(_db));
             if (m_PrivateDB && _db != m_PrivateDB)
             {
@@ -2125,6 +2461,14 @@ namespace beam::wallet
         return get_CommitmentSafe(comm, cid, get_KeyKeeper().get());
     }
 
+    void IWalletDB::setTxParameters(const std::vector<TxParameter>& params, bool shouldNotifyAboutChanges)
+    {
+        for (const auto& p : params)
+        {
+            setTxParameter(p.m_txID, static_cast<SubTxID>(p.m_subTxID), static_cast<TxParameterID>(p.m_paramID), p.m_value, shouldNotifyAboutChanges);
+        }
+    }
+
     bool IWalletDB::IsRecoveredMatch(CoinID& cid, const ECC::Point& comm)
     {
         IPrivateKeyKeeper2::Ptr pKeyKeeper = get_KeyKeeper();
@@ -2337,6 +2681,163 @@ namespace beam::wallet
         return std::make_shared<TxStatusInterpreter>(txParams);
     }
 
+    namespace
+    {
+        // Keeps the number of bound parameters of batched requests under SQLITE_MAX_VARIABLE_NUMBER (999)
+        const size_t CoinsBatchSize = 64;
+        const size_t TxParamsBatchSize = 128;
+
+        // (ID1) OR (ID2) OR ..., each term is resolved by CoinIndex
+        std::string MakeCoinIDsCondition(size_t count)
+        {
+            std::string res;
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (i)
+                    res += " OR ";
+                res += "(" ENUM_STORAGE_ID(SET_LIST, AND, ) ")";
+            }
+            return res;
+        }
+
+        std::string MakeValuesList(const char* row, size_t count)
+        {
+            std::string res;
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (i)
+                    res += ", ";
+                res += row;
+            }
+            return res;
+        }
+
+        // the same columns as CoinIndex
+        using CoinIDKey = std::tuple<uint32_t, Key::Index, uint64_t, Amount, Asset::ID>;
+
+        CoinIDKey MakeCoinIDKey(const Coin::ID& cid)
+        {
+            return CoinIDKey(cid.m_Type, cid.m_SubIdx, cid.m_Idx, cid.m_Value, cid.m_AssetID);
+        }
+
+        bool IsSameCoinID(const Coin::ID& a, const Coin::ID& b)
+        {
+            return MakeCoinIDKey(a) == MakeCoinIDKey(b);
+        }
+
+        // first occurrence of each coin
+        template <typename It>
+        std::vector<Coin> UniqueCoins(It begin, It end)
+        {
+            std::vector<Coin> res;
+            std::set<CoinIDKey> keys;
+            for (auto it = begin; it != end; ++it)
+            {
+                if (keys.insert(MakeCoinIDKey(it->m_ID)).second)
+                {
+                    res.push_back(*it);
+                }
+            }
+            return res;
+        }
+
+        struct CoinIDWrapper
+        {
+            Coin::ID m_ID;
+        };
+    }
+
+    // Available coins per asset, kept in sync by the same status transitions as the balance totals (see countCoins)
+    struct WalletDB::SpendableCoins
+    {
+        struct ShieldedKeyLess
+        {
+            bool operator()(const ShieldedTxo::BaseKey& a, const ShieldedTxo::BaseKey& b) const
+            {
+                if (a.m_nIdx != b.m_nIdx)
+                    return a.m_nIdx < b.m_nIdx;
+                if (a.m_IsCreatedByViewer != b.m_IsCreatedByViewer)
+                    return a.m_IsCreatedByViewer < b.m_IsCreatedByViewer;
+                return a.m_kSerG.m_Value < b.m_kSerG.m_Value;
+            }
+        };
+
+        // ascending amount, as CoinSelector3 expects
+        std::map<Asset::ID, std::map<std::pair<Amount, CoinIDKey>, Coin>> m_Std;
+        std::map<Asset::ID, std::map<ShieldedTxo::BaseKey, ShieldedCoin, ShieldedKeyLess>> m_Shielded;
+
+        void Update(const Coin& c, bool add)
+        {
+            auto key = std::make_pair(c.m_ID.m_Value, MakeCoinIDKey(c.m_ID));
+            auto& coins = m_Std[c.m_ID.m_AssetID];
+            if (add)
+            {
+                coins[key] = c;
+            }
+            else
+            {
+                coins.erase(key);
+            }
+        }
+
+        void Update(const ShieldedCoin& c, bool add)
+        {
+            auto& coins = m_Shielded[c.m_CoinID.m_AssetID];
+            if (add)
+            {
+                coins[c.m_CoinID.m_Key] = c;
+            }
+            else
+            {
+                coins.erase(c.m_CoinID.m_Key);
+            }
+        }
+    };
+
+    WalletDB::SpendableCoins& WalletDB::getSpendableCoins()
+    {
+        if (m_pSpendable)
+            return *m_pSpendable;
+
+        // status transitions are tracked only along with the totals
+        ensureTotals();
+
+        auto spendable = std::make_unique<SpendableCoins>();
+        {
+            sqlite::Statement stm(this, "SELECT " STORAGE_FIELDS " FROM " STORAGE_NAME " WHERE spentHeight<0 AND confirmHeight>=0;");
+            while (stm.step())
+            {
+                Coin coin;
+                int colIdx = 0;
+                ENUM_ALL_STORAGE_FIELDS(STM_GET_LIST, NOSEP, coin);
+
+                storage::DeduceStatus(*this, coin, m_TotalsHeight);
+                if (Coin::Status::Available == coin.m_status)
+                {
+                    spendable->Update(coin, true);
+                }
+            }
+        }
+        {
+            sqlite::Statement stm(this, "SELECT " ENUM_SHIELDED_COIN_FIELDS(LIST, COMMA, ) " FROM " SHIELDED_COINS_NAME " WHERE spentHeight<0 AND confirmHeight>=0;");
+            while (stm.step())
+            {
+                ShieldedCoin coin;
+                int colIdx = 0;
+                ENUM_SHIELDED_COIN_FIELDS(STM_GET_LIST, NOSEP, coin);
+
+                storage::DeduceStatus(*this, coin, m_TotalsHeight);
+                if (ShieldedCoin::Status::Available == coin.m_Status)
+                {
+                    spendable->Update(coin, true);
+                }
+            }
+        }
+
+        m_pSpendable = std::move(spendable);
+        return *m_pSpendable;
+    }
+
     vector<Coin> WalletDB::selectCoins(Amount amount, Asset::ID assetId)
     {
         return selectCoinsEx(amount, assetId, false);
@@ -2357,19 +2858,14 @@ namespace beam::wallet
 
         if (nMaxShielded)
         {
-            visitShieldedCoinsUnspent(
-                [&vShielded, aid, feeShielded](const ShieldedCoin& coin) -> bool
-                {
-                    if ((ShieldedCoin::Status::Available == coin.m_Status) && (coin.m_CoinID.m_AssetID == aid))
-                    {
-                        // skip dust
-                        bool bDust = !aid && (coin.m_CoinID.m_Value <= feeShielded);
-                        if (!bDust)
-                            vShielded.emplace_back().first = coin;
-                    }
-                    return true;
-                }
-            );
+            for (const auto& x : getSpendableCoins().m_Shielded[aid])
+            {
+                const ShieldedCoin& coin = x.second;
+                // skip dust
+                bool bDust = !aid && (coin.m_CoinID.m_Value <= feeShielded);
+                if (!bDust)
+                    vShielded.emplace_back().first = coin;
+            }
 
             if (!vShielded.empty())
             {
@@ -2459,40 +2955,20 @@ namespace beam::wallet
     vector<Coin> WalletDB::selectCoinsEx(Amount amount, Asset::ID assetId, bool bCanReturnLess)
     {
         vector<Coin> coins, coinsSel;
-        Block::SystemState::ID stateID = {};
-        getSystemStateID(stateID);
 
+        for (const auto& x : getSpendableCoins().m_Std[assetId])
         {
-            const char* query = "SELECT " STORAGE_FIELDS " FROM " STORAGE_NAME " WHERE maturity>=0 AND maturity<=?1 AND spentHeight<0 ORDER BY amount ASC";
+            const Coin& coin = coins.emplace_back(x.second);
+            if (coin.m_ID.m_Value >= amount)
+                break;
+        }
 
-            sqlite::Statement stm(this, query);
-            stm.bind(1, stateID.m_Height);
+        CoinSelector3 csel(coins);
+        CoinSelector3::Result res = csel.Select(amount);
 
-            while (stm.step())
-            {
-                auto& coin = coins.emplace_back();
-                int colIdx = 0;
-                ENUM_ALL_STORAGE_FIELDS(STM_GET_LIST, NOSEP, coin);
-
-                storage::DeduceStatus(*this, coin, stateID.m_Height);
-                if (Coin::Status::Available != coin.m_status)
-                    coins.pop_back();
-                else if (coin.m_ID.m_AssetID != assetId)
-                    coins.pop_back();
-                else
-                {
-                    if (coin.m_ID.m_Value >= amount)
-                        break;
-                }
-            }
-        }
-
-        CoinSelector3 csel(coins);
-        CoinSelector3::Result res = csel.Select(amount);
-
-        if (res.first >= amount)
-        {
-            coinsSel.reserve(res.second.size());
+        if (res.first >= amount)
+        {
+            coinsSel.reserve(res.second.size());
 
             for (size_t j = 0; j < res.second.size(); j++)
                 coinsSel.push_back(std::move(coins[res.second[j]]));
@@ -2541,43 +3017,56 @@ namespace beam::wallet
         return coins;
     }
 
-    vector<Coin> WalletDB::getCoinsByID(const CoinIDList& ids) const
+    vector<Coin> WalletDB::findCoins(const CoinIDList& ids) const
     {
         vector<Coin> coins;
         coins.reserve(ids.size());
-        struct DummyWrapper {
-                Coin::ID m_ID;
-        };
-
-        Block::SystemState::ID stateID = {};
-        getSystemStateID(stateID);
 
-        for (const auto& cid : ids)
+        Height h = getCurrentHeight();
+        vector<Coin> found;
+        for (size_t i = 0; i < ids.size(); i += CoinsBatchSize)
         {
-            const char* req = "SELECT * FROM " STORAGE_NAME STORAGE_WHERE_ID;
-            sqlite::Statement stm(this, req);
-
-            static_assert(sizeof(DummyWrapper) == sizeof(cid), "");
-            const DummyWrapper& wrp = reinterpret_cast<const DummyWrapper&>(cid);
+            size_t count = std::min(CoinsBatchSize, ids.size() - i);
+            std::string req = "SELECT " STORAGE_FIELDS " FROM " STORAGE_NAME " WHERE " + MakeCoinIDsCondition(count) + ";";
+            sqlite::Statement stm(this, req.c_str());
 
             int colIdx = 0;
-            STORAGE_BIND_ID(wrp);
+            for (size_t j = 0; j < count; ++j)
+            {
+                static_assert(sizeof(CoinIDWrapper) == sizeof(Coin::ID), "");
+                const CoinIDWrapper& wrp = reinterpret_cast<const CoinIDWrapper&>(ids[i + j]);
+                STORAGE_BIND_ID(wrp);
+            }
 
-            if (stm.step())
+            found.clear();
+            while (stm.step())
             {
-                Coin coin;
+                auto& coin = found.emplace_back();
                 colIdx = 0;
                 ENUM_ALL_STORAGE_FIELDS(STM_GET_LIST, NOSEP, coin);
-                storage::DeduceStatus(*this, coin, stateID.m_Height);
-                if (Coin::Status::Available == coin.m_status)
+            }
+
+            // restore the requested order
+            for (size_t j = 0; j < count; ++j)
+            {
+                auto it = std::find_if(found.begin(), found.end(), [&](const Coin& c) { return IsSameCoinID(c.m_ID, ids[i + j]); });
+                if (it != found.end())
                 {
-                    coins.push_back(coin);
+                    auto& coin = coins.emplace_back(*it);
+                    storage::DeduceStatus(*this, coin, h);
                 }
             }
         }
         return coins;
     }
 
+    vector<Coin> WalletDB::getCoinsByID(const CoinIDList& ids) const
+    {
+        vector<Coin> coins = findCoins(ids);
+        coins.erase(std::remove_if(coins.begin(), coins.end(), [](const Coin& c) { return c.m_status != Coin::Status::Available; }), coins.end());
+        return coins;
+    }
+
     void WalletDB::insertCoinRaw(const Coin& coin)
     {
         const char* req = "INSERT INTO " STORAGE_NAME " (" ENUM_ALL_STORAGE_FIELDS(LIST, COMMA, ) ") VALUES(" ENUM_ALL_STORAGE_FIELDS(BIND_LIST, COMMA, ) ");";
@@ -2586,6 +3075,8 @@ namespace beam::wallet
         int colIdx = 0;
         ENUM_ALL_STORAGE_FIELDS(STM_BIND_LIST, NOSEP, coin);
         stm.step();
+
+        countCoins({ coin }, true);
     }
 
     void WalletDB::insertNewCoin(Coin& coin)
@@ -2601,6 +3092,17 @@ namespace beam::wallet
 
     bool WalletDB::updateCoinRaw(const Coin& coin)
     {
+        std::vector<Coin> prev;
+        if (loadTotals())
+        {
+            Coin c;
+            c.m_ID = coin.m_ID;
+            if (findCoin(c))
+            {
+                prev.push_back(c);
+            }
+        }
+
         const char* req = "UPDATE " STORAGE_NAME " SET " ENUM_STORAGE_FIELDS(SET_LIST, COMMA, ) STORAGE_WHERE_ID  ";";
         sqlite::Statement stm(this, req);
 
@@ -2609,7 +3111,13 @@ namespace beam::wallet
         ENUM_STORAGE_ID(STM_BIND_LIST, NOSEP, coin);
         stm.step();
 
-        return sqlite3_changes(_db) > 0;
+        if (sqlite3_changes(_db) > 0)
+        {
+            countCoins(prev, false);
+            countCoins({ coin }, true);
+            return true;
+        }
+        return false;
     }
 
     bool WalletDB::saveCoinRaw(const Coin& coin)
@@ -2705,9 +3213,41 @@ namespace beam::wallet
         if (coins.empty())
             return;
 
-        for (auto& coin : coins)
+        std::vector<Coin> prev;
+        if (loadTotals())
+        {
+            CoinIDList ids;
+            ids.reserve(coins.size());
+            for (const auto& coin : coins)
+            {
+                ids.push_back(coin.m_ID);
+            }
+            prev = findCoins(ids);
+        }
+
+        // the same as saveCoinRaw, but with multi-row upserts
+        for (size_t i = 0; i < coins.size(); i += CoinsBatchSize)
+        {
+            size_t count = std::min(CoinsBatchSize, coins.size() - i);
+            std::string req = "INSERT INTO " STORAGE_NAME " (" ENUM_ALL_STORAGE_FIELDS(LIST, COMMA, ) ") VALUES "
+                + MakeValuesList("(" ENUM_ALL_STORAGE_FIELDS(BIND_LIST, COMMA, ) ")", count)
+                + " ON CONFLICT(" ENUM_STORAGE_ID(LIST, COMMA, ) ") DO UPDATE SET " ENUM_STORAGE_FIELDS(EXCLUDED_SET_LIST, COMMA, ) ";";
+            sqlite::Statement stm(this, req.c_str());
+
+            int colIdx = 0;
+            for (size_t j = 0; j < count; ++j)
+            {
+                const auto& coin = coins[i + j];
+                ENUM_ALL_STORAGE_FIELDS(STM_BIND_LIST, NOSEP, coin);
+            }
+            stm.step();
+        }
+
+        if (m_pTotals)
         {
-            saveCoinRaw(coin);
+            // only the last version of the coin is stored
+            countCoins(UniqueCoins(prev.begin(), prev.end()), false);
+            countCoins(UniqueCoins(coins.rbegin(), coins.rend()), true);
         }
 
         notifyCoinsChanged(ChangeAction::Updated, getUpdatedCoins(coins));
@@ -2741,8 +3281,28 @@ namespace beam::wallet
     {
         if (coins.size())
         {
-            for (const auto& cid : coins)
-                removeCoinImpl(cid);
+            std::vector<Coin> prev;
+            if (loadTotals())
+            {
+                prev = findCoins(coins);
+            }
+
+            for (size_t i = 0; i < coins.size(); i += CoinsBatchSize)
+            {
+                size_t count = std::min(CoinsBatchSize, coins.size() - i);
+                std::string req = "DELETE FROM " STORAGE_NAME " WHERE " + MakeCoinIDsCondition(count) + ";";
+                sqlite::Statement stm(this, req.c_str());
+
+                int colIdx = 0;
+                for (size_t j = 0; j < count; ++j)
+                {
+                    const CoinIDWrapper& wrp = reinterpret_cast<const CoinIDWrapper&>(coins[i + j]);
+                    STORAGE_BIND_ID(wrp);
+                }
+                stm.step();
+            }
+
+            countCoins(UniqueCoins(prev.begin(), prev.end()), false);
 
             notifyCoinsChanged(ChangeAction::Removed, converIDsToCoins(coins));
         }
@@ -2750,6 +3310,17 @@ namespace beam::wallet
 
     void WalletDB::removeCoinImpl(const Coin::ID& cid)
     {
+        std::vector<Coin> prev;
+        if (loadTotals())
+        {
+            Coin c;
+            c.m_ID = cid;
+            if (findCoin(c))
+            {
+                prev.push_back(c);
+            }
+        }
+
         const char* req = "DELETE FROM " STORAGE_NAME STORAGE_WHERE_ID;
         sqlite::Statement stm(this, req);
 
@@ -2764,6 +3335,8 @@ namespace beam::wallet
         STORAGE_BIND_ID(wrp)
 
         stm.step();
+
+        countCoins(prev, false);
     }
 
     void WalletDB::removeCoin(const Coin::ID& cid)
@@ -2776,13 +3349,18 @@ namespace beam::wallet
     {
         sqlite::Statement stm(this, "DELETE FROM " STORAGE_NAME ";");
         stm.step();
+        invalidateTotals();
         notifyCoinsChanged(ChangeAction::Reset, {});
     }
 
     void WalletDB::setCoinConfirmationsOffset(uint32_t offset)
     {
         setVarRaw(COIN_CONFIRMATIONS_COUNT, &offset, sizeof(uint32_t));
-        m_coinConfirmationsOffset = offset;
+        if (m_coinConfirmationsOffset != offset)
+        {
+            m_coinConfirmationsOffset = offset;
+            invalidateTotals();
+        }
     }
 
     uint32_t WalletDB::getCoinConfirmationsOffset() const
@@ -2790,6 +3368,314 @@ namespace beam::wallet
         return m_coinConfirmationsOffset;
     }
 
+    void WalletDB::getCoinTotals(storage::Totals& totals)
+    {
+        ensureTotals();
+        for (const auto& [assetId, assetTotals] : m_pTotals->allTotals)
+        {
+            totals.allTotals[assetId] = assetTotals;
+        }
+    }
+
+    bool WalletDB::loadTotals()
+    {
+        if (m_pTotals)
+            return true;
+
+        if (m_TotalsEmpty)
+            return false;
+
+        if (!IsTableCreated(this, TOTALS_NAME))
+        {
+            // not migrated yet
+            m_TotalsEmpty = true;
+            return false;
+        }
+
+        auto totals = std::make_unique<storage::Totals>();
+        bool found = false;
+        bool valid = true;
+        {
+            sqlite::Statement stm(this, "SELECT " TOTALS_FIELDS " FROM " TOTALS_NAME ";");
+            while (valid && stm.step())
+            {
+                Asset::ID assetId = 0;
+                ByteBuffer value;
+                stm.get(0, assetId);
+                stm.get(1, value);
+
+                storage::Totals::AssetTotals assetTotals;
+                valid = fromByteBuffer(value, assetTotals);
+                totals->allTotals[assetId] = assetTotals;
+                found = true;
+            }
+        }
+
+        if (!valid)
+        {
+            LOG_WARNING() << "Balance totals are corrupted and will be recalculated";
+            invalidateTotals();
+            return false;
+        }
+
+        if (!found)
+        {
+            m_TotalsEmpty = true;
+            return false;
+        }
+
+        m_pTotals = std::move(totals);
+        m_TotalsHeight = getCurrentHeight();
+        return true;
+    }
+
+    void WalletDB::ensureTotals()
+    {
+        if (loadTotals())
+            return;
+
+        m_pTotals = std::make_unique<storage::Totals>();
+        m_pTotals->InitFromCoins(*this);
+        m_TotalsHeight = getCurrentHeight();
+
+        if (m_ReadOnly)
+            return;
+
+        std::set<Asset::ID> assets;
+        for (const auto& it : m_pTotals->allTotals)
+        {
+            assets.insert(it.first);
+        }
+        saveTotals(assets);
+    }
+
+    void WalletDB::invalidateTotals()
+    {
+        m_pTotals.reset();
+        m_pSpendable.reset();
+        if (!m_TotalsEmpty && !m_ReadOnly && IsTableCreated(this, TOTALS_NAME))
+        {
+            sqlite::Statement stm(this, "DELETE FROM " TOTALS_NAME ";");
+            stm.step();
+        }
+        m_TotalsEmpty = true;
+    }
+
+    void WalletDB::saveTotals(const std::set<Asset::ID>& assets)
+    {
+        assert(m_pTotals);
+        for (auto assetId : assets)
+        {
+            auto it = m_pTotals->allTotals.find(assetId);
+            if (it == m_pTotals->allTotals.end())
+            {
+                sqlite::Statement stm(this, "DELETE FROM " TOTALS_NAME " WHERE assetId=?1;");
+                stm.bind(1, assetId);
+                stm.step();
+            }
+            else
+            {
+                sqlite::Statement stm(this, "INSERT OR REPLACE INTO " TOTALS_NAME " (" TOTALS_FIELDS ") VALUES(?1, ?2);");
+                ByteBuffer value = toByteBuffer(it->second);
+                stm.bind(1, assetId);
+                stm.bind(2, value);
+                stm.step();
+            }
+        }
+        m_TotalsEmpty = false;
+    }
+
+    void WalletDB::countCoins(const std::vector<Coin>& coins, bool add, bool existenceChanged)
+    {
+        if (coins.empty() || !loadTotals())
+            return;
+
+        std::set<Asset::ID> assets;
+        for (auto c : coins)
+        {
+            // status at the height the totals are calculated for
+            storage::DeduceStatus(*this, c, m_TotalsHeight);
+            m_pTotals->AddCoin(c, add);
+            if (m_pSpendable && (Coin::Status::Available == c.m_status))
+            {
+                m_pSpendable->Update(c, add);
+            }
+
+            auto assetId = c.m_ID.m_AssetID;
+            assets.insert(assetId);
+            if (!existenceChanged)
+                continue;
+
+            auto& totals = m_pTotals->GetTotalsRef(assetId);
+            if (add)
+            {
+                totals.MinCoinHeightMW = totals.MinCoinHeightMW == 0 ? c.m_confirmHeight :
+                                         std::min(c.m_confirmHeight, totals.MinCoinHeightMW);
+            }
+            else if (c.m_confirmHeight == totals.MinCoinHeightMW)
+            {
+                updateMinCoinHeight(assetId, false);
+            }
+        }
+        saveTotals(assets);
+    }
+
+    void WalletDB::countShieldedCoins(const std::vector<ShieldedCoin>& coins, bool add, bool existenceChanged)
+    {
+        if (coins.empty() || !loadTotals())
+            return;
+
+        std::set<Asset::ID> assets;
+        for (auto c : coins)
+        {
+            storage::DeduceStatus(*this, c, m_TotalsHeight);
+            m_pTotals->AddShieldedCoin(c, add);
+            if (m_pSpendable && (ShieldedCoin::Status::Available == c.m_Status))
+            {
+                m_pSpendable->Update(c, add);
+            }
+
+            auto assetId = c.m_CoinID.m_AssetID;
+            assets.insert(assetId);
+            if (!existenceChanged)
+                continue;
+
+            auto& totals = m_pTotals->GetTotalsRef(assetId);
+            if (add)
+            {
+                totals.MinCoinHeightShielded = totals.MinCoinHeightShielded == 0 ? c.m_confirmHeight :
+                                               std::min(c.m_confirmHeight, totals.MinCoinHeightShielded);
+            }
+            else if (c.m_confirmHeight == totals.MinCoinHeightShielded)
+            {
+                updateMinCoinHeight(assetId, true);
+            }
+        }
+        saveTotals(assets);
+    }
+
+    void WalletDB::updateMinCoinHeight(Asset::ID assetId, bool shielded)
+    {
+        // confirmHeight of unconfirmed coins is stored as -1, they count as MaxHeight
+        const char* reqMin = shielded
+            ? "SELECT confirmHeight FROM " SHIELDED_COINS_NAME " WHERE confirmHeight>=0 AND IFNULL(assetID, 0)=?1 ORDER BY confirmHeight LIMIT 1;"
+            : "SELECT confirmHeight FROM " STORAGE_NAME " WHERE confirmHeight>=0 AND IFNULL(assetId, 0)=?1 ORDER BY confirmHeight LIMIT 1;";
+        const char* reqAny = shielded
+            ? "SELECT 1 FROM " SHIELDED_COINS_NAME " WHERE IFNULL(assetID, 0)=?1 LIMIT 1;"
+            : "SELECT 1 FROM " STORAGE_NAME " WHERE IFNULL(assetId, 0)=?1 LIMIT 1;";
+
+        Height h = 0;
+        {
+            sqlite::Statement stm(this, reqMin);
+            stm.bind(1, assetId);
+            if (stm.step())
+            {
+                stm.get(0, h);
+            }
+            else
+            {
+                sqlite::Statement stm2(this, reqAny);
+                stm2.bind(1, assetId);
+                if (stm2.step())
+                {
+                    h = MaxHeight;
+                }
+            }
+        }
+
+        auto& totals = m_pTotals->GetTotalsRef(assetId);
+        (shielded ? totals.MinCoinHeightShielded : totals.MinCoinHeightMW) = h;
+
+        if (!totals.MinCoinHeightMW && !totals.MinCoinHeightShielded && assetId != Zero)
+        {
+            // no more coins
+            m_pTotals->allTotals.erase(assetId);
+        }
+    }
+
+    void WalletDB::countTxCoins(const TxID& txID, bool add)
+    {
+        if (!loadTotals())
+            return;
+
+        {
+            std::vector<Coin> coins;
+            sqlite::Statement stm(this, "SELECT " STORAGE_FIELDS " FROM " STORAGE_NAME " WHERE createTxId=?1 OR spentTxId=?1;");
+            stm.bind(1, txID);
+            while (stm.step())
+            {
+                auto& coin = coins.emplace_back();
+                int colIdx = 0;
+                ENUM_ALL_STORAGE_FIELDS(STM_GET_LIST, NOSEP, coin);
+            }
+            countCoins(coins, add, false);
+        }
+        {
+            std::vector<ShieldedCoin> coins;
+            sqlite::Statement stm(this, "SELECT " ENUM_SHIELDED_COIN_FIELDS(LIST, COMMA, ) " FROM " SHIELDED_COINS_NAME " WHERE createTxId=?1 OR spentTxId=?1;");
+            stm.bind(1, txID);
+            while (stm.step())
+            {
+                auto& coin = coins.emplace_back();
+                int colIdx = 0;
+                ENUM_SHIELDED_COIN_FIELDS(STM_GET_LIST, NOSEP, coin);
+            }
+            countShieldedCoins(coins, add, false);
+        }
+    }
+
+    void WalletDB::updateTotalsHeight(Height h)
+    {
+        if (!loadTotals() || (h == m_TotalsHeight))
+            return;
+
+        Height offset = getCoinConfirmationsOffset();
+        if (h < offset || m_TotalsHeight < offset)
+        {
+            // rare, not worth the effort
+            invalidateTotals();
+            return;
+        }
+
+        // only maturing coins change their status with height
+        Height h0 = std::min(h, m_TotalsHeight) - offset;
+        Height h1 = std::max(h, m_TotalsHeight) - offset;
+
+        std::vector<Coin> coins;
+        {
+            sqlite::Statement stm(this, "SELECT " STORAGE_FIELDS " FROM " STORAGE_NAME " WHERE maturity>?1 AND maturity<=?2 AND spentHeight<0 AND confirmHeight>=0;");
+            stm.bind(1, h0);
+            stm.bind(2, h1);
+            while (stm.step())
+            {
+                auto& coin = coins.emplace_back();
+                int colIdx = 0;
+                ENUM_ALL_STORAGE_FIELDS(STM_GET_LIST, NOSEP, coin);
+            }
+        }
+
+        std::vector<ShieldedCoin> shieldedCoins;
+        {
+            // coins confirmed above the tip are treated as mature, it's possible on rollback
+            sqlite::Statement stm(this, "SELECT " ENUM_SHIELDED_COIN_FIELDS(LIST, COMMA, ) " FROM " SHIELDED_COINS_NAME " WHERE ((confirmHeight>?1 AND confirmHeight<=?2) OR confirmHeight>?3) AND spentHeight<0 AND confirmHeight>=0;");
+            stm.bind(1, h0);
+            stm.bind(2, h1);
+            stm.bind(3, std::min(h, m_TotalsHeight));
+            while (stm.step())
+            {
+                auto& coin = shieldedCoins.emplace_back();
+                int colIdx = 0;
+                ENUM_SHIELDED_COIN_FIELDS(STM_GET_LIST, NOSEP, coin);
+            }
+        }
+
+        countCoins(coins, false, false);
+        countShieldedCoins(shieldedCoins, false, false);
+        m_TotalsHeight = h;
+        countCoins(coins, true, false);
+        countShieldedCoins(shieldedCoins, true, false);
+    }
+
     bool WalletDB::findCoin(Coin& coin)
     {
         const char* req = "SELECT " ENUM_STORAGE_FIELDS(LIST, COMMA, ) " FROM " STORAGE_NAME STORAGE_WHERE_ID;
@@ -2875,6 +3761,151 @@ namespace beam::wallet
         }
     }
 
+    void WalletDB::visitCoins(const CoinsFilter& filter, uint64_t start, int count, const std::function<bool(const Coin& coin)>& func)
+    {
+        Height h = getCurrentHeight();
+        uint32_t offset = getCoinConfirmationsOffset();
+
+        // Status depends on transactions state, so SQL selects classes of statuses by heights
+        // and the exact status is checked after deduction
+        enum StatusClass { Spent, Maturing, Confirmed, Unconfirmed, ClassCount };
+        auto getClass = [](Coin::Status status)
+        {
+            switch (status)
+            {
+            case Coin::Status::Spent:
+            case Coin::Status::Consumed: return Spent;
+            case Coin::Status::Maturing: return Maturing;
+            case Coin::Status::Available:
+            case Coin::Status::Outgoing: return Confirmed;
+            default: return Unconfirmed;
+            }
+        };
+
+        std::vector<bool> statuses(Coin::Status::count, filter.m_Statuses.empty());
+        bool exactStatus = true;
+        std::string statusCond;
+        if (!filter.m_Statuses.empty())
+        {
+            bool classes[ClassCount] = {};
+            for (auto status : filter.m_Statuses)
+            {
+                if (status < Coin::Status::count)
+                {
+                    statuses[status] = true;
+                    classes[getClass(status)] = true;
+                }
+            }
+
+            for (int status = 0; status < Coin::Status::count; ++status)
+            {
+                if (!statuses[status] && classes[getClass(static_cast<Coin::Status>(status))] && status != Coin::Status::ChangeV0)
+                    exactStatus = false;
+            }
+
+            // coins are mature when hTop - offset >= maturity, see storage::DeduceStatus
+            std::string matureCond = h < offset ? "1" : "(maturity>=0 AND maturity<=" + std::to_string(h - offset) + ")";
+            const std::string conds[ClassCount] =
+            {
+                "spentHeight>=0",
+                "(spentHeight<0 AND confirmHeight>=0 AND NOT " + matureCond + ")",
+                "(spentHeight<0 AND confirmHeight>=0 AND " + matureCond + ")",
+                "(spentHeight<0 AND confirmHeight<0)"
+            };
+
+            for (int i = 0; i < ClassCount; ++i)
+            {
+                if (!classes[i])
+                    continue;
+                statusCond += statusCond.empty() ? " AND (" : " OR ";
+                statusCond += conds[i];
+            }
+            statusCond += statusCond.empty() ? " AND 0" : ")";
+        }
+
+        std::string req = "SELECT " STORAGE_FIELDS " FROM " STORAGE_NAME " WHERE 1";
+        if (filter.m_AssetID)
+        {
+            req += *filter.m_AssetID
+                ? " AND assetId=" + std::to_string(*filter.m_AssetID)
+                : " AND (assetId=0 OR assetId IS NULL)";
+        }
+        else if (!filter.m_WithAssets)
+        {
+            req += " AND (assetId=0 OR assetId IS NULL)";
+        }
+
+        req += statusCond;
+
+        if (filter.m_MinAmount)
+            req += " AND amount>=?1";
+        if (filter.m_MaxAmount)
+            req += " AND amount<=?2";
+        // maturity of unconfirmed coins is MaxHeight, stored as -1
+        if (filter.m_MinMaturity)
+            req += " AND (maturity>=?3 OR maturity<0)";
+        if (filter.m_MaxMaturity)
+            req += " AND maturity>=0 AND maturity<=?4";
+
+        const char* dir = filter.m_Descending ? " DESC" : "";
+        switch (filter.m_SortBy)
+        {
+        case CoinsFilter::SortBy::Amount:
+            req += std::string(" ORDER BY amount") + dir + ", ROWID" + dir;
+            break;
+        case CoinsFilter::SortBy::Maturity:
+            req += std::string(" ORDER BY maturity<0") + dir + ", maturity" + dir + ", ROWID" + dir;
+            break;
+        default:
+            req += std::string(" ORDER BY ROWID") + dir;
+        }
+
+        if (exactStatus)
+        {
+            req += " LIMIT ?5 OFFSET ?6";
+        }
+        req += ";";
+
+        sqlite::Statement stm(this, req.c_str());
+        if (filter.m_MinAmount)
+            stm.bind(1, *filter.m_MinAmount);
+        if (filter.m_MaxAmount)
+            stm.bind(2, *filter.m_MaxAmount);
+        if (filter.m_MinMaturity)
+            stm.bind(3, *filter.m_MinMaturity);
+        if (filter.m_MaxMaturity)
+            stm.bind(4, *filter.m_MaxMaturity);
+        if (exactStatus)
+        {
+            stm.bind(5, count);
+            stm.bind(6, start);
+            start = 0;
+        }
+
+        for (int visited = 0; visited < count && stm.step(); )
+        {
+            Coin coin;
+
+            int colIdx = 0;
+            ENUM_ALL_STORAGE_FIELDS(STM_GET_LIST, NOSEP, coin);
+
+            storage::DeduceStatus(*this, coin, h);
+
+            if (!statuses[coin.m_status])
+                continue;
+
+            if (start)
+            {
+                --start;
+                continue;
+            }
+
+            ++visited;
+            if (!func(coin))
+                break;
+        }
+    }
+
     void WalletDB::setVarRaw(const char* name, const void* data, size_t size)
     {
         const char* req = "INSERT or REPLACE INTO " VARIABLES_NAME " (" VARIABLES_FIELDS ") VALUES(?1, ?2);";
@@ -2952,6 +3983,7 @@ namespace beam::wallet
 
     void WalletDB::setSystemStateID(const Block::SystemState::ID& stateID)
     {
+        updateTotalsHeight(stateID.m_Height);
         storage::setVar(*this, SystemStateIDName, stateID);
         storage::setVar(*this, LastUpdateTimeName, getTimestamp());
         notifySystemStateChanged(stateID);
@@ -2988,6 +4020,12 @@ namespace beam::wallet
         }
         if (!changedRows.empty())
         {
+            std::vector<Coin> prev;
+            if (loadTotals())
+            {
+                prev = getCoinsByRowIDs(changedRows);
+            }
+
             {
                 const char* req = "UPDATE " STORAGE_NAME " SET confirmHeight=?1 WHERE confirmHeight > ?2;";
                 sqlite::Statement stm(this, req);
@@ -3003,8 +4041,11 @@ namespace beam::wallet
                 stm.bind(2, minHeight);
                 stm.step();
             }
- 
-            notifyCoinsChanged(ChangeAction::Updated, getCoinsByRowIDs(changedRows));
+
+            auto coins = getCoinsByRowIDs(changedRows);
+            countCoins(prev, false);
+            countCoins(coins, true);
+            notifyCoinsChanged(ChangeAction::Updated, coins);
         }
     }
 
@@ -3087,6 +4128,7 @@ namespace beam::wallet
     {
         sqlite::Statement stm(this, "DELETE FROM " SHIELDED_COINS_NAME ";");
         stm.step();
+        invalidateTotals();
         notifyShieldedCoinsChanged(ChangeAction::Reset, {});
     }
 
@@ -3154,10 +4196,21 @@ namespace beam::wallet
        
         ENUM_SHIELDED_COIN_FIELDS(STM_BIND_LIST, NOSEP, coin);
         stm.step();
+
+        countShieldedCoins({ coin }, true);
     }
 
     bool WalletDB::updateShieldedCoinRaw(const ShieldedCoin& coin)
     {
+        std::vector<ShieldedCoin> prev;
+        if (loadTotals())
+        {
+            if (auto c = getShieldedCoin(coin.m_CoinID.m_Key); c)
+            {
+                prev.push_back(*c);
+            }
+        }
+
         const char* req = "UPDATE " SHIELDED_COINS_NAME " SET " ENUM_SHIELDED_COIN_FIELDS(SET_LIST, COMMA, ) "WHERE Key = ?;";
         sqlite::Statement stm(this, req);
         int colIdx = 0;
@@ -3166,7 +4219,13 @@ namespace beam::wallet
         stm.bind(++colIdx, coin.m_CoinID.m_Key);
         stm.step();
 
-        return sqlite3_changes(_db) > 0;
+        if (sqlite3_changes(_db) > 0)
+        {
+            countShieldedCoins(prev, false);
+            countShieldedCoins({ coin }, true);
+            return true;
+        }
+        return false;
     }
 
     void WalletDB::saveShieldedCoinRaw(const ShieldedCoin& coin)
@@ -3184,65 +4243,69 @@ namespace beam::wallet
 
     vector<TxDescription> WalletDB::getTxHistory(wallet::TxType txType, uint64_t start, int count) const
     {
-        // TODO this is temporary solution
-        int txCount = 0;
+        TxHistoryFilter filter;
+        if (txType != wallet::TxType::ALL)
         {
-            std::string req = "SELECT COUNT(DISTINCT txID) FROM " TX_PARAMS_NAME " WHERE paramID = ?1";
-            req += (txType != wallet::TxType::ALL) ? " AND value = ?2 ;" : " ;";
+            filter.m_Types.push_back(txType);
+        }
+        return getTxHistory(filter, start, count);
+    }
 
-            sqlite::Statement stm(this, req.c_str());
-            stm.bind(1, wallet::TxParameterID::TransactionType);
+    vector<TxDescription> WalletDB::getTxHistory(const TxHistoryFilter& filter, uint64_t start, int count) const
+    {
+        // conditions are integers, they are inlined to let sqlite choose the index
+        std::string req = "SELECT txID FROM " TX_SUMMARY_NAME " WHERE flags=" + std::to_string(TxSummary::Complete);
 
-            ByteBuffer typeBlob;
-            if (txType != wallet::TxType::ALL)
+        if (!filter.m_Types.empty())
+        {
+            req += " AND txType IN (";
+            for (size_t i = 0; i < filter.m_Types.size(); ++i)
             {
-                typeBlob = toByteBuffer(txType);
-                stm.bind(2, typeBlob);
+                if (i)
+                    req += ",";
+                req += std::to_string(underlying_cast(filter.m_Types[i]));
             }
-
-            stm.step();
-            stm.get(0, txCount);
+            req += ")";
         }
 
-        vector<TxDescription> res;
-        if (txCount > 0)
+        if (filter.m_Status)
         {
-            res.reserve(static_cast<size_t>(min(txCount, count)));
-            std::string req = "SELECT DISTINCT txID FROM " TX_PARAMS_NAME;
+            req += " AND status=" + std::to_string(underlying_cast(*filter.m_Status));
+        }
 
-            if (txType != wallet::TxType::ALL)
-            {
-                req += " WHERE paramID = ?3 AND value = ?4";
-            }
+        if (filter.m_AssetID)
+        {
+            req += " AND assetId=" + std::to_string(*filter.m_AssetID);
+        }
 
-            req += " LIMIT ?1 OFFSET ?2 ;";
+        if (filter.m_ProofHeight)
+        {
+            req += " AND (CASE txType WHEN " + std::to_string(underlying_cast(TxType::AssetInfo))
+                + " THEN assetConfirmedHeight ELSE kernelProofHeight END)=" + std::to_string(*filter.m_ProofHeight);
+        }
 
-            sqlite::Statement stm(this, req.c_str());
-            stm.bind(1, count);
-            stm.bind(2, start);
+        req += filter.m_OrderByMinHeight
+            ? " ORDER BY minHeight DESC, createTime DESC, txID"
+            : " ORDER BY createTime DESC, txID";
+        req += " LIMIT ?1 OFFSET ?2;";
 
-            ByteBuffer typeBlob;
-            if (txType != wallet::TxType::ALL)
-            {
-                stm.bind(3, wallet::TxParameterID::TransactionType);
-                typeBlob = toByteBuffer(txType);
-                stm.bind(4, typeBlob);
-            }
+        sqlite::Statement stm(this, req.c_str());
+        stm.bind(1, count);
+        stm.bind(2, start);
 
-            const char* gtParamReq = "SELECT * FROM " TX_PARAMS_NAME " WHERE txID=?1;";
-            sqlite::Statement stm2(this, gtParamReq);
+        const char* gtParamReq = "SELECT * FROM " TX_PARAMS_NAME " WHERE txID=?1;";
+        sqlite::Statement stm2(this, gtParamReq);
 
-            while (stm.step())
+        vector<TxDescription> res;
+        while (stm.step())
+        {
+            TxID txID;
+            stm.get(0, txID);
+            auto t = getTxImpl(txID, stm2);
+            if (t.is_initialized())
             {
-                TxID txID;
-                stm.get(0, txID);
-                auto t = getTxImpl(txID, stm2);
-                if (t.is_initialized())
-                {
-                    res.emplace_back(*t);
-                }
+                res.emplace_back(*t);
             }
-            sort(res.begin(), res.end(), [](const auto& left, const auto& right) {return left.m_createTime > right.m_createTime; });
         }
 
         return res;
@@ -3297,23 +4360,33 @@ namespace beam::wallet
     {
         ChangeAction action = ChangeAction::Added;
 
-        storage::setTxParameter(*this, p.m_txId, TxParameterID::TransactionType, p.m_txType, false);
-        storage::setTxParameter(*this, p.m_txId, TxParameterID::Amount, p.m_amount, false);
-        storage::setTxParameter(*this, p.m_txId, TxParameterID::Fee, p.m_fee, false);
-        storage::setTxParameter(*this, p.m_txId, TxParameterID::AssetID, p.m_assetId, false);
-        storage::setTxParameter(*this, p.m_txId, TxParameterID::AssetMetadata, p.m_assetMeta, false);
+        std::vector<TxParameter> params;
+        auto add = [&](TxParameterID paramID, const auto& value)
+        {
+            auto& param = params.emplace_back();
+            param.m_txID = p.m_txId;
+            param.m_paramID = static_cast<int>(paramID);
+            param.m_value = toByteBuffer(value);
+        };
+
+        add(TxParameterID::TransactionType, p.m_txType);
+        add(TxParameterID::Amount, p.m_amount);
+        add(TxParameterID::Fee, p.m_fee);
+        add(TxParameterID::AssetID, p.m_assetId);
+        add(TxParameterID::AssetMetadata, p.m_assetMeta);
         if (p.m_minHeight)
         {
-            storage::setTxParameter(*this, p.m_txId, TxParameterID::MinHeight, p.m_minHeight, false);
+            add(TxParameterID::MinHeight, p.m_minHeight);
         }
-        storage::setTxParameter(*this, p.m_txId, TxParameterID::PeerID, p.m_peerId, false);
-        storage::setTxParameter(*this, p.m_txId, TxParameterID::MyID, p.m_myId, false);
-        storage::setTxParameter(*this, p.m_txId, TxParameterID::Message, p.m_message, false);
-        storage::setTxParameter(*this, p.m_txId, TxParameterID::CreateTime, p.m_createTime, false);
-        storage::setTxParameter(*this, p.m_txId, TxParameterID::ModifyTime, p.m_modifyTime, false);
-        storage::setTxParameter(*this, p.m_txId, TxParameterID::IsSender, p.m_sender, false);
-        storage::setTxParameter(*this, p.m_txId, TxParameterID::Status, p.m_status, false);
-        storage::setTxParameter(*this, p.m_txId, TxParameterID::IsSelfTx, p.m_selfTx, false);
+        add(TxParameterID::PeerID, p.m_peerId);
+        add(TxParameterID::MyID, p.m_myId);
+        add(TxParameterID::Message, p.m_message);
+        add(TxParameterID::CreateTime, p.m_createTime);
+        add(TxParameterID::ModifyTime, p.m_modifyTime);
+        add(TxParameterID::IsSender, p.m_sender);
+        add(TxParameterID::Status, p.m_status);
+        add(TxParameterID::IsSelfTx, p.m_selfTx);
+        setTxParameters(params, false);
 
         // notify only when full TX saved
         notifyTransactionChanged(action, {p});
@@ -3324,6 +4397,8 @@ namespace beam::wallet
         auto tx = getTx(txId);
         if (tx.is_initialized())
         {
+            countTxCoins(txId, false);
+
             // we left one record about tx type in order to avoid re-launching of deleted transaction
             const char* req = "DELETE FROM " TX_PARAMS_NAME " WHERE txID=?1 AND paramID!=?2;";
             sqlite::Statement stm(this, req);
@@ -3333,6 +4408,18 @@ namespace beam::wallet
 
             stm.step();
             deleteParametersFromCache(txId);
+            countTxCoins(txId, true);
+
+            {
+                sqlite::Statement stm2(this, "DELETE FROM " TX_SUMMARY_NAME " WHERE txID=?1;");
+                stm2.bind(1, txId);
+                stm2.step();
+            }
+            ByteBuffer typeBlob;
+            if (getTxParameter(txId, kDefaultSubTxID, TxParameterID::TransactionType, typeBlob))
+            {
+                updateTxSummary(txId, TxParameterID::TransactionType, &typeBlob);
+            }
             notifyTransactionChanged(ChangeAction::Removed, { *tx });
         }
     }
@@ -3352,13 +4439,23 @@ namespace beam::wallet
         }
         if (!updatedRows.empty())
         {
+            std::vector<Coin> prev;
+            if (loadTotals())
+            {
+                prev = getCoinsByRowIDs(updatedRows);
+            }
+
             {
                 const char* req = "UPDATE " STORAGE_NAME " SET spentTxId=NULL WHERE spentTxId=?1;";
                 sqlite::Statement stm(this, req);
                 stm.bind(1, txId);
                 stm.step();
             }
-            notifyCoinsChanged(ChangeAction::Updated, getCoinsByRowIDs(updatedRows));
+
+            auto coins = getCoinsByRowIDs(updatedRows);
+            countCoins(prev, false);
+            countCoins(coins, true);
+            notifyCoinsChanged(ChangeAction::Updated, coins);
         }
     }
 
@@ -3385,6 +4482,8 @@ namespace beam::wallet
             stm.bind(2, MaxHeight);
             stm.step();
 
+            countCoins(deletedItems, false);
+
             notifyCoinsChanged(ChangeAction::Removed, deletedItems);
         }
     }
@@ -3404,6 +4503,15 @@ namespace beam::wallet
         }
         if (!updatedRows.empty())
         {
+            std::vector<ShieldedCoin> prev;
+            if (loadTotals())
+            {
+                for (const auto& key : updatedRows)
+                {
+                    prev.push_back(getShieldedCoin(key).value());
+                }
+            }
+
             {
                 const char* req = "UPDATE " SHIELDED_COINS_NAME " SET spentTxId=NULL WHERE spentTxId=?1;";
                 sqlite::Statement stm(this, req);
@@ -3421,16 +4529,29 @@ namespace beam::wallet
                 storage::DeduceStatus(*this, coin, currentHeight);
             }
 
+            countShieldedCoins(prev, false);
+            countShieldedCoins(updatedCoins, true);
             notifyShieldedCoinsChanged(ChangeAction::Updated, updatedCoins);
         }
     }
 
     void WalletDB::DeleteShieldedCoin(const ShieldedTxo::BaseKey& key)
     {
+        std::vector<ShieldedCoin> prev;
+        if (loadTotals())
+        {
+            if (auto c = getShieldedCoin(key); c)
+            {
+                prev.push_back(*c);
+            }
+        }
+
         const char* req = "DELETE FROM " SHIELDED_COINS_NAME " WHERE Key=?1;";
         sqlite::Statement stm(this, req);
         stm.bind(1, key);
         stm.step();
+
+        countShieldedCoins(prev, false);
     }
 
     void WalletDB::deleteShieldedCoinsCreatedByTx(const TxID& txId)
@@ -3501,20 +4622,35 @@ namespace beam::wallet
         const std::string addrTableName =
             isLaser ? LASER_ADDRESSES_NAME : ADDRESSES_NAME;
         vector<WalletAddress> res;
-        auto req = "SELECT * FROM " + addrTableName + " ORDER BY createTime DESC;";
+        auto req = "SELECT * FROM " + addrTableName + (own ? " WHERE OwnID<>0" : " WHERE OwnID=0") + " ORDER BY createTime DESC;";
         sqlite::Statement stm(this, req.c_str());
 
         while (stm.step())
         {
             auto& a = res.emplace_back();
             loadAddress(this, stm, a);
-
-            if (a.isOwn() != own)
-                res.pop_back(); // akward, but ok
         }
         return res;
     }
 
+    void WalletDB::visitAddresses(bool own, uint64_t start, int count, const std::function<bool(const WalletAddress&)>& func) const
+    {
+        const char* req = own
+            ? "SELECT * FROM " ADDRESSES_NAME " WHERE OwnID<>0 ORDER BY createTime DESC LIMIT ?1 OFFSET ?2;"
+            : "SELECT * FROM " ADDRESSES_NAME " WHERE OwnID=0 ORDER BY createTime DESC LIMIT ?1 OFFSET ?2;";
+        sqlite::Statement stm(this, req);
+        stm.bind(1, count);
+        stm.bind(2, start);
+
+        while (stm.step())
+        {
+            WalletAddress a;
+            loadAddress(this, stm, a);
+            if (!func(a))
+                break;
+        }
+    }
+
     void WalletDB::saveAddress(const WalletAddress& address, bool isLaser)
     {
         const std::string addrTableName =
@@ -4052,6 +5188,7 @@ namespace beam::wallet
 
     void WalletDB::changePassword(const SecString& password)
     {
+        m_pStatementCache->clear();
         int ret = sqlite3_rekey(_db, password.data(), static_cast<int>(password.size()));
         throwIfError(ret, _db);
     }
@@ -4072,6 +5209,9 @@ namespace beam::wallet
             }
         }
 
+        // coin statuses depend on the tx status
+        bool affectsTotals = (subTxID == kDefaultSubTxID) && (paramID == TxParameterID::Status);
+
         bool hasTx = hasTransaction(txID);
         {
             sqlite::Statement stm(this, "SELECT * FROM " TX_PARAMS_NAME " WHERE txID=?1 AND subTxID=?2 AND paramID=?3;");
@@ -4086,6 +5226,11 @@ namespace beam::wallet
                 if (!allowModify)
                     return false;
 
+                if (affectsTotals)
+                {
+                    countTxCoins(txID, false);
+                }
+
                 sqlite::Statement stm2(this, "UPDATE " TX_PARAMS_NAME  " SET value = ?4 WHERE txID = ?1 AND subTxID=?2 AND paramID = ?3;");
                 stm2.bind(1, txID);
                 stm2.bind(2, subTxID);
@@ -4093,6 +5238,17 @@ namespace beam::wallet
                 stm2.bind(4, blob);
                 stm2.step();
 
+                if (subTxID == kDefaultSubTxID)
+                {
+                    updateTxSummary(txID, paramID, &blob);
+                }
+
+                insertParameterToCache(txID, subTxID, paramID, blob);
+                if (affectsTotals)
+                {
+                    countTxCoins(txID, true);
+                }
+
                 if (shouldNotifyAboutChanges)
                 {
                     auto tx = getTx(txID);
@@ -4101,11 +5257,15 @@ namespace beam::wallet
                         notifyTransactionChanged(ChangeAction::Updated, { *tx });
                     }
                 }
-                insertParameterToCache(txID, subTxID, paramID, blob);
                 return true;
             }
         }
         
+        if (affectsTotals)
+        {
+            countTxCoins(txID, false);
+        }
+
         sqlite::Statement stm(this, "INSERT INTO " TX_PARAMS_NAME " (" ENUM_TX_PARAMS_FIELDS(LIST, COMMA, ) ") VALUES(" ENUM_TX_PARAMS_FIELDS(BIND_LIST, COMMA, ) ");");
         TxParameter parameter;
         parameter.m_txID = txID;
@@ -4115,6 +5275,15 @@ namespace beam::wallet
         int colIdx = 0;
         ENUM_TX_PARAMS_FIELDS(STM_BIND_LIST, NOSEP, parameter);
         stm.step();
+        if (subTxID == kDefaultSubTxID)
+        {
+            updateTxSummary(txID, paramID, &blob);
+        }
+        insertParameterToCache(txID, subTxID, paramID, blob);
+        if (affectsTotals)
+        {
+            countTxCoins(txID, true);
+        }
         if (shouldNotifyAboutChanges)
         {
             auto tx = getTx(txID);
@@ -4123,12 +5292,87 @@ namespace beam::wallet
                 notifyTransactionChanged(hasTx ? ChangeAction::Updated : ChangeAction::Added, { *tx });
             }
         }
-        insertParameterToCache(txID, subTxID, paramID, blob);
         return true;
     }
 
+    void WalletDB::setTxParameters(const std::vector<TxParameter>& params, bool shouldNotifyAboutChanges)
+    {
+        if (params.empty())
+            return;
+
+        std::vector<std::pair<TxID, bool>> txs; // with existence before the update
+        std::set<TxID> statusTxs;
+        for (const auto& p : params)
+        {
+            if (std::none_of(txs.begin(), txs.end(), [&p](const auto& x) { return x.first == p.m_txID; }))
+            {
+                txs.emplace_back(p.m_txID, hasTransaction(p.m_txID));
+            }
+            if (p.m_subTxID == kDefaultSubTxID && p.m_paramID == static_cast<int>(TxParameterID::Status))
+            {
+                statusTxs.insert(p.m_txID);
+            }
+        }
+
+        for (const auto& txID : statusTxs)
+        {
+            countTxCoins(txID, false);
+        }
+
+        for (size_t i = 0; i < params.size(); i += TxParamsBatchSize)
+        {
+            size_t count = std::min(TxParamsBatchSize, params.size() - i);
+            std::string req = "INSERT INTO " TX_PARAMS_NAME " (" TX_PARAMS_FIELDS ") VALUES "
+                + MakeValuesList("(" ENUM_TX_PARAMS_FIELDS(BIND_LIST, COMMA, ) ")", count)
+                + " ON CONFLICT(txID, subTxID, paramID) DO UPDATE SET value=excluded.value;";
+            sqlite::Statement stm(this, req.c_str());
+
+            int colIdx = 0;
+            for (size_t j = 0; j < count; ++j)
+            {
+                const auto& parameter = params[i + j];
+                ENUM_TX_PARAMS_FIELDS(STM_BIND_LIST, NOSEP, parameter);
+            }
+            stm.step();
+        }
+
+        for (const auto& p : params)
+        {
+            auto subTxID = static_cast<SubTxID>(p.m_subTxID);
+            auto paramID = static_cast<TxParameterID>(p.m_paramID);
+            if (subTxID == kDefaultSubTxID)
+            {
+                updateTxSummary(p.m_txID, paramID, &p.m_value);
+            }
+            insertParameterToCache(p.m_txID, subTxID, paramID, p.m_value);
+        }
+
+        for (const auto& txID : statusTxs)
+        {
+            countTxCoins(txID, true);
+        }
+
+        if (shouldNotifyAboutChanges)
+        {
+            for (const auto& [txID, hasTx] : txs)
+            {
+                auto tx = getTx(txID);
+                if (tx.is_initialized())
+                {
+                    notifyTransactionChanged(hasTx ? ChangeAction::Updated : ChangeAction::Added, { *tx });
+                }
+            }
+        }
+    }
+
     bool WalletDB::delTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID)
     {
+        bool affectsTotals = (subTxID == kDefaultSubTxID) && (paramID == TxParameterID::Status);
+        if (affectsTotals)
+        {
+            countTxCoins(txID, false);
+        }
+
         if (auto txIter = m_TxParametersCache.find(txID); txIter != m_TxParametersCache.end())
         {
             if (auto subTxIter = txIter->second.find(subTxID); subTxIter != txIter->second.end())
@@ -4148,9 +5392,50 @@ namespace beam::wallet
 
         stm.step();
 
+        if (subTxID == kDefaultSubTxID)
+        {
+            updateTxSummary(txID, paramID, nullptr);
+        }
+
+        if (affectsTotals)
+        {
+            countTxCoins(txID, true);
+        }
+
         return true;
     }
 
+    void WalletDB::updateTxSummary(const TxID& txID, TxParameterID paramID, const ByteBuffer* blob)
+    {
+        if (!TxSummary::IsSummaryParam(paramID))
+        {
+            return;
+        }
+
+        TxSummary summary;
+        summary.m_txID = txID;
+        {
+            sqlite::Statement stm(this, "SELECT " TX_SUMMARY_FIELDS " FROM " TX_SUMMARY_NAME " WHERE txID=?1;");
+            stm.bind(1, txID);
+            if (stm.step())
+            {
+                int colIdx = 0;
+                ENUM_TX_SUMMARY_FIELDS(STM_GET_LIST, NOSEP, summary);
+            }
+            else if (!blob)
+            {
+                return;
+            }
+        }
+
+        summary.Apply(paramID, blob);
+
+        sqlite::Statement stm(this, "INSERT OR REPLACE INTO " TX_SUMMARY_NAME " (" TX_SUMMARY_FIELDS ") VALUES(" ENUM_TX_SUMMARY_FIELDS(BIND_LIST, COMMA, ) ");");
+        int colIdx = 0;
+        ENUM_TX_SUMMARY_FIELDS(STM_BIND_LIST, NOSEP, summary);
+        stm.step();
+    }
+
     bool WalletDB::getTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID, ByteBuffer& blob) const
     {
         if (auto txIter = m_TxParametersCache.find(txID); txIter != m_TxParametersCache.end())
@@ -4239,6 +5524,44 @@ namespace beam::wallet
         }
     }
 
+    void WalletDB::enableWAL()
+    {
+        // journal mode can't be changed inside of the transaction
+        if (m_FlushTimer)
+        {
+            m_FlushTimer->cancel();
+        }
+        onFlushTimer();
+
+        int ret = sqlite3_exec(_db, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+        throwIfError(ret, _db);
+    }
+
+    void WalletDB::syncReadOnly()
+    {
+        assert(m_ReadOnly);
+
+        int dataVersion = 0;
+        {
+            sqlite::Statement stm(this, "PRAGMA data_version;");
+            if (stm.step())
+            {
+                stm.get(0, dataVersion);
+            }
+        }
+
+        if (dataVersion == m_DataVersion)
+            return;
+
+        m_DataVersion = dataVersion;
+        m_TxParametersCache.clear();
+        m_AddressesCache.clear();
+        m_pTotals.reset();
+        m_pSpendable.reset();
+        m_TotalsEmpty = false;
+        getVarRaw(COIN_CONFIRMATIONS_COUNT, &m_coinConfirmationsOffset, sizeof(uint32_t));
+    }
+
     void WalletDB::rollbackDB()
     {
         if (m_IsFlushPending)
@@ -4251,6 +5574,11 @@ namespace beam::wallet
                 m_DbTransaction->rollback();
                 m_DbTransaction.reset();
             }
+
+            // persisted totals are rolled back as well
+            m_pTotals.reset();
+            m_pSpendable.reset();
+            m_TotalsEmpty = false;
         }
     }
 
@@ -4283,7 +5611,7 @@ namespace beam::wallet
 
     void WalletDB::onPrepareToModify()
     {
-        if (!m_DbTransaction)
+        if (!m_DbTransaction && !m_ReadOnly)
         {
             m_DbTransaction.reset(new sqlite::Transaction(_db));
         }
@@ -4391,6 +5719,18 @@ namespace beam::wallet
 
         stm.step();
 
+        if (m_pSpendable)
+        {
+            for (auto& [assetId, coins] : m_pSpendable->m_Std)
+            {
+                for (auto& x : coins)
+                {
+                    if (x.second.m_sessionId == session)
+                        x.second.m_sessionId = 0;
+                }
+            }
+        }
+
         return sqlite3_changes(_db) > 0;
     }
 
@@ -4632,130 +5972,160 @@ namespace beam::wallet
 
         void Totals::Init(IWalletDB& walletDB)
         {
-            auto getTotalsRef = [this](Asset::ID assetId) -> AssetTotals& {
-                if (allTotals.find(assetId) == allTotals.end()) {
-                    allTotals[assetId] = AssetTotals();
-                    allTotals[assetId].AssetId = assetId;
+            walletDB.getCoinTotals(*this);
+
+            walletDB.visitAssets([this](const WalletAsset& asset) -> bool {
+                // we also add owned assets to totals even if there are no coins for owned assets
+                if(!HasTotals(asset.m_ID) && asset.m_IsOwned)
+                {
+                    allTotals[asset.m_ID] = AssetTotals();
+                    allTotals[asset.m_ID].AssetId = asset.m_ID;
                 }
-                return allTotals[assetId];
-            };
+                return true;
+             });
+        }
 
-            walletDB.visitCoins([getTotalsRef] (const Coin& c) -> bool
+        void Totals::InitFromCoins(IWalletDB& walletDB)
+        {
+            walletDB.visitCoins([this] (const Coin& c) -> bool
             {
-                auto& totals = getTotalsRef(c.m_ID.m_AssetID);
+                auto& totals = GetTotalsRef(c.m_ID.m_AssetID);
                 totals.MinCoinHeightMW = totals.MinCoinHeightMW == 0 ? c.m_confirmHeight :
                                          std::min(c.m_confirmHeight, totals.MinCoinHeightMW);
+                AddCoin(c);
+                return true;
+            });
 
-                const AmountBig::Type value = c.m_ID.m_Value;
-                switch (c.m_status)
-                {
-                case Coin::Status::Available:
-                    totals.Avail += value;
-                    totals.Unspent += value;
-                    switch (c.m_ID.m_Type)
-                    {
-                    case Key::Type::Coinbase:
-                        assert(!c.isAsset());
-                        totals.AvailCoinbase += value;
-                        break;
-                    case Key::Type::Comission:
-                        assert(!c.isAsset());
-                        totals.AvailFee += value;
-                        break;
-                    default: // suppress warning
-                        break;
-                    }
-                    break;
-
-                case Coin::Status::Maturing:
-                    totals.Maturing += value;
-                    totals.Unspent += value;
-                    break;
-
-                case Coin::Status::Incoming:
-                    totals.Incoming += value;
-                    if (c.m_ID.m_Type == Key::Type::Change)
-                    {
-                        totals.ReceivingChange += value;
-                    }
-                    else
-                    {
-                        totals.ReceivingIncoming += value;
-                    }
-                    break;
-
-                case Coin::Status::Outgoing:
-                    totals.Outgoing += value;
-                    break;
+            walletDB.visitShieldedCoins([this](const ShieldedCoin& c) -> bool {
+                auto& totals = GetTotalsRef(c.m_CoinID.m_AssetID);
+                totals.MinCoinHeightShielded = totals.MinCoinHeightShielded == 0 ? c.m_confirmHeight :
+                                               std::min(c.m_confirmHeight, totals.MinCoinHeightShielded);
+                AddShieldedCoin(c);
+                return true;
+            });
+        }
 
-                case Coin::Status::Unavailable:
-                    totals.Unavail += value;
-                    break;
+        void Totals::AddCoin(const Coin& c, bool add)
+        {
+            auto& totals = GetTotalsRef(c.m_ID.m_AssetID);
 
-                default: // suppress warning
-                    break;
-                }
+            AmountBig::Type value = c.m_ID.m_Value;
+            if (!add)
+            {
+                value.Negate();
+            }
 
+            switch (c.m_status)
+            {
+            case Coin::Status::Available:
+                totals.Avail += value;
+                totals.Unspent += value;
                 switch (c.m_ID.m_Type)
                 {
                 case Key::Type::Coinbase:
                     assert(!c.isAsset());
-                    totals.Coinbase += value;
+                    totals.AvailCoinbase += value;
                     break;
                 case Key::Type::Comission:
                     assert(!c.isAsset());
-                    totals.Fee += value;
+                    totals.AvailFee += value;
                     break;
                 default: // suppress warning
                     break;
                 }
-                return true;
-            });
+                break;
 
-            walletDB.visitShieldedCoins([getTotalsRef](const ShieldedCoin& c) -> bool {
-                auto& totals = getTotalsRef(c.m_CoinID.m_AssetID);
-                totals.MinCoinHeightShielded = totals.MinCoinHeightShielded == 0 ? c.m_confirmHeight :
-                                               std::min(c.m_confirmHeight, totals.MinCoinHeightShielded);
+            case Coin::Status::Maturing:
+                totals.Maturing += value;
+                totals.Unspent += value;
+                break;
 
-                const AmountBig::Type value = c.m_CoinID.m_Value;
-                switch(c.m_Status) {
-                    case ShieldedCoin::Status::Available:
-                        if (AmountBig::get_Lo(value) > Transaction::FeeSettings::MinShieldedFee)  // shielded dust
-                        {
-                            totals.AvailShielded += value;
-                            totals.UnspentShielded += value;
-                        }
-                        break;
-                    case ShieldedCoin::Status::Maturing:
-                        totals.MaturingShielded += value;
-                        totals.UnspentShielded += value;
-                        break;
-                    case ShieldedCoin::Status::Unavailable:
-                        totals.UnavailShielded += value;
-                        break;
-                    case ShieldedCoin::Status::Outgoing:
-                        totals.OutgoingShielded += value;
-                        break;
-                    case ShieldedCoin::Status::Incoming:
-                        totals.IncomingShielded += value;
-                        break;
-                    case ShieldedCoin::Status::Spent:
-                        break; // this is not necessary
-                    default:
-                        assert(false); // should never happen
+            case Coin::Status::Incoming:
+                totals.Incoming += value;
+                if (c.m_ID.m_Type == Key::Type::Change)
+                {
+                    totals.ReceivingChange += value;
                 }
-                return true;
-            });
-
-             walletDB.visitAssets([this](const WalletAsset& asset) -> bool {
-                // we also add owned assets to totals even if there are no coins for owned assets
-                if(!HasTotals(asset.m_ID) && asset.m_IsOwned)
+                else
                 {
-                    allTotals[asset.m_ID] = AssetTotals();
-                    allTotals[asset.m_ID].AssetId = asset.m_ID;
+                    totals.ReceivingIncoming += value;
                 }
-                return true;
-             });
+                break;
+
+            case Coin::Status::Outgoing:
+                totals.Outgoing += value;
+                break;
+
+            case Coin::Status::Unavailable:
+                totals.Unavail += value;
+                break;
+
+            default: // suppress warning
+                break;
+            }
+
+            switch (c.m_ID.m_Type)
+            {
+            case Key::Type::Coinbase:
+                assert(!c.isAsset());
+                totals.Coinbase += value;
+                break;
+            case Key::Type::Comission:
+                assert(!c.isAsset());
+                totals.Fee += value;
+                break;
+            default: // suppress warning
+                break;
+            }
+        }
+
+        void Totals::AddShieldedCoin(const ShieldedCoin& c, bool add)
+        {
+            auto& totals = GetTotalsRef(c.m_CoinID.m_AssetID);
+
+            AmountBig::Type value = c.m_CoinID.m_Value;
+            if (!add)
+            {
+                value.Negate();
+            }
+
+            switch(c.m_Status) {
+                case ShieldedCoin::Status::Available:
+                    if (c.m_CoinID.m_Value > Transaction::FeeSettings::MinShieldedFee)  // shielded dust
+                    {
+                        totals.AvailShielded += value;
+                        totals.UnspentShielded += value;
+                    }
+                    break;
+                case ShieldedCoin::Status::Maturing:
+                    totals.MaturingShielded += value;
+                    totals.UnspentShielded += value;
+                    break;
+                case ShieldedCoin::Status::Unavailable:
+                    totals.UnavailShielded += value;
+                    break;
+                case ShieldedCoin::Status::Outgoing:
+                    totals.OutgoingShielded += value;
+                    break;
+                case ShieldedCoin::Status::Incoming:
+                    totals.IncomingShielded += value;
+                    break;
+                case ShieldedCoin::Status::Spent:
+                    break; // this is not necessary
+                default:
+                    assert(false); // should never happen
+            }
+        }
+
+        Totals::AssetTotals& Totals::GetTotalsRef(Asset::ID assetId)
+        {
+            auto it = allTotals.find(assetId);
+            if (it == allTotals.end())
+            {
+                it = allTotals.emplace(assetId, AssetTotals()).first;
+                it->second.AssetId = assetId;
+            }
+            return it->second;
         }
 
         Totals::AssetTotals Totals::GetTotals(Asset::ID assetId) const
@@ -5107,15 +6477,13 @@ namespace beam::wallet
                         }
                     }
                     
+                    std::vector<TxParameter> params;
+                    params.reserve(paramsMap.size());
                     for (const auto& paramPair : paramsMap)
                     {
-                        const auto& p = paramPair.second;
-                        db.setTxParameter(p.m_txID,
-                            static_cast<SubTxID>(p.m_subTxID),
-                            paramPair.first,
-                            p.m_value,
-                            true);
+                        params.push_back(paramPair.second);
                     }
+                    db.setTxParameters(params, true);
                     LOG_INFO() << "Transaction " << txPair.first << " was imported.";
                 }
                 return true;
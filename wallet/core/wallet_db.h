@@ -203,6 +203,37 @@ namespace beam::wallet
         ByteBuffer m_value;
     };
 
+    // Conditions for indexed transaction history queries
+    struct TxHistoryFilter
+    {
+        std::vector<TxType> m_Types; // empty means any type
+        boost::optional<TxStatus> m_Status;
+        boost::optional<Asset::ID> m_AssetID;
+        boost::optional<Height> m_ProofHeight; // see storage::DeduceTxProofHeight
+        bool m_OrderByMinHeight = false; // otherwise by create time, newest first
+    };
+
+    // Conditions for coin queries, evaluated in SQL where possible
+    struct CoinsFilter
+    {
+        enum class SortBy
+        {
+            None, // storage order
+            Amount,
+            Maturity
+        };
+
+        boost::optional<Asset::ID> m_AssetID;
+        bool m_WithAssets = true; // if false and no m_AssetID is set only BEAM coins are selected
+        std::vector<Coin::Status> m_Statuses; // empty means any status
+        boost::optional<Amount> m_MinAmount;
+        boost::optional<Amount> m_MaxAmount;
+        boost::optional<Height> m_MinMaturity; // stored maturity without confirmations offset
+        boost::optional<Height> m_MaxMaturity;
+        SortBy m_SortBy = SortBy::None;
+        bool m_Descending = false;
+    };
+
     // Outgoing wallet messages sent through SBBS (used in Cold Wallet)
     struct OutgoingWalletMessage
     {
@@ -361,6 +392,11 @@ namespace beam::wallet
         virtual void onShieldedCoinsChanged(ChangeAction action, const std::vector<ShieldedCoin>& items) {};
     };
 
+    namespace storage
+    {
+        struct Totals;
+    }
+
     struct IWalletDB : IVariablesDB
     {
         using Ptr = std::shared_ptr<IWalletDB>;
@@ -430,6 +466,8 @@ namespace beam::wallet
         virtual void removeCoin(const Coin::ID&) = 0;
         virtual void removeCoins(const std::vector<Coin::ID>&) = 0;
         virtual bool findCoin(Coin& coin) = 0;
+        // any status, in order of ids, missing coins are skipped
+        virtual std::vector<Coin> findCoins(const CoinIDList& ids) const = 0;
         virtual void clearCoins() = 0;
         virtual void setCoinConfirmationsOffset(uint32_t offset) = 0;
         virtual uint32_t getCoinConfirmationsOffset() const = 0;
@@ -439,6 +477,11 @@ namespace beam::wallet
         virtual void visitAssets(std::function<bool(const WalletAsset&)> func) = 0;
         virtual void visitShieldedCoins(std::function<bool(const ShieldedCoin& info)> func) = 0;
         virtual void visitShieldedCoinsUnspent(const std::function<bool(const ShieldedCoin& info)>& func) = 0;
+        // Visits coins matching the filter, skipping first 'start' matches, at most 'count' coins
+        virtual void visitCoins(const CoinsFilter& filter, uint64_t start, int count, const std::function<bool(const Coin& coin)>& func) = 0;
+
+        // Balance totals per asset for all the coins, owned assets without coins are not included (see storage::Totals)
+        virtual void getCoinTotals(storage::Totals& totals) = 0;
 
         // Used in split API for session management
         virtual bool lockCoins(const CoinIDList& list, uint64_t session) = 0;
@@ -467,6 +510,7 @@ namespace beam::wallet
         // /////////////////////////////////////////////
         // Transaction management
         virtual std::vector<TxDescription> getTxHistory(wallet::TxType txType = wallet::TxType::Simple, uint64_t start = 0, int count = std::numeric_limits<int>::max()) const = 0;
+        virtual std::vector<TxDescription> getTxHistory(const TxHistoryFilter& filter, uint64_t start = 0, int count = std::numeric_limits<int>::max()) const = 0;
         virtual boost::optional<TxDescription> getTx(const TxID& txId) const = 0;
         virtual void saveTx(const TxDescription& p) = 0;
         virtual void deleteTx(const TxID& txId) = 0;
@@ -474,6 +518,8 @@ namespace beam::wallet
             const ByteBuffer& blob, bool shouldNotifyAboutChanges, bool allowModify = true) = 0;
         virtual bool delTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID) = 0;
         virtual bool getTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID, ByteBuffer& blob) const = 0;
+        // Sets (adds or modifies) several parameters at once, notifies once per transaction
+        virtual void setTxParameters(const std::vector<TxParameter>& params, bool shouldNotifyAboutChanges);
         virtual std::vector<TxParameter> getAllTxParameters() const = 0;
         virtual void restoreCoinsSpentByTx(const TxID& txId) = 0;
         virtual void deleteCoinsCreatedByTx(const TxID& txId) = 0;
@@ -486,6 +532,8 @@ namespace beam::wallet
         virtual boost::optional<WalletAddress> getAddress(
                 const WalletID&, bool isLaser = false) const = 0;
         virtual std::vector<WalletAddress> getAddresses(bool own, bool isLaser = false) const = 0;
+        // Visits addresses newest first, skipping first 'start' of them, at most 'count' addresses
+        virtual void visitAddresses(bool own, uint64_t start, int count, const std::function<bool(const WalletAddress&)>& func) const = 0;
         virtual void saveAddress(const WalletAddress&, bool isLaser = false) = 0;
         virtual void deleteAddress(const WalletID&, bool isLaser = false) = 0;
 
@@ -552,6 +600,7 @@ namespace beam::wallet
     namespace sqlite
     {
         struct Statement;
+        struct StatementCache;
         struct Transaction;
     }  // namespace sqlite
 
@@ -564,6 +613,9 @@ namespace beam::wallet
         static Ptr  initNoKeepr(const std::string& path, const SecString& password, bool separateDBForPrivateData = false);
         static Ptr  open(const std::string& path, const SecString& password, const IPrivateKeyKeeper2::Ptr&);
         static Ptr  open(const std::string& path, const SecString& password);
+        // Extra connection for queries from the other thread, it sees what's committed by the main connection.
+        // Keys aren't loaded. The main connection should switch the database to WAL mode, otherwise its writes block the reads
+        static std::shared_ptr<WalletDB> openReadOnly(const std::string& path, const SecString& password);
 
         WalletDB(sqlite3* db);
         WalletDB(sqlite3* db, sqlite3* sdb);
@@ -593,6 +645,7 @@ namespace beam::wallet
         void removeCoin(const Coin::ID&) override;
         void removeCoins(const std::vector<Coin::ID>&) override;
         bool findCoin(Coin& coin) override;
+        std::vector<Coin> findCoins(const CoinIDList& ids) const override;
         void clearCoins() override;
         void setCoinConfirmationsOffset(uint32_t offset) override;
         uint32_t getCoinConfirmationsOffset() const override;
@@ -601,6 +654,8 @@ namespace beam::wallet
         void visitAssets(std::function<bool(const WalletAsset& info)> func) override;
         void visitShieldedCoins(std::function<bool(const ShieldedCoin& info)> func) override;
         void visitShieldedCoinsUnspent(const std::function<bool(const ShieldedCoin& info)>& func) override;
+        void visitCoins(const CoinsFilter& filter, uint64_t start, int count, const std::function<bool(const Coin& coin)>& func) override;
+        void getCoinTotals(storage::Totals& totals) override;
 
         void setVarRaw(const char* name, const void* data, size_t size) override;
         bool getVarRaw(const char* name, void* data, int size) const override;
@@ -624,6 +679,7 @@ namespace beam::wallet
         void rollbackConfirmedShieldedUtxo(Height minHeight) override;
 
         std::vector<TxDescription> getTxHistory(wallet::TxType txType, uint64_t start, int count) const override;
+        std::vector<TxDescription> getTxHistory(const TxHistoryFilter& filter, uint64_t start, int count) const override;
         boost::optional<TxDescription> getTx(const TxID& txId) const override;
         void saveTx(const TxDescription& p) override;
         void deleteTx(const TxID& txId) override;
@@ -633,6 +689,7 @@ namespace beam::wallet
         void deleteShieldedCoinsCreatedByTx(const TxID& txId) override;
 
         std::vector<WalletAddress> getAddresses(bool own, bool isLaser = false) const override;
+        void visitAddresses(bool own, uint64_t start, int count, const std::function<bool(const WalletAddress&)>& func) const override;
         void saveAddress(const WalletAddress&, bool isLaser = false) override;
         boost::optional<WalletAddress> getAddress(
             const WalletID&, bool isLaser = false) const override;
@@ -657,6 +714,7 @@ namespace beam::wallet
             const ByteBuffer& blob, bool shouldNotifyAboutChanges, bool allowModify = true) override;
         bool delTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID) override;
         bool getTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID, ByteBuffer& blob) const override;
+        void setTxParameters(const std::vector<TxParameter>& params, bool shouldNotifyAboutChanges) override;
         std::vector<TxParameter> getAllTxParameters() const override;
 
         Block::SystemState::IHistory& get_History() override;
@@ -691,6 +749,15 @@ namespace beam::wallet
         void saveVoucher(const ShieldedTxo::Voucher& v, const WalletID& walletID, bool preserveOnGrab) override;
         size_t getVoucherCount(const WalletID& peerID) const override;
 
+        // Commits pending changes, so that they become visible to the other connections
+        void flushDB();
+        // There're changes since the last flush, which are not committed yet
+        bool isFlushPending() const { return m_IsFlushPending; }
+        // Switches the database to WAL journal mode, readers from the other connections don't block writes then
+        void enableWAL();
+        // For read-only connection: drops cached data if the database was changed by the other connection
+        void syncReadOnly();
+
     private:
         static std::shared_ptr<WalletDB> initBase(const std::string& path, const SecString& password, bool separateDBForPrivateData);
 
@@ -729,16 +796,33 @@ namespace beam::wallet
         bool hasTransaction(const TxID& txID) const;
         void insertAddressToCache(const WalletID& id, const boost::optional<WalletAddress>& address) const;
         void deleteAddressFromCache(const WalletID& id);
-        void flushDB();
         void rollbackDB();
         void onModified();
         void onFlushTimer();
         void onPrepareToModify();
         void MigrateCoins();
         boost::optional<TxDescription> getTxImpl(const TxID& txId, sqlite::Statement& stm) const;
+        void updateTxSummary(const TxID& txID, TxParameterID paramID, const ByteBuffer* blob);
+
+        // Balance totals are adjusted on every coin change and persisted in the same db transaction.
+        // Empty totals table means they should be recalculated on next request
+        bool loadTotals();
+        void ensureTotals();
+        void invalidateTotals();
+        void saveTotals(const std::set<Asset::ID>& assets);
+        void countCoins(const std::vector<Coin>& coins, bool add, bool existenceChanged = true);
+        void countShieldedCoins(const std::vector<ShieldedCoin>& coins, bool add, bool existenceChanged = true);
+        void countTxCoins(const TxID& txID, bool add);
+        void updateTotalsHeight(Height h);
+        void updateMinCoinHeight(Asset::ID assetId, bool shielded);
+
+        struct SpendableCoins;
+        SpendableCoins& getSpendableCoins();
     private:
         friend struct sqlite::Statement;
         bool m_Initialized = false;
+        bool m_ReadOnly = false;
+        int m_DataVersion = 0;
         sqlite3* _db;
         sqlite3* m_PrivateDB;
         Key::IKdf::Ptr m_pKdfMaster;
@@ -751,6 +835,7 @@ namespace beam::wallet
         std::unique_ptr<sqlite::Transaction> m_DbTransaction;
         std::vector<IWalletDbObserver*> m_subscribers;
         const std::set<TxParameterID> m_mandatoryTxParams;
+        std::unique_ptr<sqlite::StatementCache> m_pStatementCache;
 
         // Wallet has ablity to track blockchain state
         // This interface allows to check and update the blockchain state 
@@ -770,6 +855,10 @@ namespace beam::wallet
         struct LocalKeyKeeper;
         LocalKeyKeeper* m_pLocalKeyKeeper = nullptr;
         uint32_t m_coinConfirmationsOffset = 0;
+        std::unique_ptr<storage::Totals> m_pTotals;
+        Height m_TotalsHeight = 0;
+        bool m_TotalsEmpty = false;
+        std::unique_ptr<SpendableCoins> m_pSpendable;
 
         struct ShieldedStatusCtx;
     };
@@ -887,12 +976,26 @@ namespace beam::wallet
                 AmountBig::Type IncomingShielded = 0U;
                 Height MinCoinHeightMW = 0;
                 Height MinCoinHeightShielded = 0;
+
+                SERIALIZE(AssetId, Avail, Maturing, Incoming, ReceivingIncoming, ReceivingChange, Unavail, Outgoing,
+                          AvailCoinbase, Coinbase, AvailFee, Fee, Unspent, AvailShielded, UnspentShielded,
+                          MaturingShielded, UnavailShielded, OutgoingShielded, IncomingShielded,
+                          MinCoinHeightMW, MinCoinHeightShielded);
             };
 
             Totals();
             explicit Totals(IWalletDB& db);
             void Init(IWalletDB&);
 
+            // Full recalculation over all the coins, IWalletDB::getCoinTotals provides the same result
+            void InitFromCoins(IWalletDB&);
+
+            // Adds or subtracts amounts of the coin with deduced status, min heights aren't affected
+            void AddCoin(const Coin&, bool add = true);
+            void AddShieldedCoin(const ShieldedCoin&, bool add = true);
+
+            AssetTotals& GetTotalsRef(Asset::ID);
+
             bool HasTotals(Asset::ID) const;
             AssetTotals GetTotals(Asset::ID) const;
 
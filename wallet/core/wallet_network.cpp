@@ -62,48 +62,59 @@ namespace beam::wallet {
         Addr::Channel key;
         key.m_Value = channel;
 
-        for (ChannelSet::iterator it = m_Channels.lower_bound(key); ; ++it)
-        {
-            if (m_Channels.end() == it)
-                break;
-            if (it->m_Value != channel)
-                break; // as well
+        ChannelSet::iterator it = m_Channels.lower_bound(key);
+        if ((m_Channels.end() == it) || (it->m_Value != channel))
+            return; // not ours
 
+        if (!m_pKdfSbbs)
+        {
+            // read-only wallet
+            m_WalletDB->saveIncomingWalletMessage(channel, msg);
+            OnIncomingMessage();
+            return;
+        }
 
-            if (!m_pKdfSbbs)
-            {
-                // read-only wallet
-                m_WalletDB->saveIncomingWalletMessage(channel, msg);
-                OnIncomingMessage();
-                return;
-            }
+        if (msg.empty())
+            return;
 
-            ByteBuffer buf = msg; // duplicate
-            uint8_t* pMsg = &buf.front();
-            uint32_t nSize = static_cast<uint32_t>(buf.size());
+        // tagged message is tried only with the matching address, otherwise with every address of the channel
+        proto::Bbs::RecipientTag tag;
+        uint32_t nSize = static_cast<uint32_t>(msg.size());
+        bool bTagged = tag.Read(&msg.front(), nSize);
 
-            if (!proto::Bbs::Decrypt(pMsg, nSize, it->get_ParentObj().m_sk))
+        for ( ; (m_Channels.end() != it) && (it->m_Value == channel); ++it)
+        {
+            const Addr& addr = it->get_ParentObj();
+            if (bTagged && !tag.IsFor(addr.m_Wid.m_Value.m_Pk))
                 continue;
 
-            SetTxParameter msgWallet;
-            bool bValid = false;
+            if (ProcessMessage(addr, msg, nSize))
+                break;
+        }
+    }
 
-            try {
-                Deserializer der;
-                der.reset(pMsg, nSize);
-                der& msgWallet;
-                bValid = true;
-            }
-            catch (const std::exception&) {
-                LOG_WARNING() << "BBS deserialization failed";
-            }
+    bool BaseMessageEndpoint::ProcessMessage(const Addr& addr, const ByteBuffer& msg, uint32_t nSize)
+    {
+        ByteBuffer buf(msg.begin(), msg.begin() + nSize); // duplicate
+        uint8_t* pMsg = &buf.front();
 
-            if (bValid)
-            {
-                m_Wallet.OnWalletMessage(it->get_ParentObj().m_Wid.m_Value, msgWallet);
-                break;
-            }
+        if (!proto::Bbs::Decrypt(pMsg, nSize, addr.m_sk))
+            return false;
+
+        SetTxParameter msgWallet;
+
+        try {
+            Deserializer der;
+            der.reset(pMsg, nSize);
+            der& msgWallet;
+        }
+        catch (const std::exception&) {
+            LOG_WARNING() << "BBS deserialization failed";
+            return false;
         }
+
+        m_Wallet.OnWalletMessage(addr.m_Wid.m_Value, msgWallet);
+        return true;
     }
 
     BaseMessageEndpoint::Addr* BaseMessageEndpoint::CreateOwnAddr(const WalletID& wid)
@@ -202,7 +213,7 @@ namespace beam::wallet {
         m_pKdfSbbs->DeriveKey(nonce, hvRandom.V);
 
         ByteBuffer encryptedMessage;
-        if (proto::Bbs::Encrypt(encryptedMessage, peerID.m_Pk, nonce, sb.first, static_cast<uint32_t>(sb.second)))
+        if (proto::Bbs::Encrypt(encryptedMessage, peerID.m_Pk, nonce, sb.first, static_cast<uint32_t>(sb.second), m_TagOutgoing))
         {
             SendRawMessage(peerID, encryptedMessage);
         }
@@ -281,23 +292,10 @@ namespace beam::wallet {
         {
             proto::Bbs::get_HashPartial(pTask->m_hpPartial, pTask->m_Msg);
 
-            if (!m_Miner.m_pEvt)
-            {
-                m_Miner.m_pEvt = io::AsyncEvent::create(io::Reactor::get_Current(), [this]() { OnMined(); });
-                m_Miner.m_Shutdown = false;
-
-                uint32_t nThreads = std::thread::hardware_concurrency();
-                nThreads = (nThreads > 1) ? (nThreads - 1) : 1; // leave at least 1 vacant core for other things
-                m_Miner.m_vThreads.resize(nThreads);
-
-                for (uint32_t i = 0; i < nThreads; i++)
-                    m_Miner.m_vThreads[i] = std::thread(&BbsMiner::Thread, &m_Miner, i);
-            }
-
-            std::unique_lock<std::mutex> scope(m_Miner.m_Mutex);
+            if (!m_Miner.IsStarted())
+                m_Miner.Start(io::AsyncEvent::create(io::Reactor::get_Current(), [this]() { OnMined(); }));
 
-            m_Miner.m_Pending.push_back(std::move(pTask));
-            m_Miner.m_NewTask.notify_all();
+            m_Miner.Push(pTask);
         }
         else
         {
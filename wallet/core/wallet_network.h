@@ -57,6 +57,10 @@ namespace beam::wallet
         virtual ~BaseMessageEndpoint();
         void AddOwnAddress(const WalletAddress& address);
         void DeleteOwnAddress(const WalletID&);
+
+        // append the recipient tag to the outgoing messages. The recipient finds its address w/o trial decryption,
+        // but wallets that don't support it can't read such messages
+        bool m_TagOutgoing = false;
     protected:
         void ProcessMessage(BbsChannel channel, const ByteBuffer& msg);
         void Subscribe();
@@ -65,6 +69,7 @@ namespace beam::wallet
         virtual void OnChannelDeleted(BbsChannel channel) {};
         virtual void OnIncomingMessage() {};
     private:
+        bool ProcessMessage(const Addr&, const ByteBuffer& msg, uint32_t nSize);
         void DeleteAddr(const Addr&);
         bool IsSingleChannelUser(const Addr::Channel&);
         Addr* CreateOwnAddr(const WalletID&);
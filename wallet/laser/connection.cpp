@@ -114,26 +114,15 @@ void Connection::MineBbsRequest(FlyClient::RequestBbsMsg& r)
 
     proto::Bbs::get_HashPartial(pTask->m_hpPartial, pTask->m_Msg);
 
-    if (!m_Miner.m_pEvt)
+    if (!m_Miner.IsStarted())
     {
-        m_Miner.m_pEvt = io::AsyncEvent::create(
+        m_Miner.Start(io::AsyncEvent::create(
             io::Reactor::get_Current(),
-            [this] () { OnMined(); });
-        m_Miner.m_Shutdown = false;
-
-        uint32_t nThreads = std::thread::hardware_concurrency();
-        nThreads = (nThreads > 1) ? (nThreads - 1) : 1; // leave at least 1 vacant core for other things
-        m_Miner.m_vThreads.resize(nThreads);
-
-        for (uint32_t i = 0; i < nThreads; i++)
-            m_Miner.m_vThreads[i] = std::thread(&BbsMiner::Thread, &m_Miner, i);
+            [this] () { OnMined(); }));
     }
 
-    std::unique_lock<std::mutex> scope(m_Miner.m_Mutex);
-
     m_handlers[pTask] = r.m_pTrg;
-    m_Miner.m_Pending.push_back(std::move(pTask));
-    m_Miner.m_NewTask.notify_all();
+    m_Miner.Push(pTask);
 }
 
 }  // namespace beam::wallet::laser
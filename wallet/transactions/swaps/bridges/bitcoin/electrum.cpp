@@ -46,10 +46,26 @@ namespace
     }
 
     const char kInvalidGenesisBlockHashMsg[] = "Invalid genesis block hash";
+
+    // max requests in a single JSON-RPC batch, the rest is sent via the same connection after the response
+    const size_t kMaxBatchSize = 100;
 }
 
 namespace beam::bitcoin
-{
+{
+    struct Electrum::KeysCache
+    {
+        // settings the keys are derived from
+        std::vector<std::string> m_secretWords;
+        uint32_t m_receivingAddressAmount = 0;
+        uint32_t m_changeAddressAmount = 0;
+        uint8_t m_addressVersion = 0;
+
+        std::pair<hd_private, hd_private> m_masterKeys;
+        std::vector<ec_private> m_privateKeys; // receiving, then change
+        std::vector<std::string> m_scriptHashes; // of m_privateKeys
+    };
+
     Electrum::Electrum(Reactor& reactor, ISettingsProvider& settingsProvider)
         : m_reactor(reactor)
         , m_settingsProvider(settingsProvider)
@@ -107,7 +123,7 @@ namespace beam::bitcoin
                 unspentPoints.points.push_back(point_value(point(txHash, coin.m_details["tx_pos"].get<uint32_t>()), coin.m_details["value"].get<uint64_t>()));
             }
 
-            auto privateKeys = generateElectrumMasterPrivateKeys(m_settingsProvider.GetSettings().GetElectrumConnectionOptions().m_secretWords);
+            const auto& privateKeys = getKeys().m_masterKeys;
             while (true)
             {
                 int changePosition = -1;
@@ -277,7 +293,7 @@ namespace beam::bitcoin
         LOG_DEBUG() << "getRawChangeAddress command";
 
         Error error{ None, "" };
-        auto privateKeys = generateElectrumMasterPrivateKeys(m_settingsProvider.GetSettings().GetElectrumConnectionOptions().m_secretWords);
+        const auto& privateKeys = getKeys().m_masterKeys;
         std::srand(static_cast<unsigned int>(std::time(0)));
         uint32_t index = static_cast<uint32_t>(std::rand() % m_settingsProvider.GetSettings().GetElectrumConnectionOptions().m_receivingAddressAmount);
 
@@ -439,48 +455,39 @@ namespace beam::bitcoin
     {
         //LOG_DEBUG() << "getDetailedBalance command";
 
-        size_t index = 0;
-        Amount confirmed = 0;
-        Amount unconfirmed = 0;
-        auto privateKeys = generatePrivateKeyList();
-        auto addressVersion = m_settingsProvider.GetSettings().GetAddressVersion();
+        std::vector<std::string> params;
+        for (const auto& scriptHash : getKeys().m_scriptHashes)
+        {
+            params.push_back("\"" + scriptHash + "\"");
+        }
 
-        sendRequest("blockchain.scripthash.get_balance", "\"" + generateScriptHash(privateKeys[0].to_public(), addressVersion) + "\"",
-            [this, callback, index, confirmed, unconfirmed, privateKeys, addressVersion](IBridge::Error error, const json& result, uint64_t tag) mutable
+        sendBatchRequest("blockchain.scripthash.get_balance", std::move(params), [callback](const Error& error, std::vector<json>&& results)
         {
-            if (error.m_type == IBridge::None)
+            Amount confirmed = 0;
+            Amount unconfirmed = 0;
+
+            if (error.m_type != IBridge::None)
             {
-                TCPConnect& connection = m_connections[tag];
+                callback(error, confirmed, unconfirmed, 0);
+                return;
+            }
 
-                try
+            try
+            {
+                for (const auto& result : results)
                 {
                     confirmed += result["confirmed"].get<Amount>();
                     unconfirmed += result["unconfirmed"].get<Amount>();
                 }
-                catch (const std::exception& ex)
-                {
-                    error.m_type = IBridge::InvalidResultFormat;
-                    error.m_message = ex.what();
-
-                    callback(error, confirmed, unconfirmed, 0);
-
-                    return false;
-                }
-
-                if (++index < privateKeys.size())
-                {
-                    std::string request = R"({"method":"blockchain.scripthash.get_balance","params":[")" + generateScriptHash(privateKeys[index].to_public(), addressVersion) + R"("], "id": "teste"})";
-                    request += "\n";
-
-                    Result res = connection.m_stream->write(request.data(), request.size());
-                    if (!res) {
-                        LOG_ERROR() << error_str(res.error());
-                    }
-                    return true;
-                }
             }
+            catch (const std::exception& ex)
+            {
+                Error formatError{ IBridge::InvalidResultFormat, ex.what() };
+                callback(formatError, confirmed, unconfirmed, 0);
+                return;
+            }
+
             callback(error, confirmed, unconfirmed, 0);
-            return false;
         });
     }
 
@@ -538,23 +545,30 @@ namespace beam::bitcoin
     void Electrum::listUnspent(std::function<void(const Error&, const std::vector<Utxo>&)> callback)
     {
         LOG_DEBUG() << "listunstpent command";
-        size_t index = 0;
-        std::vector<Utxo> coins;
-        auto privateKeys = generatePrivateKeyList();
-        auto addressVersion = m_settingsProvider.GetSettings().GetAddressVersion();
 
         if (m_cache.empty() || (std::chrono::system_clock::now() - m_lastCache > kRequestPeriod))
         {
-            sendRequest("blockchain.scripthash.listunspent", "\"" + generateScriptHash(privateKeys[0].to_public(), addressVersion) + "\"",
-                [this, callback, index, coins, privateKeys, addressVersion](IBridge::Error error, const json& result, uint64_t tag) mutable
+            std::vector<std::string> params;
+            for (const auto& scriptHash : getKeys().m_scriptHashes)
             {
-                if (error.m_type == IBridge::None || error.m_type == IBridge::EmptyResult)
+                params.push_back("\"" + scriptHash + "\"");
+            }
+
+            sendBatchRequest("blockchain.scripthash.listunspent", std::move(params), [this, callback](const Error& error, std::vector<json>&& results)
+            {
+                std::vector<Utxo> coins;
+
+                if (error.m_type != IBridge::None)
                 {
-                    TCPConnect& connection = m_connections[tag];
+                    callback(error, coins);
+                    return;
+                }
 
-                    try
+                try
+                {
+                    for (size_t index = 0; index < results.size(); ++index)
                     {
-                        for (auto utxo : result)
+                        for (const auto& utxo : results[index])
                         {
                             Utxo coin;
                             coin.m_index = index;
@@ -562,35 +576,17 @@ namespace beam::bitcoin
                             coins.push_back(coin);
                         }
                     }
-                    catch (const std::exception& ex)
-                    {
-                        error.m_type = IBridge::InvalidResultFormat;
-                        error.m_message = ex.what();
-
-                        callback(error, coins);
-
-                        return false;
-                    }
-
-                    if (++index < privateKeys.size())
-                    {
-                        std::string request = R"({"method":"blockchain.scripthash.listunspent","params":[")" + generateScriptHash(privateKeys[index].to_public(), addressVersion) + R"("], "id": "teste"})";
-                        request += "\n";
-
-                        Result res = connection.m_stream->write(request.data(), request.size());
-                        if (!res) {
-                            LOG_ERROR() << error_str(res.error());
-                        }
-                        return true;
-                    }
-                    m_lastCache = std::chrono::system_clock::now();
-                    m_cache = coins;
-                    IBridge::Error emptyError{ ErrorType::None, "" };
-                    callback(emptyError, coins);
-                    return false;
                 }
+                catch (const std::exception& ex)
+                {
+                    Error formatError{ IBridge::InvalidResultFormat, ex.what() };
+                    callback(formatError, coins);
+                    return;
+                }
+
+                m_lastCache = std::chrono::system_clock::now();
+                m_cache = coins;
                 callback(error, coins);
-                return false;
             });
         }
         else
@@ -609,6 +605,97 @@ namespace beam::bitcoin
         std::string request(R"({"method":")" + method + R"(","params":[)" + params + R"(], "id": "test"})");
         request += "\n";
 
+        sendRequestData(request, std::move(callback));
+    }
+
+    void Electrum::sendBatchRequest(const std::string& method, std::vector<std::string>&& params, std::function<void(const Error&, std::vector<json>&&)> callback)
+    {
+        if (params.empty())
+        {
+            callback(Error{ None, "" }, std::vector<json>());
+            return;
+        }
+
+        // ids are the indexes in params
+        auto makeRequest = [method](const std::vector<std::string>& params, size_t offset)
+        {
+            size_t count = std::min(params.size() - offset, kMaxBatchSize);
+            std::string request = "[";
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (i)
+                {
+                    request += ",";
+                }
+                request += R"({"method":")" + method + R"(","params":[)" + params[offset + i] + R"(],"id":)" + std::to_string(offset + i) + "}";
+            }
+            request += "]\n";
+            return request;
+        };
+
+        std::string request = makeRequest(params, 0);
+        std::vector<json> results(params.size());
+
+        sendRequestData(request, [this, callback, makeRequest, params = std::move(params), results = std::move(results), offset = size_t(0)](IBridge::Error error, const json& reply, uint64_t tag) mutable
+        {
+            size_t count = std::min(params.size() - offset, kMaxBatchSize);
+
+            if (error.m_type == IBridge::None)
+            {
+                try
+                {
+                    if (!reply.is_array() || reply.size() != count)
+                    {
+                        throw std::runtime_error("unexpected batch response");
+                    }
+
+                    for (const auto& item : reply)
+                    {
+                        auto id = item.at("id").get<size_t>();
+                        if (id < offset || id >= offset + count)
+                        {
+                            throw std::runtime_error("unexpected batch response id");
+                        }
+
+                        auto itError = item.find("error");
+                        if (itError != item.end() && !itError->is_null())
+                        {
+                            error.m_type = IBridge::BitcoinError;
+                            error.m_message = itError->at("message").get<std::string>();
+                            break;
+                        }
+
+                        results[id] = item.at("result");
+                    }
+                }
+                catch (const std::exception& ex)
+                {
+                    error.m_type = IBridge::InvalidResultFormat;
+                    error.m_message = ex.what();
+                }
+            }
+
+            if (error.m_type == IBridge::None)
+            {
+                offset += count;
+                if (offset < params.size())
+                {
+                    std::string request = makeRequest(params, offset);
+                    Result res = m_connections[tag].m_stream->write(request.data(), request.size());
+                    if (!res) {
+                        LOG_ERROR() << error_str(res.error());
+                    }
+                    return true;
+                }
+            }
+
+            callback(error, std::move(results));
+            return false;
+        });
+    }
+
+    void Electrum::sendRequestData(const std::string& request, std::function<bool(const Error&, const json&, uint64_t)> callback)
+    {
         auto settings = m_settingsProvider.GetSettings();
         //LOG_INFO() << request;
         io::Address address;
@@ -672,14 +759,32 @@ namespace beam::bitcoin
                     {
                         if (size > 0 && data)
                         {
-                            std::string strResponse = std::string(static_cast<const char*>(data), size);
+                            TCPConnect& connection = m_connections[currentId];
+                            connection.m_response.append(static_cast<const char*>(data), size);
+
+                            // the response (especially a batch) may come in several parts, it's terminated by a newline
+                            json reply = json::parse(connection.m_response, nullptr, false);
+                            if (reply.is_discarded() && connection.m_response.back() != '\n')
+                            {
+                                return true;
+                            }
+
+                            std::string strResponse;
+                            strResponse.swap(connection.m_response);
 
                             //LOG_INFO() << "strResponse: " << strResponse;
                             try
                             {
-                                json reply = json::parse(strResponse);
+                                if (reply.is_discarded())
+                                {
+                                    reply = json::parse(strResponse); // throws the parse error
+                                }
 
-                                if (!reply["error"].empty())
+                                if (reply.is_array())
+                                {
+                                    result = std::move(reply);
+                                }
+                                else if (!reply["error"].empty())
                                 {
                                     error.m_type = IBridge::BitcoinError;
                                     error.m_message = reply["error"]["message"].get<std::string>();
@@ -696,7 +801,6 @@ namespace beam::bitcoin
                                     if (id == "verify")
                                     {
                                         auto genesisBlockHash = result["genesis_hash"].get<std::string>();
-                                        TCPConnect& connection = m_connections[currentId];
                                         auto genesisBlockHashes = settings.GetGenesisBlockHashes();
                                         auto currentNodeAddress = settings.GetElectrumConnectionOptions().m_address;
 
@@ -798,25 +902,49 @@ namespace beam::bitcoin
         LOG_ERROR() << "error in Electrum::sendRequest: code = " << io::error_descr(result.error());
     }
 
-    std::vector<libbitcoin::wallet::ec_private> Electrum::generatePrivateKeyList() const
+    const Electrum::KeysCache& Electrum::getKeys() const
     {
-        std::vector<ec_private> result;
         auto settings = m_settingsProvider.GetSettings().GetElectrumConnectionOptions();
-        auto privateKeys = generateElectrumMasterPrivateKeys(settings.m_secretWords);
         auto addressVersion = m_settingsProvider.GetSettings().GetAddressVersion();
-        auto receivingAddressAmount = settings.m_receivingAddressAmount;
 
-        for (uint32_t i = 0; i < receivingAddressAmount; i++)
+        if (m_keysCache &&
+            m_keysCache->m_secretWords == settings.m_secretWords &&
+            m_keysCache->m_receivingAddressAmount == settings.m_receivingAddressAmount &&
+            m_keysCache->m_changeAddressAmount == settings.m_changeAddressAmount &&
+            m_keysCache->m_addressVersion == addressVersion)
+        {
+            return *m_keysCache;
+        }
+
+        auto keys = std::make_unique<KeysCache>();
+        keys->m_secretWords = settings.m_secretWords;
+        keys->m_receivingAddressAmount = settings.m_receivingAddressAmount;
+        keys->m_changeAddressAmount = settings.m_changeAddressAmount;
+        keys->m_addressVersion = addressVersion;
+        keys->m_masterKeys = generateElectrumMasterPrivateKeys(settings.m_secretWords);
+
+        for (uint32_t i = 0; i < settings.m_receivingAddressAmount; i++)
+        {
+            keys->m_privateKeys.push_back(ec_private(keys->m_masterKeys.first.derive_private(i).secret(), addressVersion));
+        }
+
+        for (uint32_t i = 0; i < settings.m_changeAddressAmount; i++)
         {
-            result.push_back(ec_private(privateKeys.first.derive_private(i).secret(), addressVersion));
+            keys->m_privateKeys.push_back(ec_private(keys->m_masterKeys.second.derive_private(i).secret(), addressVersion));
         }
 
-        auto changeAddressAmount = settings.m_changeAddressAmount;
-        for (uint32_t i = 0; i < changeAddressAmount; i++)
+        for (const auto& privateKey : keys->m_privateKeys)
         {
-            result.push_back(ec_private(privateKeys.second.derive_private(i).secret(), addressVersion));
+            keys->m_scriptHashes.push_back(generateScriptHash(privateKey.to_public(), addressVersion));
         }
-        return result;
+
+        m_keysCache = std::move(keys);
+        return *m_keysCache;
+    }
+
+    const std::vector<libbitcoin::wallet::ec_private>& Electrum::generatePrivateKeyList() const
+    {
+        return getKeys().m_privateKeys;
     }
 
     void Electrum::lockUtxo(std::string hash, uint32_t pos)
@@ -41,10 +41,14 @@ namespace beam::bitcoin
         struct TCPConnect
         {
             std::string m_request;
+            std::string m_response; // may be received in parts
             std::function<bool(const Error&, const nlohmann::json&, uint64_t)> m_callback;
             std::unique_ptr<beam::io::TcpStream> m_stream;
         };
 
+        // keys and scripthashes derived from the secret words, valid while the relevant settings are the same
+        struct KeysCache;
+
         struct Utxo
         {
             size_t m_index;
@@ -87,9 +91,15 @@ namespace beam::bitcoin
         void listUnspent(std::function<void(const Error&, const std::vector<Utxo>&)> callback);
 
         void sendRequest(const std::string& method, const std::string& params, std::function<bool(const Error&, const nlohmann::json&, uint64_t)> callback);
+        void sendRequestData(const std::string& request, std::function<bool(const Error&, const nlohmann::json&, uint64_t)> callback);
+
+        // sends the requests of the same method via a single connection, in JSON-RPC batches. The results are in the order of params
+        void sendBatchRequest(const std::string& method, std::vector<std::string>&& params, std::function<void(const Error&, std::vector<nlohmann::json>&&)> callback);
+
+        const KeysCache& getKeys() const;
 
         // return the list of all private keys (receiving and changing)
-        std::vector<libbitcoin::wallet::ec_private> generatePrivateKeyList() const;
+        const std::vector<libbitcoin::wallet::ec_private>& generatePrivateKeyList() const;
 
         void lockUtxo(std::string hash, uint32_t pos);
         bool isLockedUtxo(std::string hash, uint32_t pos);
@@ -111,5 +121,6 @@ namespace beam::bitcoin
         std::chrono::system_clock::time_point m_lastCache;
         io::AsyncEvent::Ptr m_asyncEvent;
         std::map<std::string, bool> m_verifiedAddresses;
+        mutable std::unique_ptr<KeysCache> m_keysCache;
     };
 } // namespace beam::bitcoin
\ No newline at end of file
@@ -0,0 +1,164 @@
+// Copyright 2019 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// BBS PoW mining: nonce per hash vs hash lanes, and the miner on the executor
+// Usage: bbs_miner_bench [messages]
+
+#include "wallet/core/bbs_miner.h"
+#include "utility/test_helpers.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+using namespace beam;
+using namespace beam::wallet;
+
+namespace {
+
+BbsMiner::Task::Ptr create_task(uint32_t i) {
+    BbsMiner::Task::Ptr pTask = std::make_shared<BbsMiner::Task>();
+    pTask->m_Done = false;
+    pTask->m_StoredMessageID = i;
+    pTask->m_Msg.m_Channel = i;
+    pTask->m_Msg.m_Message.resize(200);
+    ECC::GenRandom(&pTask->m_Msg.m_Message.front(), static_cast<uint32_t>(pTask->m_Msg.m_Message.size()));
+
+    proto::Bbs::get_HashPartial(pTask->m_hpPartial, pTask->m_Msg);
+    return pTask;
+}
+
+bool is_mined(const proto::BbsMsg& msg) {
+    ECC::Hash::Value hv;
+    proto::Bbs::get_Hash(hv, msg);
+    return proto::Bbs::IsHashValid(hv);
+}
+
+void print(const char* name, uint32_t msgs, uint64_t hashes, const helpers::StopWatch& sw) {
+    double seconds = sw.seconds() > 0 ? sw.seconds() : 1e-6;
+    cout << name << ": messages=" << msgs << " hashes=" << hashes
+         << " time=" << sw.milliseconds() << "ms"
+         << " rate=" << uint64_t(hashes / seconds) << " hash/s" << endl;
+}
+
+// the way it was mined before: the partial hash is cloned for each nonce
+bool run_scalar(uint32_t msgs) {
+    bool ok = true;
+    uint64_t hashes = 0;
+
+    helpers::StopWatch sw;
+    sw.start();
+
+    for (uint32_t i = 0; i < msgs; ++i) {
+        BbsMiner::Task::Ptr pTask = create_task(i);
+        Timestamp ts = getTimestamp();
+
+        for (proto::Bbs::NonceType nonce = 0U; ; nonce.Inc()) {
+            ECC::Hash::Value hv;
+            ECC::Hash::Processor hp = pTask->m_hpPartial;
+            hp << ts << nonce >> hv;
+            ++hashes;
+
+            if (proto::Bbs::IsHashValid(hv)) {
+                pTask->m_Msg.m_TimePosted = ts;
+                pTask->m_Msg.m_Nonce = nonce;
+                break;
+            }
+        }
+
+        ok &= is_mined(pTask->m_Msg);
+    }
+
+    sw.stop();
+    print("nonce per hash", msgs, hashes, sw);
+    return ok;
+}
+
+bool run_lanes(uint32_t msgs) {
+    bool ok = true;
+    uint64_t hashes = 0;
+    volatile bool stop = false;
+
+    helpers::StopWatch sw;
+    sw.start();
+
+    for (uint32_t i = 0; i < msgs; ++i) {
+        BbsMiner::Task::Ptr pTask = create_task(i);
+
+        Timestamp ts;
+        uint32_t nonce;
+        ok &= BbsMiner::Mine(*pTask, 0, 1, ts, nonce, stop);
+        hashes += (nonce | (ECC::Hash::Processor::s_Lanes - 1)) + 1;
+
+        pTask->m_Msg.m_TimePosted = ts;
+        pTask->m_Msg.m_Nonce = nonce;
+        ok &= is_mined(pTask->m_Msg);
+    }
+
+    sw.stop();
+    print("hash lanes", msgs, hashes, sw);
+    return ok;
+}
+
+bool run_miner(uint32_t msgs) {
+    io::Reactor::Ptr reactor = io::Reactor::create();
+    io::Reactor::Scope scope(*reactor);
+
+    bool ok = true;
+    uint32_t done = 0;
+
+    BbsMiner miner;
+    miner.Start(io::AsyncEvent::create(*reactor, [&]() {
+        std::unique_lock<std::mutex> lock(miner.m_Mutex);
+        for (; !miner.m_Done.empty(); miner.m_Done.pop_front()) {
+            ok &= is_mined(miner.m_Done.front()->m_Msg);
+            if (++done == msgs) {
+                reactor->stop();
+            }
+        }
+    }));
+
+    helpers::StopWatch sw;
+    sw.start();
+
+    for (uint32_t i = 0; i < msgs; ++i) {
+        miner.Push(create_task(i));
+    }
+
+    reactor->run();
+    sw.stop();
+
+    double seconds = sw.seconds() > 0 ? sw.seconds() : 1e-6;
+    cout << "miner on executor: messages=" << done << " threads=" << miner.m_pExecutor->get_Threads()
+         << " time=" << sw.milliseconds() << "ms"
+         << " rate=" << (done / seconds) << " msg/s" << endl;
+
+    return ok && (done == msgs);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint32_t msgs = 3;
+    if (argc > 1) {
+        msgs = static_cast<uint32_t>(strtoul(argv[1], nullptr, 10));
+    }
+
+    bool ok = true;
+
+    ok &= run_scalar(msgs);
+    ok &= run_lanes(msgs);
+    ok &= run_miner(msgs);
+
+    return ok ? 0 : 1;
+}
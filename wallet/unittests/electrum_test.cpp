@@ -432,6 +432,69 @@ void testReconnectToInvalidAddresses()
     mainReactor->run();
 }
 
+void testBatchRequests()
+{
+    std::cout << "\nTesting batched requests and cached keys...\n";
+
+    io::Reactor::Ptr mainReactor{ io::Reactor::create() };
+    io::Reactor::Scope scope(*mainReactor);
+
+    bitcoin::ElectrumSettings settings;
+    settings.m_address = "127.0.0.1:10410";
+    settings.m_automaticChooseAddress = false;
+    settings.m_secretWords = { "rib", "genuine", "fury", "advance", "train", "capable", "rough", "silk", "march", "vague", "notice", "sphere" };
+    settings.m_receivingAddressAmount = 150; // more than fits a single batch
+
+    TestElectrumWallet btcWallet(*mainReactor, settings.m_address);
+    auto provider = std::make_shared<bitcoin::Provider>(settings);
+    auto electrum = std::make_shared<bitcoin::Electrum>(*mainReactor, *provider);
+
+    std::vector<Amount> balances;
+    std::vector<size_t> requests;
+    std::function<void()> nextStep;
+    auto callback = [&](const bitcoin::IBridge::Error& error, Amount confirmed, Amount unconfirmed, Amount)
+    {
+        WALLET_CHECK(error.m_type == bitcoin::IBridge::None);
+        WALLET_CHECK(unconfirmed == 0);
+        LOG_INFO() << "balance = " << confirmed << ", requests = " << btcWallet.getRequestCount();
+
+        balances.push_back(confirmed);
+        requests.push_back(btcWallet.getRequestCount());
+        nextStep();
+    };
+
+    nextStep = [&]()
+    {
+        if (balances.size() == 1)
+        {
+            // same settings, the cached keys are used
+            electrum->getDetailedBalance(callback);
+        }
+        else if (balances.size() == 2)
+        {
+            // the keys must be derived again for the new settings
+            settings.m_receivingAddressAmount = 50;
+            auto newSettings = provider->GetSettings();
+            newSettings.SetElectrumConnectionOptions(settings);
+            provider->SetSettings(newSettings);
+            electrum->getDetailedBalance(callback);
+        }
+        else
+        {
+            mainReactor->stop();
+        }
+    };
+
+    electrum->getDetailedBalance(callback);
+    mainReactor->run();
+
+    WALLET_CHECK(balances.size() == 3);
+    WALLET_CHECK(balances[0] > 0);
+    WALLET_CHECK(balances[0] == balances[1] && balances[1] == balances[2]);
+    // verification and 2 batches, then 2 batches, then 1 batch
+    WALLET_CHECK(requests == std::vector<size_t>({ 3, 5, 6 }));
+}
+
 int main()
 {
     int logLevel = LOG_LEVEL_DEBUG;
@@ -444,6 +507,7 @@ int main()
     testConnectToOfflineNode();
     testConnectToInvalidAddress();
     testReconnectToInvalidAddresses();
+    testBatchRequests();
     
     assert(g_failureCount == 0);
     return WALLET_CHECK_RESULT;
@@ -288,6 +288,12 @@ public:
 
     }
 
+    // requests received (a batch is a single request)
+    size_t getRequestCount() const
+    {
+        return m_requestCount;
+    }
+
 private:
 
     void onStreamAccepted(io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode)
@@ -302,90 +308,46 @@ private:
             {
                 if (errorCode != 0)
                 {
+                    m_requests.erase(peerId);
                     m_connections.erase(peerId);
                 }
-                else if (size > 0 && data)
-                {
-                    std::string result = "";
-                    std::string strResponse = std::string(static_cast<const char*>(data), size);
-
-                    try
-                    {
-                        json request = json::parse(strResponse);
-                        if (request["method"] == "server.features")
-                        {
-#if defined(BEAM_MAINNET) || defined(SWAP_MAINNET)
-                            result = R"({"jsonrpc": "2.0", "result": {"genesis_hash": "000000000019d6689c085ae165831e934ff763ae46a2a6c172b3f1b60a8ce26f"}, "id": "verify"})";
-#else
-                            result = R"({"jsonrpc": "2.0", "result": {"genesis_hash": "0f9188f13cb7b2c71f2a335e3a4fc328bf5beb436012afca590b1a11466e2206"}, "id": "verify"})";
-#endif
-                        }
-                        else if (request["method"] == "blockchain.headers.subscribe")
-                        {
-                            result = R"({"jsonrpc": "2.0", "result": {"hex": "00000020f067b25ee650df3118827383cc128eb00ff88ad521dd3a17c43ebeef56ce0f50d3e5df9a08d80ffff34f3b64b04eb303679290b0b908e5ae6ddd08f38aee29237ca0805dffff7f2001000000", "height": )" + std::to_string(m_blockCount++) + R"(}, "id": "test"})";
-                        }
-                        else if(request["method"] == "blockchain.scripthash.listunspent")
-                        {
-                            if (m_listUnspent.count(request["params"][0]))
-                            {
-                                result = m_listUnspent.at(request["params"][0]);
-                            }
-                            else
-                            {
-                                result = R"({"jsonrpc": "2.0", "result": [], "id": "teste"})";
-                            }
-                        }
-                        else if (request["method"] == "blockchain.transaction.broadcast")
-                        {
-                            std::string hexTx = request["params"][0];
-
-                            libbitcoin::data_chunk tx_data;
-                            libbitcoin::decode_base16(tx_data, hexTx);
-                            libbitcoin::chain::transaction tx = libbitcoin::chain::transaction::factory_from_data(tx_data);
-
-                            std::string txId = libbitcoin::encode_hash(tx.hash());
-
-                            if (m_transactions.find(txId) == m_transactions.end())
-                            {
-                                m_transactions[txId] = make_pair(hexTx, 0);
-                            }
-                            result = R"({"jsonrpc": "2.0", "result": ")" + txId + R"(", "id": "test"})";
-                        }
-                        else if (request["method"] == "blockchain.transaction.get")
-                        {
-                            std::string txId = request["params"][0];
-                            std::string lockScript = "";
-                            int confirmations = 0;
-
-                            auto idx = m_transactions.find(txId);
-                            if (idx != m_transactions.end())
-                            {
-                                confirmations = ++idx->second.second;
-                                libbitcoin::data_chunk tx_data;
-                                libbitcoin::decode_base16(tx_data, idx->second.first);
-                                libbitcoin::chain::transaction tx = libbitcoin::chain::transaction::factory_from_data(tx_data);
-
-                                auto script = tx.outputs()[0].script();
-
-                                lockScript = libbitcoin::encode_base16(script.to_data(false));
-                            }
-
-                            auto response = json::parse(R"({"jsonrpc": "2.0", "result": {"txid": "b77ada485262ccb2615903db0c6379187646c97113e8defee215aa610d66cc01", "hash": "b77ada485262ccb2615903db0c6379187646c97113e8defee215aa610d66cc01", "version": 2, "size": 224, "vsize": 224, "weight": 896, "locktime": 0, "vin": [{"txid": "b5d4225286fec7801fca9fae2f5819a938bc6fec707e5c270935ea20a9ec94ed", "vout": 1, "scriptSig": {"asm": "3045022100f92a598ddc276a0d3270a5527dbf34adff80c2030150c9a98a588073e93cebcb02206c559fb8569aff9b6008805c43d0ba497d53825b61cc2d48eaea4107f9185072[ALL] 03656b45ecae3cfe909ce78b8ace1890ad8dde8e62e3d0aebf86e73673b57c6464", "hex": "483045022100f92a598ddc276a0d3270a5527dbf34adff80c2030150c9a98a588073e93cebcb02206c559fb8569aff9b6008805c43d0ba497d53825b61cc2d48eaea4107f9185072012103656b45ecae3cfe909ce78b8ace1890ad8dde8e62e3d0aebf86e73673b57c6464"}, "sequence": 0}], "vout": [{"value": 0.002, "n": 0, "scriptPubKey": {"asm": "OP_HASH160 ff495beff01c6a334ae47294e738a724e4155b29 OP_EQUAL", "hex": "a914ff495beff01c6a334ae47294e738a724e4155b2987", "reqSigs": 1, "type": "scripthash", "addresses": ["2NGX4BHLHv5YPBShdZyYcKiMrm5BJs6Uy4e"]}}, {"value": 9.9513022, "n": 1, "scriptPubKey": {"asm": "OP_DUP OP_HASH160 45db9fa908ff3e35ab6db85ab8b189e5da54cd7d OP_EQUALVERIFY OP_CHECKSIG", "hex": "76a91445db9fa908ff3e35ab6db85ab8b189e5da54cd7d88ac", "reqSigs": 1, "type": "pubkeyhash", "addresses": ["mmtL21a47sRdc4V1WWCXTvPBBMrWUoBWoy"]}}], "hex": "0200000001ed94eca920ea3509275c7e70ec6fbc38a919582fae9fca1f80c7fe865222d4b5010000006b483045022100f92a598ddc276a0d3270a5527dbf34adff80c2030150c9a98a588073e93cebcb02206c559fb8569aff9b6008805c43d0ba497d53825b61cc2d48eaea4107f9185072012103656b45ecae3cfe909ce78b8ace1890ad8dde8e62e3d0aebf86e73673b57c64640000000002400d03000000000017a914ff495beff01c6a334ae47294e738a724e4155b29876c7b503b000000001976a91445db9fa908ff3e35ab6db85ab8b189e5da54cd7d88ac00000000"}, "id": "test"})");
-
-                            response["result"]["confirmations"] = confirmations;
-                            response["result"]["vout"][0]["scriptPubKey"]["hex"] = lockScript;
-                            result = response.dump();
-                        }
-                    }
-                    catch (const std::exception& /*ex*/)
-                    {
-                        result = R"({"jsonrpc": "2.0", "error": [], "id": "teste"})";
-                    }
-
-                    m_connections[peerId]->write(result.data(), result.size());
-                }
-                else
-                {
+                else if (size > 0 && data)
+                {
+                    // the request may come in several parts
+                    std::string& buffer = m_requests[peerId];
+                    buffer.append(static_cast<const char*>(data), size);
+
+                    json request = json::parse(buffer, nullptr, false);
+                    if (request.is_discarded() && buffer.back() != '\n')
+                    {
+                        return false;
+                    }
+                    buffer.clear();
+                    ++m_requestCount;
+
+                    std::string result;
+                    if (request.is_array())
+                    {
+                        // batch, responses are matched by id
+                        json response = json::array();
+                        for (const auto& item : request)
+                        {
+                            json itemResponse = json::parse(getResponse(item));
+                            itemResponse["id"] = item["id"];
+                            response.push_back(itemResponse);
+                        }
+                        result = response.dump();
+                    }
+                    else
+                    {
+                        result = getResponse(request);
+                    }
+                    result += "\n";
+
+                    m_connections[peerId]->write(result.data(), result.size());
+                }
+                else
+                {
                 }
 
                 return false;
@@ -398,11 +360,110 @@ private:
         }
     }
 
+    std::string getResponse(json request)
+    {
+        std::string result = "";
+
+        try
+        {
+            if (request.is_discarded())
+            {
+                throw std::runtime_error("invalid request");
+            }
+
+            if (request["method"] == "server.features")
+            {
+#if defined(BEAM_MAINNET) || defined(SWAP_MAINNET)
+                result = R"({"jsonrpc": "2.0", "result": {"genesis_hash": "000000000019d6689c085ae165831e934ff763ae46a2a6c172b3f1b60a8ce26f"}, "id": "verify"})";
+#else
+                result = R"({"jsonrpc": "2.0", "result": {"genesis_hash": "0f9188f13cb7b2c71f2a335e3a4fc328bf5beb436012afca590b1a11466e2206"}, "id": "verify"})";
+#endif
+            }
+            else if (request["method"] == "blockchain.headers.subscribe")
+            {
+                result = R"({"jsonrpc": "2.0", "result": {"hex": "00000020f067b25ee650df3118827383cc128eb00ff88ad521dd3a17c43ebeef56ce0f50d3e5df9a08d80ffff34f3b64b04eb303679290b0b908e5ae6ddd08f38aee29237ca0805dffff7f2001000000", "height": )" + std::to_string(m_blockCount++) + R"(}, "id": "test"})";
+            }
+            else if(request["method"] == "blockchain.scripthash.listunspent")
+            {
+                if (m_listUnspent.count(request["params"][0]))
+                {
+                    result = m_listUnspent.at(request["params"][0]);
+                }
+                else
+                {
+                    result = R"({"jsonrpc": "2.0", "result": [], "id": "teste"})";
+                }
+            }
+            else if (request["method"] == "blockchain.scripthash.get_balance")
+            {
+                Amount confirmed = 0;
+                if (m_listUnspent.count(request["params"][0]))
+                {
+                    auto utxos = json::parse(m_listUnspent.at(request["params"][0]));
+                    for (const auto& utxo : utxos["result"])
+                    {
+                        confirmed += utxo["value"].get<Amount>();
+                    }
+                }
+                result = R"({"jsonrpc": "2.0", "result": {"confirmed": )" + std::to_string(confirmed) + R"(, "unconfirmed": 0}, "id": "test"})";
+            }
+            else if (request["method"] == "blockchain.transaction.broadcast")
+            {
+                std::string hexTx = request["params"][0];
+
+                libbitcoin::data_chunk tx_data;
+                libbitcoin::decode_base16(tx_data, hexTx);
+                libbitcoin::chain::transaction tx = libbitcoin::chain::transaction::factory_from_data(tx_data);
+
+                std::string txId = libbitcoin::encode_hash(tx.hash());
+
+                if (m_transactions.find(txId) == m_transactions.end())
+                {
+                    m_transactions[txId] = make_pair(hexTx, 0);
+                }
+                result = R"({"jsonrpc": "2.0", "result": ")" + txId + R"(", "id": "test"})";
+            }
+            else if (request["method"] == "blockchain.transaction.get")
+            {
+                std::string txId = request["params"][0];
+                std::string lockScript = "";
+                int confirmations = 0;
+
+                auto idx = m_transactions.find(txId);
+                if (idx != m_transactions.end())
+                {
+                    confirmations = ++idx->second.second;
+                    libbitcoin::data_chunk tx_data;
+                    libbitcoin::decode_base16(tx_data, idx->second.first);
+                    libbitcoin::chain::transaction tx = libbitcoin::chain::transaction::factory_from_data(tx_data);
+
+                    auto script = tx.outputs()[0].script();
+
+                    lockScript = libbitcoin::encode_base16(script.to_data(false));
+                }
+
+                auto response = json::parse(R"({"jsonrpc": "2.0", "result": {"txid": "b77ada485262ccb2615903db0c6379187646c97113e8defee215aa610d66cc01", "hash": "b77ada485262ccb2615903db0c6379187646c97113e8defee215aa610d66cc01", "version": 2, "size": 224, "vsize": 224, "weight": 896, "locktime": 0, "vin": [{"txid": "b5d4225286fec7801fca9fae2f5819a938bc6fec707e5c270935ea20a9ec94ed", "vout": 1, "scriptSig": {"asm": "3045022100f92a598ddc276a0d3270a5527dbf34adff80c2030150c9a98a588073e93cebcb02206c559fb8569aff9b6008805c43d0ba497d53825b61cc2d48eaea4107f9185072[ALL] 03656b45ecae3cfe909ce78b8ace1890ad8dde8e62e3d0aebf86e73673b57c6464", "hex": "483045022100f92a598ddc276a0d3270a5527dbf34adff80c2030150c9a98a588073e93cebcb02206c559fb8569aff9b6008805c43d0ba497d53825b61cc2d48eaea4107f9185072012103656b45ecae3cfe909ce78b8ace1890ad8dde8e62e3d0aebf86e73673b57c6464"}, "sequence": 0}], "vout": [{"value": 0.002, "n": 0, "scriptPubKey": {"asm": "OP_HASH160 ff495beff01c6a334ae47294e738a724e4155b29 OP_EQUAL", "hex": "a914ff495beff01c6a334ae47294e738a724e4155b2987", "reqSigs": 1, "type": "scripthash", "addresses": ["2NGX4BHLHv5YPBShdZyYcKiMrm5BJs6Uy4e"]}}, {"value": 9.9513022, "n": 1, "scriptPubKey": {"asm": "OP_DUP OP_HASH160 45db9fa908ff3e35ab6db85ab8b189e5da54cd7d OP_EQUALVERIFY OP_CHECKSIG", "hex": "76a91445db9fa908ff3e35ab6db85ab8b189e5da54cd7d88ac", "reqSigs": 1, "type": "pubkeyhash", "addresses": ["mmtL21a47sRdc4V1WWCXTvPBBMrWUoBWoy"]}}], "hex": "0200000001ed94eca920ea3509275c7e70ec6fbc38a919582fae9fca1f80c7fe865222d4b5010000006b483045022100f92a598ddc276a0d3270a5527dbf34adff80c2030150c9a98a588073e93cebcb02206c559fb8569aff9b6008805c43d0ba497d53825b61cc2d48eaea4107f9185072012103656b45ecae3cfe909ce78b8ace1890ad8dde8e62e3d0aebf86e73673b57c64640000000002400d03000000000017a914ff495beff01c6a334ae47294e738a724e4155b29876c7b503b000000001976a91445db9fa908ff3e35ab6db85ab8b189e5da54cd7d88ac00000000"}, "id": "test"})");
+
+                response["result"]["confirmations"] = confirmations;
+                response["result"]["vout"][0]["scriptPubKey"]["hex"] = lockScript;
+                result = response.dump();
+            }
+        }
+        catch (const std::exception& /*ex*/)
+        {
+            result = R"({"jsonrpc": "2.0", "error": [], "id": "teste"})";
+        }
+
+        return result;
+    }
+
 private:
     io::Reactor& m_reactor;
     io::SslServer::Ptr m_server;
     std::map<uint64_t, io::TcpStream::Ptr> m_connections;
+    std::map<uint64_t, std::string> m_requests;
     uint64_t m_blockCount = 100;
+    size_t m_requestCount = 0;
 
     const std::map<std::string, std::string> m_listUnspent = {
         {"896063c12a01098375c8a379d820562922397caff3d7f61728092c67d34d9c65", R"({"jsonrpc": "2.0", "result": [{"tx_hash": "774a3898ed92a322c718e347ea8d033a0cb8f5371bc9ed19e7002c5e3a63f917", "tx_pos": 0, "height": 4336, "value": 167600}], "id": "test"})"},
@@ -0,0 +1,253 @@
+// Copyright 2018-2020 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test_helpers.h"
+
+#include "wallet/api/api_handler.h"
+#include "utility/logger.h"
+#include "nlohmann/json.hpp"
+#include <boost/filesystem.hpp>
+
+using namespace std;
+using namespace beam;
+using namespace beam::wallet;
+using json = nlohmann::json;
+
+WALLET_TEST_INIT
+
+namespace
+{
+    const char* DbName = "wallet_api.db";
+    const char* DbPassword = "pass123";
+
+    std::shared_ptr<WalletDB> createWalletDB()
+    {
+        if (boost::filesystem::exists(DbName))
+        {
+            boost::filesystem::remove(DbName);
+        }
+        ECC::NoLeak<ECC::uintBig> seed;
+        seed.V = 10283UL;
+        auto walletDB = WalletDB::init(DbName, string(DbPassword), seed);
+        beam::Block::SystemState::ID id = { };
+        id.m_Height = 134;
+        walletDB->setSystemStateID(id);
+        return std::static_pointer_cast<WalletDB>(walletDB);
+    }
+
+    struct WalletData : WalletApiHandler::IWalletData
+    {
+        IWalletDB::Ptr m_walletDB;
+        WalletApiHandler::ReadOnlyExecutor* m_readOnlyExecutor = nullptr;
+        WalletApiHandler::EventSource* m_eventSource = nullptr;
+
+        IWalletDB::Ptr getWalletDBPtr() override
+        {
+            return m_walletDB;
+        }
+
+        Wallet::Ptr getWalletPtr() override
+        {
+            return {};
+        }
+
+#ifdef BEAM_ATOMIC_SWAP_SUPPORT
+        const IAtomicSwapProvider& getAtomicSwapProvider() const override
+        {
+            throw std::runtime_error("swaps are not supported");
+        }
+#endif  // BEAM_ATOMIC_SWAP_SUPPORT
+
+        WalletApiHandler::ReadOnlyExecutor* getReadOnlyExecutor() override
+        {
+            return m_readOnlyExecutor;
+        }
+
+        WalletApiHandler::EventSource* getEventSource() override
+        {
+            return m_eventSource;
+        }
+    };
+
+    class TestApiHandler : public WalletApiHandler
+    {
+    public:
+        explicit TestApiHandler(IWalletData& walletData)
+            : WalletApiHandler(walletData, WalletApi::ACL())
+        {
+        }
+
+        bool request(const json& msg)
+        {
+            auto s = msg.dump();
+            return processRequest(s.data(), s.size());
+        }
+
+        void sendMsg(io::SerializedMsg& msg) override
+        {
+            std::string s;
+            for (const auto& fragment : msg)
+            {
+                s.append(reinterpret_cast<const char*>(fragment.data), fragment.size);
+            }
+            WALLET_CHECK(!s.empty() && s.back() == '\n');
+            m_sent.push_back(json::parse(s));
+
+            if (m_sent.size() == m_expected)
+            {
+                io::Reactor::get_Current().stop();
+            }
+        }
+
+        bool canSendNotifications() const override
+        {
+            return true;
+        }
+
+        std::vector<json> m_sent;
+        size_t m_expected = 0;
+    };
+
+    json makeRequest(int id, const std::string& method, const json& params = json::object())
+    {
+        return json
+        {
+            {"jsonrpc", "2.0"},
+            {"id", id},
+            {"method", method},
+            {"params", params}
+        };
+    }
+
+    // runs the reactor until the handler sends the expected number of messages
+    void waitForMessages(io::Reactor& reactor, TestApiHandler& handler, size_t count)
+    {
+        handler.m_expected = count;
+        if (handler.m_sent.size() >= count)
+            return;
+
+        auto timer = io::Timer::create(reactor);
+        timer->start(10000, false, [&reactor]()
+        {
+            WALLET_CHECK(!"timeout");
+            reactor.stop();
+        });
+        reactor.run();
+        WALLET_CHECK(handler.m_sent.size() == count);
+    }
+
+    void TestReadOnlyRequestsOrder()
+    {
+        cout << "\nRead-only requests on the workers, responses order test\n";
+
+        io::Reactor::Ptr reactor{ io::Reactor::create() };
+        io::Reactor::Scope scope(*reactor);
+
+        auto walletDB = createWalletDB();
+
+        // get_utxo takes much longer than addr_list, so the workers complete them out of order
+        vector<Coin> coins;
+        for (Amount i = 0; i < 2000; ++i)
+        {
+            Coin c(100 + i);
+            c.m_maturity = 10;
+            c.m_confirmHeight = 10;
+            coins.push_back(c);
+        }
+        walletDB->storeCoins(coins);
+
+        WalletAddress addr;
+        walletDB->createAddress(addr);
+        walletDB->saveAddress(addr);
+
+        WalletApiHandler::ReadOnlyExecutor executor(*reactor, walletDB, DbName, SecString(DbPassword), 4);
+        WALLET_CHECK(!walletDB->isFlushPending());
+
+        WalletData data;
+        data.m_walletDB = walletDB;
+        data.m_readOnlyExecutor = &executor;
+        auto handler = std::make_shared<TestApiHandler>(data);
+
+        json batch = json::array();
+        std::vector<int> ids;
+        for (int i = 1; i <= 16; ++i)
+        {
+            batch.push_back((i % 2)
+                ? makeRequest(i, "get_utxo")
+                : makeRequest(i, "addr_list", json{ {"own", true} }));
+            ids.push_back(i);
+
+            if (i == 8)
+            {
+                // handled in place
+                batch.push_back(makeRequest(100, "no_such_method"));
+                ids.push_back(100);
+            }
+        }
+
+        WALLET_CHECK(handler->request(batch));
+        // the next request is answered after the batch
+        WALLET_CHECK(handler->request(makeRequest(200, "addr_list", json{ {"own", true} })));
+
+        waitForMessages(*reactor, *handler, 2);
+
+        const json& res = handler->m_sent[0];
+        WALLET_CHECK(res.is_array() && res.size() == ids.size());
+        for (size_t i = 0; i < std::min(res.size(), ids.size()); ++i)
+        {
+            WALLET_CHECK(res[i]["id"] == ids[i]);
+            if (ids[i] == 100)
+            {
+                WALLET_CHECK(res[i].find("error") != res[i].end());
+            }
+            else if (ids[i] % 2)
+            {
+                WALLET_CHECK(res[i]["result"].size() == coins.size());
+            }
+            else
+            {
+                WALLET_CHECK(res[i]["result"].size() == 1);
+            }
+        }
+        WALLET_CHECK(handler->m_sent[1]["id"] == 200);
+
+        // nothing is written, so nothing is committed before the request
+        WALLET_CHECK(!walletDB->isFlushPending());
+
+        // a new address isn't committed yet, the request makes it visible to the worker
+        WalletAddress addr2;
+        walletDB->createAddress(addr2);
+        walletDB->saveAddress(addr2);
+        WALLET_CHECK(walletDB->isFlushPending());
+
+        WALLET_CHECK(handler->request(makeRequest(300, "addr_list", json{ {"own", true} })));
+        WALLET_CHECK(!walletDB->isFlushPending());
+
+        waitForMessages(*reactor, *handler, 3);
+        WALLET_CHECK(handler->m_sent[2]["id"] == 300);
+        WALLET_CHECK(handler->m_sent[2]["result"].size() == 2);
+    }
+}
+
+int main()
+{
+    auto logger = beam::Logger::create(LOG_LEVEL_WARNING, LOG_LEVEL_WARNING);
+    ECC::InitializeContext();
+
+    TestReadOnlyRequestsOrder();
+
+    boost::filesystem::remove(DbName);
+
+    return WALLET_CHECK_RESULT;
+}
@@ -619,6 +619,131 @@ namespace
         WALLET_CHECK(api.parse(msg.data(), msg.size()));
     }
 
+    void testBatchJsonRpc(const std::string& msg)
+    {
+        class WalletApiHandler : public WalletApiHandlerBase
+        {
+        public:
+
+            void onInvalidJsonRpc(const json& msg) override
+            {
+                WALLET_CHECK(_inBatch);
+                testErrorHeaderWithId(msg);
+                WALLET_CHECK(msg["id"] == 2);
+                WALLET_CHECK(msg["error"]["code"] == ApiError::NotFoundJsonRpc);
+                _order.push_back(msg["id"]);
+            }
+
+            void onBeginBatch() override
+            {
+                WALLET_CHECK(!_inBatch);
+                _inBatch = true;
+            }
+
+            void onEndBatch() override
+            {
+                WALLET_CHECK(_inBatch);
+                _inBatch = false;
+                ++_batches;
+            }
+
+            void onMessage(const JsonRpcId& id, const TxList& data) override
+            {
+                WALLET_CHECK(_inBatch);
+                WALLET_CHECK(data.count == 10);
+                _order.push_back(id);
+            }
+
+            bool _inBatch = false;
+            int _batches = 0;
+            std::vector<JsonRpcId> _order;
+        };
+
+        WalletApiHandler handler;
+        WalletApi api(handler);
+
+        WALLET_CHECK(api.parse(msg.data(), msg.size()));
+        WALLET_CHECK(handler._batches == 1);
+        WALLET_CHECK(handler._order.size() == 3);
+        WALLET_CHECK(handler._order[0] == 1);
+        WALLET_CHECK(handler._order[1] == 2);
+        WALLET_CHECK(handler._order[2] == 3);
+    }
+
+    void testEvSubscribeJsonRpc(const std::string& msg)
+    {
+        class WalletApiHandler : public WalletApiHandlerBase
+        {
+        public:
+
+            void onInvalidJsonRpc(const json& msg) override
+            {
+                WALLET_CHECK(!"invalid ev_subscribe api json!!!");
+
+                cout << msg["error"] << endl;
+            }
+
+            void onMessage(const JsonRpcId& id, const EvSubscribe& data) override
+            {
+                WALLET_CHECK(id > 0);
+                WALLET_CHECK(!data.systemState);
+                WALLET_CHECK(data.utxosChanged);
+                WALLET_CHECK(data.txsChanged);
+                WALLET_CHECK(data.resume && *data.resume == "0123abcd:15");
+            }
+        };
+
+        WalletApiHandler handler;
+        WalletApi api(handler);
+
+        WALLET_CHECK(api.parse(msg.data(), msg.size()));
+
+        {
+            json res;
+            EvSubscribe::Response response;
+            response.token = "0123abcd:20";
+            response.resumed = true;
+            api.getResponse(123, response, res);
+            testResultHeader(res);
+
+            WALLET_CHECK(res["result"]["token"] == "0123abcd:20");
+            WALLET_CHECK(res["result"]["resumed"] == true);
+        }
+
+        {
+            EvUtxosChanged ev;
+            ev.changed.emplace_back(Coin(100));
+            ev.changed.back().m_ID.m_Idx = 1;
+            ev.removed.emplace_back(Coin(200).m_ID);
+
+            json res;
+            WalletApi::getNotification(16, "0123abcd:16", ev, res);
+
+            CHECK_JSON_FIELD_ABSENT(res, "id");
+            WALLET_CHECK(res["jsonrpc"] == "2.0");
+            WALLET_CHECK(res["method"] == "ev_utxos_changed");
+            WALLET_CHECK(res["params"]["seq"] == 16);
+            WALLET_CHECK(res["params"]["token"] == "0123abcd:16");
+            WALLET_CHECK(res["params"]["reset"] == false);
+            WALLET_CHECK(res["params"]["changed"].size() == 1);
+            WALLET_CHECK(res["params"]["changed"][0]["amount"] == 100);
+            WALLET_CHECK(res["params"]["removed"].size() == 1);
+            WALLET_CHECK(res["params"]["removed"][0] == toString(ev.removed[0]));
+        }
+
+        {
+            EvSystemState ev;
+            ev.stateID.m_Height = 134;
+            ev.stateID.m_Hash = Zero;
+
+            json res;
+            WalletApi::getNotification(17, "0123abcd:17", ev, res);
+            WALLET_CHECK(res["method"] == "ev_system_state");
+            WALLET_CHECK(res["params"]["seq"] == 17);
+            WALLET_CHECK(res["params"]["current_height"] == 134);
+        }
+    }
+
     void testValidateAddressJsonRpc(const std::string& msg, bool valid)
     {
         class WalletApiHandler : public WalletApiHandlerBase
@@ -1600,6 +1725,65 @@ int main()
         }
     }));
 
+    testBatchJsonRpc(JSON_CODE(
+    [
+        {
+            "jsonrpc": "2.0",
+            "id" : 1,
+            "method" : "tx_list",
+            "params" : { "count" : 10 }
+        },
+        {
+            "jsonrpc": "2.0",
+            "id" : 2,
+            "method" : "unknown_method"
+        },
+        {
+            "jsonrpc": "2.0",
+            "id" : 3,
+            "method" : "tx_list",
+            "params" : { "count" : 10 }
+        }
+    ]));
+
+    testInvalidJsonRpc([](const json& msg)
+    {
+        testErrorHeader(msg);
+
+        CHECK_JSON_FIELD_ABSENT(msg, "id");
+        WALLET_CHECK(msg["error"]["code"] == ApiError::InvalidJsonRpc);
+    }, JSON_CODE([]));
+
+    testEvSubscribeJsonRpc(JSON_CODE(
+    {
+        "jsonrpc": "2.0",
+        "id" : 12345,
+        "method" : "ev_subscribe",
+        "params" :
+        {
+            "ev_utxos_changed" : true,
+            "ev_txs_changed" : true,
+            "resume" : "0123abcd:15"
+        }
+    }));
+
+    testInvalidJsonRpc([](const json& msg)
+    {
+        testErrorHeaderWithId(msg);
+
+        WALLET_CHECK(msg["id"] == 12345);
+        WALLET_CHECK(msg["error"]["code"] == ApiError::InvalidJsonRpc);
+    }, JSON_CODE(
+    {
+        "jsonrpc": "2.0",
+        "id" : 12345,
+        "method" : "ev_subscribe",
+        "params" :
+        {
+            "ev_system_state" : 1
+        }
+    }));
+
     testValidateAddressJsonRpc(JSON_CODE(
     {
         "jsonrpc": "2.0",
@@ -358,6 +358,537 @@ void TestStoreTxRecord()
     WALLET_CHECK(t.size() == 0);
 }
 
+void TestTxHistoryFilter()
+{
+    cout << "\nWallet database transaction history filter test\n";
+    auto walletDB = createSqliteWalletDB();
+
+    TxID id = { {1} };
+    TxDescription tr(id);
+    tr.m_amount = 5;
+    tr.m_myId.m_Pk = unsigned(42);
+    tr.m_myId.m_Channel = 0U;
+    tr.m_sender = true;
+
+    const TxType types[] = { TxType::Simple, TxType::AssetIssue, TxType::AssetInfo, TxType::AtomicSwap };
+    for (uint8_t i = 0; i < 40; ++i)
+    {
+        tr.m_txId[0] = i;
+        tr.m_txType = types[i % 4];
+        tr.m_status = (i % 3) ? TxStatus::Completed : TxStatus::Failed;
+        tr.m_assetId = (tr.m_txType == TxType::Simple && i % 8) ? Asset::s_InvalidID : 7;
+        tr.m_createTime = 1000 + i;
+        tr.m_minHeight = 100 + i / 2;
+        WALLET_CHECK_NO_THROW(walletDB->saveTx(tr));
+
+        if (tr.m_txType == TxType::AssetInfo)
+            storage::setTxParameter(*walletDB, tr.m_txId, TxParameterID::AssetConfirmedHeight, Height(500), false);
+        else
+            storage::setTxParameter(*walletDB, tr.m_txId, TxParameterID::KernelProofHeight, Height(500 + i), false);
+    }
+
+    // incomplete transaction is not listed
+    TxID incomplete = { {100} };
+    storage::setTxParameter(*walletDB, incomplete, TxParameterID::TransactionType, TxType::Simple, false);
+    storage::setTxParameter(*walletDB, incomplete, TxParameterID::Status, TxStatus::Completed, false);
+
+    auto t = walletDB->getTxHistory(TxType::ALL);
+    WALLET_CHECK(t.size() == 40);
+    WALLET_CHECK(t.front().m_txId[0] == 39 && t.back().m_txId[0] == 0);
+
+    t = walletDB->getTxHistory(TxType::Simple);
+    WALLET_CHECK(t.size() == 10);
+    for (size_t i = 1; i < t.size(); ++i)
+    {
+        WALLET_CHECK(t[i - 1].m_createTime > t[i].m_createTime);
+    }
+
+    TxHistoryFilter filter;
+    filter.m_Types = { TxType::Simple, TxType::AssetIssue, TxType::AssetInfo };
+    filter.m_OrderByMinHeight = true;
+    t = walletDB->getTxHistory(filter);
+    WALLET_CHECK(t.size() == 30);
+    for (size_t i = 1; i < t.size(); ++i)
+    {
+        WALLET_CHECK(t[i - 1].m_minHeight >= t[i].m_minHeight);
+        WALLET_CHECK(t[i].m_txType != TxType::AtomicSwap);
+    }
+
+    auto page = walletDB->getTxHistory(filter, 10, 5);
+    WALLET_CHECK(page.size() == 5);
+    WALLET_CHECK(page[0].m_txId == t[10].m_txId && page[4].m_txId == t[14].m_txId);
+
+    filter.m_Status = TxStatus::Failed;
+    t = walletDB->getTxHistory(filter);
+    WALLET_CHECK(t.size() == 10);
+    for (const auto& tx : t)
+    {
+        WALLET_CHECK(tx.m_status == TxStatus::Failed);
+    }
+
+    filter.m_Status.reset();
+    filter.m_Types = { TxType::Simple };
+    filter.m_AssetID = Asset::ID(Asset::s_InvalidID);
+    t = walletDB->getTxHistory(filter);
+    WALLET_CHECK(t.size() == 5);
+
+    filter.m_Types = { TxType::AssetIssue, TxType::AssetInfo };
+    filter.m_AssetID.reset();
+    filter.m_ProofHeight = 500;
+    t = walletDB->getTxHistory(filter);
+    WALLET_CHECK(t.size() == 10);
+    for (const auto& tx : t)
+    {
+        WALLET_CHECK(tx.m_txType == TxType::AssetInfo);
+    }
+
+    // summary follows parameter changes
+    id = { {4} };
+    storage::setTxParameter(*walletDB, id, TxParameterID::Status, TxStatus::Canceled, false);
+    filter = {};
+    filter.m_Status = TxStatus::Canceled;
+    t = walletDB->getTxHistory(filter);
+    WALLET_CHECK(t.size() == 1 && t[0].m_txId == id);
+
+    walletDB->delTxParameter(id, kDefaultSubTxID, TxParameterID::Status);
+    WALLET_CHECK(walletDB->getTxHistory(filter).empty());
+    filter.m_Status = TxStatus::Pending;
+    WALLET_CHECK(walletDB->getTxHistory(filter).size() == 1);
+
+    walletDB->deleteTx(id);
+    WALLET_CHECK(walletDB->getTxHistory(TxType::ALL).size() == 39);
+    WALLET_CHECK(walletDB->getTxHistory(filter).empty());
+
+    TxID id2 = { {5} };
+    TxDescription tr2 = *walletDB->getTx(id2);
+    tr2.m_txId = id;
+    WALLET_CHECK_NO_THROW(walletDB->saveTx(tr2));
+    WALLET_CHECK(walletDB->getTxHistory(TxType::ALL).size() == 40);
+}
+
+void CheckTotals(IWalletDB& db)
+{
+    storage::Totals cached, full;
+    db.getCoinTotals(cached);
+    full.InitFromCoins(db);
+
+    WALLET_CHECK(cached.allTotals.size() == full.allTotals.size());
+    for (const auto& [assetId, totals] : full.allTotals)
+    {
+        WALLET_CHECK(cached.HasTotals(assetId));
+        WALLET_CHECK(toByteBuffer(cached.GetTotals(assetId)) == toByteBuffer(totals));
+    }
+}
+
+void TestTotals()
+{
+    cout << "\nWallet database balance totals test\n";
+    auto db = createSqliteWalletDB();
+    CheckTotals(*db);
+
+    Coin avail = CreateAvailCoin(5, 10);
+    Coin maturing = CreateCoin(7, 140, 125);
+    Coin asset = CreateAvailCoin(11, 20);
+    asset.m_ID.m_AssetID = 3;
+    db->storeCoin(avail);
+    db->storeCoin(maturing);
+    db->storeCoin(asset);
+    CheckTotals(*db);
+
+    // tx status changes
+    TxID txID = { {7} };
+    storage::setTxParameter(*db, txID, TxParameterID::Status, TxStatus::InProgress, false);
+    Coin incoming = CreateCoin(13);
+    incoming.m_createTxId = txID;
+    db->storeCoin(incoming);
+    avail.m_spentTxId = txID;
+    db->saveCoin(avail);
+    CheckTotals(*db);
+
+    storage::setTxParameter(*db, txID, TxParameterID::Status, TxStatus::Completed, false);
+    CheckTotals(*db);
+
+    // shielded
+    ShieldedCoin sc;
+    sc.m_CoinID.m_Key.m_nIdx = 1;
+    sc.m_CoinID.m_Value = 17;
+    sc.m_confirmHeight = 130;
+    db->saveShieldedCoin(sc);
+    CheckTotals(*db);
+
+    db->setCoinConfirmationsOffset(10);
+    CheckTotals(*db);
+
+    // height changes across maturity
+    Block::SystemState::ID id = { };
+    for (Height h : { 145, 150, 138, 160 })
+    {
+        id.m_Height = h;
+        db->setSystemStateID(id);
+        CheckTotals(*db);
+    }
+
+    // spend, rollback and removal
+    avail.m_spentHeight = 155;
+    db->saveCoin(avail);
+    CheckTotals(*db);
+
+    db->rollbackConfirmedUtxo(128);
+    CheckTotals(*db);
+
+    db->removeCoins({ asset.m_ID });
+    CheckTotals(*db);
+
+    db->deleteTx(txID);
+    CheckTotals(*db);
+
+    // persisted
+    db.reset();
+    db = WalletDB::open("wallet.db", string("pass123"));
+    CheckTotals(*db);
+
+    db->clearCoins();
+    CheckTotals(*db);
+}
+
+void TestBatchedCoins()
+{
+    cout << "\nWallet database batched coins test\n";
+    auto db = createSqliteWalletDB();
+    storage::Totals totals;
+    db->getCoinTotals(totals); // maintain totals
+    auto coinsCount = [&db]()
+    {
+        size_t count = 0;
+        db->visitCoins([&count](const Coin&) { ++count; return true; });
+        return count;
+    };
+
+    // more than a single batch
+    vector<Coin> coins;
+    for (int i = 0; i < 150; ++i)
+    {
+        Coin c = CreateAvailCoin(i + 1);
+        c.m_ID.m_Idx = 1000 + i;
+        coins.push_back(c);
+    }
+    db->saveCoins(coins);
+    WALLET_CHECK(coinsCount() == coins.size());
+    CheckTotals(*db);
+
+    // updated and duplicated
+    coins[3].m_confirmHeight = MaxHeight;
+    coins[100].m_maturity = 200;
+    coins.push_back(coins[5]);
+    coins.back().m_spentHeight = 20;
+    db->saveCoins(coins);
+    coins.pop_back();
+    WALLET_CHECK(coinsCount() == coins.size());
+    CheckTotals(*db);
+
+    CoinIDList ids;
+    for (auto it = coins.rbegin(); it != coins.rend(); ++it)
+    {
+        ids.push_back(it->m_ID);
+    }
+    Coin missing = CreateAvailCoin(7);
+    missing.m_ID.m_Idx = 1;
+    ids.insert(ids.begin() + 70, missing.m_ID);
+
+    auto found = db->getCoinsByID(ids);
+    WALLET_CHECK(found.size() == coins.size() - 3);
+    WALLET_CHECK(found.front().m_ID.m_Idx == 1149);
+    WALLET_CHECK(found.back().m_ID.m_Idx == 1000);
+    for (const auto& c : found)
+    {
+        WALLET_CHECK(c.m_status == Coin::Status::Available);
+        WALLET_CHECK(c.m_ID.m_Idx != 1003 && c.m_ID.m_Idx != 1005 && c.m_ID.m_Idx != 1100);
+    }
+
+    ids.resize(120);
+    db->removeCoins(ids);
+    WALLET_CHECK(coinsCount() == coins.size() - 119);
+    CheckTotals(*db);
+
+    // tx parameters
+    vector<TxParameter> params;
+    for (uint8_t i = 0; i < 200; ++i)
+    {
+        auto& p = params.emplace_back();
+        p.m_txID = { {static_cast<uint8_t>(i % 2)} };
+        p.m_subTxID = kDefaultSubTxID + 1 + i % 5;
+        p.m_paramID = static_cast<int>(TxParameterID::Amount) + i / 10;
+        p.m_value = toByteBuffer(Amount(i));
+    }
+    db->setTxParameters(params, true);
+    for (const auto& p : params)
+    {
+        Amount v = 0;
+        WALLET_CHECK(storage::getTxParameter(*db, p.m_txID, static_cast<SubTxID>(p.m_subTxID), static_cast<TxParameterID>(p.m_paramID), v));
+        WALLET_CHECK(toByteBuffer(v) == p.m_value);
+    }
+    WALLET_CHECK(db->getAllTxParameters().size() == 200);
+}
+
+void TestSpendableCoins()
+{
+    cout << "\nWallet database spendable coins index test\n";
+    auto db = createSqliteWalletDB();
+
+    // index should contain exactly the available coins
+    auto checkSpendable = [&db](Asset::ID assetId)
+    {
+        Amount sum = 0;
+        size_t count = 0;
+        db->visitCoins([&](const Coin& c)
+        {
+            if (c.m_status == Coin::Status::Available && c.m_ID.m_AssetID == assetId)
+            {
+                sum += c.m_ID.m_Value;
+                ++count;
+            }
+            return true;
+        });
+
+        WALLET_CHECK(db->selectCoins(sum + 1, assetId).empty());
+        if (sum)
+        {
+            auto coins = db->selectCoins(sum, assetId);
+            WALLET_CHECK(coins.size() == count);
+            for (const auto& c : coins)
+            {
+                WALLET_CHECK(c.m_status == Coin::Status::Available && c.m_ID.m_AssetID == assetId);
+            }
+        }
+    };
+
+    vector<Coin> coins;
+    for (Amount i = 1; i <= 20; ++i)
+    {
+        Coin c = CreateAvailCoin(i * 10, 100 + i * 2);
+        c.m_ID.m_AssetID = (i % 4) ? 0 : 5;
+        coins.push_back(c);
+    }
+    db->storeCoins(coins);
+    checkSpendable(0);
+    checkSpendable(5);
+
+    // maturity
+    Block::SystemState::ID id = { };
+    id.m_Height = 120;
+    db->setSystemStateID(id);
+    checkSpendable(0);
+    checkSpendable(5);
+    id.m_Height = 150;
+    db->setSystemStateID(id);
+    checkSpendable(0);
+
+    // outgoing, spent and rolled back
+    TxID txID = { {3} };
+    storage::setTxParameter(*db, txID, TxParameterID::Status, TxStatus::InProgress, false);
+    coins[0].m_spentTxId = txID;
+    coins[1].m_spentTxId = txID;
+    db->saveCoins({ coins[0], coins[1] });
+    checkSpendable(0);
+
+    storage::setTxParameter(*db, txID, TxParameterID::Status, TxStatus::Failed, false);
+    checkSpendable(0);
+
+    coins[2].m_spentHeight = 145;
+    db->saveCoin(coins[2]);
+    checkSpendable(0);
+    db->rollbackConfirmedUtxo(140);
+    checkSpendable(0);
+
+    db->removeCoins({ coins[4].m_ID, coins[7].m_ID });
+    checkSpendable(0);
+    checkSpendable(5);
+
+    // locks are visible in selected coins
+    WALLET_CHECK(db->lockCoins({ coins[5].m_ID }, 77));
+    auto sel = db->selectCoins(coins[5].m_ID.m_Value, 0);
+    WALLET_CHECK(sel.size() == 1 && sel[0].m_sessionId == 77);
+    db->unlockCoins(77);
+    sel = db->selectCoins(coins[5].m_ID.m_Value, 0);
+    WALLET_CHECK(sel.size() == 1 && sel[0].m_sessionId == 0);
+
+    db->clearCoins();
+    checkSpendable(0);
+}
+
+void TestCoinsFilter()
+{
+    cout << "\nWallet database coins filter test\n";
+    auto db = createSqliteWalletDB();
+
+    vector<Coin> coins;
+    for (Amount i = 0; i < 60; ++i)
+    {
+        Coin c = CreateCoin(100 + (i * 37) % 50, 100 + (i * 13) % 60);
+        c.m_ID.m_AssetID = (i % 3) ? 0 : 1 + i % 2;
+        switch (i % 4)
+        {
+        case 0: c.m_confirmHeight = 90; break; // available or maturing
+        case 1: c.m_confirmHeight = 90; c.m_spentHeight = 120; break;
+        case 2: break; // unavailable
+        default: c.m_confirmHeight = 100; c.m_maturity = 100; break;
+        }
+        coins.push_back(c);
+    }
+    for (Amount i = 0; i < 3; ++i)
+    {
+        coins.push_back(CreateCoin(120 + i)); // unconfirmed, the maturity is unknown (MaxHeight)
+    }
+    db->storeCoins(coins);
+
+    TxID txID = { {4} };
+    storage::setTxParameter(*db, txID, TxParameterID::Status, TxStatus::InProgress, false);
+    coins[3].m_spentTxId = txID; // outgoing
+    coins[6].m_createTxId = txID; // incoming
+    db->saveCoins({ coins[3], coins[6] });
+
+    vector<Coin> all;
+    db->visitCoins([&all](const Coin& c)
+    {
+        all.push_back(c);
+        return true;
+    });
+    WALLET_CHECK(all.size() == coins.size());
+
+    auto check = [&](const CoinsFilter& filter, uint64_t start, int count)
+    {
+        vector<Coin> expected;
+        for (const auto& c : all)
+        {
+            if (filter.m_AssetID && c.m_ID.m_AssetID != *filter.m_AssetID)
+                continue;
+            if (!filter.m_AssetID && !filter.m_WithAssets && c.isAsset())
+                continue;
+            if (!filter.m_Statuses.empty() && std::find(filter.m_Statuses.begin(), filter.m_Statuses.end(), c.m_status) == filter.m_Statuses.end())
+                continue;
+            if ((filter.m_MinAmount && c.m_ID.m_Value < *filter.m_MinAmount) || (filter.m_MaxAmount && c.m_ID.m_Value > *filter.m_MaxAmount))
+                continue;
+            if ((filter.m_MinMaturity && c.m_maturity < *filter.m_MinMaturity) || (filter.m_MaxMaturity && c.m_maturity > *filter.m_MaxMaturity))
+                continue;
+            expected.push_back(c);
+        }
+
+        if (filter.m_Descending)
+            std::reverse(expected.begin(), expected.end());
+
+        auto key = [&filter](const Coin& c)
+        {
+            return filter.m_SortBy == CoinsFilter::SortBy::Amount ? c.m_ID.m_Value : c.m_maturity;
+        };
+        if (filter.m_SortBy != CoinsFilter::SortBy::None)
+        {
+            std::stable_sort(expected.begin(), expected.end(), [&](const Coin& a, const Coin& b)
+            {
+                return filter.m_Descending ? key(a) > key(b) : key(a) < key(b);
+            });
+        }
+
+        expected.erase(expected.begin(), expected.begin() + std::min<size_t>(start, expected.size()));
+        if (expected.size() > size_t(count))
+            expected.resize(count);
+
+        vector<Coin> actual;
+        db->visitCoins(filter, start, count, [&actual](const Coin& c)
+        {
+            actual.push_back(c);
+            return true;
+        });
+
+        WALLET_CHECK(actual.size() == expected.size());
+        for (size_t i = 0; i < std::min(actual.size(), expected.size()); ++i)
+        {
+            WALLET_CHECK(actual[i].m_ID == expected[i].m_ID);
+            WALLET_CHECK(actual[i].m_status == expected[i].m_status);
+        }
+    };
+
+    const int Max = std::numeric_limits<int>::max();
+    CoinsFilter filter;
+    check(filter, 0, Max);
+    check(filter, 5, 10);
+    filter.m_WithAssets = false;
+    check(filter, 0, Max);
+    filter.m_AssetID = 2;
+    check(filter, 1, 3);
+    filter.m_AssetID = 0;
+    check(filter, 0, Max);
+
+    filter = {};
+    filter.m_Statuses = { Coin::Status::Available };
+    check(filter, 0, Max);
+    check(filter, 3, 4);
+    filter.m_Statuses = { Coin::Status::Maturing, Coin::Status::Spent };
+    check(filter, 2, 20);
+    filter.m_Statuses = { Coin::Status::Incoming };
+    check(filter, 0, Max);
+    filter.m_Statuses = { Coin::Status::Outgoing, Coin::Status::Unavailable };
+    check(filter, 0, 5);
+
+    filter = {};
+    filter.m_MinAmount = 110;
+    filter.m_MaxAmount = 130;
+    filter.m_SortBy = CoinsFilter::SortBy::Amount;
+    check(filter, 0, Max);
+    filter.m_Descending = true;
+    check(filter, 4, 7);
+
+    filter = {};
+    filter.m_MinMaturity = 110;
+    filter.m_MaxMaturity = 140;
+    filter.m_SortBy = CoinsFilter::SortBy::Maturity;
+    check(filter, 0, Max);
+    filter.m_Statuses = { Coin::Status::Available, Coin::Status::Outgoing };
+    filter.m_Descending = true;
+    check(filter, 1, 6);
+
+    // a single bound, unconfirmed coins are above any
+    filter = {};
+    filter.m_MaxMaturity = 130;
+    check(filter, 0, Max);
+    filter.m_SortBy = CoinsFilter::SortBy::Maturity;
+    check(filter, 0, Max);
+    filter = {};
+    filter.m_MinMaturity = 130;
+    filter.m_SortBy = CoinsFilter::SortBy::Maturity;
+    check(filter, 0, Max);
+    filter.m_Descending = true;
+    check(filter, 2, 10);
+
+    // addresses
+    for (int i = 0; i < 8; ++i)
+    {
+        WalletAddress a = {};
+        a.m_label = "label " + std::to_string(i);
+        a.m_createTime = 1000 + i;
+        a.m_OwnID = (i % 3) ? 0 : 10 + i;
+        db->get_SbbsWalletID(a.m_walletID, 10 + i);
+        db->saveAddress(a);
+    }
+
+    for (bool own : { true, false })
+    {
+        auto addresses = db->getAddresses(own);
+        WALLET_CHECK(addresses.size() == (own ? 3 : 5));
+        vector<WalletAddress> paged;
+        db->visitAddresses(own, 1, 2, [&paged](const WalletAddress& a)
+        {
+            paged.push_back(a);
+            return true;
+        });
+        WALLET_CHECK(paged.size() == 2);
+        for (size_t i = 0; i < paged.size(); ++i)
+        {
+            WALLET_CHECK(paged[i].m_walletID == addresses[i + 1].m_walletID);
+            WALLET_CHECK(paged[i].isOwn() == own);
+        }
+    }
+}
+
 void TestUTXORollback()
 {
     cout << "\nWallet database rollback test\n";
@@ -527,6 +1058,65 @@ void TestUTXORollback()
     }
 }
 
+void TestReadOnlyConnection()
+{
+    cout << "\nWallet database read-only connection test\n";
+    auto db = createSqliteWalletDB();
+    auto& mainDB = static_cast<WalletDB&>(*db);
+    mainDB.enableWAL();
+
+    auto getAvailable = [](IWalletDB& walletDB)
+    {
+        storage::Totals totals(walletDB);
+        return AmountBig::get_Lo(totals.GetBeamTotals().Avail);
+    };
+
+    vector<Coin> coins = { CreateAvailCoin(5), CreateAvailCoin(7) };
+    db->storeCoins(coins);
+    mainDB.flushDB();
+
+    auto roDB = WalletDB::openReadOnly("wallet.db", string("pass123"));
+    WALLET_CHECK(getAvailable(*roDB) == 12);
+    WALLET_CHECK(roDB->getCoinConfirmationsOffset() == 0);
+
+    // not committed yet
+    Coin coin = CreateAvailCoin(3);
+    db->storeCoin(coin);
+    WalletAddress addr;
+    db->createAddress(addr);
+    db->saveAddress(addr);
+    roDB->syncReadOnly();
+    WALLET_CHECK(getAvailable(*roDB) == 12);
+    WALLET_CHECK(roDB->getAddresses(true).empty());
+
+    mainDB.flushDB();
+    roDB->syncReadOnly();
+    WALLET_CHECK(getAvailable(*roDB) == 15);
+    WALLET_CHECK(roDB->getAddresses(true).size() == 1);
+    WALLET_CHECK(roDB->getAddress(addr.m_walletID));
+
+    db->setCoinConfirmationsOffset(3);
+    db->deleteAddress(addr.m_walletID);
+    mainDB.flushDB();
+    roDB->syncReadOnly();
+    WALLET_CHECK(roDB->getCoinConfirmationsOffset() == 3);
+    WALLET_CHECK(!roDB->getAddress(addr.m_walletID));
+
+    // nothing can be written
+    bool failed = false;
+    try
+    {
+        Coin c = CreateAvailCoin(1);
+        roDB->storeCoin(c);
+    }
+    catch (const std::exception&)
+    {
+        failed = true;
+    }
+    WALLET_CHECK(failed);
+    WALLET_CHECK(getAvailable(*db) == 15);
+}
+
 void TestTxRollback()
 {
     cout << "\nWallet database transaction rollback test\n";
@@ -1508,6 +2098,12 @@ int main()
     TestWalletDataBase();
     TestStoreCoins();
     TestStoreTxRecord();
+    TestTxHistoryFilter();
+    TestTotals();
+    TestBatchedCoins();
+    TestSpendableCoins();
+    TestCoinsFilter();
+    TestReadOnlyConnection();
     TestTxRollback();
     TestUTXORollback();
     TestSelect();
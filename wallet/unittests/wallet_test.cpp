@@ -207,6 +207,9 @@ namespace
         TestWalletRig sender(createSenderWalletDB(), f, TestWalletRig::Type::Regular, false, 0);
         TestWalletRig receiver(createReceiverWalletDB(), f);
 
+        // sender tags its messages, the receiver replies in the old format
+        dynamic_cast<BaseMessageEndpoint&>(*sender.m_messageEndpoint).m_TagOutgoing = true;
+
         WALLET_CHECK(sender.m_WalletDB->selectCoins(6, Zero).size() == 2);
         WALLET_CHECK(sender.m_WalletDB->getTxHistory().empty());
         WALLET_CHECK(receiver.m_WalletDB->getTxHistory().empty());
@@ -638,6 +641,61 @@ namespace
         }
     }
 
+    void TestBbsRecipientTag()
+    {
+        cout << "\nTesting SBBS recipient tag...\n";
+
+        Key::IKdf::Ptr pKdf;
+        HKdf::Create(pKdf, 1234U);
+
+        struct Address
+        {
+            ECC::Scalar::Native m_sk;
+            PeerID m_pk;
+        };
+
+        Address pAddr[5];
+        for (uint32_t i = 0; i < _countof(pAddr); i++)
+        {
+            pKdf->DeriveKey(pAddr[i].m_sk, ECC::Hash::Value(i + 1));
+            pAddr[i].m_pk.FromSk(pAddr[i].m_sk);
+        }
+
+        ByteBuffer message(100);
+        for (size_t i = 0; i < message.size(); i++)
+            message[i] = static_cast<uint8_t>(i);
+
+        const Address& trg = pAddr[3];
+
+        for (uint32_t iTag = 0; iTag < 2; iTag++)
+        {
+            ECC::Scalar::Native nonce;
+            pKdf->DeriveKey(nonce, ECC::Hash::Value(100 + iTag));
+
+            ByteBuffer encrypted;
+            WALLET_CHECK(proto::Bbs::Encrypt(encrypted, trg.m_pk, nonce, &message.front(), static_cast<uint32_t>(message.size()), !!iTag));
+
+            proto::Bbs::RecipientTag tag;
+            uint32_t nSize = static_cast<uint32_t>(encrypted.size());
+            WALLET_CHECK(tag.Read(&encrypted.front(), nSize) == !!iTag);
+
+            for (const auto& addr : pAddr)
+            {
+                bool bMatch = (&addr == &trg);
+                if (iTag)
+                    WALLET_CHECK(tag.IsFor(addr.m_pk) == bMatch);
+
+                ByteBuffer buf(encrypted.begin(), encrypted.begin() + nSize);
+                uint8_t* pMsg = &buf.front();
+                uint32_t n = nSize;
+
+                WALLET_CHECK(proto::Bbs::Decrypt(pMsg, n, addr.m_sk) == bMatch);
+                if (bMatch)
+                    WALLET_CHECK((n == message.size()) && !memcmp(pMsg, &message.front(), n));
+            }
+        }
+    }
+
     void TestSplitTransaction()
     {
         cout << "\nTesting split Tx...\n";
@@ -2564,6 +2622,202 @@ void TestKeyKeeper(IPrivateKeyKeeper2::Ptr externalKeyKeeper = {}, size_t index
     WALLET_CHECK(tx.IsValid(ctx));
 }
 
+void TestKeyKeeperOutputsBatch()
+{
+    cout << "\nTesting key keeper outputs batch...\n";
+
+    io::Reactor::Ptr mainReactor{ io::Reactor::create() };
+    io::Reactor::Scope scope(*mainReactor);
+
+    Key::IKdf::Ptr pKdf;
+    HKdf::Create(pKdf, 12345U);
+
+    auto pKk = std::make_shared<LocalPrivateKeyKeeperStd>(pKdf);
+    const Height hScheme = Rules::get().pForks[1].m_Height;
+
+    auto makeBatch = [&]()
+    {
+        IPrivateKeyKeeper2::Method::CreateOutputs res;
+        res.m_vOutputs.resize(9);
+        for (size_t i = 0; i < res.m_vOutputs.size(); i++)
+        {
+            auto& m = res.m_vOutputs[i];
+            m.m_hScheme = hScheme;
+            m.m_Cid = CoinID(100 + i, 200 + i, Key::Type::Regular, static_cast<Key::Index>(i % 3));
+        }
+        return res;
+    };
+
+    auto getBuf = [](const Output& outp)
+    {
+        Serializer ser;
+        ser & outp;
+        return ser.buffer();
+    };
+
+    // must be the same as created one by one, regardless of the evaluation order
+    auto verify = [&](IPrivateKeyKeeper2::Method::CreateOutputs& x)
+    {
+        for (const auto& m : x.m_vOutputs)
+        {
+            IPrivateKeyKeeper2::Method::CreateOutput mSingle;
+            mSingle.m_hScheme = m.m_hScheme;
+            mSingle.m_Cid = m.m_Cid;
+            WALLET_CHECK(IPrivateKeyKeeper2::Status::Success == pKk->InvokeSync(mSingle));
+
+            ECC::Point::Native comm;
+            WALLET_CHECK(m.m_pResult && m.m_pResult->IsValid(hScheme, comm));
+            WALLET_CHECK(getBuf(*m.m_pResult) == getBuf(*mSingle.m_pResult));
+        }
+    };
+
+    {
+        auto m = makeBatch();
+        WALLET_CHECK(IPrivateKeyKeeper2::Status::Success == pKk->InvokeSync(m));
+        verify(m);
+    }
+
+    {
+        auto m = makeBatch();
+        ExecutorMT exec;
+        Executor::Scope scopeExec(exec);
+        WALLET_CHECK(IPrivateKeyKeeper2::Status::Success == pKk->InvokeSync(m));
+        verify(m);
+    }
+
+    {
+        // via the default implementation (one by one), and via the worker threads
+        auto pThreadedImpl = std::make_shared<ThreadedPrivateKeyKeeper>(pKk, 2);
+        IPrivateKeyKeeper2::Ptr pThreaded = pThreadedImpl;
+
+        struct MyHandler
+            :public IPrivateKeyKeeper2::Handler
+        {
+            IPrivateKeyKeeper2::Status::Type m_Status = IPrivateKeyKeeper2::Status::InProgress;
+            uint32_t m_Calls = 0;
+
+            void OnDone(IPrivateKeyKeeper2::Status::Type n) override
+            {
+                m_Status = n;
+                m_Calls++;
+                io::Reactor::get_Current().stop();
+            }
+        };
+
+        auto m = makeBatch();
+        auto pHandler = std::make_shared<MyHandler>();
+        pThreaded->IPrivateKeyKeeper2::InvokeAsync(m, pHandler);
+        mainReactor->run();
+        WALLET_CHECK(IPrivateKeyKeeper2::Status::Success == pHandler->m_Status);
+        WALLET_CHECK(1 == pHandler->m_Calls);
+        verify(m);
+
+        m = makeBatch();
+        WALLET_CHECK(IPrivateKeyKeeper2::Status::Success == pThreaded->InvokeSync(m));
+        verify(m);
+
+        IPrivateKeyKeeper2::Method::get_Kdf mKdf;
+        mKdf.m_Root = true;
+        WALLET_CHECK(IPrivateKeyKeeper2::Status::Success == pThreaded->InvokeSync(mKdf));
+        WALLET_CHECK(mKdf.m_pKdf);
+
+        typedef ThreadedPrivateKeyKeeper::MethodID MethodID;
+        WALLET_CHECK(pThreadedImpl->get_Stats(MethodID::CreateOutput).m_Count == m.m_vOutputs.size());
+        WALLET_CHECK(pThreadedImpl->get_Stats(MethodID::CreateOutputs).m_Count == 1);
+        WALLET_CHECK(pThreadedImpl->get_Stats(MethodID::get_Kdf).m_Count == 1);
+        WALLET_CHECK(pThreadedImpl->get_Stats(MethodID::SignSender).m_Count == 0);
+        WALLET_CHECK(!strcmp(ThreadedPrivateKeyKeeper::get_MethodName(MethodID::CreateOutputs), "CreateOutputs"));
+    }
+
+    {
+        // the keeper isn't declared thread-safe, the light method must not run while the heavy one is in progress
+        struct MyKeeKeeper
+            :public LocalPrivateKeyKeeperStd
+        {
+            using LocalPrivateKeyKeeperStd::LocalPrivateKeyKeeperStd;
+            using LocalPrivateKeyKeeperStd::InvokeSync;
+
+            std::atomic<uint32_t> m_Inside{ 0 };
+            std::atomic<uint32_t> m_Overlaps{ 0 };
+
+            void Enter()
+            {
+                if (m_Inside++)
+                    m_Overlaps++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+
+            Status::Type InvokeSync(Method::CreateOutputs& m) override
+            {
+                Enter();
+                auto res = LocalPrivateKeyKeeperStd::InvokeSync(m);
+                m_Inside--;
+                return res;
+            }
+
+            Status::Type InvokeSync(Method::get_Kdf& m) override
+            {
+                Enter();
+                auto res = LocalPrivateKeyKeeperStd::InvokeSync(m);
+                m_Inside--;
+                return res;
+            }
+        };
+
+        struct MyHandler
+            :public IPrivateKeyKeeper2::Handler
+        {
+            uint32_t& m_Pending;
+            explicit MyHandler(uint32_t& n) :m_Pending(n) {}
+
+            void OnDone(IPrivateKeyKeeper2::Status::Type n) override
+            {
+                WALLET_CHECK(IPrivateKeyKeeper2::Status::Success == n);
+                if (!--m_Pending)
+                    io::Reactor::get_Current().stop();
+            }
+        };
+
+        auto pMyKk = std::make_shared<MyKeeKeeper>(pKdf);
+        auto pThreaded = std::make_shared<ThreadedPrivateKeyKeeper>(pMyKk, 2);
+
+        uint32_t nPending = 0;
+        auto pHandler = std::make_shared<MyHandler>(nPending);
+
+        auto m1 = makeBatch();
+        auto m2 = makeBatch();
+        IPrivateKeyKeeper2::Method::get_Kdf mKdf;
+        mKdf.m_Root = true;
+
+        nPending = 3;
+        pThreaded->InvokeAsync(m1, pHandler);
+        pThreaded->InvokeAsync(m2, pHandler);
+        pThreaded->InvokeAsync(mKdf, pHandler);
+        mainReactor->run();
+
+        WALLET_CHECK(!nPending);
+        WALLET_CHECK(!pMyKk->m_Overlaps);
+        verify(m1);
+        verify(m2);
+    }
+
+    {
+        // trustless keeper must reject the whole batch if one of the outputs uses weak scheme
+        struct MyKeeKeeper
+            :public LocalPrivateKeyKeeperStd
+        {
+            using LocalPrivateKeyKeeperStd::LocalPrivateKeyKeeperStd;
+
+            bool IsTrustless() override { return true; }
+        };
+
+        MyKeeKeeper kk(pKdf);
+        auto m = makeBatch();
+        m.m_vOutputs[5].m_hScheme = 0;
+        WALLET_CHECK(IPrivateKeyKeeper2::Status::Success != kk.InvokeSync(m));
+    }
+}
+
 void TestVouchers()
 {
     cout << "\nTesting wallets vouchers exchange...\n";
@@ -2623,6 +2877,115 @@ void TestVouchers()
     WALLET_CHECK(!sender.m_Vouchers.empty());
 }
 
+void TestEventsUtxoBatch()
+{
+    cout << "\nTesting wallet utxo events batch...\n";
+
+    io::Reactor::Ptr mainReactor{ io::Reactor::create() };
+    io::Reactor::Scope scope(*mainReactor);
+
+    TestNodeNetwork::Shared tnns;
+
+    // responds with the given events
+    struct MyNetwork
+        :public TestNodeNetwork
+    {
+        ByteBuffer m_Events;
+        uint32_t m_Requests = 0;
+
+        using TestNodeNetwork::TestNodeNetwork;
+
+        void PostProcess(Request& r) override
+        {
+            if (Request::Type::Events != r.get_Type())
+            {
+                TestNodeNetwork::PostProcess(r);
+                return;
+            }
+
+            auto& v = static_cast<proto::FlyClient::RequestEvents&>(r);
+            v.m_Res.m_Events = m_Events;
+            m_Requests++;
+
+            io::Reactor::get_Current().stop(); // the response is handled before the reactor exits
+        }
+    };
+
+    struct MyObserver
+        :public IWalletDbObserver
+    {
+        uint32_t m_Notifications = 0;
+        size_t m_Items = 0;
+
+        void onCoinsChanged(ChangeAction, const std::vector<Coin>& items) override
+        {
+            m_Notifications++;
+            m_Items += items.size();
+        }
+    } obs;
+
+    auto db = createReceiverWalletDB();
+
+    Coin cSpent = CreateAvailCoin(3, 0);
+    db->storeCoin(cSpent); // known coin, spent in the batch
+
+    Coin cTmp = db->generateNewCoin(5, 0); // created and spent in the batch
+    Coin cNew = db->generateNewCoin(7, 0); // created in the batch
+
+    Serializer ser;
+    auto addEvent = [&ser, &db](Height h, const CoinID& cid, bool bAdd)
+    {
+        proto::Event::Utxo evt;
+        evt.m_Flags = bAdd ? proto::Event::Flags::Add : 0;
+        evt.m_Cid = cid;
+        evt.m_Maturity = h;
+        WALLET_CHECK(db->get_CommitmentSafe(evt.m_Commitment, cid));
+
+        ser & h;
+        ser & proto::Event::Utxo::s_Type;
+        ser & evt;
+    };
+
+    addEvent(1, cTmp.m_ID, true);
+    addEvent(1, cNew.m_ID, true);
+    addEvent(2, cTmp.m_ID, false);
+    addEvent(3, cSpent.m_ID, false);
+
+    Wallet wallet(db);
+    auto pNet = make_shared<MyNetwork>(tnns, wallet);
+    ser.swap_buf(pNet->m_Events);
+    wallet.SetNodeEndpoint(pNet);
+
+    for (int i = 0; i < 3; i++)
+        tnns.AddBlock();
+
+    db->Subscribe(&obs);
+    Cast::Down<proto::FlyClient>(wallet).OnOwnedNode(Zero, true); // the wallet requests the events from the owned node only
+
+    io::Timer::Ptr timer = io::Timer::create(*mainReactor);
+    timer->start(5000, false, []() { io::Reactor::get_Current().stop(); });
+
+    mainReactor->run();
+    db->Unsubscribe(&obs);
+
+    WALLET_CHECK(pNet->m_Requests == 1); // fewer events than the max, no more requests
+    WALLET_CHECK(obs.m_Notifications == 1); // the whole batch is saved at once
+    WALLET_CHECK(obs.m_Items == 3); // the events of the same coin are merged
+
+    WALLET_CHECK(db->findCoin(cTmp));
+    WALLET_CHECK(cTmp.m_confirmHeight == 1);
+    WALLET_CHECK(cTmp.m_spentHeight == 2);
+    WALLET_CHECK(cTmp.m_status == Coin::Status::Spent);
+
+    WALLET_CHECK(db->findCoin(cNew));
+    WALLET_CHECK(cNew.m_confirmHeight == 1);
+    WALLET_CHECK(cNew.m_status == Coin::Status::Available);
+
+    WALLET_CHECK(db->findCoin(cSpent));
+    WALLET_CHECK(cSpent.m_spentHeight == 3);
+    WALLET_CHECK(cSpent.m_status == Coin::Status::Spent);
+}
+
 #if defined(BEAM_HW_WALLET)
 
 //IWalletDB::Ptr createSqliteWalletDB()
@@ -2872,8 +3235,10 @@ int main()
     storage::HookErrors();
 
     TestKeyKeeper();
+    TestKeyKeeperOutputsBatch();
 
     TestVouchers();
+    TestEventsUtxoBatch();
 
 
     //TestBbsDecrypt();
@@ -2888,6 +3253,7 @@ int main()
     
     TestNegotiation();
     
+    TestBbsRecipientTag();
     TestP2PWalletNegotiationST();
     
     TestTxRollback();
@@ -96,6 +96,7 @@ public:
         return ret;
     }
     bool findCoin(Coin& coin) override { return false; }
+    std::vector<Coin> findCoins(const CoinIDList& ids) const override { return {}; }
     std::vector<Coin> getCoinsCreatedByTx(const TxID& txId) const override { return {}; };
     std::vector<Coin> getCoinsByID(const CoinIDList& ids) const override { return {}; };
     void storeCoin(Coin&) override {}
@@ -105,6 +106,8 @@ public:
     void removeCoins(const std::vector<Coin::ID>&) override {}
     void removeCoin(const Coin::ID&) override {}
     void visitCoins(std::function<bool(const Coin& coin)>) override {}
+    void visitCoins(const CoinsFilter&, uint64_t, int, const std::function<bool(const Coin& coin)>&) override {}
+    void getCoinTotals(storage::Totals&) override {}
     void setVarRaw(const char*, const void*, size_t) override {}
     bool getVarRaw(const char*, void*, int) const override { return false; }
     bool getBlob(const char* name, ByteBuffer& var) const override { return false; }
@@ -116,6 +119,7 @@ public:
     void Unsubscribe(IWalletDbObserver* observer) override {}
 
     std::vector<TxDescription> getTxHistory(wallet::TxType, uint64_t, int) const override { return {}; };
+    std::vector<TxDescription> getTxHistory(const TxHistoryFilter&, uint64_t, int) const override { return {}; };
     boost::optional<TxDescription> getTx(const TxID&) const override { return boost::optional<TxDescription>{}; };
     void saveTx(const TxDescription& p) override
     {
@@ -135,6 +139,7 @@ public:
     void deleteTx(const TxID&) override {};
 
     std::vector<WalletAddress> getAddresses(bool own, bool isLaser = false) const override { return {}; }
+    void visitAddresses(bool, uint64_t, int, const std::function<bool(const WalletAddress&)>&) const override {}
 
     WalletAddress m_LastAdddr;
 